@@ -1,11 +1,15 @@
 #ifndef ACTIONMANAGER_H
 # define ACTIONMANAGER_H
 
-# include <stack>
+# include <deque>
 # include <memory>
 # include <functional>
+# include <chrono>
+# include <optional>
 
 # include "IAction.h"
+# include "CompoundAction.h"
+# include "EditJournal.h"
 
 namespace HMDT::Action {
     /**
@@ -14,11 +18,33 @@ namespace HMDT::Action {
      * @par This class is the main interface for how Actions are triggered. It
      *      maintains a state of each action performed, and is able to roll that
      *      stack backwards or forwards as necessary.
+     *
+     * @par The history is kept within a byte budget, based on the size that
+     *      each action reports. Once the budget is exceeded, the oldest
+     *      actions are forgotten. Consecutive actions which are performed
+     *      within the coalesce window of each other may also be merged into a
+     *      single entry (see IAction::mergeWith), and any actions performed
+     *      between beginGroup() and endGroup() are recorded as a single entry.
+     *
+     * @par If a journal is set, then the result of every action which is done,
+     *      undone, or redone is appended to it. Edits which are made outside
+     *      of any action may be appended to it with recordEdits(). The same
+     *      results are also passed to the edits callback, whether or not a
+     *      journal is set.
      */
     class ActionManager final {
         public:
             using ActionUpdateCallbackType = std::function<void(const IAction&)>;
 
+            //! Called with the result of every edit, and whether that result
+            //!   describes everything that was changed
+            using EditsCallbackType = std::function<void(const JournalDeltaList&, bool)>;
+
+            using Clock = std::chrono::steady_clock;
+
+            //! The default number of bytes the history may take up
+            constexpr static std::size_t DEFAULT_HISTORY_BUDGET = 64 * 1024 * 1024;
+
             static ActionManager& getInstance();
 
             template<typename T>
@@ -34,24 +60,69 @@ namespace HMDT::Action {
 
             void clearHistory();
 
+            void beginGroup();
+            bool endGroup();
+            bool isGrouping() const;
+
             bool canUndo() const;
             bool canRedo() const;
 
             uint32_t getHistorySize() const;
             uint32_t getUndoneHistorySize() const;
 
+            std::size_t getHistoryBytes() const;
+
+            void setHistoryBudget(std::size_t);
+            std::size_t getHistoryBudget() const;
+
+            void setCoalesceWindow(const Clock::duration&);
+            const Clock::duration& getCoalesceWindow() const;
+
+            void setJournal(std::shared_ptr<EditJournal>);
+            const std::shared_ptr<EditJournal>& getJournal() const;
+
+            void recordEdits(const JournalDeltaList&);
+
             void setOnDoActionCallback(const ActionUpdateCallbackType&);
             void setOnUndoActionCallback(const ActionUpdateCallbackType&);
             void setOnRedoActionCallback(const ActionUpdateCallbackType&);
+            void setOnEditsCallback(const EditsCallbackType&);
 
         private:
             ActionManager();
 
+            void pushAction(std::unique_ptr<IAction>);
+            void clearUndoneActions();
+            void enforceHistoryBudget();
+            void journalAction(const IAction&, bool);
+
             //! Stack of actions from oldest to newest
-            std::stack<std::unique_ptr<IAction>> m_actions;
+            std::deque<std::unique_ptr<IAction>> m_actions;
+
+            //! Stack of undone actions, the next one to be redone is at the back
+            std::deque<std::unique_ptr<IAction>> m_undone_actions;
+
+            //! The sum of getSize() for every action in both stacks
+            std::size_t m_history_bytes;
+
+            //! The maximum number of bytes both stacks may take up
+            std::size_t m_history_budget;
+
+            //! How soon after the last action an action must be done to be
+            //!   coalesced with it. A duration of 0 disables coalescing
+            Clock::duration m_coalesce_window;
+
+            //! When the top of m_actions was last done, if it may be coalesced
+            std::optional<Clock::time_point> m_last_action_time;
+
+            //! The group that actions are currently being added to
+            std::unique_ptr<CompoundAction> m_group;
+
+            //! How many times beginGroup() has been called without endGroup()
+            uint32_t m_group_depth;
 
-            //! Stack of undone actions from newest to oldest
-            std::stack<std::unique_ptr<IAction>> m_undone_actions;
+            //! The journal that every edit is recorded in, if any
+            std::shared_ptr<EditJournal> m_journal;
 
             //! Called when an action is performed
             ActionUpdateCallbackType m_on_do_action;
@@ -59,6 +130,8 @@ namespace HMDT::Action {
             ActionUpdateCallbackType m_on_undo_action;
             //! Called when an action is redone
             ActionUpdateCallbackType m_on_redo_action;
+            //! Called with the result of every edit
+            EditsCallbackType m_on_edits;
     };
 }
 
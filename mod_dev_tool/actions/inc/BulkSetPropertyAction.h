@@ -0,0 +1,257 @@
+#ifndef BULKSETPROPERTYACTION_H
+# define BULKSETPROPERTYACTION_H
+
+# include <string>
+# include <string_view>
+# include <vector>
+# include <functional>
+
+# include "PreprocessorUtils.h"
+# include "Util.h"
+# include "Types.h"
+
+# include "Logger.h"
+
+# include "IAction.h"
+
+namespace HMDT::Action {
+    /**
+     * @brief Sets a single property to the same value on many structures at
+     *        once.
+     *
+     * @par Every structure is validated before any of them are modified, so
+     *      the action is either applied to all structures or to none of them.
+     *      Structures which already hold the new value are skipped entirely,
+     *      and once the change has been made (or reverted), a single
+     *      notification is sent out with the ID of every structure that was
+     *      affected.
+     *
+     * @tparam S The structure type. Must have an 'id' field.
+     * @tparam T The type of value that is to get set
+     */
+    template<typename S, typename T>
+    class BulkSetPropertyAction: public Action::IAction {
+        public:
+            //! The type of ID used to refer to each structure
+            using IDType = std::remove_cv_t<decltype(S::id)>;
+
+            //! Called once with every affected ID and the name of the field
+            //!   after a do or undo
+            using ChangedCallback = std::function<void(const std::vector<IDType>&, std::string_view)>;
+
+            BulkSetPropertyAction(const RefVector<S>& structures,
+                                  T S::* field,
+                                  const T& new_value,
+                                  std::string_view field_name = "",
+                                  const ChangedCallback& on_changed = nullptr):
+                m_structures(),
+                m_old_values(),
+                m_ids(),
+                m_field(field),
+                m_new_value(new_value),
+                m_field_name(field_name),
+                m_on_changed(on_changed)
+            {
+                m_structures.reserve(structures.size());
+                m_old_values.reserve(structures.size());
+                m_ids.reserve(structures.size());
+
+                for(S& structure : structures) {
+                    // Nothing to do (or undo) for these
+                    if(structure.*m_field == m_new_value) continue;
+
+                    m_structures.push_back(&structure);
+                    m_old_values.push_back(structure.*m_field);
+                    m_ids.push_back(structure.id);
+                }
+            }
+
+            template<typename V,
+                     typename = std::enable_if_t<std::is_convertible_v<V, T>>>
+            BulkSetPropertyAction(const RefVector<S>& structures,
+                                  T S::* field, const V& new_value,
+                                  std::string_view field_name = "",
+                                  const ChangedCallback& on_changed = nullptr):
+                BulkSetPropertyAction(structures, field,
+                                      static_cast<const T&>(new_value),
+                                      field_name, on_changed)
+            { }
+
+            virtual bool doAction(const Action::IAction::Callback& callback = _) override
+            {
+                if(!callback(0)) return false;
+
+                if(auto num_mismatched = countMismatched(true);
+                        num_mismatched != 0)
+                {
+                    WRITE_ERROR(num_mismatched, " of ", m_structures.size(),
+                                " current values do not match the old value!");
+                    return false;
+                }
+
+                WRITE_DEBUG("Setting field '", m_field_name.data(), "' on ",
+                            m_structures.size(), " structures.");
+                for(auto* structure : m_structures) {
+                    structure->*m_field = m_new_value;
+                }
+
+                // Set back if we are told of a failure
+                if(!callback(1)) {
+                    restoreOldValues();
+                    return false;
+                }
+
+                notifyChanged();
+
+                return true;
+            }
+
+            virtual bool undoAction(const Action::IAction::Callback& callback = _) override
+            {
+                if(!callback(0)) return false;
+
+                if(auto num_mismatched = countMismatched(false);
+                        num_mismatched != 0)
+                {
+                    WRITE_ERROR(num_mismatched, " of ", m_structures.size(),
+                                " current values do not match the new value!");
+                    return false;
+                }
+
+                WRITE_DEBUG("UnSetting field '", m_field_name.data(), "' on ",
+                            m_structures.size(), " structures.");
+                restoreOldValues();
+
+                // Set back if we are told of a failure
+                if(!callback(1)) {
+                    for(auto* structure : m_structures) {
+                        structure->*m_field = m_new_value;
+                    }
+                    return false;
+                }
+
+                notifyChanged();
+
+                return true;
+            }
+
+            /**
+             * @brief Bulk actions which end up not changing anything are not
+             *        worth keeping in the history.
+             */
+            virtual bool canBeUndone() const override {
+                return !m_structures.empty();
+            }
+
+            virtual std::size_t getSize() const override {
+                std::size_t size = sizeof(*this) + getHeapSize(m_new_value) +
+                                   m_structures.capacity() * sizeof(S*) +
+                                   m_old_values.capacity() * sizeof(T) +
+                                   m_ids.capacity() * sizeof(IDType);
+
+                for(auto&& old_value : m_old_values) {
+                    size += getHeapSize(old_value);
+                }
+
+                return size;
+            }
+
+            /**
+             * @brief Describes the value the field holds on every affected
+             *        structure after this action is done or undone.
+             */
+            virtual bool writeDeltas(JournalDeltaList& deltas,
+                                     bool is_undo) const override
+            {
+                for(std::size_t i = 0; i < m_structures.size(); ++i) {
+                    auto delta = makeSetPropertyDelta(*m_structures[i], m_field,
+                                                      is_undo ? m_old_values[i]
+                                                              : m_new_value);
+                    if(!delta) return false;
+
+                    deltas.push_back(std::move(*delta));
+                }
+
+                return true;
+            }
+
+            /**
+             * @brief Gets the ID of every structure this action modifies.
+             */
+            const std::vector<IDType>& getAffectedIDs() const noexcept {
+                return m_ids;
+            }
+
+        protected:
+            /**
+             * @brief Counts how many structures do not currently hold the
+             *        value they are expected to.
+             *
+             * @param expect_old Whether the old values or the new value are
+             *                   expected to be held.
+             *
+             * @return The number of structures which do not match.
+             */
+            std::size_t countMismatched(bool expect_old) const {
+                std::size_t num_mismatched = 0;
+
+                for(std::size_t i = 0; i < m_structures.size(); ++i) {
+                    const auto& expected = expect_old ? m_old_values[i] : m_new_value;
+
+                    if(!(m_structures[i]->*m_field == expected)) {
+                        ++num_mismatched;
+                    }
+                }
+
+                return num_mismatched;
+            }
+
+            void restoreOldValues() {
+                for(std::size_t i = 0; i < m_structures.size(); ++i) {
+                    m_structures[i]->*m_field = m_old_values[i];
+                }
+            }
+
+            void notifyChanged() {
+                if(m_on_changed && !m_ids.empty()) {
+                    m_on_changed(m_ids, m_field_name);
+                }
+            }
+
+        private:
+            //! Every structure which is getting modified
+            std::vector<S*> m_structures;
+
+            //! The old value of the field for each structure
+            std::vector<T> m_old_values;
+
+            //! The ID of each structure
+            std::vector<IDType> m_ids;
+
+            //! The field of the structures that is getting modified
+            T S::* m_field;
+
+            //! The new value of the field
+            T m_new_value;
+
+            //! A string representation of the field that is being set (for debug)
+            std::string_view m_field_name;
+
+            //! Called with every affected ID once the field has been changed
+            ChangedCallback m_on_changed;
+    };
+
+# define NewBulkSetPropertyActionWithCallback(STRUCTURES, NAME, VALUE, ON_CHANGED) \
+    new HMDT::Action::BulkSetPropertyAction< \
+        std::remove_reference_t<typename std::decay_t<decltype(STRUCTURES)>::value_type::type>, \
+        decltype(std::remove_reference_t<typename std::decay_t<decltype(STRUCTURES)>::value_type::type>::NAME)> \
+            (STRUCTURES, \
+             &std::remove_reference_t<typename std::decay_t<decltype(STRUCTURES)>::value_type::type>::NAME, \
+             VALUE, STR(NAME), ON_CHANGED)
+
+# define NewBulkSetPropertyAction(STRUCTURES, NAME, VALUE) \
+    NewBulkSetPropertyActionWithCallback(STRUCTURES, NAME, VALUE, nullptr)
+}
+
+#endif
+
@@ -0,0 +1,44 @@
+#ifndef COMPOUNDACTION_H
+# define COMPOUNDACTION_H
+
+# include <vector>
+# include <memory>
+
+# include "IAction.h"
+
+namespace HMDT::Action {
+    /**
+     * @brief An action made up of several other actions, which are all done
+     *        and undone together as a single unit.
+     *
+     * @par Child actions are done in the order they were added, and undone in
+     *      the reverse order. If any child fails, then every child which was
+     *      already processed is rolled back so that the group is either fully
+     *      applied or not applied at all.
+     */
+    class CompoundAction: public Action::IAction {
+        public:
+            CompoundAction() = default;
+            CompoundAction(std::vector<std::unique_ptr<IAction>>&&);
+
+            virtual ~CompoundAction() = default;
+
+            virtual bool doAction(const Callback& = _) override;
+            virtual bool undoAction(const Callback& = _) override;
+
+            virtual std::size_t getSize() const override;
+            virtual bool writeDeltas(JournalDeltaList&, bool) const override;
+
+            void addAction(std::unique_ptr<IAction>);
+
+            bool empty() const noexcept;
+            std::size_t getActionCount() const noexcept;
+
+        private:
+            //! All child actions, from first done to last done
+            std::vector<std::unique_ptr<IAction>> m_actions;
+    };
+}
+
+#endif
+
@@ -22,6 +22,8 @@ namespace HMDT::Action {
             virtual bool doAction(const Callback& = _) override;
             virtual bool undoAction(const Callback& = _) override;
 
+            virtual bool writeDeltas(JournalDeltaList&, bool) const override;
+
         protected:
             bool create();
             bool remove();
@@ -0,0 +1,136 @@
+/**
+ * @file EditJournal.h
+ *
+ * @brief Defines an append-only journal of every edit made to a project since
+ *        it was last saved.
+ */
+
+#ifndef EDITJOURNAL_H
+# define EDITJOURNAL_H
+
+# include <chrono>
+# include <cstdint>
+# include <cstdio>
+# include <filesystem>
+# include <memory>
+# include <mutex>
+# include <string>
+# include <vector>
+
+# include "Maybe.h"
+
+# include "IProject.h"
+
+# include "JournalDelta.h"
+
+namespace HMDT::Action {
+    /**
+     * @brief An append-only file of every edit made to a project since it was
+     *        last saved.
+     *
+     * @details Each delta is given a sequence number and encoded into a small
+     *          binary record. Records are buffered in memory and only written
+     *          and synced to disk in batches, once enough of them have built
+     *          up or enough time has passed since the last batch. A record
+     *          which was only partially written when the program died is
+     *          detected by its length and checksum, and is thrown away the
+     *          next time the journal is read.
+     *
+     * @par Once a full save has been written, discardThrough() drops every
+     *      delta which the save already holds. The journal is also compacted
+     *      every so often, keeping only the last value set on each field, so
+     *      that it stays small even if a project is left unsaved for a long
+     *      time.
+     *
+     * @par When a project is closed on purpose, clear() drops every delta,
+     *      so a journal is only ever left holding deltas if the program did
+     *      not shut down cleanly. On startup, replay() applies every delta in
+     *      such a journal on top of the last full save.
+     */
+    class EditJournal {
+        public:
+            using Clock = std::chrono::steady_clock;
+            using Sequence = std::uint64_t;
+
+            //! How many deltas may be buffered before they must be written
+            constexpr static std::size_t FLUSH_COUNT = 64;
+
+            //! How long deltas may be buffered before they must be written
+            constexpr static Clock::duration FLUSH_INTERVAL = std::chrono::seconds(5);
+
+            //! How many records the file may hold before it is compacted
+            constexpr static std::size_t COMPACT_COUNT = 8192;
+
+            //! The version of the file format
+            constexpr static std::uint32_t VERSION = 1;
+
+            static Maybe<std::shared_ptr<EditJournal>> open(const std::filesystem::path&);
+            static Maybe<JournalDeltaList> read(const std::filesystem::path&);
+            static Maybe<std::size_t> replay(const std::filesystem::path&,
+                                             Project::IRootProject&);
+            static MaybeVoid apply(const JournalDelta&, Project::IRootProject&);
+
+            EditJournal(const EditJournal&) = delete;
+            EditJournal& operator=(const EditJournal&) = delete;
+
+            ~EditJournal();
+
+            MaybeVoid append(const JournalDeltaList&);
+            MaybeVoid flush();
+            bool flushForCrash() noexcept;
+
+            MaybeVoid compact();
+            MaybeVoid discardThrough(Sequence);
+            MaybeVoid clear();
+
+            Sequence getSequence() const noexcept;
+            const std::filesystem::path& getPath() const noexcept;
+
+        private:
+            /**
+             * @brief A single delta, as it is stored in the file
+             */
+            struct Record {
+                Sequence sequence;
+                JournalDelta delta;
+            };
+
+            EditJournal(const std::filesystem::path&, std::FILE*, Sequence,
+                        std::size_t);
+
+            static Maybe<std::vector<Record>> readRecords(const std::filesystem::path&,
+                                                          std::uintmax_t* = nullptr);
+            static void encodeRecord(const Record&, std::string&);
+
+            MaybeVoid writePending();
+            MaybeVoid compactFile();
+            MaybeVoid rewrite(const std::vector<Record>&);
+
+            //! Guards every member below
+            mutable std::mutex m_mutex;
+
+            //! The path to the journal file
+            std::filesystem::path m_path;
+
+            //! The journal file, opened for appending
+            std::FILE* m_file;
+
+            //! Every record which has not yet been written, already encoded
+            std::string m_pending;
+
+            //! How many records are in m_pending
+            std::size_t m_pending_count;
+
+            //! The sequence number of the last delta appended
+            Sequence m_sequence;
+
+            //! How many records have been written to the file
+            std::size_t m_file_record_count;
+
+            //! When the last batch of records was written
+            Clock::time_point m_last_flush;
+    };
+}
+
+#endif
+
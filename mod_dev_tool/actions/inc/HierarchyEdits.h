@@ -0,0 +1,25 @@
+/**
+ * @file HierarchyEdits.h
+ *
+ * @brief Works out which nodes of a project hierarchy are touched by the
+ *        edits recorded in journal deltas.
+ */
+
+#ifndef HIERARCHYEDITS_H
+# define HIERARCHYEDITS_H
+
+# include <optional>
+# include <string>
+# include <vector>
+
+# include "IProject.h"
+
+# include "JournalDelta.h"
+
+namespace HMDT::Action {
+    std::optional<std::vector<std::string>> getChangedPropertyPaths(const JournalDeltaList&,
+                                                                    const Project::IRootProject&);
+}
+
+#endif
+
@@ -2,6 +2,11 @@
 # define IACTION_H
 
 # include <functional>
+# include <cstddef>
+
+# include "TypeTraits.h"
+
+# include "JournalDelta.h"
 
 namespace HMDT::Action {
     /**
@@ -32,6 +37,18 @@ namespace HMDT::Action {
      *      either does not affect the affect the stored project state (such as
      *      saving), or where the history will no longer matter (such as loading
      *      or creating a new project).
+     *
+     * @par
+     *      Actions may also report roughly how much memory they are holding on
+     *      to via getSize(), which the ActionManager uses to keep the history
+     *      within its budget, and may optionally absorb an action performed
+     *      immediately after them via mergeWith() so that rapid successive
+     *      edits end up as a single history entry.
+     *
+     * @par
+     *      Actions which change the project should describe their results via
+     *      writeDeltas(), so that they can be recovered from the edit journal
+     *      if the program stops before the project is saved.
      */
     class IAction {
         public:
@@ -50,6 +67,55 @@ namespace HMDT::Action {
             virtual bool undoAction(const Callback& = _) = 0;
 
             virtual bool canBeUndone() const { return true; }
+
+            /**
+             * @brief Gets the approximate number of bytes held by this action,
+             *        including any memory it owns on the heap.
+             */
+            virtual std::size_t getSize() const { return sizeof(IAction); }
+
+            /**
+             * @brief Attempts to fold an action which was performed directly
+             *        after this one into this action.
+             * @details If this returns true, then undoing this action must also
+             *          undo the effects of the given action, which will then be
+             *          thrown away.
+             *
+             * @return True if the action was merged into this action.
+             */
+            virtual bool mergeWith(const IAction&) { return false; }
+
+            /**
+             * @brief Describes the result of doing or undoing this action, so
+             *        that it can be recorded in an EditJournal.
+             *
+             * @param deltas The list to add to.
+             * @param is_undo Whether to describe undoing this action rather
+             *                than doing it.
+             *
+             * @return False if this action cannot be journaled.
+             */
+            virtual bool writeDeltas(JournalDeltaList&, bool) const {
+                return false;
+            }
+
+        protected:
+            /**
+             * @brief Estimates how many bytes a value owns on the heap.
+             *
+             * @param value The value to check.
+             *
+             * @return The capacity of the value if it owns contiguous storage,
+             *         0 otherwise.
+             */
+            template<typename V>
+            static std::size_t getHeapSize(const V& value) {
+                if constexpr(HasCapacity_v<V>) {
+                    return value.capacity() * sizeof(typename V::value_type);
+                } else {
+                    return 0;
+                }
+            }
     };
 }
 
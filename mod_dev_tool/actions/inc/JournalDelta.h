@@ -0,0 +1,281 @@
+/**
+ * @file JournalDelta.h
+ *
+ * @brief Defines a single compact, binary record of an edit made to a
+ *        project, along with how values are encoded into it.
+ */
+
+#ifndef JOURNALDELTA_H
+# define JOURNALDELTA_H
+
+# include <cstdint>
+# include <cstring>
+# include <optional>
+# include <string>
+# include <string_view>
+# include <type_traits>
+# include <vector>
+
+# include "TypeTraits.h"
+# include "Types.h"
+# include "Uuid.h"
+
+namespace HMDT::Action {
+    /**
+     * @brief Encodes a single value onto the end of a byte string.
+     *
+     * @tparam T The type of value to encode
+     * @param value The value to encode
+     * @param out The byte string to append to
+     */
+    template<typename T>
+    void encodeJournalValue(const T& value, std::string& out) {
+        if constexpr(IsSymbol_v<T>) {
+            encodeJournalValue(value.str(), out);
+        } else if constexpr(std::is_same_v<T, std::string>) {
+            encodeJournalValue(static_cast<std::uint32_t>(value.size()), out);
+            out.append(value);
+        } else if constexpr(std::is_same_v<T, UUID>) {
+            auto bytes = value.toBytes();
+            out.append(reinterpret_cast<const char*>(bytes.data()), bytes.size());
+        } else if constexpr(IsVector_v<T>) {
+            encodeJournalValue(static_cast<std::uint32_t>(value.size()), out);
+            for(auto&& element : value) {
+                encodeJournalValue(element, out);
+            }
+        } else {
+            static_assert(std::is_trivially_copyable_v<T>,
+                          "Cannot encode this type into a journal.");
+            out.append(reinterpret_cast<const char*>(&value), sizeof(T));
+        }
+    }
+
+    /**
+     * @brief Decodes a single value from the front of a byte string.
+     *
+     * @tparam T The type of value to decode
+     * @param in The byte string to read from. The decoded bytes are removed
+     *           from the front of it.
+     * @param value Where to decode the value into
+     *
+     * @return True if the value was decoded, false if there were not enough
+     *         bytes left.
+     */
+    template<typename T>
+    bool decodeJournalValue(std::string_view& in, T& value) {
+        if constexpr(IsSymbol_v<T>) {
+            std::string name;
+            if(!decodeJournalValue(in, name)) return false;
+
+            value = T(name);
+        } else if constexpr(std::is_same_v<T, std::string>) {
+            std::uint32_t size;
+            if(!decodeJournalValue(in, size) || in.size() < size) return false;
+
+            value.assign(in.data(), size);
+            in.remove_prefix(size);
+        } else if constexpr(std::is_same_v<T, UUID>) {
+            UUID::Bytes bytes;
+            if(in.size() < bytes.size()) return false;
+
+            std::memcpy(bytes.data(), in.data(), bytes.size());
+            in.remove_prefix(bytes.size());
+
+            value = UUID(bytes);
+        } else if constexpr(IsVector_v<T>) {
+            std::uint32_t size;
+            if(!decodeJournalValue(in, size)) return false;
+
+            value.clear();
+            value.reserve(size);
+            for(std::uint32_t i = 0; i < size; ++i) {
+                auto& element = value.emplace_back();
+                if(!decodeJournalValue(in, element)) return false;
+            }
+        } else {
+            static_assert(std::is_trivially_copyable_v<T>,
+                          "Cannot decode this type from a journal.");
+            if(in.size() < sizeof(T)) return false;
+
+            std::memcpy(&value, in.data(), sizeof(T));
+            in.remove_prefix(sizeof(T));
+        }
+
+        return true;
+    }
+
+    /**
+     * @brief A single edit made to a project.
+     *
+     * @details Every delta holds the result of an edit rather than the edit
+     *          itself, so that replaying a delta on top of a project which
+     *          already has it applied changes nothing. The key, field, and
+     *          value are encoded with encodeJournalValue(), and what they
+     *          mean depends on the type of delta.
+     */
+    struct JournalDelta {
+        enum class Type: std::uint8_t {
+            //! key: ProvinceID, field: Field name, value: New value
+            SET_PROVINCE_PROPERTY,
+
+            //! key: StateID, field: Field name, value: New value
+            SET_STATE_PROPERTY,
+
+            //! key: Continent name
+            CREATE_CONTINENT,
+
+            //! key: Continent name
+            REMOVE_CONTINENT,
+
+            //! key: Parent ProvinceID, value: Child ProvinceID
+            MERGE_PROVINCES,
+
+            //! key: ProvinceID
+            UNMERGE_PROVINCE,
+
+            //! key: StateID, value: Every ProvinceID in the state
+            CREATE_STATE,
+
+            //! key: StateID
+            REMOVE_STATE,
+
+            //! key: ProvinceID, value: StateID
+            MOVE_PROVINCE_TO_STATE,
+
+            //! key: ProvinceID
+            REMOVE_PROVINCE_FROM_STATE
+        };
+
+        Type type;
+        std::string key;
+        std::string field;
+        std::string value;
+
+        bool isSetProperty() const noexcept;
+
+        static JournalDelta createContinent(const std::string&);
+        static JournalDelta removeContinent(const std::string&);
+        static JournalDelta mergeProvinces(const ProvinceID&, const ProvinceID&);
+        static JournalDelta unmergeProvince(const ProvinceID&);
+        static JournalDelta createState(StateID, const std::vector<ProvinceID>&);
+        static JournalDelta removeState(StateID);
+        static JournalDelta moveProvinceToState(const ProvinceID&, StateID);
+        static JournalDelta removeProvinceFromState(const ProvinceID&);
+    };
+
+    using JournalDeltaList = std::vector<JournalDelta>;
+
+    /**
+     * @brief Describes which fields of a structure may be journaled, and how
+     *        the structure is identified. Structures without a specialization
+     *        are never journaled.
+     *
+     * @tparam S The structure type
+     */
+    template<typename S>
+    struct JournalTraits {
+        static constexpr bool IS_JOURNALED = false;
+    };
+
+    template<>
+    struct JournalTraits<Province> {
+        static constexpr bool IS_JOURNALED = true;
+        static constexpr JournalDelta::Type SET_TYPE = JournalDelta::Type::SET_PROVINCE_PROPERTY;
+
+        /**
+         * @brief Calls func(name, member) for every journaled field
+         */
+        template<typename F>
+        static void forEachField(F&& func) {
+            func("type", &Province::type);
+            func("coastal", &Province::coastal);
+            func("terrain", &Province::terrain);
+            func("continent", &Province::continent);
+        }
+    };
+
+    template<>
+    struct JournalTraits<State> {
+        static constexpr bool IS_JOURNALED = true;
+        static constexpr JournalDelta::Type SET_TYPE = JournalDelta::Type::SET_STATE_PROPERTY;
+
+        /**
+         * @brief Calls func(name, member) for every journaled field
+         */
+        template<typename F>
+        static void forEachField(F&& func) {
+            func("name", &State::name);
+            func("manpower", &State::manpower);
+            func("category", &State::category);
+            func("buildings_max_level_factor", &State::buildings_max_level_factor);
+            func("impassable", &State::impassable);
+            func("provinces", &State::provinces);
+        }
+    };
+
+    /**
+     * @brief Builds a delta which sets a single field of a structure.
+     *
+     * @tparam S The structure type
+     * @tparam T The type of the field
+     * @param structure The structure which is changed
+     * @param field The field which is changed
+     * @param value The value the field is set to
+     *
+     * @return The delta, or std::nullopt if the field cannot be journaled.
+     */
+    template<typename S, typename T>
+    std::optional<JournalDelta> makeSetPropertyDelta(const S& structure,
+                                                     T S::* field,
+                                                     const T& value)
+    {
+        if constexpr(JournalTraits<S>::IS_JOURNALED) {
+            std::optional<JournalDelta> delta;
+
+            JournalTraits<S>::forEachField([&](const char* name, auto member) {
+                if constexpr(std::is_same_v<decltype(member), T S::*>) {
+                    if(!delta && member == field) {
+                        delta = JournalDelta{ JournalTraits<S>::SET_TYPE, "", name, "" };
+                        encodeJournalValue(structure.id, delta->key);
+                        encodeJournalValue(value, delta->value);
+                    }
+                }
+            });
+
+            return delta;
+        } else {
+            return std::nullopt;
+        }
+    }
+
+    /**
+     * @brief Applies a delta built by makeSetPropertyDelta() to a structure.
+     *
+     * @tparam S The structure type
+     * @param delta The delta to apply
+     * @param structure The structure to apply it to
+     *
+     * @return True if the delta was applied, false if its field is unknown or
+     *         its value could not be decoded.
+     */
+    template<typename S>
+    bool applySetPropertyDelta(const JournalDelta& delta, S& structure) {
+        bool applied = false;
+
+        JournalTraits<S>::forEachField([&](const char* name, auto member) {
+            if(applied || delta.field != name) return;
+
+            std::remove_reference_t<decltype(structure.*member)> value;
+            std::string_view in = delta.value;
+            if(decodeJournalValue(in, value)) {
+                structure.*member = std::move(value);
+                applied = true;
+            }
+        });
+
+        return applied;
+    }
+}
+
+#endif
+
@@ -84,6 +84,53 @@ namespace HMDT::Action {
                 return true;
             }
 
+            virtual std::size_t getSize() const override {
+                return sizeof(*this) + getHeapSize(m_old_value) +
+                                       getHeapSize(m_new_value);
+            }
+
+            /**
+             * @brief Merges another edit of the same field on the same
+             *        structure into this one.
+             * @details The merge only happens if the other action picked up
+             *          where this one left off, so that undoing this action
+             *          restores the value from before either of them.
+             *
+             * @param next The action which was just performed.
+             *
+             * @return True if next was merged into this action.
+             */
+            virtual bool mergeWith(const Action::IAction& next) override {
+                auto* next_set = dynamic_cast<const SetPropertyAction*>(&next);
+
+                if(next_set == nullptr ||
+                   next_set->m_structure != m_structure ||
+                   next_set->m_field != m_field ||
+                   !(next_set->m_old_value == m_new_value))
+                {
+                    return false;
+                }
+
+                m_new_value = next_set->m_new_value;
+                return true;
+            }
+
+            /**
+             * @brief Describes the value the field holds after this action is
+             *        done or undone.
+             */
+            virtual bool writeDeltas(JournalDeltaList& deltas,
+                                     bool is_undo) const override
+            {
+                auto delta = makeSetPropertyDelta(*m_structure, m_field,
+                                                  is_undo ? m_old_value
+                                                          : m_new_value);
+                if(!delta) return false;
+
+                deltas.push_back(std::move(*delta));
+                return true;
+            }
+
         private:
             //! The structure that is getting modified
             S* m_structure;
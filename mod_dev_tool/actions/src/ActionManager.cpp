@@ -1,6 +1,7 @@
 
 #include "ActionManager.h"
 
+#include "Logger.h"
 #include "Util.h"
 
 auto HMDT::Action::ActionManager::getInstance() -> ActionManager& {
@@ -11,6 +12,10 @@ auto HMDT::Action::ActionManager::getInstance() -> ActionManager& {
 
 /**
  * @brief Performs a single action.
+ * @details If the action was performed within the coalesce window of the
+ *          previous action, and the previous action is able to absorb it, then
+ *          no new history entry is made. If a group is currently open, then
+ *          the action is instead added to that group.
  *
  * @param action The action to perform
  * @param callback A callback to be passed to the action
@@ -27,11 +32,39 @@ bool HMDT::Action::ActionManager::doAction(std::unique_ptr<IAction> action,
         // If the action cannot be undone, make sure we don't add it to the
         //  action history or clear the undo history
         if(action->canBeUndone()) {
+            journalAction(*action, false);
+
             // Once an action is performed, all undone actions must be cleared,
             //  otherwise we end up in a situation where we have branching history,
             //  which just seems like a pain to manage
-            m_undone_actions = { };
-            m_actions.push(std::move(action));
+            clearUndoneActions();
+
+            if(isGrouping()) {
+                m_group->addAction(std::move(action));
+                return true;
+            }
+
+            auto now = Clock::now();
+
+            if(m_coalesce_window != Clock::duration::zero() &&
+               m_last_action_time && !m_actions.empty() &&
+               (now - *m_last_action_time) <= m_coalesce_window)
+            {
+                auto& last_action = m_actions.back();
+                auto last_size = last_action->getSize();
+
+                if(last_action->mergeWith(*action)) {
+                    m_history_bytes -= last_size;
+                    m_history_bytes += last_action->getSize();
+                    m_last_action_time = now;
+
+                    enforceHistoryBudget();
+                    return true;
+                }
+            }
+
+            pushAction(std::move(action));
+            m_last_action_time = now;
         }
         return true;
     }
@@ -51,14 +84,24 @@ bool HMDT::Action::ActionManager::undoAction(const IAction::Callback& callback)
     // Stop early if there is nothing to undo
     if(!canUndo()) return false;
 
-    auto& action = m_actions.top();
+    if(isGrouping()) {
+        WRITE_ERROR("Cannot undo while a group of actions is still open.");
+        return false;
+    }
+
+    auto& action = m_actions.back();
 
     auto* action_ptr = action.get();
     RUN_AT_SCOPE_END([this, action_ptr]() { m_on_undo_action(*action_ptr); });
 
     if(action->undoAction(callback)) {
-        m_undone_actions.push(std::move(action));
-        m_actions.pop();
+        journalAction(*action, true);
+
+        m_undone_actions.push_back(std::move(action));
+        m_actions.pop_back();
+
+        // Never coalesce into an action which was undone and redone
+        m_last_action_time.reset();
         return true;
     }
 
@@ -81,14 +124,23 @@ bool HMDT::Action::ActionManager::redoAction(const IAction::Callback& callback)
     // Stop early if there is nothing to redo
     if(!canRedo()) return false;
 
-    auto& action = m_undone_actions.top();
+    if(isGrouping()) {
+        WRITE_ERROR("Cannot redo while a group of actions is still open.");
+        return false;
+    }
+
+    auto& action = m_undone_actions.back();
 
     auto* action_ptr = action.get();
     RUN_AT_SCOPE_END([this, action_ptr]() { m_on_redo_action(*action_ptr); });
 
     if(action->doAction(callback)) {
-        m_actions.push(std::move(action));
-        m_undone_actions.pop();
+        journalAction(*action, false);
+
+        m_actions.push_back(std::move(action));
+        m_undone_actions.pop_back();
+
+        m_last_action_time.reset();
         return true;
     }
 
@@ -96,8 +148,54 @@ bool HMDT::Action::ActionManager::redoAction(const IAction::Callback& callback)
 }
 
 void HMDT::Action::ActionManager::clearHistory() {
-    m_actions = { };
-    m_undone_actions = { };
+    m_actions.clear();
+    m_undone_actions.clear();
+    m_history_bytes = 0;
+    m_last_action_time.reset();
+
+    if(isGrouping()) {
+        m_group.reset(new CompoundAction);
+    }
+}
+
+/**
+ * @brief Starts recording every action done into a single history entry.
+ * @details Groups may be nested, in which case only the outermost group will
+ *          produce a history entry.
+ */
+void HMDT::Action::ActionManager::beginGroup() {
+    if(m_group_depth++ == 0) {
+        m_group.reset(new CompoundAction);
+    }
+}
+
+/**
+ * @brief Stops recording actions into the current group.
+ * @details Once the outermost group is ended, every action which was done
+ *          since beginGroup() is added to the history as a single entry.
+ *
+ * @return True if a new history entry was made, false otherwise.
+ */
+bool HMDT::Action::ActionManager::endGroup() {
+    if(!isGrouping()) {
+        WRITE_WARN("endGroup() called without a matching beginGroup().");
+        return false;
+    }
+
+    if(--m_group_depth != 0) return false;
+
+    auto group = std::move(m_group);
+
+    if(group->empty()) return false;
+
+    pushAction(std::move(group));
+    m_last_action_time.reset();
+
+    return true;
+}
+
+bool HMDT::Action::ActionManager::isGrouping() const {
+    return m_group_depth != 0;
 }
 
 bool HMDT::Action::ActionManager::canUndo() const {
@@ -116,6 +214,76 @@ uint32_t HMDT::Action::ActionManager::getUndoneHistorySize() const {
     return m_undone_actions.size();
 }
 
+/**
+ * @brief Gets the number of bytes reported by every action in the history.
+ */
+std::size_t HMDT::Action::ActionManager::getHistoryBytes() const {
+    return m_history_bytes;
+}
+
+/**
+ * @brief Sets how many bytes the history may take up. The oldest actions are
+ *        forgotten immediately if the history is over this new budget.
+ *
+ * @param budget The new budget in bytes
+ */
+void HMDT::Action::ActionManager::setHistoryBudget(std::size_t budget) {
+    m_history_budget = budget;
+    enforceHistoryBudget();
+}
+
+std::size_t HMDT::Action::ActionManager::getHistoryBudget() const {
+    return m_history_budget;
+}
+
+/**
+ * @brief Sets how close together two actions must be done in order to be
+ *        merged into a single history entry.
+ *
+ * @param window The coalesce window. A window of 0 disables coalescing.
+ */
+void HMDT::Action::ActionManager::setCoalesceWindow(const Clock::duration& window)
+{
+    m_coalesce_window = window;
+}
+
+auto HMDT::Action::ActionManager::getCoalesceWindow() const
+    -> const Clock::duration&
+{
+    return m_coalesce_window;
+}
+
+/**
+ * @brief Sets the journal which every edit is recorded in.
+ *
+ * @param journal The journal, or nullptr to stop recording edits.
+ */
+void HMDT::Action::ActionManager::setJournal(std::shared_ptr<EditJournal> journal)
+{
+    m_journal = std::move(journal);
+}
+
+auto HMDT::Action::ActionManager::getJournal() const
+    -> const std::shared_ptr<EditJournal>&
+{
+    return m_journal;
+}
+
+/**
+ * @brief Records edits which were made to the project without an action.
+ *
+ * @param deltas The result of each edit
+ */
+void HMDT::Action::ActionManager::recordEdits(const JournalDeltaList& deltas)
+{
+    if(m_journal != nullptr) {
+        auto result = m_journal->append(deltas);
+        WRITE_IF_ERROR(result);
+    }
+
+    m_on_edits(deltas, true);
+}
+
 void HMDT::Action::ActionManager::setOnDoActionCallback(const ActionUpdateCallbackType& do_callback)
 {
     m_on_do_action = do_callback;
@@ -131,10 +299,102 @@ void HMDT::Action::ActionManager::setOnRedoActionCallback(const ActionUpdateCall
     m_on_redo_action = redo_callback;
 }
 
+/**
+ * @brief Sets the callback which is given the result of every edit.
+ * @details The second parameter of the callback is false if an action could
+ *          not describe its result, in which case the list is empty and
+ *          anything may have changed.
+ *
+ * @param edits_callback The callback
+ */
+void HMDT::Action::ActionManager::setOnEditsCallback(const EditsCallbackType& edits_callback)
+{
+    m_on_edits = edits_callback;
+}
+
 HMDT::Action::ActionManager::ActionManager(): m_actions(),
                                               m_undone_actions(),
+                                              m_history_bytes(0),
+                                              m_history_budget(DEFAULT_HISTORY_BUDGET),
+                                              m_coalesce_window(Clock::duration::zero()),
+                                              m_last_action_time(std::nullopt),
+                                              m_group(nullptr),
+                                              m_group_depth(0),
+                                              m_journal(nullptr),
                                               m_on_do_action([](const auto&...) { }),
                                               m_on_undo_action([](const auto&...) { }),
-                                              m_on_redo_action([](const auto&...) { })
+                                              m_on_redo_action([](const auto&...) { }),
+                                              m_on_edits([](const auto&...) { })
 { }
 
+/**
+ * @brief Adds an action which has been done to the top of the history.
+ *
+ * @param action The action to add
+ */
+void HMDT::Action::ActionManager::pushAction(std::unique_ptr<IAction> action) {
+    m_history_bytes += action->getSize();
+    m_actions.push_back(std::move(action));
+
+    enforceHistoryBudget();
+}
+
+void HMDT::Action::ActionManager::clearUndoneActions() {
+    for(auto&& action : m_undone_actions) {
+        m_history_bytes -= action->getSize();
+    }
+    m_undone_actions.clear();
+}
+
+/**
+ * @brief Forgets the oldest actions until the history fits in the budget.
+ * @details The most recently done action is always kept, even if it alone is
+ *          larger than the budget. Actions which have been undone are only
+ *          forgotten after every other action, starting with the one that is
+ *          furthest from being redone.
+ */
+void HMDT::Action::ActionManager::enforceHistoryBudget() {
+    std::size_t num_dropped = 0;
+
+    while(m_history_bytes > m_history_budget && m_actions.size() > 1) {
+        m_history_bytes -= m_actions.front()->getSize();
+        m_actions.pop_front();
+        ++num_dropped;
+    }
+
+    while(m_history_bytes > m_history_budget && !m_undone_actions.empty()) {
+        m_history_bytes -= m_undone_actions.front()->getSize();
+        m_undone_actions.pop_front();
+        ++num_dropped;
+    }
+
+    if(num_dropped != 0) {
+        WRITE_DEBUG("Dropped ", num_dropped, " actions from the history to stay"
+                    " within the budget of ", m_history_budget, " bytes.");
+    }
+}
+
+/**
+ * @brief Records the result of doing or undoing an action in the journal, and
+ *        passes it on to the edits callback.
+ *
+ * @param action The action which was done or undone
+ * @param is_undo Whether the action was undone
+ */
+void HMDT::Action::ActionManager::journalAction(const IAction& action,
+                                                bool is_undo)
+{
+    JournalDeltaList deltas;
+    if(!action.writeDeltas(deltas, is_undo)) {
+        if(m_journal != nullptr) {
+            WRITE_WARN("Action cannot be journaled, so it will not be recovered"
+                       " if the project is not saved.");
+        }
+
+        m_on_edits({}, false);
+        return;
+    }
+
+    recordEdits(deltas);
+}
+
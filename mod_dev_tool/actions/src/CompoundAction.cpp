@@ -0,0 +1,142 @@
+
+#include "CompoundAction.h"
+
+#include <algorithm>
+
+#include "Logger.h"
+
+HMDT::Action::CompoundAction::CompoundAction(std::vector<std::unique_ptr<IAction>>&& actions):
+    m_actions(std::move(actions))
+{ }
+
+/**
+ * @brief Does every child action in order.
+ * @details The callback is invoked once before any child is done, and once
+ *          after all of them have been done.
+ *
+ * @param callback The callback
+ *
+ * @return True if every child action was done, false otherwise.
+ */
+bool HMDT::Action::CompoundAction::doAction(const Callback& callback) {
+    if(!callback(0)) return false;
+
+    for(auto it = m_actions.begin(); it != m_actions.end(); ++it) {
+        if(!(*it)->doAction()) {
+            WRITE_ERROR("Failed to do child action ",
+                        std::distance(m_actions.begin(), it), " of ",
+                        m_actions.size(), ", rolling back.");
+
+            // Undo everything which did succeed, so we don't end up half-done
+            while(it != m_actions.begin()) {
+                --it;
+                (*it)->undoAction();
+            }
+            return false;
+        }
+    }
+
+    if(!callback(1)) {
+        for(auto it = m_actions.rbegin(); it != m_actions.rend(); ++it) {
+            (*it)->undoAction();
+        }
+        return false;
+    }
+
+    return true;
+}
+
+/**
+ * @brief Undoes every child action in reverse order.
+ * @details The callback is invoked once before any child is undone, and once
+ *          after all of them have been undone.
+ *
+ * @param callback The callback
+ *
+ * @return True if every child action was undone, false otherwise.
+ */
+bool HMDT::Action::CompoundAction::undoAction(const Callback& callback) {
+    if(!callback(0)) return false;
+
+    for(auto it = m_actions.rbegin(); it != m_actions.rend(); ++it) {
+        if(!(*it)->undoAction()) {
+            WRITE_ERROR("Failed to undo child action ",
+                        std::distance(it, m_actions.rend()) - 1, " of ",
+                        m_actions.size(), ", rolling back.");
+
+            // Redo everything we already undid
+            while(it != m_actions.rbegin()) {
+                --it;
+                (*it)->doAction();
+            }
+            return false;
+        }
+    }
+
+    if(!callback(1)) {
+        for(auto&& action : m_actions) {
+            action->doAction();
+        }
+        return false;
+    }
+
+    return true;
+}
+
+std::size_t HMDT::Action::CompoundAction::getSize() const {
+    std::size_t size = sizeof(*this) +
+                       m_actions.capacity() * sizeof(decltype(m_actions)::value_type);
+
+    for(auto&& action : m_actions) {
+        size += action->getSize();
+    }
+
+    return size;
+}
+
+/**
+ * @brief Describes every child action, in the order they are done or undone.
+ *
+ * @param deltas The list to add to.
+ * @param is_undo Whether to describe undoing this action rather than doing it.
+ *
+ * @return False if any child cannot be journaled.
+ */
+bool HMDT::Action::CompoundAction::writeDeltas(JournalDeltaList& deltas,
+                                               bool is_undo) const
+{
+    auto writeChild = [&deltas, is_undo](const std::unique_ptr<IAction>& action)
+    {
+        return action->writeDeltas(deltas, is_undo);
+    };
+
+    if(is_undo) {
+        return std::all_of(m_actions.rbegin(), m_actions.rend(), writeChild);
+    } else {
+        return std::all_of(m_actions.begin(), m_actions.end(), writeChild);
+    }
+}
+
+/**
+ * @brief Adds a child action which has already been done.
+ * @details If the action can be merged into the previous child, then it is
+ *          merged rather than being added separately.
+ *
+ * @param action The action to add.
+ */
+void HMDT::Action::CompoundAction::addAction(std::unique_ptr<IAction> action) {
+    if(!m_actions.empty() && m_actions.back()->mergeWith(*action)) {
+        return;
+    }
+
+    m_actions.push_back(std::move(action));
+}
+
+bool HMDT::Action::CompoundAction::empty() const noexcept {
+    return m_actions.empty();
+}
+
+std::size_t HMDT::Action::CompoundAction::getActionCount() const noexcept {
+    return m_actions.size();
+}
+
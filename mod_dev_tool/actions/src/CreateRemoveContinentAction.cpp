@@ -49,6 +49,22 @@ bool HMDT::Action::CreateRemoveContinentAction::undoAction(const Callback& callb
     return true;
 }
 
+/**
+ * @brief Describes whether the continent exists after this action is done or
+ *        undone.
+ */
+bool HMDT::Action::CreateRemoveContinentAction::writeDeltas(JournalDeltaList& deltas,
+                                                            bool is_undo) const
+{
+    if((m_type == Type::CREATE) != is_undo) {
+        deltas.push_back(JournalDelta::createContinent(m_continent_name));
+    } else {
+        deltas.push_back(JournalDelta::removeContinent(m_continent_name));
+    }
+
+    return true;
+}
+
 bool HMDT::Action::CreateRemoveContinentAction::create() {
     if(m_map_project.getContinentProject().doesContinentExist(m_continent_name)) {
         WRITE_ERROR("Continent ", m_continent_name, " does not exist.");
@@ -0,0 +1,782 @@
+
+#include "EditJournal.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <set>
+#include <tuple>
+
+#ifdef _WIN32
+# include <io.h>
+#else
+# include <unistd.h>
+#endif
+
+#include "Constants.h"
+#include "Logger.h"
+#include "StatusCodes.h"
+
+namespace {
+    //! The size of the magic bytes and version at the start of every journal
+    const std::size_t HEADER_SIZE = HMDT::EDIT_JOURNAL_MAGIC.size() +
+                                    sizeof(std::uint32_t);
+
+    //! The size of the length and checksum written before every record
+    constexpr std::size_t RECORD_HEADER_SIZE = 2 * sizeof(std::uint32_t);
+
+    /**
+     * @brief Calculates the 32-bit FNV-1a hash of some bytes
+     */
+    std::uint32_t checksum(std::string_view bytes) noexcept {
+        std::uint32_t hash = 0x811C9DC5;
+
+        for(auto byte : bytes) {
+            hash ^= static_cast<std::uint8_t>(byte);
+            hash *= 0x01000193;
+        }
+
+        return hash;
+    }
+
+    /**
+     * @brief Makes sure everything written to a file has reached the disk
+     */
+    void syncFile(std::FILE* file) noexcept {
+#ifdef _WIN32
+        _commit(_fileno(file));
+#else
+        ::fsync(::fileno(file));
+#endif
+    }
+
+    /**
+     * @brief Writes bytes straight to a file's descriptor, bypassing stdio.
+     * @details Only calls functions which are safe to call from inside of a
+     *          signal handler.
+     *
+     * @return True if every byte was written, false otherwise.
+     */
+    bool writeRaw(std::FILE* file, const char* data, std::size_t size) noexcept
+    {
+#ifdef _WIN32
+        auto fd = _fileno(file);
+#else
+        auto fd = ::fileno(file);
+#endif
+
+        while(size != 0) {
+#ifdef _WIN32
+            auto written = _write(fd, data, static_cast<unsigned int>(size));
+#else
+            auto written = ::write(fd, data, size);
+#endif
+            if(written < 0) {
+                if(errno == EINTR) continue;
+
+                return false;
+            }
+
+            data += written;
+            size -= static_cast<std::size_t>(written);
+        }
+
+        return true;
+    }
+
+    /**
+     * @brief Builds the header written at the start of every journal
+     */
+    std::string makeHeader() {
+        std::string header = HMDT::EDIT_JOURNAL_MAGIC;
+        HMDT::Action::encodeJournalValue(HMDT::Action::EditJournal::VERSION,
+                                         header);
+        return header;
+    }
+}
+
+/**
+ * @brief Opens a journal for appending to, creating it if it doesn't exist.
+ * @details If the end of an existing journal was only partially written, then
+ *          it is cut off, so that new records are never appended after it.
+ *
+ * @param path The path to the journal
+ *
+ * @return The opened journal, or an error if it could not be opened.
+ */
+auto HMDT::Action::EditJournal::open(const std::filesystem::path& path)
+    -> Maybe<std::shared_ptr<EditJournal>>
+{
+    Sequence sequence = 0;
+    std::size_t record_count = 0;
+
+    if(std::filesystem::exists(path)) {
+        std::uintmax_t valid_size = 0;
+
+        auto records = readRecords(path, &valid_size);
+        RETURN_IF_ERROR(records);
+
+        if(!records->empty()) {
+            sequence = records->back().sequence;
+        }
+        record_count = records->size();
+
+        std::error_code ec;
+        if(std::filesystem::file_size(path, ec) != valid_size) {
+            std::filesystem::resize_file(path, valid_size, ec);
+        }
+
+        if(ec) {
+            WRITE_ERROR("Failed to truncate journal ", path, ". Reason: ",
+                        ec.message());
+            RETURN_ERROR(ec);
+        }
+    } else {
+        std::error_code ec;
+        if(path.has_parent_path()) {
+            std::filesystem::create_directories(path.parent_path(), ec);
+        }
+
+        std::ofstream out(path, std::ios::binary);
+        if(ec || !out) {
+            WRITE_ERROR("Failed to create journal ", path, ". Reason: ",
+                        std::strerror(errno));
+            RETURN_ERROR(std::make_error_code(static_cast<std::errc>(errno)));
+        }
+
+        out << makeHeader();
+    }
+
+    auto* file = std::fopen(path.generic_string().c_str(), "ab");
+    if(file == nullptr) {
+        WRITE_ERROR("Failed to open journal ", path, ". Reason: ",
+                    std::strerror(errno));
+        RETURN_ERROR(std::make_error_code(static_cast<std::errc>(errno)));
+    }
+
+    WRITE_DEBUG("Opened journal ", path, " with ", record_count, " edits.");
+
+    return std::shared_ptr<EditJournal>(new EditJournal(path, file, sequence,
+                                                        record_count));
+}
+
+/**
+ * @brief Reads every delta out of a journal.
+ *
+ * @param path The path to the journal
+ *
+ * @return Every delta in the order they were appended, or an error if the
+ *         journal could not be read.
+ */
+auto HMDT::Action::EditJournal::read(const std::filesystem::path& path)
+    -> Maybe<JournalDeltaList>
+{
+    auto records = readRecords(path);
+    RETURN_IF_ERROR(records);
+
+    JournalDeltaList deltas;
+    deltas.reserve(records->size());
+
+    for(auto&& record : *records) {
+        deltas.push_back(std::move(record.delta));
+    }
+
+    return deltas;
+}
+
+/**
+ * @brief Applies every delta in a journal to a project.
+ * @details Deltas which fail to apply are skipped, so that a single bad edit
+ *          doesn't lose every edit after it.
+ *
+ * @param path The path to the journal. Nothing is done if it doesn't exist.
+ * @param project The project to apply the deltas to
+ *
+ * @return The number of deltas which were applied, or an error if the
+ *         journal could not be read.
+ */
+auto HMDT::Action::EditJournal::replay(const std::filesystem::path& path,
+                                       Project::IRootProject& project)
+    -> Maybe<std::size_t>
+{
+    if(!std::filesystem::exists(path)) {
+        return 0;
+    }
+
+    auto deltas = read(path);
+    RETURN_IF_ERROR(deltas);
+
+    std::size_t num_failed = 0;
+    for(auto&& delta : *deltas) {
+        if(auto result = apply(delta, project); IS_FAILURE(result)) {
+            ++num_failed;
+        }
+    }
+
+    // The deltas were written straight into the provinces
+    project.getMapProject().getProvinceProject().rebuildProvinceTable();
+
+    if(num_failed != 0) {
+        WRITE_WARN(num_failed, " of ", deltas->size(), " edits in journal ",
+                   path, " could not be applied.");
+    }
+
+    WRITE_INFO("Recovered ", deltas->size() - num_failed,
+               " unsaved edits from ", path);
+
+    return deltas->size() - num_failed;
+}
+
+/**
+ * @brief Applies a single delta to a project.
+ *
+ * @param delta The delta to apply
+ * @param project The project to apply it to
+ *
+ * @return STATUS_SUCCESS on success, or STATUS_JOURNAL_DELTA_FAILED if the
+ *         delta is malformed or refers to something which doesn't exist.
+ */
+auto HMDT::Action::EditJournal::apply(const JournalDelta& delta,
+                                      Project::IRootProject& project)
+    -> MaybeVoid
+{
+    using Type = JournalDelta::Type;
+
+    auto& map_project = project.getMapProject();
+    auto& province_project = map_project.getProvinceProject();
+    auto& continent_project = map_project.getContinentProject();
+    auto& state_project = project.getHistoryProject().getStateProject();
+
+    std::string_view key = delta.key;
+    std::string_view value = delta.value;
+
+    // Decodes a province ID, making sure that the province exists
+    auto decodeProvince = [&province_project](std::string_view& in,
+                                              ProvinceID& id)
+    {
+        return decodeJournalValue(in, id) &&
+               province_project.isValidProvinceID(id);
+    };
+
+    switch(delta.type) {
+        case Type::SET_PROVINCE_PROPERTY: {
+            ProvinceID id;
+            RETURN_ERROR_IF(!decodeProvince(key, id) ||
+                            !applySetPropertyDelta(delta,
+                                province_project.getProvinceForID(id)),
+                            STATUS_JOURNAL_DELTA_FAILED);
+            break;
+        }
+        case Type::SET_STATE_PROPERTY: {
+            StateID id;
+            RETURN_ERROR_IF(!decodeJournalValue(key, id),
+                            STATUS_JOURNAL_DELTA_FAILED);
+
+            auto state = state_project.getStateForID(id);
+            RETURN_IF_ERROR(state);
+
+            RETURN_ERROR_IF(!applySetPropertyDelta(delta, state->get()),
+                            STATUS_JOURNAL_DELTA_FAILED);
+            break;
+        }
+        case Type::CREATE_CONTINENT: {
+            std::string name;
+            RETURN_ERROR_IF(!decodeJournalValue(key, name),
+                            STATUS_JOURNAL_DELTA_FAILED);
+
+            if(!continent_project.doesContinentExist(name)) {
+                continent_project.addNewContinent(name);
+            }
+            break;
+        }
+        case Type::REMOVE_CONTINENT: {
+            std::string name;
+            RETURN_ERROR_IF(!decodeJournalValue(key, name),
+                            STATUS_JOURNAL_DELTA_FAILED);
+
+            if(continent_project.doesContinentExist(name)) {
+                continent_project.removeContinent(name);
+            }
+            break;
+        }
+        case Type::MERGE_PROVINCES: {
+            ProvinceID parent_id;
+            ProvinceID child_id;
+            RETURN_ERROR_IF(!decodeProvince(key, parent_id) ||
+                            !decodeProvince(value, child_id),
+                            STATUS_JOURNAL_DELTA_FAILED);
+
+            auto result = province_project.mergeProvinces(parent_id, child_id);
+            RETURN_IF_ERROR(result);
+            break;
+        }
+        case Type::UNMERGE_PROVINCE: {
+            ProvinceID id;
+            RETURN_ERROR_IF(!decodeProvince(key, id),
+                            STATUS_JOURNAL_DELTA_FAILED);
+
+            auto result = province_project.unmergeProvince(id);
+            RETURN_IF_ERROR(result);
+            break;
+        }
+        case Type::CREATE_STATE: {
+            StateID id;
+            std::vector<ProvinceID> provinces;
+            RETURN_ERROR_IF(!decodeJournalValue(key, id) ||
+                            !decodeJournalValue(value, provinces),
+                            STATUS_JOURNAL_DELTA_FAILED);
+
+            if(auto new_id = state_project.addNewState(provinces); new_id != id)
+            {
+                WRITE_WARN("State ", id, " was recreated with a new ID of ",
+                           new_id, ". Later edits to it may not be applied.");
+            }
+            break;
+        }
+        case Type::REMOVE_STATE: {
+            StateID id;
+            RETURN_ERROR_IF(!decodeJournalValue(key, id),
+                            STATUS_JOURNAL_DELTA_FAILED);
+
+            auto result = state_project.removeState(id);
+            RETURN_IF_ERROR(result);
+            break;
+        }
+        case Type::MOVE_PROVINCE_TO_STATE: {
+            ProvinceID id;
+            StateID state_id;
+            RETURN_ERROR_IF(!decodeProvince(key, id) ||
+                            !decodeJournalValue(value, state_id),
+                            STATUS_JOURNAL_DELTA_FAILED);
+
+            map_project.moveProvinceToState(id, state_id);
+            break;
+        }
+        case Type::REMOVE_PROVINCE_FROM_STATE: {
+            ProvinceID id;
+            RETURN_ERROR_IF(!decodeProvince(key, id),
+                            STATUS_JOURNAL_DELTA_FAILED);
+
+            map_project.removeProvinceFromState(province_project.getProvinceForID(id));
+            break;
+        }
+        default:
+            WRITE_ERROR("Unknown journal delta type ",
+                        static_cast<std::uint32_t>(delta.type));
+            RETURN_ERROR(STATUS_JOURNAL_DELTA_FAILED);
+    }
+
+    return STATUS_SUCCESS;
+}
+
+HMDT::Action::EditJournal::EditJournal(const std::filesystem::path& path,
+                                       std::FILE* file,
+                                       Sequence sequence,
+                                       std::size_t record_count):
+    m_mutex(),
+    m_path(path),
+    m_file(file),
+    m_pending(),
+    m_pending_count(0),
+    m_sequence(sequence),
+    m_file_record_count(record_count),
+    m_last_flush(Clock::now())
+{ }
+
+/**
+ * @brief Writes any buffered deltas before closing the journal
+ */
+HMDT::Action::EditJournal::~EditJournal() {
+    auto result = flush();
+    WRITE_IF_ERROR(result);
+
+    if(m_file != nullptr) {
+        std::fclose(m_file);
+    }
+}
+
+/**
+ * @brief Appends deltas to the journal.
+ * @details The deltas are only buffered, unless enough deltas have built up
+ *          or enough time has passed to write out a new batch.
+ *
+ * @param deltas The deltas to append
+ *
+ * @return STATUS_SUCCESS on success, or an error if a batch had to be written
+ *         and could not be.
+ */
+auto HMDT::Action::EditJournal::append(const JournalDeltaList& deltas)
+    -> MaybeVoid
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    for(auto&& delta : deltas) {
+        encodeRecord(Record{ ++m_sequence, delta }, m_pending);
+        ++m_pending_count;
+    }
+
+    if(m_pending_count >= FLUSH_COUNT ||
+       (Clock::now() - m_last_flush) >= FLUSH_INTERVAL)
+    {
+        auto result = writePending();
+        RETURN_IF_ERROR(result);
+    }
+
+    return STATUS_SUCCESS;
+}
+
+/**
+ * @brief Writes every buffered delta, and waits for them to reach the disk
+ */
+auto HMDT::Action::EditJournal::flush() -> MaybeVoid {
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    return writePending();
+}
+
+/**
+ * @brief Writes every buffered delta from inside of a signal handler.
+ * @details Unlike flush(), this never logs, allocates, or compacts the
+ *          journal. The buffered records are already encoded, so they are
+ *          written with a single write and sync straight to the file's
+ *          descriptor. Nothing is written if another thread is using the
+ *          journal, as the buffer may be only partially updated.
+ *
+ * @return True if every buffered delta was written, false otherwise.
+ */
+bool HMDT::Action::EditJournal::flushForCrash() noexcept {
+    std::unique_lock<std::mutex> lock(m_mutex, std::try_to_lock);
+    if(!lock.owns_lock() || m_file == nullptr) {
+        return false;
+    }
+
+    if(m_pending.empty()) {
+        return true;
+    }
+
+    if(!writeRaw(m_file, m_pending.data(), m_pending.size())) {
+        return false;
+    }
+
+    syncFile(m_file);
+
+    // Does not free anything, so that nothing is ever written twice
+    m_pending.clear();
+    m_pending_count = 0;
+
+    return true;
+}
+
+/**
+ * @brief Rewrites the journal, keeping only the last value set on each field.
+ * @details Values set in between any other kinds of edits are never folded
+ *          together, as those edits may depend on them.
+ */
+auto HMDT::Action::EditJournal::compact() -> MaybeVoid {
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    auto result = writePending();
+    RETURN_IF_ERROR(result);
+
+    return compactFile();
+}
+
+/**
+ * @brief Drops every delta up to and including a sequence number.
+ * @details Meant to be called once a full save has been written, with the
+ *          sequence number from before the save was started, as the save
+ *          already holds every one of those deltas.
+ *
+ * @param sequence The sequence number of the last delta to drop
+ */
+auto HMDT::Action::EditJournal::discardThrough(Sequence sequence) -> MaybeVoid
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    auto result = writePending();
+    RETURN_IF_ERROR(result);
+
+    auto records = readRecords(m_path);
+    RETURN_IF_ERROR(records);
+
+    records->erase(std::remove_if(records->begin(), records->end(),
+                                  [sequence](const Record& record) {
+                                      return record.sequence <= sequence;
+                                  }),
+                   records->end());
+
+    return rewrite(*records);
+}
+
+/**
+ * @brief Drops every delta, including any which are still buffered.
+ * @details Meant to be called when the project is closed on purpose, so that
+ *          any edits which the user chose not to save are not recovered the
+ *          next time it is opened.
+ */
+auto HMDT::Action::EditJournal::clear() -> MaybeVoid {
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    m_pending.clear();
+    m_pending_count = 0;
+
+    return rewrite({});
+}
+
+/**
+ * @brief Gets the sequence number of the last delta appended
+ */
+auto HMDT::Action::EditJournal::getSequence() const noexcept -> Sequence {
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    return m_sequence;
+}
+
+/**
+ * @brief Gets the path to the journal file
+ */
+auto HMDT::Action::EditJournal::getPath() const noexcept
+    -> const std::filesystem::path&
+{
+    return m_path;
+}
+
+/**
+ * @brief Reads every complete record out of a journal.
+ * @details Reading stops at the first record which is cut off or whose
+ *          checksum does not match, as that record was still being written
+ *          when the program stopped.
+ *
+ * @param path The path to the journal
+ * @param valid_size If not null, set to the number of bytes at the start of
+ *                   the file which hold complete records.
+ *
+ * @return Every complete record, or STATUS_INVALID_JOURNAL if the file is not
+ *         a journal.
+ */
+auto HMDT::Action::EditJournal::readRecords(const std::filesystem::path& path,
+                                            std::uintmax_t* valid_size)
+    -> Maybe<std::vector<Record>>
+{
+    std::ifstream in(path, std::ios::binary);
+    if(!in) {
+        WRITE_ERROR("Failed to open journal ", path, ". Reason: ",
+                    std::strerror(errno));
+        RETURN_ERROR(std::make_error_code(static_cast<std::errc>(errno)));
+    }
+
+    std::string contents(std::istreambuf_iterator<char>(in),
+                         std::istreambuf_iterator<char>{});
+    std::string_view view = contents;
+
+    std::uint32_t version = 0;
+    if(view.size() < HEADER_SIZE ||
+       view.substr(0, EDIT_JOURNAL_MAGIC.size()) != EDIT_JOURNAL_MAGIC)
+    {
+        WRITE_ERROR(path, " is not an edit journal.");
+        RETURN_ERROR(STATUS_INVALID_JOURNAL);
+    }
+
+    view.remove_prefix(EDIT_JOURNAL_MAGIC.size());
+    decodeJournalValue(view, version);
+
+    if(version != VERSION) {
+        WRITE_ERROR("Journal ", path, " has version ", version,
+                    ", but only version ", VERSION, " is supported.");
+        RETURN_ERROR(STATUS_INVALID_JOURNAL);
+    }
+
+    std::vector<Record> records;
+
+    while(!view.empty()) {
+        auto record_view = view;
+
+        std::uint32_t length = 0;
+        std::uint32_t expected_checksum = 0;
+        if(!decodeJournalValue(record_view, length) ||
+           !decodeJournalValue(record_view, expected_checksum) ||
+           record_view.size() < length ||
+           checksum(record_view.substr(0, length)) != expected_checksum)
+        {
+            break;
+        }
+
+        auto body = record_view.substr(0, length);
+
+        Record record;
+        if(!decodeJournalValue(body, record.sequence) ||
+           !decodeJournalValue(body, record.delta.type) ||
+           !decodeJournalValue(body, record.delta.key) ||
+           !decodeJournalValue(body, record.delta.field) ||
+           !decodeJournalValue(body, record.delta.value))
+        {
+            break;
+        }
+
+        records.push_back(std::move(record));
+        view.remove_prefix(RECORD_HEADER_SIZE + length);
+    }
+
+    if(!view.empty()) {
+        WRITE_WARN("Ignoring the last ", view.size(), " bytes of journal ",
+                   path, ", which were only partially written.");
+    }
+
+    if(valid_size != nullptr) {
+        *valid_size = contents.size() - view.size();
+    }
+
+    return records;
+}
+
+/**
+ * @brief Encodes a single record onto the end of a byte string
+ */
+void HMDT::Action::EditJournal::encodeRecord(const Record& record,
+                                             std::string& out)
+{
+    std::string body;
+    encodeJournalValue(record.sequence, body);
+    encodeJournalValue(record.delta.type, body);
+    encodeJournalValue(record.delta.key, body);
+    encodeJournalValue(record.delta.field, body);
+    encodeJournalValue(record.delta.value, body);
+
+    encodeJournalValue(static_cast<std::uint32_t>(body.size()), out);
+    encodeJournalValue(checksum(body), out);
+    out.append(body);
+}
+
+/**
+ * @brief Writes every buffered record as a single batch. m_mutex must be held.
+ * @details The journal is compacted afterwards if it has grown too large.
+ */
+auto HMDT::Action::EditJournal::writePending() -> MaybeVoid {
+    if(m_pending.empty()) {
+        return STATUS_SUCCESS;
+    }
+
+    RETURN_ERROR_IF(m_file == nullptr, STATUS_UNINITIALIZED);
+
+    if(std::fwrite(m_pending.data(), 1, m_pending.size(), m_file) != m_pending.size() ||
+       std::fflush(m_file) != 0)
+    {
+        WRITE_ERROR("Failed to write ", m_pending_count, " edits to journal ",
+                    m_path, ". Reason: ", std::strerror(errno));
+        RETURN_ERROR(std::make_error_code(static_cast<std::errc>(errno)));
+    }
+
+    syncFile(m_file);
+
+    m_file_record_count += m_pending_count;
+    m_pending.clear();
+    m_pending_count = 0;
+    m_last_flush = Clock::now();
+
+    if(m_file_record_count >= COMPACT_COUNT) {
+        auto result = compactFile();
+        RETURN_IF_ERROR(result);
+    }
+
+    return STATUS_SUCCESS;
+}
+
+/**
+ * @brief Compacts every record which has been written. m_mutex must be held.
+ */
+auto HMDT::Action::EditJournal::compactFile() -> MaybeVoid {
+    auto records = readRecords(m_path);
+    RETURN_IF_ERROR(records);
+
+    // Walk backwards so that the last value set on each field is seen first
+    std::set<std::tuple<JournalDelta::Type, std::string, std::string>> seen;
+    std::vector<Record> compacted;
+
+    for(auto it = records->rbegin(); it != records->rend(); ++it) {
+        auto& delta = it->delta;
+
+        if(!delta.isSetProperty()) {
+            seen.clear();
+        } else if(!seen.emplace(delta.type, delta.key, delta.field).second) {
+            continue;
+        }
+
+        compacted.push_back(std::move(*it));
+    }
+
+    std::reverse(compacted.begin(), compacted.end());
+
+    WRITE_DEBUG("Compacted journal ", m_path, " from ", records->size(),
+                " to ", compacted.size(), " edits.");
+
+    return rewrite(compacted);
+}
+
+/**
+ * @brief Replaces the journal with the given records. m_mutex must be held.
+ * @details The records are written to a temporary file first, which then
+ *          replaces the journal, so that the journal is never left
+ *          half-written.
+ *
+ * @param records The records to keep
+ */
+auto HMDT::Action::EditJournal::rewrite(const std::vector<Record>& records)
+    -> MaybeVoid
+{
+    auto temp_path = m_path;
+    temp_path += ".tmp";
+
+    std::string contents = makeHeader();
+    for(auto&& record : records) {
+        encodeRecord(record, contents);
+    }
+
+    auto* temp_file = std::fopen(temp_path.generic_string().c_str(), "wb");
+    if(temp_file == nullptr) {
+        WRITE_ERROR("Failed to open ", temp_path, ". Reason: ",
+                    std::strerror(errno));
+        RETURN_ERROR(std::make_error_code(static_cast<std::errc>(errno)));
+    }
+
+    bool written = std::fwrite(contents.data(), 1, contents.size(), temp_file) == contents.size() &&
+                   std::fflush(temp_file) == 0;
+    auto write_errno = errno;
+    if(written) {
+        syncFile(temp_file);
+    }
+    std::fclose(temp_file);
+
+    if(!written) {
+        WRITE_ERROR("Failed to write ", temp_path, ". Reason: ",
+                    std::strerror(write_errno));
+        std::filesystem::remove(temp_path);
+        RETURN_ERROR(std::make_error_code(static_cast<std::errc>(write_errno)));
+    }
+
+    // The journal must be closed before it can be replaced on some platforms
+    std::fclose(m_file);
+
+    std::error_code ec;
+    std::filesystem::rename(temp_path, m_path, ec);
+
+    m_file = std::fopen(m_path.generic_string().c_str(), "ab");
+
+    if(ec) {
+        WRITE_ERROR("Failed to replace journal ", m_path, ". Reason: ",
+                    ec.message());
+        RETURN_ERROR(ec);
+    }
+
+    if(m_file == nullptr) {
+        WRITE_ERROR("Failed to reopen journal ", m_path, ". Reason: ",
+                    std::strerror(errno));
+        RETURN_ERROR(std::make_error_code(static_cast<std::errc>(errno)));
+    }
+
+    m_file_record_count = records.size();
+
+    return STATUS_SUCCESS;
+}
+
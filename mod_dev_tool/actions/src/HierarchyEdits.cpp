@@ -0,0 +1,135 @@
+
+#include "HierarchyEdits.h"
+
+#include <algorithm>
+#include <string_view>
+
+#include "NodeKeyNames.h"
+
+namespace {
+    using namespace HMDT::Project::Hierarchy;
+
+    /**
+     * @brief Maps a journaled Province field to the name of its property node
+     *
+     * @return The node name, or nullptr if the field has no property node
+     */
+    const char* getProvinceKey(std::string_view field) {
+        if(field == "type") return ProvinceKeys::TYPE;
+        if(field == "coastal") return ProvinceKeys::COASTAL;
+        if(field == "terrain") return ProvinceKeys::TERRAIN;
+        if(field == "continent") return ProvinceKeys::CONTINENT;
+
+        return nullptr;
+    }
+
+    /**
+     * @brief Maps a journaled State field to the name of its property node
+     * @details The name and provinces of a state are not properties: the name
+     *          is the name of the state's node, and the provinces are built
+     *          as nodes of their own.
+     *
+     * @return The node name, or nullptr if the field has no property node
+     */
+    const char* getStateKey(std::string_view field) {
+        if(field == "manpower") return StateKeys::MANPOWER;
+        if(field == "category") return StateKeys::CATEGORY;
+        if(field == "buildings_max_level_factor") return StateKeys::BUILDINGS_MAX_LEVEL_FACTOR;
+        if(field == "impassable") return StateKeys::IMPASSABLE;
+
+        return nullptr;
+    }
+
+    /**
+     * @brief Joins every part of a path together
+     */
+    std::string joinPath(std::initializer_list<std::string_view> parts) {
+        std::string path;
+        for(auto&& part : parts) {
+            if(!path.empty()) path += '/';
+            path += part;
+        }
+
+        return path;
+    }
+}
+
+/**
+ * @brief Gets the path of every property node whose value is changed by the
+ *        given edits, in the form used by Hierarchy::HierarchyIndex.
+ * @details Edits to provinces which are merged or unmerged change no node.
+ *
+ * @param deltas The result of each edit
+ * @param project The project the edits were made to
+ *
+ * @return The path to every changed property, or std::nullopt if the edits
+ *         add, remove, or rename nodes, meaning that the whole hierarchy has
+ *         to be rebuilt.
+ */
+auto HMDT::Action::getChangedPropertyPaths(const JournalDeltaList& deltas,
+                                           const Project::IRootProject& project)
+    -> std::optional<std::vector<std::string>>
+{
+    std::vector<std::string> paths;
+    paths.reserve(deltas.size());
+
+    for(auto&& delta : deltas) {
+        std::string_view key = delta.key;
+
+        switch(delta.type) {
+            case JournalDelta::Type::SET_PROVINCE_PROPERTY: {
+                ProvinceID id;
+                const char* field_key = getProvinceKey(delta.field);
+                if(field_key == nullptr || !decodeJournalValue(key, id)) {
+                    return std::nullopt;
+                }
+
+                paths.push_back(joinPath({ ProjectKeys::MAP,
+                                           ProjectKeys::PROVINCES,
+                                           GroupKeys::PROVINCES,
+                                           std::to_string(id),
+                                           field_key }));
+                break;
+            }
+            case JournalDelta::Type::SET_STATE_PROPERTY: {
+                StateID id;
+                const char* field_key = getStateKey(delta.field);
+                if(field_key == nullptr || !decodeJournalValue(key, id)) {
+                    return std::nullopt;
+                }
+
+                const auto& states = project.getHistoryProject().getStateProject().getStates();
+                auto it = states.find(id);
+                if(it == states.end()) {
+                    return std::nullopt;
+                }
+
+                // States which share a name get a numbered node name, which
+                //   depends on the order they were added to the hierarchy in
+                const auto& name = it->second.name;
+                auto num_named = std::count_if(states.begin(), states.end(),
+                                               [&name](auto&& id_state) {
+                                                   return id_state.second.name == name;
+                                               });
+                if(num_named != 1) {
+                    return std::nullopt;
+                }
+
+                paths.push_back(joinPath({ ProjectKeys::HISTORY,
+                                           ProjectKeys::STATES,
+                                           GroupKeys::STATES,
+                                           name,
+                                           field_key }));
+                break;
+            }
+            case JournalDelta::Type::MERGE_PROVINCES:
+            case JournalDelta::Type::UNMERGE_PROVINCE:
+                break;
+            default:
+                return std::nullopt;
+        }
+    }
+
+    return paths;
+}
+
@@ -0,0 +1,80 @@
+
+#include "JournalDelta.h"
+
+/**
+ * @brief Checks if this delta sets a single field, meaning that only the last
+ *        delta for the same field needs to be kept.
+ */
+bool HMDT::Action::JournalDelta::isSetProperty() const noexcept {
+    return type == Type::SET_PROVINCE_PROPERTY ||
+           type == Type::SET_STATE_PROPERTY;
+}
+
+auto HMDT::Action::JournalDelta::createContinent(const std::string& name)
+    -> JournalDelta
+{
+    JournalDelta delta{ Type::CREATE_CONTINENT, "", "", "" };
+    encodeJournalValue(name, delta.key);
+    return delta;
+}
+
+auto HMDT::Action::JournalDelta::removeContinent(const std::string& name)
+    -> JournalDelta
+{
+    JournalDelta delta{ Type::REMOVE_CONTINENT, "", "", "" };
+    encodeJournalValue(name, delta.key);
+    return delta;
+}
+
+auto HMDT::Action::JournalDelta::mergeProvinces(const ProvinceID& parent_id,
+                                                const ProvinceID& child_id)
+    -> JournalDelta
+{
+    JournalDelta delta{ Type::MERGE_PROVINCES, "", "", "" };
+    encodeJournalValue(parent_id, delta.key);
+    encodeJournalValue(child_id, delta.value);
+    return delta;
+}
+
+auto HMDT::Action::JournalDelta::unmergeProvince(const ProvinceID& id)
+    -> JournalDelta
+{
+    JournalDelta delta{ Type::UNMERGE_PROVINCE, "", "", "" };
+    encodeJournalValue(id, delta.key);
+    return delta;
+}
+
+auto HMDT::Action::JournalDelta::createState(StateID id,
+                                             const std::vector<ProvinceID>& provinces)
+    -> JournalDelta
+{
+    JournalDelta delta{ Type::CREATE_STATE, "", "", "" };
+    encodeJournalValue(id, delta.key);
+    encodeJournalValue(provinces, delta.value);
+    return delta;
+}
+
+auto HMDT::Action::JournalDelta::removeState(StateID id) -> JournalDelta {
+    JournalDelta delta{ Type::REMOVE_STATE, "", "", "" };
+    encodeJournalValue(id, delta.key);
+    return delta;
+}
+
+auto HMDT::Action::JournalDelta::moveProvinceToState(const ProvinceID& id,
+                                                     StateID state_id)
+    -> JournalDelta
+{
+    JournalDelta delta{ Type::MOVE_PROVINCE_TO_STATE, "", "", "" };
+    encodeJournalValue(id, delta.key);
+    encodeJournalValue(state_id, delta.value);
+    return delta;
+}
+
+auto HMDT::Action::JournalDelta::removeProvinceFromState(const ProvinceID& id)
+    -> JournalDelta
+{
+    JournalDelta delta{ Type::REMOVE_PROVINCE_FROM_STATE, "", "", "" };
+    encodeJournalValue(id, delta.key);
+    return delta;
+}
+
@@ -0,0 +1,103 @@
+/**
+ * @file ArenaResource.h
+ *
+ * @brief Defines a monotonic arena memory resource which keeps track of how
+ *        much memory has been drawn from it.
+ */
+
+#ifndef ARENA_RESOURCE_H
+# define ARENA_RESOURCE_H
+
+# include <memory_resource>
+# include <cstddef>
+# include <ostream>
+
+namespace HMDT {
+    /**
+     * @brief A monotonic arena for short-lived data.
+     *
+     * @details Every allocation is bumped out of a chain of large blocks which
+     *          are requested from the upstream resource, and individual
+     *          deallocations are no-ops. All memory is handed back at once by
+     *          calling release(), at which point the arena may be re-used.
+     *
+     * @par Note that this resource is not thread-safe.
+     */
+    class ArenaResource: public std::pmr::memory_resource {
+        public:
+            /**
+             * @brief Usage statistics about an arena
+             */
+            struct Statistics {
+                //! Total bytes handed out to containers since the last release
+                std::size_t bytes_allocated;
+                //! Bytes handed out which have not yet been given back
+                std::size_t bytes_in_use;
+                //! The largest value bytes_in_use has ever reached
+                std::size_t peak_bytes_in_use;
+                //! Bytes currently reserved from the upstream resource
+                std::size_t bytes_reserved;
+                //! The largest value bytes_reserved has ever reached
+                std::size_t peak_bytes_reserved;
+                //! Number of allocations since the last release
+                std::size_t num_allocations;
+                //! Number of deallocations since the last release
+                std::size_t num_deallocations;
+                //! Number of times the arena has been released
+                std::size_t num_releases;
+            };
+
+            //! The default size of the first block requested from upstream
+            constexpr static std::size_t DEFAULT_INITIAL_SIZE = 1 << 20;
+
+            explicit ArenaResource(std::size_t = DEFAULT_INITIAL_SIZE,
+                                   std::pmr::memory_resource* = std::pmr::new_delete_resource());
+
+            ArenaResource(const ArenaResource&) = delete;
+            ArenaResource& operator=(const ArenaResource&) = delete;
+
+            virtual ~ArenaResource() = default;
+
+            void release();
+
+            const Statistics& getStatistics() const noexcept;
+
+        protected:
+            virtual void* do_allocate(std::size_t, std::size_t) override;
+            virtual void do_deallocate(void*, std::size_t, std::size_t) override;
+            virtual bool do_is_equal(const std::pmr::memory_resource&) const noexcept override;
+
+        private:
+            /**
+             * @brief Sits between the arena and the real upstream resource so
+             *        that we know how many bytes the arena is holding on to.
+             */
+            class UpstreamCounter: public std::pmr::memory_resource {
+                public:
+                    UpstreamCounter(std::pmr::memory_resource*, Statistics&);
+
+                protected:
+                    virtual void* do_allocate(std::size_t, std::size_t) override;
+                    virtual void do_deallocate(void*, std::size_t, std::size_t) override;
+                    virtual bool do_is_equal(const std::pmr::memory_resource&) const noexcept override;
+
+                private:
+                    std::pmr::memory_resource* m_upstream;
+                    Statistics& m_stats;
+            };
+
+            //! Usage statistics
+            Statistics m_stats;
+
+            //! Counts memory requested by m_arena
+            UpstreamCounter m_upstream_counter;
+
+            //! The actual arena which everything is allocated out of
+            std::pmr::monotonic_buffer_resource m_arena;
+    };
+
+    std::ostream& operator<<(std::ostream&, const ArenaResource::Statistics&);
+}
+
+#endif
+
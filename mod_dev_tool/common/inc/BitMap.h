@@ -9,6 +9,8 @@
 
 # include <ostream> // std::ostream
 # include <filesystem> // std::filesystem::path
+# include <functional> // std::function
+# include <vector> // std::vector
 
 # include "Maybe.h"
 
@@ -174,6 +176,14 @@ namespace HMDT {
         std::unique_ptr<RGBQuad[]> color_table;
     };
 
+    /**
+     * @brief Fills in a single row of a bitmap which is being written
+     * @details Called with the row to fill in (where 0 is the top of the
+     *          image), and where to write it to, which holds exactly
+     *          width * depth bytes. 24-bit pixels are written in RGB order.
+     */
+    using BMPRowGenerator = std::function<MaybeVoid(uint32_t, unsigned char*)>;
+
     MaybeRef<BitMap2> readBMP(const std::filesystem::path&,
                               std::shared_ptr<BitMap2>) noexcept;
     MaybeRef<BitMap2> readBMP(std::istream&, std::shared_ptr<BitMap2>) noexcept;
@@ -189,6 +199,15 @@ namespace HMDT {
                         uint32_t, uint32_t, uint16_t = 3, bool = false,
                         BMPHeaderToUse = BMPHeaderToUse::V4,
                         MonadOptional<ColorTable> = std::nullopt) noexcept;
+    MaybeVoid writeBMPRows(const std::filesystem::path&,
+                           uint32_t, uint32_t, uint16_t,
+                           const BMPRowGenerator&, bool = false,
+                           BMPHeaderToUse = BMPHeaderToUse::V4,
+                           MonadOptional<ColorTable> = std::nullopt) noexcept;
+    MaybeVoid writeBMPFill(const std::filesystem::path&,
+                           uint32_t, uint32_t,
+                           const std::vector<unsigned char>&,
+                           BMPHeaderToUse = BMPHeaderToUse::V4) noexcept;
 
     MaybeVoid createColorTable(BitMap2&, ColorTable&&, bool = false);
     MaybeVoid createColorTable(BitMap2&, bool = false);
@@ -99,6 +99,9 @@ namespace HMDT {
     //! The filename for the imported province maps
     const std::string INPUT_PROVINCEMAP_FILENAME = "import_provincemap.bmp";
 
+    //! The filename for the journal of edits made since the last save
+    const std::string EDIT_JOURNAL_FILENAME = "edits.journal";
+
     //! The file extension for the log files
     const std::string LOG_FILE_EXTENSION = ".log";
 
@@ -108,8 +111,14 @@ namespace HMDT {
     //! The 4 magic bytes 
     const std::string SHAPEDATA_MAGIC = "SDAT";
 
-    //! The maximum number of province previews to store in memory
-    const size_t MAX_CACHED_PROVINCE_PREVIEWS = 100;
+    //! The 4 magic bytes at the start of an edit journal
+    const std::string EDIT_JOURNAL_MAGIC = "EJRN";
+
+    //! The maximum number of bytes of province previews to store in memory
+    const size_t MAX_PROVINCE_PREVIEW_CACHE_BYTES = 64 * 1024 * 1024;
+
+    //! The maximum number of files to be writing to at once when exporting
+    const size_t MAX_CONCURRENT_EXPORT_FILES = 8;
 
     //! How much to zoom each time
     const double ZOOM_FACTOR = 0.1;
@@ -117,6 +126,10 @@ namespace HMDT {
     //! The default zoom level
     const double DEFAULT_ZOOM = 1.0;
 
+    //! How far away (in pixels) a click on a pixel without a province may be
+    //!   from a province and still pick it
+    const double MAX_PROVINCE_PICK_DISTANCE = 4.0;
+
     const uint32_t PROVINCE_HIGHLIGHT_COLOR = 0xFFFFFFFF;
 
     const std::string SOURCE_LOCATION = "https://github.com/AFlyingCar/HoI4-Mod-Development-Tool";
@@ -127,9 +140,6 @@ namespace HMDT {
     //! The license of the tool
     extern const std::string TOOL_LICENSE;
 
-    //! The maximum number of provinces that can be selected
-    const uint32_t MAX_SELECTED_PROVINCES = 128;
-
     //! The default value of buildings_max_level_factor
     const float DEFAULT_BUILDINGS_MAX_LEVEL_FACTOR = 1.0f;
 
@@ -0,0 +1,88 @@
+/**
+ * @file DenseBitSet.h
+ *
+ * @brief Defines a growable bitset over dense indices, which remembers which
+ *        indices are set.
+ */
+
+#ifndef DENSE_BIT_SET_H
+# define DENSE_BIT_SET_H
+
+# include <cstddef>
+# include <cstdint>
+# include <vector>
+
+namespace HMDT {
+    /**
+     * @brief A set of small integers, stored as one bit per possible value.
+     *
+     * @details Membership checks, insertions and removals are all O(1), and
+     *          the set grows as larger indices are inserted. The sorted list
+     *          of every set index is built on first use after a change and
+     *          then cached, so repeatedly reading it is free.
+     *
+     * @par Note that this set is not thread-safe.
+     */
+    class DenseBitSet {
+        public:
+            using Index = std::uint32_t;
+
+            DenseBitSet() = default;
+            explicit DenseBitSet(std::size_t);
+
+            bool set(Index);
+            bool reset(Index);
+            bool test(Index) const noexcept;
+
+            void clear() noexcept;
+            void reserve(std::size_t);
+
+            std::size_t count() const noexcept;
+            bool empty() const noexcept;
+            std::size_t capacity() const noexcept;
+
+            const std::vector<Index>& getIndices() const;
+
+            /**
+             * @brief Calls a function with every set index, in ascending
+             *        order.
+             *
+             * @param func The function to call
+             */
+            template<typename F>
+            void forEach(F&& func) const {
+                for(std::size_t w = 0; w < m_words.size(); ++w) {
+                    auto word = m_words[w];
+                    while(word != 0) {
+                        auto bit = __builtin_ctzll(word);
+                        func(static_cast<Index>(w * WORD_BITS + bit));
+
+                        // Clear the lowest set bit
+                        word &= word - 1;
+                    }
+                }
+            }
+
+        private:
+            using Word = std::uint64_t;
+
+            //! The number of bits in each word
+            constexpr static std::size_t WORD_BITS = sizeof(Word) * 8;
+
+            //! Every bit, WORD_BITS at a time
+            std::vector<Word> m_words;
+
+            //! How many bits are set
+            std::size_t m_count = 0;
+
+            //! Every set index, in ascending order. Only valid if
+            //!   m_indices_valid is true
+            mutable std::vector<Index> m_indices;
+
+            //! Whether m_indices matches m_words
+            mutable bool m_indices_valid = true;
+    };
+}
+
+#endif
+
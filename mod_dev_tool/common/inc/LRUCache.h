@@ -0,0 +1,194 @@
+/**
+ * @file LRUCache.h
+ *
+ * @brief Defines a least-recently-used cache which is bounded by the number
+ *        of bytes it holds rather than by the number of entries.
+ */
+
+#ifndef LRU_CACHE_H
+# define LRU_CACHE_H
+
+# include <cstddef>
+# include <functional>
+# include <list>
+# include <unordered_map>
+# include <utility>
+
+namespace HMDT {
+    /**
+     * @brief A least-recently-used cache with a byte budget.
+     *
+     * @details Every entry is given a size when it is inserted. Whenever the
+     *          total size goes over budget, the least recently used entries
+     *          are evicted until it fits again. Lookups, insertions and
+     *          evictions are all O(1).
+     *
+     * @par The most recently inserted entry is never evicted, so an entry
+     *      which is larger than the whole budget is still kept until something
+     *      else is inserted.
+     *
+     * @par Note that this cache is not thread-safe.
+     *
+     * @tparam K The key type
+     * @tparam V The value type
+     * @tparam Hash The hash to use for K
+     */
+    template<typename K, typename V, typename Hash = std::hash<K>>
+    class LRUCache {
+        public:
+            /**
+             * @brief Constructs an empty cache
+             *
+             * @param byte_budget The maximum number of bytes to hold
+             */
+            explicit LRUCache(std::size_t byte_budget):
+                m_byte_budget(byte_budget),
+                m_total_bytes(0)
+            { }
+
+            /**
+             * @brief Looks up a value, marking it as the most recently used
+             *
+             * @param key The key to look up
+             *
+             * @return A pointer to the value, or nullptr if it is not cached.
+             *         The pointer remains valid until the entry is evicted.
+             */
+            V* get(const K& key) {
+                auto it = m_index.find(key);
+                if(it == m_index.end()) {
+                    return nullptr;
+                }
+
+                // Move the entry to the front without copying it
+                m_entries.splice(m_entries.begin(), m_entries, it->second);
+
+                return &it->second->value;
+            }
+
+            /**
+             * @brief Checks if a value is cached, without marking it as used
+             */
+            bool contains(const K& key) const {
+                return m_index.count(key) != 0;
+            }
+
+            /**
+             * @brief Inserts or replaces a value, marking it as the most
+             *        recently used.
+             *
+             * @param key The key to insert at
+             * @param value The value to insert
+             * @param bytes How many bytes value takes up
+             *
+             * @return A reference to the inserted value
+             */
+            V& put(const K& key, V value, std::size_t bytes) {
+                if(auto it = m_index.find(key); it != m_index.end()) {
+                    m_total_bytes -= it->second->bytes;
+                    m_entries.erase(it->second);
+                    m_index.erase(it);
+                }
+
+                m_entries.push_front(Entry{ key, std::move(value), bytes });
+                m_index.emplace(key, m_entries.begin());
+                m_total_bytes += bytes;
+
+                evict();
+
+                return m_entries.front().value;
+            }
+
+            /**
+             * @brief Removes a value from the cache
+             *
+             * @return True if the value was cached, false otherwise
+             */
+            bool erase(const K& key) {
+                auto it = m_index.find(key);
+                if(it == m_index.end()) {
+                    return false;
+                }
+
+                m_total_bytes -= it->second->bytes;
+                m_entries.erase(it->second);
+                m_index.erase(it);
+
+                return true;
+            }
+
+            /**
+             * @brief Removes every value from the cache
+             */
+            void clear() noexcept {
+                m_entries.clear();
+                m_index.clear();
+                m_total_bytes = 0;
+            }
+
+            /**
+             * @brief Changes the byte budget, evicting entries if needed
+             */
+            void setByteBudget(std::size_t byte_budget) {
+                m_byte_budget = byte_budget;
+                evict();
+            }
+
+            std::size_t getByteBudget() const noexcept {
+                return m_byte_budget;
+            }
+
+            std::size_t getTotalBytes() const noexcept {
+                return m_total_bytes;
+            }
+
+            std::size_t size() const noexcept {
+                return m_index.size();
+            }
+
+            bool empty() const noexcept {
+                return m_index.empty();
+            }
+
+        private:
+            /**
+             * @brief A single cached value
+             */
+            struct Entry {
+                K key;
+                V value;
+                std::size_t bytes;
+            };
+
+            using EntryList = std::list<Entry>;
+
+            /**
+             * @brief Evicts from the back until the cache is within budget,
+             *        always keeping the front entry.
+             */
+            void evict() {
+                while(m_total_bytes > m_byte_budget && m_entries.size() > 1) {
+                    auto& last = m_entries.back();
+
+                    m_total_bytes -= last.bytes;
+                    m_index.erase(last.key);
+                    m_entries.pop_back();
+                }
+            }
+
+            //! The maximum number of bytes to hold
+            std::size_t m_byte_budget;
+
+            //! The number of bytes currently held
+            std::size_t m_total_bytes;
+
+            //! Every entry, from most to least recently used
+            EntryList m_entries;
+
+            //! Maps each key to its entry
+            std::unordered_map<K, typename EntryList::iterator, Hash> m_index;
+    };
+}
+
+#endif
+
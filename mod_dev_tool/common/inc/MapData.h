@@ -1,7 +1,9 @@
 #ifndef MAPDATA_H
 # define MAPDATA_H
 
+# include <cstdint>
 # include <memory>
+# include <mutex>
 # include <utility>
 
 # include "Types.h"
@@ -10,9 +12,31 @@ namespace HMDT {
     /**
      * @brief Holds all representations of the map. Note that this object cannot
      *        be copied, and must either be used as-is or as a shared_ptr
+     *
+     * @details Each representation (or layer) is only allocated the first
+     *          time that it is asked for, so a layer which is never used (such
+     *          as the heightmap of a project without one) never takes up any
+     *          memory. A layer which is no longer needed may be given back
+     *          with release(), and will be allocated again (zero-filled) if it
+     *          is ever asked for again.
      */
     class MapData {
         public:
+            /**
+             * @brief Every layer of the map
+             */
+            enum class Layer {
+                INPUT,
+                PROVINCES,
+                PROVINCE_COLORS,
+                PROVINCE_OUTLINES,
+                CITIES,
+                LABEL_MATRIX,
+                STATE_ID_MATRIX,
+                HEIGHTMAP,
+                RIVERS
+            };
+
             using MapType = std::weak_ptr<uint8_t[]>;
             using ConstMapType = std::weak_ptr<const uint8_t[]>;
 
@@ -26,7 +50,7 @@ namespace HMDT {
             MapData(uint32_t, uint32_t);
             explicit MapData(const MapData*);
 
-            MapData(MapData&&) = default;
+            MapData(MapData&&);
 
             MapData(const MapData&) = delete;
             MapData& operator=(const MapData&) = delete;
@@ -48,6 +72,10 @@ namespace HMDT {
 
             bool isClosed() const;
 
+            bool isResident(Layer) const;
+            void release(Layer);
+            std::uint64_t getResidentSize() const;
+
             [[deprecated]] void setLabelMatrix(uint32_t[]);
             [[deprecated]] void setStateIDMatrix(uint32_t[]);
 
@@ -58,6 +86,7 @@ namespace HMDT {
 
             MapTypeUUID getProvinces();
             ConstMapTypeUUID getProvinces() const;
+            std::shared_ptr<const UUID[]> shareProvinces();
 
             MapType getProvinceColors();
             ConstMapType getProvinceColors() const;
@@ -75,6 +104,7 @@ namespace HMDT {
             ConstMapType32 getStateIDMatrix() const;
 
             uint32_t getStateIDMatrixUpdatedTag() const;
+            void markStateIDMatrixUpdated();
 
             MapType getHeightMap();
             ConstMapType getHeightMap() const;
@@ -87,24 +117,41 @@ namespace HMDT {
             using InternalMapType32 = std::shared_ptr<uint32_t[]>;
             using InternalMapTypeUUID = std::shared_ptr<UUID[]>;
 
+            template<typename T>
+            std::shared_ptr<T[]> materialize(std::shared_ptr<T[]>&, uint32_t,
+                                             const T&) const;
+
+            template<typename F>
+            decltype(auto) visitLayer(Layer, F&&) const;
+
             uint32_t m_width;
             uint32_t m_height;
 
-            InternalMapType m_input;
-            InternalMapTypeUUID m_provinces;
-            InternalMapType m_province_colors;
-            InternalMapType m_province_outlines;
-            InternalMapType m_cities;
-            InternalMapType32 m_label_matrix;
-            InternalMapType32 m_state_id_matrix;
-            InternalMapType m_heightmap;
-            InternalMapType m_rivers;
+            //! Guards the allocation and release of every layer
+            mutable std::mutex m_layers_mutex;
+
+            //! Every layer, which is nullptr until it is first asked for
+            mutable InternalMapType m_input;
+            mutable InternalMapTypeUUID m_provinces;
+            mutable InternalMapType m_province_colors;
+            mutable InternalMapType m_province_outlines;
+            mutable InternalMapType m_cities;
+            mutable InternalMapType32 m_label_matrix;
+            mutable InternalMapType32 m_state_id_matrix;
+            mutable InternalMapType m_heightmap;
+            mutable InternalMapType m_rivers;
             // More map representations as necessary
 
             bool m_closed;
 
             uint32_t m_state_id_matrix_updated_tag;
 
+            //! Keeps m_provinces alive for as long as anything returned by
+            //!   shareProvinces() is alive
+            std::weak_ptr<InternalMapTypeUUID> m_shared_provinces;
+
+            void detachProvinces();
+
         public:
             void setLabelMatrix(InternalMapType32);
             void setStateIDMatrix(InternalMapType32);
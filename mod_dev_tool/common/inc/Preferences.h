@@ -8,8 +8,11 @@
 # define PREFERENCES_H
 
 # include <map>
+# include <atomic>
 # include <string>
+# include <cstdint>
 # include <variant>
+# include <functional>
 # include <filesystem>
 
 # include "Maybe.h"
@@ -43,6 +46,85 @@ namespace HMDT {
              */
             using OnPreferenceChangeCallback = std::function<bool(const ValueVariant&, const ValueVariant&)>;
 
+            /**
+             * @brief The callback to be called after a preference value has
+             *        changed, with the new value
+             */
+            using OnPreferenceChangedCallback = std::function<void(const ValueVariant&)>;
+
+            /**
+             * @brief Identifies a callback registered with subscribe()
+             */
+            using SubscriptionID = std::uint64_t;
+
+            /**
+             * @brief Counts changes made to the preferences. Any change to any
+             *        value, default, or $ENVVAR gives a new version.
+             */
+            using Version = std::uint64_t;
+
+            /**
+             * @brief A typed handle to a single preference value.
+             * @details The value is looked up on first use and then cached.
+             *          Every later call to get() only compares the cached
+             *          version against the current version, and only looks
+             *          the value up again if something has changed since,
+             *          so a handle is cheap enough to read from render and
+             *          logging paths.
+             *
+             * @par A handle caches its value without any locking, so each
+             *      thread should use its own handle.
+             *
+             * @tparam T The type that is expected from the value path.
+             */
+            template<typename T>
+            class Handle {
+                public:
+                    Handle(const Preferences& preferences,
+                           const std::string& value_path):
+                        m_preferences(&preferences),
+                        m_value_path(value_path),
+                        m_version(0),
+                        m_value(std::nullopt)
+                    { }
+
+                    /**
+                     * @brief Gets the preference value.
+                     *
+                     * @return The same as Preferences::getPreferenceValue()
+                     */
+                    MonadOptional<T> get() const noexcept {
+                        if(auto version = m_preferences->getVersion();
+                                version != m_version)
+                        {
+                            m_value = m_preferences->getPreferenceValue<T>(m_value_path);
+                            m_version = version;
+                        }
+
+                        // Copy through a const reference, as MonadOptional
+                        //   cannot be copied from a non-const one
+                        const MonadOptional<T>& value = m_value;
+                        return value;
+                    }
+
+                    const std::string& getValuePath() const noexcept {
+                        return m_value_path;
+                    }
+
+                private:
+                    //! The preferences this handle reads from
+                    const Preferences* m_preferences;
+
+                    //! The path to the config value
+                    std::string m_value_path;
+
+                    //! The version m_value was looked up at
+                    mutable Version m_version;
+
+                    //! The last value that was looked up
+                    mutable MonadOptional<T> m_value;
+            };
+
             /**
              * @brief Helper function which constructs a ValueVariant from a T
              * @details This should be used instead of constructing in-place, as
@@ -166,6 +248,25 @@ namespace HMDT {
 
             MonadOptional<bool> doesPathRequireRestart(const std::string&) const noexcept;
 
+            /**
+             * @brief Gets a handle to a preference value.
+             *
+             * @tparam T The type that is expected from the given value path.
+             *
+             * @param value_path The path to the config value. Given in the
+             *                   format of "{Section}.{Group}.{Config}"
+             */
+            template<typename T>
+            Handle<T> getHandle(const std::string& value_path) const noexcept {
+                return Handle<T>(*this, value_path);
+            }
+
+            Version getVersion() const noexcept;
+
+            Maybe<SubscriptionID> subscribe(const std::string&,
+                                            OnPreferenceChangedCallback) noexcept;
+            bool unsubscribe(SubscriptionID) noexcept;
+
             MaybeVoid setCallbackOnPreferenceChange(const std::string&,
                                                     OnPreferenceChangeCallback) noexcept;
 
@@ -282,6 +383,9 @@ namespace HMDT {
             //   done on 'get'
             void initialize() noexcept;
 
+            void notifySubscribers(const std::string&);
+            void markChanged() noexcept;
+
         private:
             Preferences();
 
@@ -300,6 +404,16 @@ namespace HMDT {
             //! All registered callbacks to be called when a preference value changes
             std::map<std::string, OnPreferenceChangeCallback> m_on_pref_change_callbacks;
 
+            //! All callbacks to be called after a preference value has changed
+            std::map<std::string,
+                     std::map<SubscriptionID, OnPreferenceChangedCallback>> m_subscriptions;
+
+            //! The ID to give to the next subscription
+            SubscriptionID m_next_subscription_id;
+
+            //! The current version of the preferences
+            std::atomic<Version> m_version;
+
             //! Used to specify if initialize() has been called and succeeded
             bool m_initialized;
 
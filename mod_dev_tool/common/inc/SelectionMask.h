@@ -0,0 +1,92 @@
+/**
+ * @file SelectionMask.h
+ *
+ * @brief Defines the CPU-side copy of a lookup table which marks whether each
+ *        label is selected, laid out so that it can be uploaded as a texture.
+ */
+
+#ifndef SELECTION_MASK_H
+# define SELECTION_MASK_H
+
+# include <cstddef>
+# include <cstdint>
+# include <optional>
+# include <utility>
+# include <vector>
+
+namespace HMDT {
+    /**
+     * @brief A lookup table of which labels are selected.
+     *
+     * @details Each label gets a single byte, which is either SELECTED or
+     *          NOT_SELECTED. The bytes are laid out in rows of ROW_WIDTH, so
+     *          that the whole table can be uploaded as a 2D texture and a
+     *          shader can find out whether a label is selected with a single
+     *          texel fetch, no matter how many labels are selected.
+     *
+     * @par Every change records which rows it touched, so that only those
+     *      rows need to be uploaded again. Call markClean() once they have
+     *      been uploaded.
+     *
+     * @par Label 0 is reserved to mean "no label", and can never be selected.
+     */
+    class SelectionMask {
+        public:
+            using Label = std::uint32_t;
+
+            //! How many labels are stored in each row of the table
+            constexpr static std::uint32_t ROW_WIDTH = 1024;
+
+            constexpr static std::uint8_t NOT_SELECTED = 0x00;
+            constexpr static std::uint8_t SELECTED = 0xFF;
+
+            SelectionMask() = default;
+            explicit SelectionMask(std::size_t);
+
+            void resize(std::size_t);
+
+            bool set(Label, bool = true);
+            void assign(const std::vector<Label>&);
+            void clear();
+
+            bool test(Label) const noexcept;
+
+            std::size_t size() const noexcept;
+            std::size_t count() const noexcept;
+
+            std::uint32_t getWidth() const noexcept;
+            std::uint32_t getHeight() const noexcept;
+            const std::uint8_t* getData() const noexcept;
+            const std::uint8_t* getRow(std::uint32_t) const noexcept;
+
+            std::optional<std::pair<std::uint32_t, std::uint32_t>> getDirtyRows() const noexcept;
+            bool isResized() const noexcept;
+            void markClean() noexcept;
+
+        private:
+            void markDirty(Label) noexcept;
+
+            //! One byte per label, padded out to a whole number of rows
+            std::vector<std::uint8_t> m_values;
+
+            //! How many labels the table holds
+            std::size_t m_size = 0;
+
+            //! Every selected label, in no particular order
+            std::vector<Label> m_selected;
+
+            //! The first row changed since the last call to markClean()
+            std::uint32_t m_dirty_first = 0;
+
+            //! One past the last row changed since the last call to
+            //!   markClean()
+            std::uint32_t m_dirty_last = 0;
+
+            //! Whether the number of rows has changed since the last call to
+            //!   markClean()
+            bool m_is_resized = false;
+    };
+}
+
+#endif
+
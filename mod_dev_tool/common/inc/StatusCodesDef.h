@@ -26,6 +26,7 @@
     X(INVALID_TYPE, gettext("The given type is not valid.")) \
     X(KEY_EXISTS, gettext("The key already exists.")) \
     X(KEY_NOT_FOUND, gettext("The key does not exist.")) \
+    X(INVALID_UUID_STRING, gettext("The string is not a valid UUID.")) \
     /* Project Error Codes */ \
     Y(PROJECT, 0x100) \
     X(PROJECT_VALIDATION_FAILED, gettext("Project Validation Failed.")) \
@@ -33,6 +34,7 @@
     X(NO_DATA_LOADED, gettext("No data is currently loaded.")) \
     X(DIMENSION_MISMATCH, gettext("The loaded map image has dimensions which do not match previously loaded maps.")) \
     X(CALLBACK_NOT_REGISTERED, gettext("No prompt callback was registered with this project.")) \
+    X(LOAD_STAGE_CYCLE, gettext("The project's load stages depend on each other in a cycle.")) \
     /* Province Project Error Codes */ \
     Y(PROVINCE_PROJECT, 0x200) \
     X(PROVINCE_INVALID_STATE_ID, gettext("The Province's StateID is invalid.")) \
@@ -40,6 +42,10 @@
     /* State Project Error Codes */ \
     Y(STATE_PROJECT, 0x300) \
     X(STATE_DOES_NOT_EXIST, gettext("The state does not exist.")) \
+    X(STATE_EXPORT_FAILED, gettext("One or more state files could not be exported.")) \
+    /* Project Hierarchy Error Codes */ \
+    Y(PROJECT_HIERARCHY, 0x400) \
+    X(INVALID_QUERY, gettext("The hierarchy query could not be parsed.")) \
     /* Gui Error Codes */ \
     Y(GUI, 0x2000) \
     X(DISPATCHER_DOES_NOT_EXIST, gettext("The provided dispatcher id does not exist.")) \
@@ -55,6 +61,8 @@
     Y(FILECODES, 0x10000) \
     X(CANNOT_READ_FROM_STREAM, gettext("Unable to read from the given stream.")) \
     X(READ_TOO_FEW_BYTES, gettext("Too few bytes were read from the given stream.")) \
+    X(INVALID_JOURNAL, gettext("The file is not a valid edit journal.")) \
+    X(JOURNAL_DELTA_FAILED, gettext("An edit in the journal could not be applied.")) \
     /* Logger Error Codes */ \
     Y(LOGGER, 0x16000) \
     X(INVALID_LEVEL_STRING, gettext("String is unable to be converted to a level enum.")) \
@@ -0,0 +1,232 @@
+/**
+ * @file Symbol.h
+ *
+ * @brief Defines interned string handles, for names which are shared by many
+ *        objects.
+ */
+
+#ifndef SYMBOL_H
+# define SYMBOL_H
+
+# include <cstdint>
+# include <deque>
+# include <functional>
+# include <optional>
+# include <ostream>
+# include <shared_mutex>
+# include <string>
+# include <string_view>
+# include <type_traits>
+# include <unordered_map>
+
+namespace HMDT {
+    /**
+     * @brief Stores one copy of every unique name, each with a small ID.
+     *
+     * @details IDs are handed out in the order that names are first interned,
+     *          starting at 0 for the empty string. Names are never removed, so
+     *          an Entry remains valid for as long as the table does.
+     *
+     * @par Interning and lookups may be done from any thread.
+     */
+    class SymbolTable {
+        public:
+            //! The ID of an interned name
+            using ID = std::uint32_t;
+
+            /**
+             * @brief A single interned name
+             */
+            struct Entry {
+                std::string name;
+                ID id;
+            };
+
+            SymbolTable();
+
+            SymbolTable(const SymbolTable&) = delete;
+            SymbolTable& operator=(const SymbolTable&) = delete;
+
+            const Entry& intern(std::string_view);
+            const Entry* find(std::string_view) const noexcept;
+
+            const Entry& getEmpty() const noexcept;
+
+            std::size_t size() const noexcept;
+
+        private:
+            //! Guards every member below
+            mutable std::shared_mutex m_mutex;
+
+            //! Every interned name, indexed by ID. A deque so that entries
+            //!   never move once they are added.
+            std::deque<Entry> m_entries;
+
+            //! Maps every name (viewing into m_entries) to its ID
+            std::unordered_map<std::string_view, ID> m_ids;
+
+            //! The entry for the empty string
+            const Entry* m_empty;
+    };
+
+    template<typename Tag>
+    class Symbol;
+
+    /**
+     * @brief Checks if a type is a Symbol
+     */
+    template<typename T>
+    struct IsSymbol: std::false_type { };
+
+    template<typename Tag>
+    struct IsSymbol<Symbol<Tag>>: std::true_type { };
+
+    template<typename T>
+    constexpr bool IsSymbol_v = IsSymbol<T>::value;
+
+    /**
+     * @brief A handle to a name interned in a SymbolTable.
+     *
+     * @details A Symbol is a single pointer, so copying and comparing them is
+     *          as cheap as for an integer, and both the name and the ID can be
+     *          read without touching the table. Each Tag gets its own table,
+     *          so that the IDs of one kind of name stay small and dense.
+     *
+     * @tparam Tag An empty type which picks the table to intern into
+     */
+    template<typename Tag>
+    class Symbol {
+        public:
+            using ID = SymbolTable::ID;
+
+            /**
+             * @brief Constructs a symbol for the empty string
+             */
+            Symbol() noexcept:
+                m_entry(&getTable().getEmpty())
+            { }
+
+            /**
+             * @brief Interns a name
+             *
+             * @param name Anything that a std::string can be built from.
+             */
+            template<typename S,
+                     typename = std::enable_if_t<!IsSymbol_v<S> &&
+                                                 std::is_constructible_v<std::string, const S&>>>
+            Symbol(const S& name):
+                m_entry(&intern(name))
+            { }
+
+            const std::string& str() const noexcept { return m_entry->name; }
+            const char* c_str() const noexcept { return m_entry->name.c_str(); }
+            ID getID() const noexcept { return m_entry->id; }
+
+            bool empty() const noexcept { return m_entry->name.empty(); }
+
+            operator const std::string&() const noexcept {
+                return m_entry->name;
+            }
+
+            bool operator==(const Symbol& other) const noexcept {
+                return m_entry == other.m_entry;
+            }
+            bool operator!=(const Symbol& other) const noexcept {
+                return m_entry != other.m_entry;
+            }
+            bool operator==(const std::string& other) const noexcept {
+                return m_entry->name == other;
+            }
+            bool operator!=(const std::string& other) const noexcept {
+                return m_entry->name != other;
+            }
+            bool operator==(const char* other) const noexcept {
+                return m_entry->name == other;
+            }
+            bool operator!=(const char* other) const noexcept {
+                return m_entry->name != other;
+            }
+
+            //! Orders by name, so that sorted output doesn't depend on the
+            //!   order that names were interned in
+            bool operator<(const Symbol& other) const noexcept {
+                return m_entry->name < other.m_entry->name;
+            }
+
+            /**
+             * @brief Gets the table that every symbol with this Tag lives in
+             */
+            static SymbolTable& getTable() noexcept {
+                static SymbolTable table;
+                return table;
+            }
+
+            /**
+             * @brief Gets the symbol for a name, without interning it
+             *
+             * @param name The name to look for
+             *
+             * @return The symbol, or std::nullopt if name has never been
+             *         interned.
+             */
+            static std::optional<Symbol> find(std::string_view name) noexcept {
+                if(auto* entry = getTable().find(name); entry != nullptr) {
+                    return Symbol(entry);
+                }
+
+                return std::nullopt;
+            }
+
+            friend std::ostream& operator<<(std::ostream& stream,
+                                            const Symbol& symbol)
+            {
+                return stream << symbol.str();
+            }
+
+        private:
+            explicit Symbol(const SymbolTable::Entry* entry) noexcept:
+                m_entry(entry)
+            { }
+
+            template<typename S>
+            static const SymbolTable::Entry& intern(const S& name) {
+                if constexpr(std::is_convertible_v<const S&, std::string_view>) {
+                    return getTable().intern(name);
+                } else {
+                    return getTable().intern(std::string(name));
+                }
+            }
+
+            //! The interned name
+            const SymbolTable::Entry* m_entry;
+    };
+
+    template<typename Tag>
+    bool operator==(const std::string& lhs, const Symbol<Tag>& rhs) noexcept {
+        return rhs == lhs;
+    }
+
+    template<typename Tag>
+    bool operator!=(const std::string& lhs, const Symbol<Tag>& rhs) noexcept {
+        return rhs != lhs;
+    }
+
+    /**
+     * @brief Tags for every kind of Symbol
+     */
+    namespace SymbolTags {
+        struct Terrain;
+        struct Continent;
+        struct StateCategory;
+    }
+}
+
+template<typename Tag>
+struct std::hash<HMDT::Symbol<Tag>> {
+    std::size_t operator()(const HMDT::Symbol<Tag>& symbol) const noexcept {
+        return std::hash<HMDT::SymbolTable::ID>{}(symbol.getID());
+    }
+};
+
+#endif
+
@@ -2,6 +2,8 @@
 # define TYPE_TRAITS_H
 
 # include <type_traits>
+# include <utility>
+# include <vector>
 
 namespace HMDT {
     /**
@@ -28,6 +30,30 @@ namespace HMDT {
     template<typename T>
     using RemoveAllPointers_t = typename RemoveAllPointers<T>::type;
 
+    /**
+     * @brief Checks if a type owns a contiguous block of storage which it
+     *        reports the capacity of (such as std::string or std::vector).
+     */
+    template<typename T, typename = void>
+    struct HasCapacity: std::false_type { };
+    template<typename T>
+    struct HasCapacity<T, std::void_t<decltype(std::declval<const T&>().capacity()),
+                                      typename T::value_type>>:
+        std::true_type
+    { };
+    template<typename T>
+    constexpr bool HasCapacity_v = HasCapacity<T>::value;
+
+    /**
+     * @brief Checks if a type is a std::vector
+     */
+    template<typename T>
+    struct IsVector: std::false_type { };
+    template<typename T, typename A>
+    struct IsVector<std::vector<T, A>>: std::true_type { };
+    template<typename T>
+    constexpr bool IsVector_v = IsVector<T>::value;
+
 /// @cond
     template<typename T>
     T __void_if_no_value(T);
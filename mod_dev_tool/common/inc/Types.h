@@ -10,8 +10,10 @@
 # include <optional>
 # include <utility>
 # include <unordered_map>
+# include <memory_resource>
 
 # include "Uuid.h"
+# include "Symbol.h"
 
 namespace HMDT {
     /**
@@ -83,7 +85,9 @@ namespace HMDT {
         //! The ID of this polygon
         UUID id;
 
-        std::vector<Pixel> pixels;
+        //! Every pixel in the shape. May be allocated out of an arena owned by
+        //!   whoever built this polygon.
+        std::pmr::vector<Pixel> pixels;
         Color color; //!< Color of the shape as it was read in
         Color unique_color; //!< Unique color we have generated just for this shape
 
@@ -105,8 +109,9 @@ namespace HMDT {
     };
 
     using ProvinceID = UUID;
-    using TerrainID = std::string;
-    using Continent = std::string;
+    using TerrainID = Symbol<SymbolTags::Terrain>;
+    using Continent = Symbol<SymbolTags::Continent>;
+    using StateCategory = Symbol<SymbolTags::StateCategory>;
     using StateID = std::uint32_t;
 
     /**
@@ -151,7 +156,7 @@ namespace HMDT {
         StateID id;
         std::string name;
         size_t manpower;
-        std::string category;
+        StateCategory category;
         float buildings_max_level_factor;
         bool impassable;
         
@@ -7,13 +7,76 @@
 #ifndef UNIQUE_COLOR_GENERATOR_H
 # define UNIQUE_COLOR_GENERATOR_H
 
+# include <array>
+# include <cstdint>
+# include <mutex>
+# include <unordered_map>
+# include <vector>
+
 # include "Types.h"
+# include "Monad.h"
 
 namespace HMDT {
-    Color generateUniqueColor(ProvinceType);
+    /**
+     * @brief Hands out unique colors for each type of province.
+     *
+     * @details Each allocator keeps its own cursor into the color list of every
+     *          province type, so two allocators never affect each other, and
+     *          the colors an allocator gives out only depend on what has been
+     *          asked of it. Every color which has been given out is tracked,
+     *          which allows checking if a color is in use in constant time.
+     *
+     * @par Colors which are released (for example, when a state is deleted)
+     *      are given out again before any new ones. Colors which were loaded
+     *      from elsewhere can be marked as in use so that they never get given
+     *      out.
+     *
+     * @par All functions are safe to call from multiple threads. Callers which
+     *      need many colors at once should ask for them all in one call.
+     */
+    class UniqueColorAllocator {
+        public:
+            UniqueColorAllocator();
+            UniqueColorAllocator(UniqueColorAllocator&&);
+
+            UniqueColorAllocator& operator=(UniqueColorAllocator&&);
+
+            Color allocate(ProvinceType);
+            std::vector<Color> allocate(ProvinceType, std::size_t);
+
+            bool markInUse(const Color&);
+            bool markInUse(const Color&, ProvinceType);
+            bool release(const Color&);
+
+            bool isInUse(const Color&) const;
+            std::size_t getInUseCount() const;
+
+            void reset();
+            void reset(ProvinceType);
+
+        private:
+            //! How many province types have their own list of colors
+            constexpr static std::size_t TYPE_COUNT = 4;
+
+            static std::size_t getTypeIndex(ProvinceType) noexcept;
+
+            bool allocateFromType(ProvinceType, Color&);
+            Color allocateUnlocked(ProvinceType);
+
+            //! Guards every member below
+            mutable std::mutex m_mutex;
+
+            //! How many colors have been taken from each type's color list
+            std::array<std::size_t, TYPE_COUNT> m_cursors;
+
+            //! Every color which was released, for each type
+            std::array<std::vector<Color>, TYPE_COUNT> m_free_colors;
+
+            //! Every color currently in use, and the type it was given out for
+            std::unordered_map<std::uint32_t, ProvinceType> m_in_use;
+    };
 
-    void resetUniqueColorGenerator(ProvinceType);
-    void resetUniqueColorGenerator();
+    MonadOptional<ProvinceType> findUniqueColorType(const Color&) noexcept;
 }
 
 #endif
@@ -16,6 +16,7 @@
 # include <optional>
 # include <thread>
 # include <future>
+# include <system_error>
 
 # include "Types.h"
 # include "Logger.h"
@@ -126,6 +127,8 @@ namespace HMDT {
         }
     }
 
+    bool safeRead(UUID*, std::istream&);
+
     /**
      * @brief Safely reads from a stream if and only if the stream has not
      *        reached eof and is still good.
@@ -189,6 +192,8 @@ namespace HMDT {
         return STATUS_SUCCESS;
     }
 
+    MaybeVoid safeRead2(UUID*, std::istream&);
+
     /**
      * @brief Safely reads from a stream if and only if the stream has not
      *        reached eof and is still good.
@@ -225,6 +230,8 @@ namespace HMDT {
         stream.write(reinterpret_cast<const char*>(&data), sizeof(T));
     }
 
+    void writeData(std::ostream&, const UUID&);
+
     /**
      * @brief Writes multiple values directly to an ostream
      *
@@ -308,6 +315,8 @@ namespace HMDT {
             }
 
             return *res;
+        } else if constexpr(IsSymbol_v<T>) {
+            return T(s);
         } else {
             static_assert("Unsupported type!");
 
@@ -517,6 +526,34 @@ namespace HMDT {
         return result;
     }
 
+    /**
+     * @brief Gets the value of a field which every structure holds in common.
+     *
+     * @tparam S The type of structure.
+     * @tparam T The type of the field.
+     *
+     * @param structures The structures to look at.
+     * @param field The field to compare across every structure.
+     *
+     * @return The shared value, or std::nullopt if the structures do not all
+     *         hold the same value or if there are no structures.
+     */
+    template<typename S, typename T>
+    std::optional<T> getCommonValue(const RefVector<S>& structures,
+                                    T std::remove_const_t<S>::* field)
+    {
+        if(structures.empty()) return std::nullopt;
+
+        const T& value = structures.front().get().*field;
+        for(auto&& structure : structures) {
+            if(!(structure.get().*field == value)) {
+                return std::nullopt;
+            }
+        }
+
+        return value;
+    }
+
     template<typename InputIt, typename OutputIt, typename UnaryOperation>
     void parallelTransform(InputIt first, InputIt last, OutputIt d_first,
                            UnaryOperation unary_op)
@@ -593,6 +630,75 @@ namespace HMDT {
         }
     }
 
+    /**
+     * @brief Splits the range [first, last) into contiguous chunks, and calls
+     *        func(chunk_first, chunk_last) on each chunk in parallel.
+     * @details Each chunk is at least min_chunk_size elements large (except
+     *          for possibly the last one), and no more chunks are made than
+     *          there are cores available. This function will block until
+     *          every chunk has been processed.
+     *
+     * @par If a thread cannot be started for a chunk, then that chunk is
+     *      processed on the calling thread instead, so this only throws if
+     *      func does.
+     *
+     * @tparam Func The type of function to call on each chunk.
+     *
+     * @param first The start of the range.
+     * @param last One past the end of the range.
+     * @param func The function to call for each chunk of the range.
+     * @param min_chunk_size The smallest number of elements that are worth
+     *                       spinning up a new thread for.
+     * @param max_thread_count The most chunks to process at once, or 0 to
+     *                         only be limited by the number of cores.
+     */
+    template<typename Func>
+    void parallelForRange(std::uint64_t first, std::uint64_t last, Func func,
+                          std::uint64_t min_chunk_size = 1,
+                          std::uint64_t max_thread_count = 0)
+    {
+        if(first >= last) return;
+
+        std::uint64_t length = last - first;
+        std::uint64_t thread_count = std::max(std::thread::hardware_concurrency(), 1U);
+
+        if(max_thread_count != 0) {
+            thread_count = std::min(thread_count, max_thread_count);
+        }
+
+        thread_count = std::min(thread_count,
+                                std::max<std::uint64_t>(length / std::max<std::uint64_t>(min_chunk_size, 1), 1));
+
+        if(thread_count <= 1) {
+            func(first, last);
+            return;
+        }
+
+        auto step = length / thread_count;
+
+        std::vector<std::future<void>> futures;
+        futures.reserve(thread_count - 1);
+
+        // Hand off all but the last chunk to other threads, and take care of
+        //   the last one (which also picks up any remainder) ourselves
+        for(std::uint64_t i = 0; i < thread_count - 1; ++i) {
+            try {
+                futures.push_back(std::async(std::launch::async, func,
+                                             first, first + step));
+            } catch(const std::system_error&) {
+                // No more threads can be started, so just do the work here
+                func(first, first + step);
+            }
+            first += step;
+        }
+
+        func(first, last);
+
+        for(auto&& future : futures) {
+            future.get();
+        }
+    }
+
     /**
      * @brief Joins a range of values together into a string.
      *
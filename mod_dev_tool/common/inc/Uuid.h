@@ -10,7 +10,10 @@
 #ifndef HMDT_UUID_H
 # define HMDT_UUID_H
 
+# include <array>
+# include <cstdint>
 # include <string>
+# include <string_view>
 # include <optional>
 
 extern "C" {
@@ -66,7 +69,18 @@ namespace HMDT {
              */
             constexpr static std::uint32_t STRING_REPR_LENGTH = 36;
 
+            //! The number of bytes in the binary representation of a UUID
+            constexpr static std::uint32_t BINARY_REPR_LENGTH = 16;
+
+            /**
+             * @brief The binary representation of a UUID, in the same
+             *        (big-endian) byte order as the string representation on
+             *        every platform.
+             */
+            using Bytes = std::array<std::uint8_t, BINARY_REPR_LENGTH>;
+
             UUID(CreationParams = CreationParams::BEST);
+            explicit UUID(const Bytes&) noexcept;
             UUID(const UUID&);
             UUID(UUID&&);
 
@@ -92,7 +106,11 @@ namespace HMDT {
 
             std::size_t hash() const noexcept;
 
-            static Maybe<UUID> parse(const std::string&) noexcept;
+            Bytes toBytes() const noexcept;
+
+            char* format(char*) const noexcept;
+
+            static Maybe<UUID> parse(std::string_view) noexcept;
 
         private:
             SystemUUIDType m_internal_uuid;
@@ -0,0 +1,117 @@
+
+#include "ArenaResource.h"
+
+#include <algorithm>
+
+/**
+ * @brief Constructs a new arena
+ *
+ * @param initial_size The size of the first block to request from upstream.
+ * @param upstream The resource to request blocks of memory from.
+ */
+HMDT::ArenaResource::ArenaResource(std::size_t initial_size,
+                                   std::pmr::memory_resource* upstream):
+    m_stats{ },
+    m_upstream_counter(upstream, m_stats),
+    m_arena(initial_size, &m_upstream_counter)
+{ }
+
+/**
+ * @brief Releases every block held by this arena back to upstream.
+ * @details Any memory previously allocated out of this arena is invalidated,
+ *          so all containers using it must have been destroyed or cleared
+ *          before this is called.
+ */
+void HMDT::ArenaResource::release() {
+    m_arena.release();
+
+    m_stats.bytes_allocated = 0;
+    m_stats.bytes_in_use = 0;
+    m_stats.num_allocations = 0;
+    m_stats.num_deallocations = 0;
+    ++m_stats.num_releases;
+}
+
+auto HMDT::ArenaResource::getStatistics() const noexcept -> const Statistics& {
+    return m_stats;
+}
+
+void* HMDT::ArenaResource::do_allocate(std::size_t bytes, std::size_t alignment)
+{
+    void* ptr = m_arena.allocate(bytes, alignment);
+
+    m_stats.bytes_allocated += bytes;
+    m_stats.bytes_in_use += bytes;
+    m_stats.peak_bytes_in_use = std::max(m_stats.peak_bytes_in_use,
+                                         m_stats.bytes_in_use);
+    ++m_stats.num_allocations;
+
+    return ptr;
+}
+
+void HMDT::ArenaResource::do_deallocate(void* ptr, std::size_t bytes,
+                                        std::size_t alignment)
+{
+    // Note that the monotonic resource never actually frees anything here, we
+    //   just keep track of it for the statistics
+    m_arena.deallocate(ptr, bytes, alignment);
+
+    m_stats.bytes_in_use -= std::min(bytes, m_stats.bytes_in_use);
+    ++m_stats.num_deallocations;
+}
+
+bool HMDT::ArenaResource::do_is_equal(const std::pmr::memory_resource& other) const noexcept
+{
+    return this == &other;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+HMDT::ArenaResource::UpstreamCounter::UpstreamCounter(std::pmr::memory_resource* upstream,
+                                                      Statistics& stats):
+    m_upstream(upstream),
+    m_stats(stats)
+{ }
+
+void* HMDT::ArenaResource::UpstreamCounter::do_allocate(std::size_t bytes,
+                                                        std::size_t alignment)
+{
+    void* ptr = m_upstream->allocate(bytes, alignment);
+
+    m_stats.bytes_reserved += bytes;
+    m_stats.peak_bytes_reserved = std::max(m_stats.peak_bytes_reserved,
+                                           m_stats.bytes_reserved);
+
+    return ptr;
+}
+
+void HMDT::ArenaResource::UpstreamCounter::do_deallocate(void* ptr,
+                                                         std::size_t bytes,
+                                                         std::size_t alignment)
+{
+    m_upstream->deallocate(ptr, bytes, alignment);
+
+    m_stats.bytes_reserved -= std::min(bytes, m_stats.bytes_reserved);
+}
+
+bool HMDT::ArenaResource::UpstreamCounter::do_is_equal(const std::pmr::memory_resource& other) const noexcept
+{
+    return this == &other;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+std::ostream& HMDT::operator<<(std::ostream& out,
+                               const ArenaResource::Statistics& stats)
+{
+    return out << "{ allocated=" << stats.bytes_allocated
+               << ", in_use=" << stats.bytes_in_use
+               << ", peak_in_use=" << stats.peak_bytes_in_use
+               << ", reserved=" << stats.bytes_reserved
+               << ", peak_reserved=" << stats.peak_bytes_reserved
+               << ", allocations=" << stats.num_allocations
+               << ", deallocations=" << stats.num_deallocations
+               << ", releases=" << stats.num_releases
+               << " }";
+}
+
@@ -505,274 +505,385 @@ auto HMDT::writeBMP(const std::filesystem::path& path,
     return res;
 }
 
-auto HMDT::writeBMP(const std::filesystem::path& path, const BitMap2& bmp) noexcept
-    -> MaybeVoid
-{
-    std::ofstream file(path, std::ios::out | std::ios::binary);
+namespace {
+    /**
+     * @brief Writes a bitmap file one row at a time, so that the whole image
+     *        never needs to be held in memory in the order it is written.
+     *
+     * @param path The path to write to
+     * @param bmp The headers and color table to write. Its data is ignored.
+     * @param generator Fills in each row of the image
+     *
+     * @return STATUS_SUCCESS on success, or the first error encountered.
+     */
+    HMDT::MaybeVoid writeBMPStream(const std::filesystem::path& path,
+                                   const HMDT::BitMap2& bmp,
+                                   const HMDT::BMPRowGenerator& generator) noexcept
+    {
+        using namespace HMDT;
 
-    if(!file) {
-        WRITE_ERROR("Failed to open output file ", path);
-        RETURN_ERROR(std::error_code(errno, std::generic_category()));
-    }
+        std::ofstream file(path, std::ios::out | std::ios::binary);
 
-    WRITE_DEBUG(bmp);
+        if(!file) {
+            WRITE_ERROR("Failed to open output file ", path);
+            RETURN_ERROR(std::error_code(errno, std::generic_category()));
+        }
 
-    // Helper macro to make the following code easier to read
+        WRITE_DEBUG(bmp);
+
+        // Helper macro to make the following code easier to read
 #define WRITE_BMP_VALUE(MEMBER) \
     file.write(reinterpret_cast<const char*>(&(MEMBER)), \
                sizeof(MEMBER))
 
-    WRITE_BMP_VALUE(bmp.file_header.filetype);
-    WRITE_BMP_VALUE(bmp.file_header.fileSize);
-    WRITE_BMP_VALUE(bmp.file_header.reserved1);
-    WRITE_BMP_VALUE(bmp.file_header.reserved2);
-    WRITE_BMP_VALUE(bmp.file_header.bitmapOffset);
-    WRITE_BMP_VALUE(bmp.info_header.v1.headerSize);
-    WRITE_BMP_VALUE(bmp.info_header.v1.width);
-    WRITE_BMP_VALUE(bmp.info_header.v1.height);
-    WRITE_BMP_VALUE(bmp.info_header.v1.bitPlanes);
-    WRITE_BMP_VALUE(bmp.info_header.v1.bitsPerPixel);
-    WRITE_BMP_VALUE(bmp.info_header.v1.compression);
-    WRITE_BMP_VALUE(bmp.info_header.v1.sizeOfBitmap);
-    WRITE_BMP_VALUE(bmp.info_header.v1.horzResolution);
-    WRITE_BMP_VALUE(bmp.info_header.v1.vertResolution);
-    WRITE_BMP_VALUE(bmp.info_header.v1.colorsUsed);
-    WRITE_BMP_VALUE(bmp.info_header.v1.colorImportant);
-
-    // Write the V4 header
-    if(bmp.info_header.v1.headerSize >= V4_INFO_HEADER_LENGTH) {
-        WRITE_BMP_VALUE(bmp.info_header.v4.redMask);
-        WRITE_BMP_VALUE(bmp.info_header.v4.greenMask);
-        WRITE_BMP_VALUE(bmp.info_header.v4.blueMask);
-        WRITE_BMP_VALUE(bmp.info_header.v4.alphaMask);
-        WRITE_BMP_VALUE(bmp.info_header.v4.CSType);
-
-        WRITE_BMP_VALUE(bmp.info_header.v4.redX);
-        WRITE_BMP_VALUE(bmp.info_header.v4.redY);
-        WRITE_BMP_VALUE(bmp.info_header.v4.redZ);
-        WRITE_BMP_VALUE(bmp.info_header.v4.greenX);
-        WRITE_BMP_VALUE(bmp.info_header.v4.greenY);
-        WRITE_BMP_VALUE(bmp.info_header.v4.greenZ);
-        WRITE_BMP_VALUE(bmp.info_header.v4.blueX);
-        WRITE_BMP_VALUE(bmp.info_header.v4.blueY);
-        WRITE_BMP_VALUE(bmp.info_header.v4.blueZ);
-
-        WRITE_BMP_VALUE(bmp.info_header.v4.gammaRed);
-        WRITE_BMP_VALUE(bmp.info_header.v4.gammaGreen);
-        WRITE_BMP_VALUE(bmp.info_header.v4.gammaBlue);
-    }
+        WRITE_BMP_VALUE(bmp.file_header.filetype);
+        WRITE_BMP_VALUE(bmp.file_header.fileSize);
+        WRITE_BMP_VALUE(bmp.file_header.reserved1);
+        WRITE_BMP_VALUE(bmp.file_header.reserved2);
+        WRITE_BMP_VALUE(bmp.file_header.bitmapOffset);
+        WRITE_BMP_VALUE(bmp.info_header.v1.headerSize);
+        WRITE_BMP_VALUE(bmp.info_header.v1.width);
+        WRITE_BMP_VALUE(bmp.info_header.v1.height);
+        WRITE_BMP_VALUE(bmp.info_header.v1.bitPlanes);
+        WRITE_BMP_VALUE(bmp.info_header.v1.bitsPerPixel);
+        WRITE_BMP_VALUE(bmp.info_header.v1.compression);
+        WRITE_BMP_VALUE(bmp.info_header.v1.sizeOfBitmap);
+        WRITE_BMP_VALUE(bmp.info_header.v1.horzResolution);
+        WRITE_BMP_VALUE(bmp.info_header.v1.vertResolution);
+        WRITE_BMP_VALUE(bmp.info_header.v1.colorsUsed);
+        WRITE_BMP_VALUE(bmp.info_header.v1.colorImportant);
+
+        // Write the V4 header
+        if(bmp.info_header.v1.headerSize >= V4_INFO_HEADER_LENGTH) {
+            WRITE_BMP_VALUE(bmp.info_header.v4.redMask);
+            WRITE_BMP_VALUE(bmp.info_header.v4.greenMask);
+            WRITE_BMP_VALUE(bmp.info_header.v4.blueMask);
+            WRITE_BMP_VALUE(bmp.info_header.v4.alphaMask);
+            WRITE_BMP_VALUE(bmp.info_header.v4.CSType);
+
+            WRITE_BMP_VALUE(bmp.info_header.v4.redX);
+            WRITE_BMP_VALUE(bmp.info_header.v4.redY);
+            WRITE_BMP_VALUE(bmp.info_header.v4.redZ);
+            WRITE_BMP_VALUE(bmp.info_header.v4.greenX);
+            WRITE_BMP_VALUE(bmp.info_header.v4.greenY);
+            WRITE_BMP_VALUE(bmp.info_header.v4.greenZ);
+            WRITE_BMP_VALUE(bmp.info_header.v4.blueX);
+            WRITE_BMP_VALUE(bmp.info_header.v4.blueY);
+            WRITE_BMP_VALUE(bmp.info_header.v4.blueZ);
+
+            WRITE_BMP_VALUE(bmp.info_header.v4.gammaRed);
+            WRITE_BMP_VALUE(bmp.info_header.v4.gammaGreen);
+            WRITE_BMP_VALUE(bmp.info_header.v4.gammaBlue);
+        }
 
-    // Write the V5 header
-    if(bmp.info_header.v1.headerSize >= V5_INFO_HEADER_LENGTH) {
-        WRITE_BMP_VALUE(bmp.info_header.v5.profileData);
-        WRITE_BMP_VALUE(bmp.info_header.v5.profileSize);
-        WRITE_BMP_VALUE(bmp.info_header.v5.reserved);
-    }
+        // Write the V5 header
+        if(bmp.info_header.v1.headerSize >= V5_INFO_HEADER_LENGTH) {
+            WRITE_BMP_VALUE(bmp.info_header.v5.profileData);
+            WRITE_BMP_VALUE(bmp.info_header.v5.profileSize);
+            WRITE_BMP_VALUE(bmp.info_header.v5.reserved);
+        }
 
-    if(bmp.color_table != nullptr) {
-        WRITE_DEBUG("Writing color table with ", bmp.info_header.v1.colorsUsed,
-                    " values.");
-        for(auto i = 0U; i < bmp.info_header.v1.colorsUsed; ++i) {
-            WRITE_BMP_VALUE(bmp.color_table[i].blue);
-            WRITE_BMP_VALUE(bmp.color_table[i].green);
-            WRITE_BMP_VALUE(bmp.color_table[i].red);
-            WRITE_BMP_VALUE(bmp.color_table[i].reserved);
+        if(bmp.color_table != nullptr) {
+            WRITE_DEBUG("Writing color table with ", bmp.info_header.v1.colorsUsed,
+                        " values.");
+            for(auto i = 0U; i < bmp.info_header.v1.colorsUsed; ++i) {
+                WRITE_BMP_VALUE(bmp.color_table[i].blue);
+                WRITE_BMP_VALUE(bmp.color_table[i].green);
+                WRITE_BMP_VALUE(bmp.color_table[i].red);
+                WRITE_BMP_VALUE(bmp.color_table[i].reserved);
+            }
         }
-    }
 
-    // Verify that the offset matches where in the file we are
-    if(auto stream_loc = file.tellp();
-            stream_loc != bmp.file_header.bitmapOffset)
-    {
-        WRITE_ERROR("Validation error! Calculated bitmapOffset of ",
-                    bmp.file_header.bitmapOffset, " does not match number of "
-                    "bytes we've written so far of ", stream_loc);
-        RETURN_ERROR(STATUS_BITMAP_OFFSET_VALIDATION_ERROR);
-    }
+        // Verify that the offset matches where in the file we are
+        if(auto stream_loc = file.tellp();
+                stream_loc != bmp.file_header.bitmapOffset)
+        {
+            WRITE_ERROR("Validation error! Calculated bitmapOffset of ",
+                        bmp.file_header.bitmapOffset, " does not match number of "
+                        "bytes we've written so far of ", stream_loc);
+            RETURN_ERROR(STATUS_BITMAP_OFFSET_VALIDATION_ERROR);
+        }
 
-    //----------------
-    // Flip the entire image, because BitMap is a weird format.
-    //----------------
+        // This is how much space a single line takes up
+        const std::size_t depth = bmp.info_header.v1.bitsPerPixel / 8;
+        const std::size_t pitch = bmp.info_header.v1.width * depth;
+        const auto height = static_cast<uint32_t>(bmp.info_header.v1.height);
 
-    // This is how much space a single line takes up
-    size_t depth = bmp.info_header.v1.bitsPerPixel / 8;
-    size_t pitch = bmp.info_header.v1.width * depth;
+        // Big enough to store exactly one line of the image, which is reused
+        //   for every line
+        std::unique_ptr<unsigned char[]> row;
+        try {
+            row.reset(new unsigned char[pitch]);
+        } catch(const std::bad_alloc& e) {
+            WRITE_ERROR("Failed to allocate enough space for one line of pixels (",
+                        pitch, " bytes required): ", e.what());
+            RETURN_ERROR(STATUS_BADALLOC);
+        }
 
-    WRITE_DEBUG("Flipping entire image before we write it. depth=", depth, ", pitch=", pitch);
-    std::unique_ptr<unsigned char[]> output;
-    try {
-        output.reset(new unsigned char[bmp.info_header.v1.sizeOfBitmap]{ 0 });
-    } catch(const std::bad_alloc& e) {
-        WRITE_ERROR("Failed to allocate enough space for flipped output data: ", e.what());
-        RETURN_ERROR(STATUS_BADALLOC);
-    }
+        WRITE_DEBUG("Writing ", height, " lines of ", pitch, " bytes to file.");
 
-    auto res = flipImage(output.get(), bmp.data.get(), pitch, bmp.info_header.v1.height);
-    RETURN_IF_ERROR(res);
+        // BitMaps are stored bottom-up, so start from the last line
+        for(uint32_t y = height; y > 0; --y) {
+            auto res = generator(y - 1, row.get());
+            RETURN_IF_ERROR(res);
 
-    // Only flip the bytes for 24-bit images
-    if(depth == 3) {
-        WRITE_DEBUG("Swapping RGB to BGR before writing the BitMap.");
-        // Swap B and R every 3 pixels since BitMap expects pixels in BGR rather
-        //   than RGB format
-        for(size_t i = 2; i < bmp.info_header.v1.sizeOfBitmap; i += depth) {
-            std::swap(output[i], output[i - 2]);
+            // Only flip the bytes for 24-bit images
+            if(depth == 3) {
+                // Swap B and R every 3 pixels since BitMap expects pixels in
+                //   BGR rather than RGB format
+                for(std::size_t i = 2; i < pitch; i += depth) {
+                    std::swap(row[i], row[i - 2]);
+                }
+            }
+
+            file.write(reinterpret_cast<const char*>(row.get()), pitch);
         }
-    }
 
-    {
-        WRITE_DEBUG("Image flipped successfully, writing ",
-                    bmp.info_header.v1.sizeOfBitmap, " bytes to file.");
-        auto before = file.tellp();
-        file.write(reinterpret_cast<const char*>(output.get()),
-                   bmp.info_header.v1.sizeOfBitmap);
-        WRITE_DEBUG("Wrote ", (file.tellp() - before), " bytes.");
-    }
+        // Close the file and verify if the write succeeded
+        file.close();
+        if(file.bad()) {
+            WRITE_ERROR("badbit set on output file after closing it. Write failed!");
+            RETURN_ERROR(std::error_code(errno, std::generic_category()));
+        }
 
-    // Close the file and verify if the write succeeded
-    file.close();
-    if(file.bad()) {
-        WRITE_ERROR("badbit set on output file after closing it. Write failed!");
-        RETURN_ERROR(std::error_code(errno, std::generic_category()));
+        return STATUS_SUCCESS;
+
+#undef WRITE_BMP_VALUE
     }
 
-    return STATUS_SUCCESS;
+    /**
+     * @brief Fills out the headers and color table of a bitmap to be written
+     *
+     * @param bmp The bitmap to fill out
+     * @param width The width of the bitmap
+     * @param height The height of the bitmap
+     * @param depth The number of bytes in each pixel
+     * @param is_greyscale Whether a generated color table should be greyscale
+     * @param hdr_version_to_use Which info header to write
+     * @param color_table The color table to use, or std::nullopt to generate
+     *                    one if the depth requires it
+     */
+    HMDT::MaybeVoid buildBMPHeaders(HMDT::BitMap2& bmp, uint32_t width,
+                                    uint32_t height, uint16_t depth,
+                                    bool is_greyscale,
+                                    HMDT::BMPHeaderToUse hdr_version_to_use,
+                                    HMDT::MonadOptional<HMDT::ColorTable> color_table) noexcept
+    {
+        using namespace HMDT;
+
+        auto num_pixels = width * height;
+
+        bmp.file_header.filetype = BM_TYPE;
+        bmp.file_header.fileSize = FILE_HEADER_LENGTH + num_pixels * depth;
+        bmp.file_header.reserved1 = 0;
+        bmp.file_header.reserved2 = 0;
+        bmp.file_header.bitmapOffset = FILE_HEADER_LENGTH;
+
+        auto info_header_size = 0;
+
+        // Fill out the info header based on what version is requested
+        //   Note: we populate it backwards to take advantage of switch-case
+        //   fallthrough
+        switch(hdr_version_to_use) {
+            case BMPHeaderToUse::V5:
+                WRITE_DEBUG("Build V5 header");
+                info_header_size += (V5_INFO_HEADER_LENGTH - V4_INFO_HEADER_LENGTH);
+
+                bmp.info_header.v5.profileData = 0;
+                bmp.info_header.v5.profileSize = 0;
+                bmp.info_header.v5.reserved = 0;
+
+                [[fallthrough]];
+            case BMPHeaderToUse::V4:
+                WRITE_DEBUG("Build V4 header");
+                info_header_size += (V4_INFO_HEADER_LENGTH - V1_INFO_HEADER_LENGTH);
+
+                bmp.info_header.v4.redMask   = 0x00FF0000;
+                bmp.info_header.v4.greenMask = 0x0000FF00;
+                bmp.info_header.v4.blueMask  = 0x000000FF;
+                bmp.info_header.v4.alphaMask = 0xFF000000;
+                bmp.info_header.v4.CSType = LogicalColorSpace::CALIBRATED_RGB;
+
+                // endpoints
+                bmp.info_header.v4.redX = 0;
+                bmp.info_header.v4.redY = 0;
+                bmp.info_header.v4.redZ = 0;
+                bmp.info_header.v4.greenX = 0;
+                bmp.info_header.v4.greenY = 0;
+                bmp.info_header.v4.greenZ = 0;
+                bmp.info_header.v4.blueX = 0;
+                bmp.info_header.v4.blueY = 0;
+                bmp.info_header.v4.blueZ = 0;
+
+                bmp.info_header.v4.gammaRed = 0;
+                bmp.info_header.v4.gammaGreen = 0;
+                bmp.info_header.v4.gammaBlue = 0;
+
+                [[fallthrough]];
+            case BMPHeaderToUse::V1:
+                WRITE_DEBUG("Build V1 header");
+                info_header_size += V1_INFO_HEADER_LENGTH;
+
+                bmp.info_header.v1.headerSize = info_header_size;
+                bmp.info_header.v1.width = static_cast<int>(width);
+                bmp.info_header.v1.height = static_cast<int>(height);
+                bmp.info_header.v1.bitPlanes = 1;
+                bmp.info_header.v1.bitsPerPixel = depth * 8; // 8 bits per pixel
+                bmp.info_header.v1.compression = 0; // For Win32 systems, this is BI_RGB
+                bmp.info_header.v1.sizeOfBitmap = num_pixels * depth;
+                bmp.info_header.v1.horzResolution = 0; // TODO: Do we need to set this?
+                bmp.info_header.v1.vertResolution = 0; // TODO: Do we need to set this?
+                bmp.info_header.v1.colorsUsed = 0;
+                bmp.info_header.v1.colorImportant = 0;
+        }
 
-#undef WRITE_BMP_VALUE
-}
+        // Now that we know the info header size, add it to the relevant file header
+        //   fields
+        bmp.file_header.fileSize += info_header_size;
+        bmp.file_header.bitmapOffset += info_header_size;
 
-auto HMDT::writeBMP2(const std::filesystem::path& path, unsigned char* data,
-                     uint32_t width, uint32_t height, uint16_t depth,
-                     bool is_greyscale, BMPHeaderToUse hdr_version_to_use,
-                     MonadOptional<ColorTable> color_table) noexcept
-    -> MaybeVoid
-{
-    BitMap2 bmp{};
+        auto res = asMaybe(color_table.andThen([&](ColorTable& color_table)
+            -> MaybeVoid
+        {
+            bmp.info_header.v1.colorsUsed = color_table.num_colors;
 
-    // Make sure we release the grabbed 'data' pointer when we exit, as it is
-    //   not ours to delete
-    RUN_AT_SCOPE_END([&bmp]() {
-        bmp.data.release();
-    });
+            auto res = createColorTable(bmp, std::move(color_table), is_greyscale);
+            RETURN_IF_ERROR(res);
 
-    auto num_pixels = width * height;
+            return STATUS_SUCCESS;
+        })).orElse<std::monostate>([&]() -> MaybeVoid {
+            if(bmp.info_header.v1.bitsPerPixel <= 8) {
+                switch(bmp.info_header.v1.bitsPerPixel) {
+                    case 8:
+                        bmp.info_header.v1.colorsUsed = 256;
+                        break;
+                    case 4:
+                        bmp.info_header.v1.colorsUsed = 16;
+                        break;
+                    case 1:
+                        bmp.info_header.v1.colorsUsed = 2;
+                        break;
+                    default:
+                        WRITE_ERROR("Invalid bitsPerPixel<=8! Must be 1, 4, or 8, not ",
+                                    bmp.info_header.v1.bitsPerPixel);
+                        RETURN_ERROR(STATUS_INVALID_BITS_PER_PIXEL);
+                }
 
-    bmp.file_header.filetype = BM_TYPE;
-    bmp.file_header.fileSize = FILE_HEADER_LENGTH + num_pixels * depth;
-    bmp.file_header.reserved1 = 0;
-    bmp.file_header.reserved2 = 0;
-    bmp.file_header.bitmapOffset = FILE_HEADER_LENGTH;
-
-    auto info_header_size = 0;
-
-    // Fill out the info header based on what version is requested
-    //   Note: we populate it backwards to take advantage of switch-case
-    //   fallthrough
-    switch(hdr_version_to_use) {
-        case BMPHeaderToUse::V5:
-            WRITE_DEBUG("Build V5 header");
-            info_header_size += (V5_INFO_HEADER_LENGTH - V4_INFO_HEADER_LENGTH);
-
-            bmp.info_header.v5.profileData = 0;
-            bmp.info_header.v5.profileSize = 0;
-            bmp.info_header.v5.reserved = 0;
-
-            [[fallthrough]];
-        case BMPHeaderToUse::V4:
-            WRITE_DEBUG("Build V4 header");
-            info_header_size += (V4_INFO_HEADER_LENGTH - V1_INFO_HEADER_LENGTH);
-
-            bmp.info_header.v4.redMask   = 0x00FF0000;
-            bmp.info_header.v4.greenMask = 0x0000FF00;
-            bmp.info_header.v4.blueMask  = 0x000000FF;
-            bmp.info_header.v4.alphaMask = 0xFF000000;
-            bmp.info_header.v4.CSType = LogicalColorSpace::CALIBRATED_RGB;
-
-            // endpoints
-            bmp.info_header.v4.redX = 0;
-            bmp.info_header.v4.redY = 0;
-            bmp.info_header.v4.redZ = 0;
-            bmp.info_header.v4.greenX = 0;
-            bmp.info_header.v4.greenY = 0;
-            bmp.info_header.v4.greenZ = 0;
-            bmp.info_header.v4.blueX = 0;
-            bmp.info_header.v4.blueY = 0;
-            bmp.info_header.v4.blueZ = 0;
-
-            bmp.info_header.v4.gammaRed = 0;
-            bmp.info_header.v4.gammaGreen = 0;
-            bmp.info_header.v4.gammaBlue = 0;
-
-            [[fallthrough]];
-        case BMPHeaderToUse::V1:
-            WRITE_DEBUG("Build V1 header");
-            info_header_size += V1_INFO_HEADER_LENGTH;
-
-            bmp.info_header.v1.headerSize = info_header_size;
-            bmp.info_header.v1.width = static_cast<int>(width);
-            bmp.info_header.v1.height = static_cast<int>(height);
-            bmp.info_header.v1.bitPlanes = 1;
-            bmp.info_header.v1.bitsPerPixel = depth * 8; // 8 bits per pixel
-            bmp.info_header.v1.compression = 0; // For Win32 systems, this is BI_RGB
-            bmp.info_header.v1.sizeOfBitmap = num_pixels * depth;
-            bmp.info_header.v1.horzResolution = 0; // TODO: Do we need to set this?
-            bmp.info_header.v1.vertResolution = 0; // TODO: Do we need to set this?
-            bmp.info_header.v1.colorsUsed = 0;
-            bmp.info_header.v1.colorImportant = 0;
-    }
+                // colorsImportant will always match colorsUsed
+                bmp.info_header.v1.colorImportant = bmp.info_header.v1.colorsUsed;
 
-    // Now that we know the info header size, add it to the relevant file header
-    //   fields
-    bmp.file_header.fileSize += info_header_size;
-    bmp.file_header.bitmapOffset += info_header_size;
+                WRITE_DEBUG("Generating color table with ", bmp.info_header.v1.colorsUsed,
+                            " values.");
 
-    auto res = asMaybe(color_table.andThen([&](ColorTable& color_table)
-        -> MaybeVoid
-    {
-        bmp.info_header.v1.colorsUsed = color_table.num_colors;
+                auto res = createColorTable(bmp, is_greyscale);
+                RETURN_IF_ERROR(res);
+            }
 
-        auto res = createColorTable(bmp, std::move(color_table), is_greyscale);
+            return STATUS_SUCCESS;
+        });
         RETURN_IF_ERROR(res);
 
+
         return STATUS_SUCCESS;
-    })).orElse<std::monostate>([&]() -> MaybeVoid {
-        if(bmp.info_header.v1.bitsPerPixel <= 8) {
-            switch(bmp.info_header.v1.bitsPerPixel) {
-                case 8:
-                    bmp.info_header.v1.colorsUsed = 256;
-                    break;
-                case 4:
-                    bmp.info_header.v1.colorsUsed = 16;
-                    break;
-                case 1:
-                    bmp.info_header.v1.colorsUsed = 2;
-                    break;
-                default:
-                    WRITE_ERROR("Invalid bitsPerPixel<=8! Must be 1, 4, or 8, not ",
-                                bmp.info_header.v1.bitsPerPixel);
-                    RETURN_ERROR(STATUS_INVALID_BITS_PER_PIXEL);
-            }
+    }
+}
 
-            // colorsImportant will always match colorsUsed
-            bmp.info_header.v1.colorImportant = bmp.info_header.v1.colorsUsed;
+auto HMDT::writeBMP(const std::filesystem::path& path, const BitMap2& bmp) noexcept
+    -> MaybeVoid
+{
+    RETURN_ERROR_IF(bmp.data == nullptr, STATUS_PARAM_CANNOT_BE_NULL);
 
-            WRITE_DEBUG("Generating color table with ", bmp.info_header.v1.colorsUsed,
-                        " values.");
+    const std::size_t depth = bmp.info_header.v1.bitsPerPixel / 8;
+    const std::size_t pitch = bmp.info_header.v1.width * depth;
+    const unsigned char* data = bmp.data.get();
 
-            auto res = createColorTable(bmp, is_greyscale);
-            RETURN_IF_ERROR(res);
-        }
+    return writeBMPStream(path, bmp,
+        [data, pitch](uint32_t y, unsigned char* row) -> MaybeVoid {
+            std::memcpy(row, data + y * pitch, pitch);
+            return STATUS_SUCCESS;
+        });
+}
 
-        return STATUS_SUCCESS;
-    });
-    RETURN_IF_ERROR(res);
+auto HMDT::writeBMP2(const std::filesystem::path& path, unsigned char* data,
+                     uint32_t width, uint32_t height, uint16_t depth,
+                     bool is_greyscale, BMPHeaderToUse hdr_version_to_use,
+                     MonadOptional<ColorTable> color_table) noexcept
+    -> MaybeVoid
+{
+    RETURN_ERROR_IF(data == nullptr, STATUS_PARAM_CANNOT_BE_NULL);
+
+    const std::size_t pitch = static_cast<std::size_t>(width) * depth;
+
+    return writeBMPRows(path, width, height, depth,
+        [data, pitch](uint32_t y, unsigned char* row) -> MaybeVoid {
+            std::memcpy(row, data + y * pitch, pitch);
+            return STATUS_SUCCESS;
+        }, is_greyscale, hdr_version_to_use, std::move(color_table));
+}
 
-    bmp.data.reset(data);
+/**
+ * @brief Writes a bitmap file, generating each row just before it is written
+ * @details Only a single row of the image is ever held in memory, so this is
+ *          meant for images which can be cheaply generated rather than those
+ *          which already exist in memory.
+ *
+ * @param path The path to write to
+ * @param width The width of the bitmap
+ * @param height The height of the bitmap
+ * @param depth The number of bytes in each pixel
+ * @param generator Fills in each row of the image
+ * @param is_greyscale Whether a generated color table should be greyscale
+ * @param hdr_version_to_use Which info header to write
+ * @param color_table The color table to use, or std::nullopt to generate one
+ *                    if the depth requires it
+ *
+ * @return STATUS_SUCCESS on success, or the first error encountered.
+ */
+auto HMDT::writeBMPRows(const std::filesystem::path& path,
+                        uint32_t width, uint32_t height, uint16_t depth,
+                        const BMPRowGenerator& generator, bool is_greyscale,
+                        BMPHeaderToUse hdr_version_to_use,
+                        MonadOptional<ColorTable> color_table) noexcept
+    -> MaybeVoid
+{
+    BitMap2 bmp{};
 
-    res = writeBMP(path, bmp);
+    auto res = buildBMPHeaders(bmp, width, height, depth, is_greyscale,
+                               hdr_version_to_use, std::move(color_table));
     RETURN_IF_ERROR(res);
 
-    return STATUS_SUCCESS;
+    return writeBMPStream(path, bmp, generator);
+}
+
+/**
+ * @brief Writes a bitmap file where every pixel is the same value
+ *
+ * @param path The path to write to
+ * @param width The width of the bitmap
+ * @param height The height of the bitmap
+ * @param pixel The value of every pixel. Its size is the number of bytes in
+ *              each pixel, and 24-bit pixels are in RGB order.
+ * @param hdr_version_to_use Which info header to write
+ *
+ * @return STATUS_SUCCESS on success, or the first error encountered.
+ */
+auto HMDT::writeBMPFill(const std::filesystem::path& path,
+                        uint32_t width, uint32_t height,
+                        const std::vector<unsigned char>& pixel,
+                        BMPHeaderToUse hdr_version_to_use) noexcept
+    -> MaybeVoid
+{
+    RETURN_ERROR_IF(pixel.empty(), STATUS_INVALID_BITS_PER_PIXEL);
+
+    const auto depth = static_cast<uint16_t>(pixel.size());
+
+    return writeBMPRows(path, width, height, depth,
+        [&pixel, width](uint32_t, unsigned char* row) -> MaybeVoid {
+            for(uint32_t x = 0; x < width; ++x) {
+                std::memcpy(row + x * pixel.size(), pixel.data(), pixel.size());
+            }
+            return STATUS_SUCCESS;
+        }, false /* is_greyscale */, hdr_version_to_use);
 }
 
 auto HMDT::createColorTable(BitMap2& bmp, bool is_greyscale) -> MaybeVoid {
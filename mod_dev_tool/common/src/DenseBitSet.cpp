@@ -0,0 +1,123 @@
+
+#include "DenseBitSet.h"
+
+#include <algorithm>
+
+/**
+ * @brief Constructs an empty set with room for some number of indices
+ *
+ * @param size How many indices to make room for
+ */
+HMDT::DenseBitSet::DenseBitSet(std::size_t size) {
+    reserve(size);
+}
+
+/**
+ * @brief Adds an index to the set
+ *
+ * @param index The index to add
+ *
+ * @return True if the index was added, false if it was already in the set
+ */
+bool HMDT::DenseBitSet::set(Index index) {
+    auto w = index / WORD_BITS;
+    if(w >= m_words.size()) {
+        m_words.resize(w + 1, 0);
+    }
+
+    auto mask = Word{1} << (index % WORD_BITS);
+    if(m_words[w] & mask) {
+        return false;
+    }
+
+    m_words[w] |= mask;
+    ++m_count;
+    m_indices_valid = false;
+
+    return true;
+}
+
+/**
+ * @brief Removes an index from the set
+ *
+ * @param index The index to remove
+ *
+ * @return True if the index was removed, false if it was not in the set
+ */
+bool HMDT::DenseBitSet::reset(Index index) {
+    if(!test(index)) {
+        return false;
+    }
+
+    m_words[index / WORD_BITS] &= ~(Word{1} << (index % WORD_BITS));
+    --m_count;
+    m_indices_valid = false;
+
+    return true;
+}
+
+/**
+ * @brief Checks if an index is in the set
+ */
+bool HMDT::DenseBitSet::test(Index index) const noexcept {
+    auto w = index / WORD_BITS;
+
+    return w < m_words.size() && (m_words[w] & (Word{1} << (index % WORD_BITS)));
+}
+
+/**
+ * @brief Removes every index from the set, keeping the allocated space
+ */
+void HMDT::DenseBitSet::clear() noexcept {
+    std::fill(m_words.begin(), m_words.end(), 0);
+    m_count = 0;
+    m_indices.clear();
+    m_indices_valid = true;
+}
+
+/**
+ * @brief Makes room for some number of indices, so that setting any index
+ *        below it will not allocate.
+ *
+ * @param size How many indices to make room for
+ */
+void HMDT::DenseBitSet::reserve(std::size_t size) {
+    auto words = (size + WORD_BITS - 1) / WORD_BITS;
+    if(words > m_words.size()) {
+        m_words.resize(words, 0);
+    }
+}
+
+std::size_t HMDT::DenseBitSet::count() const noexcept {
+    return m_count;
+}
+
+bool HMDT::DenseBitSet::empty() const noexcept {
+    return m_count == 0;
+}
+
+/**
+ * @brief Gets how many indices can be stored without allocating
+ */
+std::size_t HMDT::DenseBitSet::capacity() const noexcept {
+    return m_words.size() * WORD_BITS;
+}
+
+/**
+ * @brief Gets every index in the set, in ascending order
+ *
+ * @return A reference to the cached list of indices, which remains valid
+ *         until the set is next changed.
+ */
+auto HMDT::DenseBitSet::getIndices() const -> const std::vector<Index>& {
+    if(!m_indices_valid) {
+        m_indices.clear();
+        m_indices.reserve(m_count);
+        forEach([this](Index index) { m_indices.push_back(index); });
+
+        m_indices_valid = true;
+    }
+
+    return m_indices;
+}
+
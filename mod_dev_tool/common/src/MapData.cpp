@@ -1,5 +1,8 @@
 #include "MapData.h"
 
+#include <memory>
+#include <type_traits>
+
 #include "Util.h"
 
 HMDT::MapData::MapData():
@@ -18,18 +21,25 @@ HMDT::MapData::MapData():
 {
 }
 
+/**
+ * @brief Creates a map of the given size. No layer is allocated until it is
+ *        first asked for.
+ *
+ * @param width The width of the map
+ * @param height The height of the map
+ */
 HMDT::MapData::MapData(uint32_t width, uint32_t height):
     m_width(width),
     m_height(height),
-    m_input(new uint8_t[getInputSize()]{ 0 }),
-    m_provinces(new UUID[getProvincesSize()]{ EMPTY_UUID }),
-    m_province_colors(new uint8_t[getProvinceColorsSize()]{ 0 }),
-    m_province_outlines(new uint8_t[getProvinceOutlinesSize()]{ 0 }),
-    m_cities(new uint8_t[getCitiesSize()]{ 0 }),
-    m_label_matrix(new uint32_t[getMatrixSize()]{ 0 }),
-    m_state_id_matrix(new uint32_t[getMatrixSize()]{ 0 }),
-    m_heightmap(new uint8_t[getHeightMapSize()]{ 0 }),
-    m_rivers(new uint8_t[getRiversSize()]{ 0 }),
+    m_input(nullptr),
+    m_provinces(nullptr),
+    m_province_colors(nullptr),
+    m_province_outlines(nullptr),
+    m_cities(nullptr),
+    m_label_matrix(nullptr),
+    m_state_id_matrix(nullptr),
+    m_heightmap(nullptr),
+    m_rivers(nullptr),
     m_closed(false),
     m_state_id_matrix_updated_tag(0)
 {
@@ -38,18 +48,94 @@ HMDT::MapData::MapData(uint32_t width, uint32_t height):
 HMDT::MapData::MapData(const MapData* other):
     m_width(other->m_width),
     m_height(other->m_height),
-    m_input(other->m_input),
-    m_provinces(other->m_provinces),
-    m_province_colors(other->m_province_colors),
-    m_province_outlines(other->m_province_outlines),
-    m_cities(other->m_cities),
-    m_label_matrix(other->m_label_matrix),
-    m_state_id_matrix(other->m_state_id_matrix),
-    m_heightmap(other->m_heightmap),
-    m_rivers(other->m_rivers),
     m_closed(other->m_closed),
     m_state_id_matrix_updated_tag(other->m_state_id_matrix_updated_tag)
 {
+    std::lock_guard<std::mutex> lock(other->m_layers_mutex);
+
+    m_input = other->m_input;
+    m_provinces = other->m_provinces;
+    m_province_colors = other->m_province_colors;
+    m_province_outlines = other->m_province_outlines;
+    m_cities = other->m_cities;
+    m_label_matrix = other->m_label_matrix;
+    m_state_id_matrix = other->m_state_id_matrix;
+    m_heightmap = other->m_heightmap;
+    m_rivers = other->m_rivers;
+}
+
+HMDT::MapData::MapData(MapData&& other):
+    m_width(other.m_width),
+    m_height(other.m_height),
+    m_closed(other.m_closed),
+    m_state_id_matrix_updated_tag(other.m_state_id_matrix_updated_tag)
+{
+    std::lock_guard<std::mutex> lock(other.m_layers_mutex);
+
+    m_input = std::move(other.m_input);
+    m_provinces = std::move(other.m_provinces);
+    m_province_colors = std::move(other.m_province_colors);
+    m_province_outlines = std::move(other.m_province_outlines);
+    m_cities = std::move(other.m_cities);
+    m_label_matrix = std::move(other.m_label_matrix);
+    m_state_id_matrix = std::move(other.m_state_id_matrix);
+    m_heightmap = std::move(other.m_heightmap);
+    m_rivers = std::move(other.m_rivers);
+    m_shared_provinces = std::move(other.m_shared_provinces);
+}
+
+/**
+ * @brief Gets a layer, allocating it first if it has not been yet.
+ *
+ * @tparam T The type of each element in the layer
+ * @param layer The layer to get
+ * @param size How many elements the layer holds
+ * @param fill The value to give to the first element of a newly allocated
+ *             layer. Every other element is value-initialized.
+ *
+ * @return The layer, or nullptr if the map is empty.
+ */
+template<typename T>
+auto HMDT::MapData::materialize(std::shared_ptr<T[]>& layer, uint32_t size,
+                                const T& fill) const
+    -> std::shared_ptr<T[]>
+{
+    std::lock_guard<std::mutex> lock(m_layers_mutex);
+
+    if(layer == nullptr && size != 0) {
+        layer.reset(new T[size]{ fill });
+    }
+
+    return layer;
+}
+
+/**
+ * @brief Calls func(layer, size) with the given layer and how many elements it
+ *        holds.
+ */
+template<typename F>
+decltype(auto) HMDT::MapData::visitLayer(Layer layer, F&& func) const {
+    switch(layer) {
+        case Layer::INPUT:
+            return func(m_input, getInputSize());
+        case Layer::PROVINCES:
+            return func(m_provinces, getProvincesSize());
+        case Layer::PROVINCE_COLORS:
+            return func(m_province_colors, getProvinceColorsSize());
+        case Layer::PROVINCE_OUTLINES:
+            return func(m_province_outlines, getProvinceOutlinesSize());
+        case Layer::CITIES:
+            return func(m_cities, getCitiesSize());
+        case Layer::LABEL_MATRIX:
+            return func(m_label_matrix, getMatrixSize());
+        case Layer::STATE_ID_MATRIX:
+            return func(m_state_id_matrix, getMatrixSize());
+        case Layer::HEIGHTMAP:
+            return func(m_heightmap, getHeightMapSize());
+        case Layer::RIVERS:
+        default:
+            return func(m_rivers, getRiversSize());
+    }
 }
 
 void HMDT::MapData::close() {
@@ -104,20 +190,78 @@ bool HMDT::MapData::isClosed() const {
     return m_closed;
 }
 
+/**
+ * @brief Checks if a layer has been allocated
+ */
+bool HMDT::MapData::isResident(Layer layer) const {
+    std::lock_guard<std::mutex> lock(m_layers_mutex);
+
+    return visitLayer(layer, [](const auto& data, uint32_t) {
+        return data != nullptr;
+    });
+}
+
+/**
+ * @brief Gives back the memory held by a layer.
+ * @details Anything still holding onto the layer keeps it alive until it lets
+ *          go. The next time the layer is asked for, it is allocated again
+ *          with nothing in it.
+ *
+ * @param layer The layer to release
+ */
+void HMDT::MapData::release(Layer layer) {
+    std::lock_guard<std::mutex> lock(m_layers_mutex);
+
+    visitLayer(layer, [](auto& data, uint32_t) {
+        data.reset();
+    });
+
+    // Anything drawing the state ID matrix must know that it is now empty
+    if(layer == Layer::STATE_ID_MATRIX) {
+        ++m_state_id_matrix_updated_tag;
+    }
+}
+
+/**
+ * @brief Gets how many bytes every allocated layer takes up together
+ */
+std::uint64_t HMDT::MapData::getResidentSize() const {
+    std::lock_guard<std::mutex> lock(m_layers_mutex);
+
+    std::uint64_t size = 0;
+    for(auto layer : { Layer::INPUT, Layer::PROVINCES, Layer::PROVINCE_COLORS,
+                       Layer::PROVINCE_OUTLINES, Layer::CITIES,
+                       Layer::LABEL_MATRIX, Layer::STATE_ID_MATRIX,
+                       Layer::HEIGHTMAP, Layer::RIVERS })
+    {
+        size += visitLayer(layer, [](const auto& data, uint32_t count) {
+            using ElementType = typename std::remove_reference_t<decltype(data)>::element_type;
+
+            return data != nullptr ? count * static_cast<std::uint64_t>(sizeof(ElementType)) : 0;
+        });
+    }
+
+    return size;
+}
+
 void HMDT::MapData::setLabelMatrix(uint32_t label_matrix[]) {
+    std::lock_guard<std::mutex> lock(m_layers_mutex);
     m_label_matrix.reset(label_matrix);
 }
 
 void HMDT::MapData::setLabelMatrix(InternalMapType32 label_matrix) {
+    std::lock_guard<std::mutex> lock(m_layers_mutex);
     m_label_matrix = label_matrix;
 }
 
 void HMDT::MapData::setStateIDMatrix(uint32_t state_id_matrix[]) {
+    std::lock_guard<std::mutex> lock(m_layers_mutex);
     m_state_id_matrix.reset(state_id_matrix);
     ++m_state_id_matrix_updated_tag;
 }
 
 void HMDT::MapData::setStateIDMatrix(InternalMapType32 state_id_matrix) {
+    std::lock_guard<std::mutex> lock(m_layers_mutex);
     m_state_id_matrix = state_id_matrix;
     ++m_state_id_matrix_updated_tag;
 }
@@ -125,78 +269,142 @@ void HMDT::MapData::setStateIDMatrix(InternalMapType32 state_id_matrix) {
 ///////////////////////////////////////////////////////////////////////////////
 
 auto HMDT::MapData::getInput() -> MapType {
-    return m_input;
+    return materialize(m_input, getInputSize(), uint8_t{0});
 }
 
 auto HMDT::MapData::getInput() const -> ConstMapType {
-    return m_input;
+    return materialize(m_input, getInputSize(), uint8_t{0});
 }
 
 auto HMDT::MapData::getProvinces() -> MapTypeUUID {
-    return m_provinces;
+    materialize(m_provinces, getProvincesSize(), EMPTY_UUID);
+    detachProvinces();
+
+    return materialize(m_provinces, getProvincesSize(), EMPTY_UUID);
 }
 
 auto HMDT::MapData::getProvinces() const -> ConstMapTypeUUID {
-    return m_provinces;
+    return materialize(m_provinces, getProvincesSize(), EMPTY_UUID);
+}
+
+/**
+ * @brief Gets a read-only copy of the provinces which will never change.
+ * @details No copy is actually made here. Instead, the next time the
+ *          provinces are requested for writing while the returned pointer is
+ *          still alive, MapData makes a copy for itself and leaves the
+ *          returned pointer alone.
+ *
+ * @return The provinces, as they are right now.
+ */
+auto HMDT::MapData::shareProvinces() -> std::shared_ptr<const UUID[]> {
+    materialize(m_provinces, getProvincesSize(), EMPTY_UUID);
+
+    std::lock_guard<std::mutex> lock(m_layers_mutex);
+
+    auto shared = m_shared_provinces.lock();
+    if(shared == nullptr || shared->get() != m_provinces.get()) {
+        shared = std::make_shared<InternalMapTypeUUID>(m_provinces);
+        m_shared_provinces = shared;
+    }
+
+    // Share ownership with the holder rather than the provinces themselves,
+    //   so that we can tell whether anything returned from here is alive
+    return std::shared_ptr<const UUID[]>(shared, shared->get());
+}
+
+/**
+ * @brief Makes sure that nothing returned by shareProvinces() can see any
+ *        changes made to the provinces, by copying them if needed.
+ */
+void HMDT::MapData::detachProvinces() {
+    std::lock_guard<std::mutex> lock(m_layers_mutex);
+
+    auto shared = m_shared_provinces.lock();
+    if(shared == nullptr || shared->get() != m_provinces.get()) {
+        return;
+    }
+
+    const auto size = getProvincesSize();
+
+    // UUIDs generate a new value when default constructed, so copy them into
+    //   uninitialized memory instead
+    std::allocator<UUID> allocator;
+    UUID* copy = allocator.allocate(size);
+    std::uninitialized_copy(m_provinces.get(), m_provinces.get() + size, copy);
+
+    m_provinces = InternalMapTypeUUID(copy, [size](UUID* data) {
+        std::destroy(data, data + size);
+        std::allocator<UUID>().deallocate(data, size);
+    });
+    m_shared_provinces.reset();
 }
 
 auto HMDT::MapData::getProvinceColors() -> MapType {
-    return m_province_colors;
+    return materialize(m_province_colors, getProvinceColorsSize(), uint8_t{0});
 }
 
 auto HMDT::MapData::getProvinceColors() const -> ConstMapType {
-    return m_province_colors;
+    return materialize(m_province_colors, getProvinceColorsSize(), uint8_t{0});
 }
 
 auto HMDT::MapData::getProvinceOutlines() -> MapType {
-    return m_province_outlines;
+    return materialize(m_province_outlines, getProvinceOutlinesSize(), uint8_t{0});
 }
 
 auto HMDT::MapData::getProvinceOutlines() const -> ConstMapType {
-    return m_province_outlines;
+    return materialize(m_province_outlines, getProvinceOutlinesSize(), uint8_t{0});
 }
 
 auto HMDT::MapData::getCities() -> MapType {
-    return m_cities;
+    return materialize(m_cities, getCitiesSize(), uint8_t{0});
 }
 
 auto HMDT::MapData::getCities() const -> ConstMapType {
-    return m_cities;
+    return materialize(m_cities, getCitiesSize(), uint8_t{0});
 }
 
 auto HMDT::MapData::getLabelMatrix() -> MapType32 {
-    return m_label_matrix;
+    return materialize(m_label_matrix, getMatrixSize(), uint32_t{0});
 }
 
 auto HMDT::MapData::getLabelMatrix() const -> ConstMapType32 {
-    return m_label_matrix;
+    return materialize(m_label_matrix, getMatrixSize(), uint32_t{0});
 }
 
 auto HMDT::MapData::getStateIDMatrix() -> MapType32 {
-    return m_state_id_matrix;
+    return materialize(m_state_id_matrix, getMatrixSize(), uint32_t{0});
 }
 
 auto HMDT::MapData::getStateIDMatrix() const -> ConstMapType32 {
-    return m_state_id_matrix;
+    return materialize(m_state_id_matrix, getMatrixSize(), uint32_t{0});
 }
 
 uint32_t HMDT::MapData::getStateIDMatrixUpdatedTag() const {
     return m_state_id_matrix_updated_tag;
 }
 
+/**
+ * @brief Lets anything drawing the state ID matrix know that it has been
+ *        written to in place, and so must be re-read.
+ */
+void HMDT::MapData::markStateIDMatrixUpdated() {
+    std::lock_guard<std::mutex> lock(m_layers_mutex);
+    ++m_state_id_matrix_updated_tag;
+}
+
 HMDT::MapData::MapType HMDT::MapData::getHeightMap() {
-    return m_heightmap;
+    return materialize(m_heightmap, getHeightMapSize(), uint8_t{0});
 }
 
 HMDT::MapData::ConstMapType HMDT::MapData::getHeightMap() const {
-    return m_heightmap;
+    return materialize(m_heightmap, getHeightMapSize(), uint8_t{0});
 }
 
 HMDT::MapData::MapType HMDT::MapData::getRivers() {
-    return m_rivers;
+    return materialize(m_rivers, getRiversSize(), uint8_t{0});
 }
 
 HMDT::MapData::ConstMapType HMDT::MapData::getRivers() const {
-    return m_rivers;
+    return materialize(m_rivers, getRiversSize(), uint8_t{0});
 }
 
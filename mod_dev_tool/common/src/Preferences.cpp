@@ -143,10 +143,14 @@ void HMDT::Preferences::defineEnvVar(const std::string& var_name,
                                      ValueVariant value)
 {
     m_env_vars[var_name] = value;
+
+    markChanged();
 }
 
 void HMDT::Preferences::setDefaultValues(const SectionMap& default_sections) {
     m_default_sections = default_sections;
+
+    markChanged();
 }
 
 /**
@@ -196,6 +200,9 @@ bool HMDT::Preferences::setPreferenceValue(const std::string& value_path,
 
             m_dirty = true;
 
+            markChanged();
+            notifySubscribers(value_path);
+
             return true;
         }).orElse(false);
 }
@@ -240,6 +247,105 @@ auto HMDT::Preferences::setCallbackOnPreferenceChange(const std::string& value_p
     }
 }
 
+/**
+ * @brief Gets the current version of the preferences.
+ * @details The version changes whenever any value, default value, or $ENVVAR
+ *          changes, which lets a Handle know when its cached value may be out
+ *          of date.
+ */
+auto HMDT::Preferences::getVersion() const noexcept -> Version {
+    return m_version.load(std::memory_order_acquire);
+}
+
+/**
+ * @brief Registers a callback to be called after the value at value_path has
+ *        changed.
+ * @details Unlike setCallbackOnPreferenceChange(), the callback cannot stop
+ *          the value from changing, and any number of callbacks may be
+ *          registered for the same value. Callbacks are only ever called by
+ *          whatever changed the value, never when a value is read.
+ *
+ * @param value_path The path to the config value. Given in the format of
+ *                   "{Section}.{Group}.{Config}"
+ * @param callback The callback to call with the new value
+ *
+ * @return An ID which can be passed to unsubscribe(), or STATUS_VALUE_NOT_FOUND
+ *         if value_path does not exist.
+ */
+auto HMDT::Preferences::subscribe(const std::string& value_path,
+                                  OnPreferenceChangedCallback callback) noexcept
+    -> Maybe<SubscriptionID>
+{
+    if(!getValueVariantForPath(value_path).has_value()) {
+        RETURN_ERROR(STATUS_VALUE_NOT_FOUND);
+    }
+
+    auto id = m_next_subscription_id++;
+    m_subscriptions[value_path][id] = callback;
+
+    return id;
+}
+
+/**
+ * @brief Removes a callback registered with subscribe()
+ *
+ * @param id The ID returned by subscribe()
+ *
+ * @return True if the callback was removed, false if there was no callback
+ *         with the given ID.
+ */
+bool HMDT::Preferences::unsubscribe(SubscriptionID id) noexcept {
+    for(auto it = m_subscriptions.begin(); it != m_subscriptions.end(); ++it) {
+        if(it->second.erase(id) != 0) {
+            if(it->second.empty()) {
+                m_subscriptions.erase(it);
+            }
+
+            return true;
+        }
+    }
+
+    return false;
+}
+
+/**
+ * @brief Calls every callback subscribed to value_path with its current value
+ *
+ * @param value_path The path to the config value that changed
+ */
+void HMDT::Preferences::notifySubscribers(const std::string& value_path) {
+    auto it = m_subscriptions.find(value_path);
+    if(it == m_subscriptions.end()) {
+        return;
+    }
+
+    // Copy the callbacks out first, as they are allowed to subscribe or
+    //   unsubscribe while being called
+    std::vector<OnPreferenceChangedCallback> callbacks;
+    callbacks.reserve(it->second.size());
+    for(auto&& [id, callback] : it->second) {
+        callbacks.push_back(callback);
+    }
+
+    getValueVariantForPath(value_path)
+        .andThen([&callbacks](Ref<ValueVariant> ref_val)
+        {
+            const ValueVariant value = ref_val.get();
+
+            for(auto&& callback : callbacks) {
+                callback(value);
+            }
+        });
+}
+
+/**
+ * @brief Marks that a value may have changed, so that every Handle looks its
+ *        value up again.
+ */
+void HMDT::Preferences::markChanged() noexcept {
+    m_version.fetch_add(1, std::memory_order_acq_rel);
+}
+
 /**
  * @brief Gets the Section named 'section_name'
  *
@@ -562,6 +668,9 @@ void HMDT::Preferences::initialize() noexcept {
                                     m_on_pref_change_callbacks.at(path)(def_value, value);
                                 });
                         }
+
+                        markChanged();
+                        notifySubscribers(path);
                     }
                 }
             }
@@ -607,6 +716,20 @@ void HMDT::Preferences::resetToDefaults() {
 
     m_sections = m_default_sections;
     m_dirty = false;
+
+    markChanged();
+
+    // Every value may have changed, so let every subscriber know. The paths
+    //   are copied out first, as callbacks may subscribe or unsubscribe.
+    std::vector<std::string> subscribed_paths;
+    subscribed_paths.reserve(m_subscriptions.size());
+    for(auto&& [pref_path, subscriptions] : m_subscriptions) {
+        subscribed_paths.push_back(pref_path);
+    }
+
+    for(auto&& pref_path : subscribed_paths) {
+        notifySubscribers(pref_path);
+    }
 }
 
 /**
@@ -856,6 +979,9 @@ HMDT::Preferences::Preferences():
     m_sections(),
     m_default_sections(),
     m_env_vars(),
+    m_subscriptions(),
+    m_next_subscription_id(1),
+    m_version(1),
     m_initialized(false),
     m_dirty(false)
 { }
@@ -875,8 +1001,11 @@ void HMDT::Preferences::_reset() noexcept {
     m_sections.clear();
     m_default_sections.clear();
     m_env_vars.clear();
+    m_subscriptions.clear();
     m_initialized = false;
     m_dirty = false;
+
+    markChanged();
 }
 
 bool HMDT::operator==(const Preferences::Config& left,
@@ -0,0 +1,243 @@
+
+#include "SelectionMask.h"
+
+#include <algorithm>
+
+/**
+ * @brief Constructs a table where nothing is selected
+ *
+ * @param size How many labels the table should hold, including label 0
+ */
+HMDT::SelectionMask::SelectionMask(std::size_t size) {
+    resize(size);
+}
+
+/**
+ * @brief Changes how many labels the table holds, keeping any selected
+ *        labels which still fit.
+ *
+ * @param size How many labels the table should hold, including label 0
+ */
+void HMDT::SelectionMask::resize(std::size_t size) {
+    auto old_height = getHeight();
+
+    // Forget about anything which will no longer fit
+    m_selected.erase(std::remove_if(m_selected.begin(), m_selected.end(),
+                                    [this, size](Label label) {
+                                        if(label < size) return false;
+
+                                        m_values[label] = NOT_SELECTED;
+                                        return true;
+                                    }),
+                     m_selected.end());
+
+    m_size = size;
+
+    // Always keep at least one row, so that there is always something to
+    //   upload
+    auto rows = std::max<std::size_t>((size + ROW_WIDTH - 1) / ROW_WIDTH, 1);
+    m_values.resize(rows * ROW_WIDTH, NOT_SELECTED);
+
+    if(getHeight() != old_height) {
+        m_is_resized = true;
+    }
+}
+
+/**
+ * @brief Marks a single label as selected or not
+ *
+ * @param label The label to change. The table is grown if it doesn't fit.
+ * @param selected Whether the label should be selected
+ *
+ * @return True if the label changed, false otherwise
+ */
+bool HMDT::SelectionMask::set(Label label, bool selected) {
+    if(label == 0) {
+        return false;
+    }
+
+    if(label >= m_size) {
+        if(!selected) return false;
+
+        resize(label + 1);
+    }
+
+    auto value = selected ? SELECTED : NOT_SELECTED;
+    if(m_values[label] == value) {
+        return false;
+    }
+
+    m_values[label] = value;
+    markDirty(label);
+
+    if(selected) {
+        m_selected.push_back(label);
+    } else {
+        m_selected.erase(std::find(m_selected.begin(), m_selected.end(), label));
+    }
+
+    return true;
+}
+
+/**
+ * @brief Makes exactly the given labels selected
+ * @details Only labels whose selection actually changes are touched, so the
+ *          rows which need to be uploaded again are only the ones around
+ *          labels which were added or removed.
+ *
+ * @param labels Every label which should be selected
+ */
+void HMDT::SelectionMask::assign(const std::vector<Label>& labels) {
+    // Grow first, so that growing doesn't happen part of the way through
+    if(auto it = std::max_element(labels.begin(), labels.end());
+            it != labels.end() && *it >= m_size)
+    {
+        resize(*it + 1);
+    }
+
+    // Mark every label which should stay selected, so that we know which ones
+    //   to deselect. A value of 1 is used, since it is never a valid state.
+    constexpr std::uint8_t KEEP = 0x01;
+    for(auto label : labels) {
+        if(label != 0 && m_values[label] == SELECTED) {
+            m_values[label] = KEEP;
+        }
+    }
+
+    std::vector<Label> selected;
+    selected.reserve(labels.size());
+
+    for(auto label : m_selected) {
+        if(m_values[label] == KEEP) {
+            m_values[label] = SELECTED;
+            selected.push_back(label);
+        } else {
+            m_values[label] = NOT_SELECTED;
+            markDirty(label);
+        }
+    }
+
+    for(auto label : labels) {
+        if(label != 0 && m_values[label] == NOT_SELECTED) {
+            m_values[label] = SELECTED;
+            markDirty(label);
+            selected.push_back(label);
+        }
+    }
+
+    m_selected = std::move(selected);
+}
+
+/**
+ * @brief Deselects every label
+ */
+void HMDT::SelectionMask::clear() {
+    for(auto label : m_selected) {
+        m_values[label] = NOT_SELECTED;
+        markDirty(label);
+    }
+
+    m_selected.clear();
+}
+
+/**
+ * @brief Checks if a label is selected
+ */
+bool HMDT::SelectionMask::test(Label label) const noexcept {
+    return label < m_size && m_values[label] == SELECTED;
+}
+
+/**
+ * @brief Gets how many labels the table holds, including label 0
+ */
+std::size_t HMDT::SelectionMask::size() const noexcept {
+    return m_size;
+}
+
+/**
+ * @brief Gets how many labels are selected
+ */
+std::size_t HMDT::SelectionMask::count() const noexcept {
+    return m_selected.size();
+}
+
+/**
+ * @brief Gets the width of the table when uploaded as a texture
+ */
+std::uint32_t HMDT::SelectionMask::getWidth() const noexcept {
+    return ROW_WIDTH;
+}
+
+/**
+ * @brief Gets the height of the table when uploaded as a texture
+ */
+std::uint32_t HMDT::SelectionMask::getHeight() const noexcept {
+    return static_cast<std::uint32_t>(m_values.size() / ROW_WIDTH);
+}
+
+/**
+ * @brief Gets the whole table, getWidth() * getHeight() bytes long
+ */
+const std::uint8_t* HMDT::SelectionMask::getData() const noexcept {
+    return m_values.data();
+}
+
+/**
+ * @brief Gets a single row of the table, getWidth() bytes long
+ */
+const std::uint8_t* HMDT::SelectionMask::getRow(std::uint32_t row) const noexcept
+{
+    return m_values.data() + static_cast<std::size_t>(row) * ROW_WIDTH;
+}
+
+/**
+ * @brief Gets which rows have changed since the last call to markClean()
+ *
+ * @return The first row which changed, and one past the last row which
+ *         changed, or std::nullopt if nothing has changed.
+ */
+auto HMDT::SelectionMask::getDirtyRows() const noexcept
+    -> std::optional<std::pair<std::uint32_t, std::uint32_t>>
+{
+    if(m_is_resized) {
+        return std::make_pair(0U, getHeight());
+    }
+
+    if(m_dirty_first >= m_dirty_last) {
+        return std::nullopt;
+    }
+
+    return std::make_pair(m_dirty_first, m_dirty_last);
+}
+
+/**
+ * @brief Checks if the number of rows has changed since the last call to
+ *        markClean(), meaning that the whole texture must be recreated.
+ */
+bool HMDT::SelectionMask::isResized() const noexcept {
+    return m_is_resized;
+}
+
+/**
+ * @brief Marks every row as uploaded
+ */
+void HMDT::SelectionMask::markClean() noexcept {
+    m_dirty_first = m_dirty_last = 0;
+    m_is_resized = false;
+}
+
+/**
+ * @brief Marks the row holding a label as needing to be uploaded
+ */
+void HMDT::SelectionMask::markDirty(Label label) noexcept {
+    auto row = label / ROW_WIDTH;
+
+    if(m_dirty_first >= m_dirty_last) {
+        m_dirty_first = row;
+        m_dirty_last = row + 1;
+    } else {
+        m_dirty_first = std::min(m_dirty_first, row);
+        m_dirty_last = std::max(m_dirty_last, row + 1);
+    }
+}
+
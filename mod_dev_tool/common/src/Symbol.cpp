@@ -0,0 +1,68 @@
+
+#include "Symbol.h"
+
+#include <mutex>
+
+HMDT::SymbolTable::SymbolTable() {
+    // The empty string is always ID 0, so that a default Symbol never has to
+    //   take the lock
+    m_entries.push_back(Entry{ "", 0 });
+    m_ids.emplace(m_entries.back().name, 0);
+    m_empty = &m_entries.back();
+}
+
+/**
+ * @brief Gets the entry for a name, adding it to the table if needed
+ *
+ * @param name The name to intern
+ *
+ * @return The entry for name
+ */
+auto HMDT::SymbolTable::intern(std::string_view name) -> const Entry& {
+    if(auto* entry = find(name); entry != nullptr) {
+        return *entry;
+    }
+
+    std::unique_lock lock(m_mutex);
+
+    // Someone else may have interned it while we were waiting for the lock
+    if(auto it = m_ids.find(name); it != m_ids.end()) {
+        return m_entries[it->second];
+    }
+
+    auto id = static_cast<ID>(m_entries.size());
+    m_entries.push_back(Entry{ std::string(name), id });
+    m_ids.emplace(m_entries.back().name, id);
+
+    return m_entries.back();
+}
+
+/**
+ * @brief Gets the entry for a name, without adding it to the table
+ *
+ * @param name The name to look for
+ *
+ * @return The entry for name, or nullptr if it has never been interned
+ */
+auto HMDT::SymbolTable::find(std::string_view name) const noexcept
+    -> const Entry*
+{
+    std::shared_lock lock(m_mutex);
+
+    if(auto it = m_ids.find(name); it != m_ids.end()) {
+        return &m_entries[it->second];
+    }
+
+    return nullptr;
+}
+
+auto HMDT::SymbolTable::getEmpty() const noexcept -> const Entry& {
+    // Never moves and is never modified, so there's no need to lock
+    return *m_empty;
+}
+
+std::size_t HMDT::SymbolTable::size() const noexcept {
+    std::shared_lock lock(m_mutex);
+
+    return m_entries.size();
+}
@@ -1,7 +1,9 @@
 
 #include "UniqueColorGenerator.h"
 #include "ColorArray.h"
+#include "UniqueColorIndex.h"
 #include "Logger.h"
+#include "Util.h"
 
 #ifndef NOMINMAX
 # define NOMINMAX
@@ -12,137 +14,333 @@
 
 #include <iostream> // std::cerr
 
-// NOTE: None of this stuff is in a private namespace. Never use it outside of
-//  here. The reason it's not static or in an anonymous namespace is because
-//  unit tests will need to use them directly, but other than that these should
-//  never get used outside of this file
-using UniqueColorPtr = const unsigned char*;
-
-UniqueColorPtr getUniqueColorPtrStart(HMDT::ProvinceType bias) {
-    switch(bias) {
-        case HMDT::ProvinceType::LAND:
-            return HMDT_ALL_LANDS;
-        case HMDT::ProvinceType::SEA:
-            return HMDT_ALL_SEAS;
-        case HMDT::ProvinceType::LAKE:
-            return HMDT_ALL_LAKES;
-        default:
-            return HMDT_ALL_UNKNOWNS;
+namespace {
+    using UniqueColorPtr = const unsigned char*;
+
+    /**
+     * @brief Gets the start of the list of unique colors for the given type
+     */
+    UniqueColorPtr getUniqueColorPtrStart(HMDT::ProvinceType bias) {
+        switch(bias) {
+            case HMDT::ProvinceType::LAND:
+                return HMDT_ALL_LANDS;
+            case HMDT::ProvinceType::SEA:
+                return HMDT_ALL_SEAS;
+            case HMDT::ProvinceType::LAKE:
+                return HMDT_ALL_LAKES;
+            default:
+                return HMDT_ALL_UNKNOWNS;
+        }
+    }
+
+    /**
+     * @brief Gets the size in bytes of the list of unique colors for the given
+     *        type
+     */
+    unsigned int getUniqueColorPtrSize(HMDT::ProvinceType bias) {
+        switch(bias) {
+            case HMDT::ProvinceType::LAND:
+                return HMDT_ALL_LANDS_SIZE;
+            case HMDT::ProvinceType::SEA:
+                return HMDT_ALL_SEAS_SIZE;
+            case HMDT::ProvinceType::LAKE:
+                return HMDT_ALL_LAKES_SIZE;
+            default:
+                return HMDT_ALL_UNKNOWNS_SIZE;
+        }
     }
 }
 
-unsigned int getUniqueColorPtrSize(HMDT::ProvinceType bias) {
-    switch(bias) {
-        case HMDT::ProvinceType::LAND:
-            return HMDT_ALL_LANDS_SIZE;
-        case HMDT::ProvinceType::SEA:
-            return HMDT_ALL_SEAS_SIZE;
-        case HMDT::ProvinceType::LAKE:
-            return HMDT_ALL_LAKES_SIZE;
+////////////////////////////////////////////////////////////////////////////////
+
+/**
+ * @brief Finds which type of province a unique color was generated for.
+ *
+ * @param color The color to look up.
+ *
+ * @return The type of province, or std::nullopt if the color is not one which
+ *         would ever be generated.
+ */
+auto HMDT::findUniqueColorType(const Color& color) noexcept
+    -> MonadOptional<ProvinceType>
+{
+    auto location = UniqueColors::findColor(colorToRGB(color));
+    if(!location) {
+        return std::nullopt;
+    }
+
+    switch(location->table) {
+        case UniqueColors::Table::LANDS:
+            return ProvinceType::LAND;
+        case UniqueColors::Table::SEAS:
+            return ProvinceType::SEA;
+        case UniqueColors::Table::LAKES:
+            return ProvinceType::LAKE;
         default:
-            return HMDT_ALL_UNKNOWNS_SIZE;
+            return ProvinceType::UNKNOWN;
     }
 }
 
+////////////////////////////////////////////////////////////////////////////////
+
+HMDT::UniqueColorAllocator::UniqueColorAllocator():
+    m_mutex(),
+    m_cursors(),
+    m_free_colors(),
+    m_in_use()
+{ }
+
+HMDT::UniqueColorAllocator::UniqueColorAllocator(UniqueColorAllocator&& other):
+    m_mutex(),
+    m_cursors(),
+    m_free_colors(),
+    m_in_use()
+{
+    std::lock_guard<std::mutex> lock(other.m_mutex);
+
+    m_cursors = other.m_cursors;
+    m_free_colors = std::move(other.m_free_colors);
+    m_in_use = std::move(other.m_in_use);
+}
+
+auto HMDT::UniqueColorAllocator::operator=(UniqueColorAllocator&& other)
+    -> UniqueColorAllocator&
+{
+    if(this != &other) {
+        std::scoped_lock lock(m_mutex, other.m_mutex);
+
+        m_cursors = other.m_cursors;
+        m_free_colors = std::move(other.m_free_colors);
+        m_in_use = std::move(other.m_in_use);
+    }
+
+    return *this;
+}
+
 /**
- * @brief Gets a pointer to the current location in the list of unique colors
- *        for the given bias
+ * @brief Allocates a unique color.
+ * @details If there are no more color values for the given type, or the type
+ *          is not recognized, then an UNKNOWN color is given out instead, and
+ *          if there are no UNKNOWN colors left either then BLACK is given out.
  *
- * @param bias The type of province for the unique color
+ * @param type The type of province which the color is for.
  *
- * @return A reference to a pointer into one of the unique color arrays
+ * @return A color which no other caller of this allocator has been given.
  */
-UniqueColorPtr& getUniqueColorPtr(HMDT::ProvinceType bias) {
-    static const unsigned char* land_ptr = HMDT_ALL_LANDS;
-    static const unsigned char* sea_ptr = HMDT_ALL_SEAS;
-    static const unsigned char* lake_ptr = HMDT_ALL_LAKES;
-    static const unsigned char* unknown_ptr = HMDT_ALL_UNKNOWNS;
-
-    switch(bias) {
-        case HMDT::ProvinceType::LAND:
-            return land_ptr;
-        case HMDT::ProvinceType::SEA:
-            return sea_ptr;
-        case HMDT::ProvinceType::LAKE:
-            return lake_ptr;
-        default:
-            return unknown_ptr;
+HMDT::Color HMDT::UniqueColorAllocator::allocate(ProvinceType type) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    return allocateUnlocked(type);
+}
+
+/**
+ * @brief Allocates several unique colors at once.
+ * @details This only has to lock the allocator once, so it should be preferred
+ *          when building many shapes at the same time.
+ *
+ * @param type The type of province which the colors are for.
+ * @param count How many colors to allocate.
+ *
+ * @return Every color which was allocated, in the order they were allocated.
+ */
+auto HMDT::UniqueColorAllocator::allocate(ProvinceType type, std::size_t count)
+    -> std::vector<Color>
+{
+    std::vector<Color> colors;
+    colors.reserve(count);
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    for(std::size_t i = 0; i < count; ++i) {
+        colors.push_back(allocateUnlocked(type));
     }
+
+    return colors;
+}
+
+/**
+ * @brief Marks a color which was given out elsewhere (such as one loaded from
+ *        a file) as in use, so that it never gets allocated.
+ * @details Once released, the color goes back to the free list of whichever
+ *          type it was generated for.
+ *
+ * @param color The color to mark.
+ *
+ * @return True if the color was marked, false if it was already in use.
+ */
+bool HMDT::UniqueColorAllocator::markInUse(const Color& color) {
+    return markInUse(color,
+                     findUniqueColorType(color).orElse(ProvinceType::UNKNOWN));
+}
+
+/**
+ * @brief Marks a color which was given out elsewhere (such as one loaded from
+ *        a file) as in use, so that it never gets allocated.
+ *
+ * @param color The color to mark.
+ * @param type The type whose free list the color goes to once released.
+ *
+ * @return True if the color was marked, false if it was already in use.
+ */
+bool HMDT::UniqueColorAllocator::markInUse(const Color& color,
+                                           ProvinceType type)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    return m_in_use.emplace(colorToRGB(color), type).second;
 }
 
 /**
- * @brief Verify that some colors remain for the given bias
+ * @brief Releases a color, allowing it to be allocated again.
  *
- * @param bias The type of province 
+ * @param color The color to release.
  *
- * @return True if there are still values, false otherwise.
+ * @return True if the color was released, false if it was not in use.
  */
-bool verifyColorsRemain(HMDT::ProvinceType bias) {
-    UniqueColorPtr color_ptr = getUniqueColorPtr(bias);
-    UniqueColorPtr start_ptr = getUniqueColorPtrStart(bias);
-    unsigned int size = getUniqueColorPtrSize(bias);
+bool HMDT::UniqueColorAllocator::release(const Color& color) {
+    std::lock_guard<std::mutex> lock(m_mutex);
 
-    if(color_ptr >= start_ptr + size) {
-        WRITE_WARN("NO VALUES LEFT!");
+    auto it = m_in_use.find(colorToRGB(color));
+    if(it == m_in_use.end()) {
         return false;
     }
 
+    m_free_colors[getTypeIndex(it->second)].push_back(color);
+    m_in_use.erase(it);
+
     return true;
 }
 
-////////////////////////////////////////////////////////////////////////////////
+/**
+ * @brief Checks if a color has been allocated or marked as in use.
+ */
+bool HMDT::UniqueColorAllocator::isInUse(const Color& color) const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    return m_in_use.count(colorToRGB(color)) != 0;
+}
 
 /**
- * @brief Generates a unique color value.
- * @details If there are no more color values for the given bias, then give out
- *          BLACK instead. If we don't recognize the bias, then give out WHITE
- *          instead.
- *
- * @param bias The type of province which will change the type of color chosen.
- * @return A unique color, biased based on the given ProvinceType. Will return
- *         BLACK if no color values are left, or WHITE if the given bias is
- *         unknown.
+ * @brief Gets how many colors are in use.
  */
-HMDT::Color HMDT::generateUniqueColor(ProvinceType bias) {
-    UniqueColorPtr& color_ptr = getUniqueColorPtr(bias);
+std::size_t HMDT::UniqueColorAllocator::getInUseCount() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
 
-    bool err = (bias == ProvinceType::UNKNOWN);
-    Color c;
+    return m_in_use.size();
+}
 
-    if(err) {
-        goto unknown_color_label;
+/**
+ * @brief Forgets about every color, so that allocation starts over from the
+ *        beginning of every color list.
+ */
+void HMDT::UniqueColorAllocator::reset() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    m_cursors.fill(0);
+    for(auto&& free_colors : m_free_colors) {
+        free_colors.clear();
     }
+    m_in_use.clear();
+}
 
-    if(!verifyColorsRemain(bias)) {
-        err = true;
-        goto unknown_color_label;
+/**
+ * @brief Forgets about every color of the given type, so that allocation for
+ *        that type starts over from the beginning of its color list.
+ *
+ * @param type The type of province to reset.
+ */
+void HMDT::UniqueColorAllocator::reset(ProvinceType type) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    auto index = getTypeIndex(type);
+
+    m_cursors[index] = 0;
+    m_free_colors[index].clear();
+
+    for(auto it = m_in_use.begin(); it != m_in_use.end();) {
+        if(getTypeIndex(it->second) == index) {
+            it = m_in_use.erase(it);
+        } else {
+            ++it;
+        }
     }
+}
 
-    c = Color { color_ptr[0], color_ptr[1], color_ptr[2] };
-    color_ptr += 3;
+std::size_t HMDT::UniqueColorAllocator::getTypeIndex(ProvinceType type) noexcept
+{
+    switch(type) {
+        case ProvinceType::LAND:
+            return 1;
+        case ProvinceType::SEA:
+            return 2;
+        case ProvinceType::LAKE:
+            return 3;
+        default:
+            return 0;
+    }
+}
 
-unknown_color_label:
-    if(err) {
-        color_ptr = getUniqueColorPtr(ProvinceType::UNKNOWN);
-        if(!verifyColorsRemain(ProvinceType::UNKNOWN)) {
-            return Color { 0, 0, 0 }; // Last possible resort
+/**
+ * @brief Takes the next free color for the given type. The caller must hold
+ *        m_mutex.
+ *
+ * @param type The type of province to take a color for.
+ * @param color Set to the color which was taken.
+ *
+ * @return True if a color was taken, false if the type has no colors left.
+ */
+bool HMDT::UniqueColorAllocator::allocateFromType(ProvinceType type,
+                                                  Color& color)
+{
+    auto index = getTypeIndex(type);
+
+    // Released colors get re-used first. A released color may have been marked
+    //   as in use again since then, so those get skipped.
+    auto& free_colors = m_free_colors[index];
+    while(!free_colors.empty()) {
+        auto candidate = free_colors.back();
+        free_colors.pop_back();
+
+        if(m_in_use.emplace(colorToRGB(candidate), type).second) {
+            color = candidate;
+            return true;
         }
+    }
+
+    UniqueColorPtr start = getUniqueColorPtrStart(type);
+    std::size_t count = getUniqueColorPtrSize(type) / 3;
 
-        c = Color { color_ptr[0], color_ptr[1], color_ptr[2] };
-        color_ptr += 3;
+    for(auto& cursor = m_cursors[index]; cursor < count;) {
+        UniqueColorPtr color_ptr = start + (cursor++ * 3);
+        Color candidate{ color_ptr[0], color_ptr[1], color_ptr[2] };
+
+        // Skip over anything which was marked as in use
+        if(m_in_use.emplace(colorToRGB(candidate), type).second) {
+            color = candidate;
+            return true;
+        }
     }
 
-    return c;
+    return false;
 }
 
-void HMDT::resetUniqueColorGenerator() {
-    getUniqueColorPtr(ProvinceType::LAND) = getUniqueColorPtrStart(ProvinceType::LAND);
-    getUniqueColorPtr(ProvinceType::LAKE) = getUniqueColorPtrStart(ProvinceType::LAKE);
-    getUniqueColorPtr(ProvinceType::SEA) = getUniqueColorPtrStart(ProvinceType::SEA);
-    getUniqueColorPtr(ProvinceType::UNKNOWN) = getUniqueColorPtrStart(ProvinceType::UNKNOWN);
-}
+/**
+ * @brief Allocates a color, falling back to UNKNOWN and then BLACK if there are
+ *        none left. The caller must hold m_mutex.
+ *
+ * @param type The type of province which the color is for.
+ */
+HMDT::Color HMDT::UniqueColorAllocator::allocateUnlocked(ProvinceType type) {
+    Color color;
 
-void HMDT::resetUniqueColorGenerator(ProvinceType bias) {
-    getUniqueColorPtr(bias) = getUniqueColorPtrStart(bias);
-}
+    if(type != ProvinceType::UNKNOWN && allocateFromType(type, color)) {
+        return color;
+    }
 
+    if(allocateFromType(ProvinceType::UNKNOWN, color)) {
+        return color;
+    }
+
+    WRITE_WARN("NO VALUES LEFT!");
+    return Color { 0, 0, 0 }; // Last possible resort
+}
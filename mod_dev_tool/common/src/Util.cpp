@@ -61,11 +61,14 @@ HMDT::Color HMDT::RGBToColor(std::uint32_t rgb) {
 }
 
 void HMDT::ltrim(std::string& str) {
-    str.erase(str.begin(), str.begin() + str.find_first_not_of(" \t\n\r"));
+    // Erases everything if the string is entirely whitespace
+    str.erase(0, str.find_first_not_of(" \t\n\r"));
 }
 
 void HMDT::rtrim(std::string& str) {
-    str.erase(str.begin() + str.find_last_not_of(" \t\n\r") + 1, str.end());
+    // npos + 1 wraps around to 0, so this erases everything if the string is
+    //   entirely whitespace
+    str.erase(str.find_last_not_of(" \t\n\r") + 1);
 }
 
 void HMDT::trim(std::string& str) {
@@ -91,6 +94,56 @@ std::string HMDT::trim(const std::string& str) {
     return s;
 }
 
+/**
+ * @brief Safely reads the binary representation of a UUID from a stream
+ * @details The bytes are always read in the same order, so this is safe to use
+ *          for files which are shared between platforms.
+ *
+ * @param destination The UUID to read into. Left unmodified if reading fails.
+ * @param stream The stream to read from.
+ *
+ * @return True if the read was successful, false otherwise.
+ */
+bool HMDT::safeRead(UUID* destination, std::istream& stream) {
+    UUID::Bytes bytes;
+    if(!safeRead(bytes.data(), bytes.size(), stream)) {
+        return false;
+    }
+
+    *destination = UUID(bytes);
+
+    return true;
+}
+
+/**
+ * @brief Safely reads the binary representation of a UUID from a stream
+ *
+ * @param destination The UUID to read into. Left unmodified if reading fails.
+ * @param stream The stream to read from.
+ *
+ * @return STATUS_SUCCESS on success, or an error code if the read failed.
+ */
+auto HMDT::safeRead2(UUID* destination, std::istream& stream) -> MaybeVoid {
+    UUID::Bytes bytes;
+    auto result = safeRead2(bytes.data(), bytes.size(), stream);
+    RETURN_IF_ERROR(result);
+
+    *destination = UUID(bytes);
+
+    return STATUS_SUCCESS;
+}
+
+/**
+ * @brief Writes the binary representation of a UUID to a stream
+ *
+ * @param stream The stream to write to
+ * @param uuid The UUID to write
+ */
+void HMDT::writeData(std::ostream& stream, const UUID& uuid) {
+    auto bytes = uuid.toBytes();
+    stream.write(reinterpret_cast<const char*>(bytes.data()), bytes.size());
+}
+
 std::string& HMDT::toLower(std::string& str) {
     return (str = toLower(const_cast<const std::string&>(str)));
 }
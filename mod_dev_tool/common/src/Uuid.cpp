@@ -1,8 +1,38 @@
 #include "Uuid.h"
 
 #include <cstring>
+#include <algorithm>
+#include <cctype>
+#include <istream>
+#include <ostream>
 
 #include "Logger.h"
+#include "StatusCodes.h"
+
+namespace {
+    //! The value of each hex digit, or 0xFF for characters which are not one
+    constexpr auto HEX_DECODE_TABLE = []() {
+        std::array<std::uint8_t, 256> table{};
+
+        for(auto& v : table) v = 0xFF;
+        for(int c = '0'; c <= '9'; ++c) table[c] = c - '0';
+        for(int c = 'a'; c <= 'f'; ++c) table[c] = c - 'a' + 10;
+        for(int c = 'A'; c <= 'F'; ++c) table[c] = c - 'A' + 10;
+
+        return table;
+    }();
+
+    //! The character for each hex digit
+    constexpr char HEX_ENCODE_TABLE[] = "0123456789abcdef";
+
+    //! Where in the string representation each byte of a UUID starts
+    constexpr std::array<std::uint8_t, HMDT::UUID::BINARY_REPR_LENGTH> BYTE_OFFSETS {
+        0, 2, 4, 6, 9, 11, 14, 16, 19, 21, 24, 26, 28, 30, 32, 34
+    };
+
+    //! Where in the string representation each '-' is
+    constexpr std::array<std::uint8_t, 4> DASH_OFFSETS { 8, 13, 18, 23 };
+}
 
 const HMDT::UUID HMDT::EMPTY_UUID(HMDT::UUID::CreationParams::EMPTY);
 
@@ -37,6 +67,26 @@ HMDT::UUID::UUID(CreationParams params) {
     }
 }
 
+/**
+ * @brief Builds a UUID out of its binary representation
+ *
+ * @param bytes The bytes of the UUID, in string order
+ */
+HMDT::UUID::UUID(const Bytes& bytes) noexcept {
+#ifdef WIN32
+    // The first three fields are stored in native (little-endian) order
+    m_internal_uuid.Data1 = (static_cast<unsigned long>(bytes[0]) << 24) |
+                            (static_cast<unsigned long>(bytes[1]) << 16) |
+                            (static_cast<unsigned long>(bytes[2]) << 8) |
+                             static_cast<unsigned long>(bytes[3]);
+    m_internal_uuid.Data2 = static_cast<unsigned short>((bytes[4] << 8) | bytes[5]);
+    m_internal_uuid.Data3 = static_cast<unsigned short>((bytes[6] << 8) | bytes[7]);
+    std::memcpy(m_internal_uuid.Data4, bytes.data() + 8, 8);
+#else
+    std::memcpy(m_internal_uuid, bytes.data(), bytes.size());
+#endif
+}
+
 HMDT::UUID::UUID(const UUID& other) {
     *this = other;
 }
@@ -141,34 +191,105 @@ std::size_t HMDT::UUID::hash() const noexcept {
     return std::hash<HMDT::UUID>()(*this);
 }
 
-HMDT::Maybe<HMDT::UUID> HMDT::UUID::parse(const std::string& str) noexcept {
-    UUID uuid(EMPTY_UUID);
+/**
+ * @brief Gets the binary representation of this UUID
+ *
+ * @return The bytes of this UUID, in the same order as they appear in the
+ *         string representation.
+ */
+auto HMDT::UUID::toBytes() const noexcept -> Bytes {
+    Bytes bytes;
 
 #ifdef WIN32
-    // Note: For some stupid reason, the Win32 API takes the Uuid types by
-    //   non-const pointer rather than by const pointer. So, make sure we cast
-    //   away the const-ness before calling this function.
-    auto status = UuidFromStringA(
-            reinterpret_cast<RPC_CSTR>(const_cast<char*>(str.c_str())),
-            const_cast<SystemUUIDType*>(&uuid.m_internal_uuid));
-    constexpr auto FAILURE_STATUS = RPC_S_INVALID_STRING_UUID;
+    bytes[0] = static_cast<std::uint8_t>(m_internal_uuid.Data1 >> 24);
+    bytes[1] = static_cast<std::uint8_t>(m_internal_uuid.Data1 >> 16);
+    bytes[2] = static_cast<std::uint8_t>(m_internal_uuid.Data1 >> 8);
+    bytes[3] = static_cast<std::uint8_t>(m_internal_uuid.Data1);
+    bytes[4] = static_cast<std::uint8_t>(m_internal_uuid.Data2 >> 8);
+    bytes[5] = static_cast<std::uint8_t>(m_internal_uuid.Data2);
+    bytes[6] = static_cast<std::uint8_t>(m_internal_uuid.Data3 >> 8);
+    bytes[7] = static_cast<std::uint8_t>(m_internal_uuid.Data3);
+    std::memcpy(bytes.data() + 8, m_internal_uuid.Data4, 8);
 #else
-    auto status = uuid_parse(str.c_str(), uuid.m_internal_uuid);
-    constexpr auto FAILURE_STATUS = -1;
+    std::memcpy(bytes.data(), m_internal_uuid, bytes.size());
 #endif
 
-    if(status == FAILURE_STATUS) {
+    return bytes;
+}
+
+/**
+ * @brief Writes the string representation of this UUID into a buffer
+ * @details Writes exactly STRING_REPR_LENGTH lowercase characters, with no
+ *          null-terminator.
+ *
+ * @param buffer The buffer to write into. Must have room for at least
+ *               STRING_REPR_LENGTH characters.
+ *
+ * @return A pointer to one past the last character written.
+ */
+char* HMDT::UUID::format(char* buffer) const noexcept {
+    auto bytes = toBytes();
+
+    for(auto offset : DASH_OFFSETS) {
+        buffer[offset] = '-';
+    }
+
+    for(std::size_t i = 0; i < bytes.size(); ++i) {
+        buffer[BYTE_OFFSETS[i]] = HEX_ENCODE_TABLE[bytes[i] >> 4];
+        buffer[BYTE_OFFSETS[i] + 1] = HEX_ENCODE_TABLE[bytes[i] & 0xF];
+    }
+
+    return buffer + STRING_REPR_LENGTH;
+}
+
+/**
+ * @brief Parses a UUID out of its string representation
+ * @details Accepts exactly "XXXXXXXX-XXXX-XXXX-XXXX-XXXXXXXXXXXX", where each
+ *          X is an upper or lowercase hex digit. No memory is allocated.
+ *
+ * @param str The string to parse
+ *
+ * @return The parsed UUID, or STATUS_INVALID_UUID_STRING if str is not a valid
+ *         UUID.
+ */
+HMDT::Maybe<HMDT::UUID> HMDT::UUID::parse(std::string_view str) noexcept {
+    bool valid = str.size() == STRING_REPR_LENGTH;
+
+    if(valid) {
+        for(auto offset : DASH_OFFSETS) {
+            valid &= str[offset] == '-';
+        }
+    }
+
+    Bytes bytes{};
+    if(valid) {
+        // Invalid digits decode to 0xFF, so just check all of the high bits at
+        //   once at the end rather than after each digit
+        std::uint8_t invalid_bits = 0;
+        for(std::size_t i = 0; i < bytes.size(); ++i) {
+            auto high = HEX_DECODE_TABLE[static_cast<unsigned char>(str[BYTE_OFFSETS[i]])];
+            auto low = HEX_DECODE_TABLE[static_cast<unsigned char>(str[BYTE_OFFSETS[i] + 1])];
+
+            invalid_bits |= high | low;
+            bytes[i] = static_cast<std::uint8_t>((high << 4) | (low & 0xF));
+        }
+
+        valid = (invalid_bits & 0xF0) == 0;
+    }
+
+    if(!valid) {
         WRITE_ERROR("Failed to parse uuid: ", str);
-        // TODO: RETURN_IF_ERROR?
+        RETURN_ERROR(STATUS_INVALID_UUID_STRING);
     }
 
-    return uuid;
+    return UUID(bytes);
 }
 
 std::ostream& HMDT::operator<<(std::ostream& out, const UUID& uuid) noexcept {
-    return out << std::to_string(uuid);
+    char buffer[UUID::STRING_REPR_LENGTH];
+    uuid.format(buffer);
 
-    return out;
+    return out.write(buffer, sizeof(buffer));
 }
 
 /**
@@ -181,23 +302,43 @@ std::ostream& HMDT::operator<<(std::ostream& out, const UUID& uuid) noexcept {
  * @return in
  */
 std::istream& HMDT::operator>>(std::istream& in, UUID& uuid) noexcept {
-    std::string str;
+    char buffer[UUID::STRING_REPR_LENGTH];
+    std::size_t length = 0;
 
     // Read the first token, it should be a full UUID.
     // If the stream contains data like "{UUID}extradata", then it is not to be
-    //   considered a valid UUID
-    in >> str;
+    //   considered a valid UUID. The whole token is always consumed, but only
+    //   as much as could be a UUID is kept.
+    in >> std::ws;
+    for(auto c = in.peek();
+        c != std::istream::traits_type::eof() && !std::isspace(c);
+        c = in.peek())
+    {
+        in.get();
+
+        if(length < sizeof(buffer)) {
+            buffer[length] = static_cast<char>(c);
+        }
+        ++length;
+    }
 
-    if(str.size() < UUID::STRING_REPR_LENGTH) {
-        WRITE_ERROR("Incorrect string length ", str.size(), ", expected ",
-                    UUID::STRING_REPR_LENGTH, ". Unable to parse '", str, '\'');
+    if(length == 0) {
+        in.setstate(std::ios_base::failbit);
+    }
+
+    if(length != UUID::STRING_REPR_LENGTH) {
+        WRITE_ERROR("Incorrect string length ", length, ", expected ",
+                    UUID::STRING_REPR_LENGTH, ". Unable to parse '",
+                    std::string_view(buffer, std::min<std::size_t>(length, sizeof(buffer))),
+                    '\'');
         return in;
     }
 
-    auto new_uuid = UUID::parse(str);
+    auto new_uuid = UUID::parse(std::string_view(buffer, length));
 
     if(IS_FAILURE(new_uuid)) {
-        WRITE_ERROR("Failed to parse UUID of '", str, '\'');
+        WRITE_ERROR("Failed to parse UUID of '",
+                    std::string_view(buffer, length), '\'');
         return in;
     }
 
@@ -213,19 +354,8 @@ HMDT::HashOnlyUUID::HashOnlyUUID(std::size_t hash):
 { }
 
 std::string std::to_string(const HMDT::UUID& uuid) {
-#ifdef WIN32
-    unsigned char* str;
-    UuidToStringA(&uuid.getSystemType(), &str);
-
-    std::string s((char*)str);
-
-    RpcStringFreeA(&str);
-#else
-
-    char s[37];
-    uuid_unparse(uuid.getSystemType(), s);
-#endif
+    std::string s(HMDT::UUID::STRING_REPR_LENGTH, '\0');
+    uuid.format(s.data());
 
     return s;
 }
-
@@ -11,6 +11,9 @@
 #include "WorldNormalBuilder.h"
 
 #include <cmath> // std::sqrt
+#include <array>
+#include <vector>
+#include <algorithm>
 
 #include "BitMap.h"
 #include "Util.h"
@@ -53,8 +56,130 @@ namespace {
 
         return Vec3{ x / l, y / l, z / l };
     }
+
+    /**
+     * @brief The fewest number of rows that are worth handing off to a
+     *        separate thread.
+     */
+    constexpr std::uint64_t MIN_ROWS_PER_BAND = 64;
+
+    /**
+     * @brief The Z component of the sobel normal, scaled by the same factor
+     *        that intensitySum() scales intensities by (1/2 * 255 * 3).
+     */
+    constexpr float SCALED_DZ = (255.0f * 3.0f) / 2.0f;
+
+    /**
+     * @brief Calculate the intensity of the given color, scaled up by 255 * 3
+     *        so that it can be kept as an integer.
+     *
+     * @param c The color
+     *
+     * @return The scaled intensity, in the range [0, 765]
+     */
+    std::int32_t intensitySum(HMDT::Color c) {
+        return static_cast<std::int32_t>(c.r) + c.g + c.b;
+    }
+
+    /**
+     * @brief Converts one component of a unit vector to a color value.
+     *
+     * @param n The component, in the range [-1, 1]
+     *
+     * @return The color value
+     */
+    std::uint8_t componentToColor(float n) {
+        return static_cast<std::uint8_t>((n + 1.0f) * (255.0f / 2.0f));
+    }
+
+    /**
+     * @brief Generates the normal map for rows [first_row, last_row).
+     *
+     * @param data The 8-bit heightmap data
+     * @param width The width of the heightmap
+     * @param height The height of the heightmap
+     * @param intensities The scaled intensity of every 8-bit value
+     * @param normal_data The output array
+     * @param first_row The first row to generate
+     * @param last_row One past the last row to generate
+     */
+    void generateNormalRows(const unsigned char* data,
+                            std::int32_t width, std::int32_t height,
+                            const std::array<std::int32_t, 256>& intensities,
+                            unsigned char* normal_data,
+                            std::uint64_t first_row, std::uint64_t last_row)
+    {
+        // Both of these are padded by one element on either side, holding the
+        //   clamped edge values so that the inner loop never has to check
+        //   bounds.
+        // smooth[x] = top + 2*mid + bot (vertical smoothing for dX)
+        // diff[x]   = bot - top         (vertical derivative for dY)
+        std::vector<std::int32_t> smooth(width + 2);
+        std::vector<std::int32_t> diff(width + 2);
+
+        for(auto y = static_cast<std::int32_t>(first_row);
+                 y < static_cast<std::int32_t>(last_row); ++y)
+        {
+            const unsigned char* top = data + static_cast<std::uint64_t>(std::max(y - 1, 0)) * width;
+            const unsigned char* mid = data + static_cast<std::uint64_t>(y) * width;
+            const unsigned char* bot = data + static_cast<std::uint64_t>(std::min(y + 1, height - 1)) * width;
+
+            for(std::int32_t x = 0; x < width; ++x) {
+                auto t = intensities[top[x]];
+                auto m = intensities[mid[x]];
+                auto b = intensities[bot[x]];
+
+                smooth[x + 1] = t + 2 * m + b;
+                diff[x + 1] = b - t;
+            }
+
+            smooth[0] = smooth[1];
+            smooth[width + 1] = smooth[width];
+            diff[0] = diff[1];
+            diff[width + 1] = diff[width];
+
+            unsigned char* out = normal_data + static_cast<std::uint64_t>(y) * width * 3;
+
+            // Note: This loop is kept branch-free so that it can be
+            //   vectorized by the compiler
+            for(std::int32_t x = 0; x < width; ++x) {
+                auto dX = static_cast<float>(smooth[x + 2] - smooth[x]);
+                auto dY = static_cast<float>(diff[x] + 2 * diff[x + 1] + diff[x + 2]);
+
+                float inv_length = 1.0f / std::sqrt(dX * dX + dY * dY +
+                                                    SCALED_DZ * SCALED_DZ);
+
+                out[x * 3]     = componentToColor(dX * inv_length);
+                out[x * 3 + 1] = componentToColor(dY * inv_length);
+                out[x * 3 + 2] = componentToColor(SCALED_DZ * inv_length);
+            }
+        }
+    }
 }
 
+/**
+ * @brief Generates a world normal map from the given 8-bit heightmap.
+ *
+ * @details This works over entire rows at a time, computing the sobel filter
+ *          as two separable integer passes over each triplet of rows, and
+ *          normalizing the result in single-precision floats. Rows are split
+ *          into bands which are processed in parallel.
+ *
+ * @par Edge pixels are clamped to the nearest valid pixel in the image. The
+ *      interior of the output will match a straight double-precision
+ *      implementation of the same filter to within +/-1 per channel, as the
+ *      float normalization can land on the other side of a truncation
+ *      boundary.
+ *
+ * @param heightmap The input heightmap to generate a normal map from. Must be
+ *                  an 8-bit image with a color table.
+ * @param normal_data The output image data array. Must be at least
+ *                    width * height * 3 bytes large. Each pixel will be
+ *                    written as RGB.
+ *
+ * @return STATUS_SUCCESS on success, or an error code if the heightmap is not
+ *         a valid 8-bit image.
+ */
 auto HMDT::generateWorldNormalMap(const BitMap2& heightmap,
                                   unsigned char* normal_data)
     -> MaybeVoid
@@ -67,60 +192,34 @@ auto HMDT::generateWorldNormalMap(const BitMap2& heightmap,
         RETURN_ERROR(STATUS_INVALID_BIT_DEPTH);
     }
 
-    // For every single pixel
-    for(int y = 0; y < height; ++y) {
-        for(int x = 0; x < width; ++x) {
-            // Index into normal_data based on our current X,Y coordinate
-            // Hardcode 3 because we want the output to have a pixel-depth of 3
-            auto index = xyToIndex(width * 3, x * 3, y);
-
-            // Surrounding pixels
-            auto top_left  = getAsPixel(heightmap, clamp(x - 1, 0, width), clamp(y - 1, 0, height));
-            RETURN_IF_ERROR(top_left);
-            auto top       = getAsPixel(heightmap, x, clamp(y - 1, 0, height));
-            RETURN_IF_ERROR(top);
-            auto top_right = getAsPixel(heightmap, clamp(x + 1, 0, width), clamp(y - 1, 0, height));
-            RETURN_IF_ERROR(top_right);
-            auto left      = getAsPixel(heightmap, clamp(x - 1, 0, width), y);
-            RETURN_IF_ERROR(left);
-            auto right     = getAsPixel(heightmap, clamp(x + 1, 0, width), y);
-            RETURN_IF_ERROR(right);
-            auto bot_left  = getAsPixel(heightmap, clamp(x - 1, 0, width), clamp(y + 1, 0, height));
-            RETURN_IF_ERROR(bot_left);
-            auto bot       = getAsPixel(heightmap, x, clamp(y + 1, 0, height));
-            RETURN_IF_ERROR(bot);
-            auto bot_right = getAsPixel(heightmap, clamp(x + 1, 0, width), clamp(y + 1, 0, height));
-            RETURN_IF_ERROR(bot_right);
-
-            // Get intensities of surrounding pixels
-            double tl_intensity = intensity(top_left->color);
-            double t_intensity = intensity(top->color);
-            double tr_intensity = intensity(top_right->color);
-            double l_intensity = intensity(left->color);
-            double r_intensity = intensity(right->color);
-            double bl_intensity = intensity(bot_left->color);
-            double b_intensity = intensity(bot->color);
-            double br_intensity = intensity(bot_right->color);
+    // 8-bit images require a color table
+    if(heightmap.color_table == nullptr) {
+        WRITE_ERROR("8-bit bitmaps require a color table to be provided!");
+        RETURN_ERROR(STATUS_COLOR_TABLE_REQUIRED);
+    }
 
-            // sobel filter
-            double dX = (tr_intensity + 2.0 * r_intensity + br_intensity) - (tl_intensity + 2.0 * l_intensity + bl_intensity);
-            double dY = (bl_intensity + 2.0 * b_intensity + br_intensity) - (tl_intensity + 2.0 * t_intensity + tr_intensity);
-            double dZ = 1.0 / 2.0;
+    if(width <= 0 || height <= 0) {
+        return STATUS_SUCCESS;
+    }
 
-            // Normalize the sobel filter values
-            auto [nX, nY, nZ] = normalize(dX, dY, dZ);
+    // Precompute the (unscaled) intensity of every possible value in the
+    //   image, so that the filter can stay in integers
+    std::array<std::int32_t, 256> intensities{ };
+    auto num_colors = std::min<std::uint32_t>(heightmap.info_header.v1.colorsUsed,
+                                              intensities.size());
+    for(std::uint32_t i = 0; i < num_colors; ++i) {
+        intensities[i] = intensitySum(Color{ heightmap.color_table[i].red,
+                                             heightmap.color_table[i].green,
+                                             heightmap.color_table[i].blue });
+    }
 
-            // Convert the coordinates back into color values
-            auto r = static_cast<std::uint8_t>((nX + 1.0) * (255.0 / 2.0));
-            auto g = static_cast<std::uint8_t>((nY + 1.0) * (255.0 / 2.0));
-            auto b = static_cast<std::uint8_t>((nZ + 1.0) * (255.0 / 2.0));
+    const unsigned char* data = heightmap.data.get();
 
-            // Finally, place the new color data into the output array.
-            normal_data[index] = r;
-            normal_data[index + 1] = g;
-            normal_data[index + 2] = b;
-        }
-    }
+    parallelForRange(0, height,
+        [&](std::uint64_t first_row, std::uint64_t last_row) {
+            generateNormalRows(data, width, height, intensities,
+                               normal_data, first_row, last_row);
+        }, MIN_ROWS_PER_BAND);
 
     return STATUS_SUCCESS;
 }
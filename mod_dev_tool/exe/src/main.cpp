@@ -42,6 +42,8 @@
 #include "Interfaces.h"
 #include "Logger.h"
 
+#include "ActionManager.h"
+
 namespace HMDT {
     FILE* _dump_out_file = nullptr;
 
@@ -76,6 +78,16 @@ extern "C" {
             last_resort_invoked = true;
         }
 
+        // Write out any edits still waiting in the journal's buffer, so that
+        //   they can be recovered the next time the project is opened. This
+        //   is done before anything else which may allocate, and without
+        //   logging, as the heap or the logger may be what crashed.
+        if(const auto& journal = HMDT::Action::ActionManager::getInstance().getJournal();
+                journal != nullptr)
+        {
+            journal->flushForCrash();
+        }
+
         WRITE_ERROR("Fatal Error: Signal ", signal_num, " received. Dumping all"
                     " logs and stack traces (if possible), and then terminating"
                     " immediately.");
@@ -5,8 +5,8 @@ out vec4 FragColor; // Output color value
 uniform sampler2D selection;
 uniform usampler2D label_matrix;
 
-uniform uint province_labels[MAX_SELECTED_PROVINCES];
-uniform uint num_selected; // Will be no larger than MAX_SELECTED_PROVINCES
+// Whether each label is selected, SELECTION_MASK_ROW_WIDTH labels per row
+uniform sampler2D selection_mask;
 
 // The color that the selection will appear rendered as
 uniform vec3 selection_color;
@@ -14,16 +14,19 @@ uniform vec3 selection_color;
 in vec2 texture_coords; // Input from vertex shader
 
 /**
- * @brief Checks if the given label is selected. Only iterates up to num_selected.
+ * @brief Checks if the given label is selected, with a single lookup into
+ *        selection_mask.
  */
 bool isSelected(uint pixel_label) {
-    for(uint i = 0; i < num_selected; ++i) {
-        if(province_labels[i] == pixel_label) {
-            return true;
-        }
+    ivec2 mask_coords = ivec2(pixel_label % SELECTION_MASK_ROW_WIDTH,
+                              pixel_label / SELECTION_MASK_ROW_WIDTH);
+
+    // Anything past the end of the mask can't be selected
+    if(mask_coords.y >= textureSize(selection_mask, 0).y) {
+        return false;
     }
 
-    return false;
+    return texelFetch(selection_mask, mask_coords, 0).r > 0.5;
 }
 
 void main() {
@@ -11,8 +11,9 @@ uniform uint state_id;
 // This is necessary for dFd*Exact to work
 uniform ivec2 tex_dimensions;
 
-uniform uint selected_state_ids[MAX_SELECTED_PROVINCES];
-uniform uint num_selected; // Will be no larger than MAX_SELECTED_PROVINCES
+// Whether each state is selected, indexed by state ID, with
+//   SELECTION_MASK_ROW_WIDTH states per row
+uniform sampler2D selection_mask;
 
 in vec2 texture_coords; // Input from vertex shader
 
@@ -51,16 +52,19 @@ vec4 layerColors(vec4 foreground, vec4 background) {
 }
 
 /**
- * @brief Checks if the given label is selected. Only iterates up to num_selected.
+ * @brief Checks if the given state is selected, with a single lookup into
+ *        selection_mask.
  */
 bool isSelected(uint pixel_label) {
-    for(uint i = 0; i < num_selected; ++i) {
-        if(selected_state_ids[i] == pixel_label) {
-            return true;
-        }
+    ivec2 mask_coords = ivec2(pixel_label % SELECTION_MASK_ROW_WIDTH,
+                              pixel_label / SELECTION_MASK_ROW_WIDTH);
+
+    // Anything past the end of the mask can't be selected
+    if(mask_coords.y >= textureSize(selection_mask, 0).y) {
+        return false;
     }
 
-    return false;
+    return texelFetch(selection_mask, mask_coords, 0).r > 0.5;
 }
 
 void main() {
@@ -16,6 +16,8 @@
 
 # include <glm/vec4.hpp>
 
+# include "SelectionMask.h"
+
 # include "Program.h"
 # include "Texture.h"
 # include "IRenderingView.h"
@@ -50,6 +52,9 @@ namespace HMDT::GUI::GL {
 
             void drawMapVAO();
 
+            static void initSelectionMaskTexture(Texture&, Texture::Unit);
+            static void uploadSelectionMask(SelectionMask&, Texture&);
+
         private:
             //! The map VAO
             uint32_t m_vao = -1;
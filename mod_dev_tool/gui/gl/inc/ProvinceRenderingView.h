@@ -31,6 +31,9 @@ namespace HMDT::GUI::GL {
             Texture& getMapTexture();
             Texture& getLabelTexture();
 
+            void updateLabelTexture();
+            void updateSelectionMasks();
+
             virtual void setupUniforms() override;
             virtual const std::string& getVertexShaderSource() const override;
             virtual const std::string& getFragmentShaderSource() const override;
@@ -45,11 +48,31 @@ namespace HMDT::GUI::GL {
             //! The Texture of the map
             Texture m_texture;
 
-            //! The texture of the label matrix
+            //! The dense index of the province at each pixel, plus one
             Texture m_label_texture;
 
             //! The outline texture
             Texture m_outline_texture;
+
+            //! The number of provinces in m_label_texture
+            std::size_t m_indexed_province_count = 0;
+
+            //! Whether each province is selected, indexed by the labels in
+            //!   m_label_texture
+            SelectionMask m_selection_mask;
+
+            //! Whether each province is adjacent to the selected province
+            SelectionMask m_adjacency_mask;
+
+            //! The GPU copy of m_selection_mask
+            Texture m_selection_mask_texture;
+
+            //! The GPU copy of m_adjacency_mask
+            Texture m_adjacency_mask_texture;
+
+            //! Whether the selection has changed since the masks were last
+            //!   updated
+            bool m_is_selection_dirty = true;
     };
 }
 
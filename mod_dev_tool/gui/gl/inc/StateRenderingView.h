@@ -34,6 +34,7 @@ namespace HMDT::GUI::GL {
             Texture& getStateIDMatrixTexture();
 
             void updateStateIDTexture();
+            void updateSelectionMask();
 
         private:
             std::shared_ptr<const MapData> m_map_data;
@@ -43,6 +44,16 @@ namespace HMDT::GUI::GL {
 
             //! A tag for the last state ID matrix value, used to know if it needs to be refreshed
             uint32_t m_last_state_id_matrix_updated_tag = -1;
+
+            //! Whether each state is selected, indexed by StateID
+            SelectionMask m_selection_mask;
+
+            //! The GPU copy of m_selection_mask
+            Texture m_selection_mask_texture;
+
+            //! Whether the selection has changed since the mask was last
+            //!   updated
+            bool m_is_selection_dirty = true;
     };
 }
 
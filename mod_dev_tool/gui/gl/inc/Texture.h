@@ -117,6 +117,29 @@ namespace HMDT::GUI::GL {
                                typeToDataType(typeid(T)), data, format);
             }
 
+            /**
+             * @brief Replaces part of the texture data already on the GPU.
+             *
+             * @details Implicitly calls bind()
+             *
+             * @tparam T The type of data being passed in
+             *
+             * @param x The left edge of the region to replace
+             * @param y The top edge of the region to replace
+             * @param width The width of the region to replace
+             * @param height The height of the region to replace
+             * @param data The data to send to the GPU
+             * @param format The CPU-side format of the data
+             */
+            template<typename T>
+            void updateTextureData(uint32_t x, uint32_t y,
+                                   uint32_t width, uint32_t height,
+                                   const T* data, uint32_t format)
+            {
+                updateTextureData(x, y, width, height,
+                                  typeToDataType(typeid(T)), data, format);
+            }
+
             uint32_t getTextureUnitID() const;
             uint32_t getTextureID() const;
             uint32_t getWidth() const;
@@ -139,6 +162,8 @@ namespace HMDT::GUI::GL {
 
             void setTextureData(Format, uint32_t, uint32_t, uint32_t,
                                 const void*, std::optional<uint32_t>);
+            void updateTextureData(uint32_t, uint32_t, uint32_t, uint32_t,
+                                   uint32_t, const void*, uint32_t);
 
         private:
             //! The texture ID
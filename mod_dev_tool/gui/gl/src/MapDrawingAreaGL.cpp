@@ -17,6 +17,7 @@
 #include "Logger.h"
 #include "Constants.h"
 #include "Options.h"
+#include "SelectionMask.h"
 
 #include "GLEWInitializationException.h"
 #include "Shader.h"
@@ -203,7 +204,11 @@ void HMDT::GUI::GL::MapDrawingArea::onShow() {
 
 void HMDT::GUI::GL::MapDrawingArea::onSelectionChanged(std::optional<SelectionInfo> selection)
 {
-    getCurrentRenderingView()->onSelectionChanged(selection);
+    // Every view needs to know, so that switching views doesn't show an old
+    //   selection
+    for(auto&& [viewing_mode, rendering_view] : m_rendering_views) {
+        rendering_view->onSelectionChanged(selection);
+    }
 
     queue_draw();
 }
@@ -217,7 +222,7 @@ void HMDT::GUI::GL::MapDrawingArea::queueDraw() {
  * @brief Initializes all global shader macros
  */
 void HMDT::GUI::GL::MapDrawingArea::initShaderMacros() {
-    Shader::defineMacro("MAX_SELECTED_PROVINCES", MAX_SELECTED_PROVINCES);
+    Shader::defineMacro("SELECTION_MASK_ROW_WIDTH", SelectionMask::ROW_WIDTH);
 }
 
 auto HMDT::GUI::GL::MapDrawingArea::getCurrentRenderingView()
@@ -283,6 +288,8 @@ glm::mat4 HMDT::GUI::GL::MapDrawingArea::getTransformation() const {
 /**
  * @brief Callback for a mouse-click. Will call the relevant onSelection
  *        callback, depending on if the click was done while SHIFT was held.
+ * @details Clicks with CTRL or ALT held start a box or lasso selection, which
+ *          is handled by IMapDrawingArea.
  *
  * @param event The mouse-button event
  *
@@ -296,6 +303,10 @@ bool HMDT::GUI::GL::MapDrawingArea::on_button_press_event(GdkEventButton* event)
 
     // Is it a left-click?
     if(event->type == GDK_BUTTON_PRESS && event->button == 1) {
+        if(event->state & (GDK_CONTROL_MASK | GDK_MOD1_MASK)) {
+            return IMapDrawingArea::on_button_press_event(event);
+        }
+
         // Note that x and y will be the values after scaling. If we want the
         //  true coordinates, we have to invert the scaling
 #if 1
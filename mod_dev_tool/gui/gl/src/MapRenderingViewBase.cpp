@@ -184,3 +184,52 @@ auto HMDT::GUI::GL::MapRenderingViewBase::getPrograms() -> ProgramList {
     return { m_program };
 }
 
+/**
+ * @brief Sets up a texture to hold a SelectionMask
+ *
+ * @param texture The texture to set up
+ * @param unit The texture unit to use
+ */
+void HMDT::GUI::GL::MapRenderingViewBase::initSelectionMaskTexture(Texture& texture,
+                                                                   Texture::Unit unit)
+{
+    texture.setTextureUnitID(unit);
+
+    // The mask is only ever read with texelFetch, but the texture must still
+    //   not expect any mipmaps or it will be incomplete
+    texture.setFiltering(Texture::FilterType::MAG, Texture::Filter::NEAREST);
+    texture.setFiltering(Texture::FilterType::MIN, Texture::Filter::NEAREST);
+
+    texture.setWrapping(Texture::Axis::S, Texture::WrapMode::CLAMP_TO_EDGE);
+    texture.setWrapping(Texture::Axis::T, Texture::WrapMode::CLAMP_TO_EDGE);
+
+    texture.bind(false);
+}
+
+/**
+ * @brief Uploads whatever has changed in a SelectionMask to its texture
+ *
+ * @details If the mask has changed size then the whole texture is recreated,
+ *          otherwise only the rows which have changed are uploaded.
+ *
+ * @param mask The mask to upload
+ * @param texture The texture to upload to
+ */
+void HMDT::GUI::GL::MapRenderingViewBase::uploadSelectionMask(SelectionMask& mask,
+                                                              Texture& texture)
+{
+    if(mask.isResized()) {
+        texture.setTextureData(Texture::Format::RED,
+                               mask.getWidth(), mask.getHeight(),
+                               mask.getData());
+        texture.bind(false);
+    } else if(auto dirty_rows = mask.getDirtyRows(); dirty_rows) {
+        auto [first, last] = *dirty_rows;
+
+        texture.updateTextureData(0, first, mask.getWidth(), last - first,
+                                  mask.getRow(first), GL_RED);
+        texture.bind(false);
+    }
+
+    mask.markClean();
+}
@@ -40,6 +40,9 @@ void HMDT::GUI::GL::ProvinceRenderingView::init() {
                           Shader(Shader::Type::FRAGMENT,
                                  ShaderSources::province_selection_fragment)
                          };
+
+    initSelectionMaskTexture(m_selection_mask_texture, Texture::Unit::TEX_UNIT5);
+    initSelectionMaskTexture(m_adjacency_mask_texture, Texture::Unit::TEX_UNIT6);
 }
 
 void HMDT::GUI::GL::ProvinceRenderingView::beginRender() {
@@ -60,6 +63,8 @@ void HMDT::GUI::GL::ProvinceRenderingView::render() {
     //  But, obviously, only do so if there _is_ a selection
     if(auto selections = getOwningGLDrawingArea()->getSelections(); !selections.empty())
     {
+        updateSelectionMasks();
+
         m_selection_shader.use();
 
         setupUniforms();
@@ -73,23 +78,13 @@ void HMDT::GUI::GL::ProvinceRenderingView::render() {
         // Set up the textures
         m_selection_shader.uniform("selection", getSelectionTexture());
         m_selection_shader.uniform("label_matrix", getLabelTexture());
-
-        // All other uniforms
-        std::vector<uint32_t> selection_ids;
-        std::transform(selections.begin(),
-                       selections.end(),
-                       std::back_inserter(selection_ids),
-                       [](const auto& s) {
-                           return s.id.hash();
-                       });
-
-        m_selection_shader.uniform("province_labels", selection_ids);
-        m_selection_shader.uniform("num_selected", static_cast<uint32_t>(selection_ids.size()));
+        m_selection_shader.uniform("selection_mask", m_selection_mask_texture);
 
         m_selection_shader.uniform("selection_color", Color{ 255, 0, 0 });
 
         getSelectionTexture().activate();
         getLabelTexture().activate();
+        m_selection_mask_texture.activate();
 
         // The drawn selection is still a square, so just go ahead and use the
         //  same VAO
@@ -97,52 +92,22 @@ void HMDT::GUI::GL::ProvinceRenderingView::render() {
 
         // Render adjacencies only if we are selecting a single province
         if(getOwningGLDrawingArea()->shouldDrawAdjacencies() && selections.size() == 1) {
-            if(auto opt_project = Driver::getInstance().getProject(); opt_project) {
-                auto& map_project = opt_project->get().getMapProject();
-
-                setupUniforms();
-
-                // Set up the textures
-                m_selection_shader.uniform("selection", getSelectionTexture());
-                m_selection_shader.uniform("label_matrix", getLabelTexture());
-
-                // All other uniforms
-                std::set<uint32_t> adjacent_ids;
-                {
-                    // We only have one selection here, but do a loop anyway in case
-                    //   I change my mind on doing that later
-                    for(auto&& selection_info : selections) {
-                        if(!map_project.getProvinceProject().isValidProvinceID(selection_info.id))
-                        {
-                            WRITE_WARN("Unable to render adjacency for invalid province ID ", selection_info.id);
-                            continue;
-                        }
-
-                        const auto& selection = map_project.getProvinceProject().getProvinceForID(selection_info.id);
-
-                        std::transform(selection.adjacent_provinces.begin(),
-                                       selection.adjacent_provinces.end(),
-                                       std::inserter(adjacent_ids, adjacent_ids.begin()),
-                                       [](auto& id) -> uint32_t {
-                                           return id.hash();
-                                       });
-                    }
-                }
+            setupUniforms();
 
-                m_selection_shader.uniform("province_labels",
-                                           std::vector<uint32_t>(adjacent_ids.begin(),
-                                                                 adjacent_ids.end()));
-                m_selection_shader.uniform("num_selected", static_cast<uint32_t>(adjacent_ids.size()));
+            // Set up the textures
+            m_selection_shader.uniform("selection", getSelectionTexture());
+            m_selection_shader.uniform("label_matrix", getLabelTexture());
+            m_selection_shader.uniform("selection_mask", m_adjacency_mask_texture);
 
-                m_selection_shader.uniform("selection_color", Color{ 255, 0, 255 });
+            m_selection_shader.uniform("selection_color", Color{ 255, 0, 255 });
 
-                getSelectionTexture().activate();
-                getLabelTexture().activate();
+            getSelectionTexture().activate();
+            getLabelTexture().activate();
+            m_adjacency_mask_texture.activate();
 
-                // The drawn selection is still a square, so just go ahead and use the
-                //  same VAO
-                drawMapVAO();
-            }
+            // The drawn selection is still a square, so just go ahead and use the
+            //  same VAO
+            drawMapVAO();
         }
 
         m_selection_shader.use(false);
@@ -198,23 +163,7 @@ void HMDT::GUI::GL::ProvinceRenderingView::onMapDataChanged(std::shared_ptr<cons
 
         ////////////////////////////////////////////////////////////////////////////
 
-        m_label_texture.setTextureUnitID(Texture::Unit::TEX_UNIT1);
-
-        m_label_texture.bind();
-        {
-            WRITE_DEBUG("Building label matrix texture.");
-            m_label_texture.setWrapping(Texture::Axis::S, Texture::WrapMode::REPEAT);
-            m_label_texture.setWrapping(Texture::Axis::T, Texture::WrapMode::REPEAT);
-
-            m_label_texture.setFiltering(Texture::FilterType::MAG, Texture::Filter::NEAREST);
-            m_label_texture.setFiltering(Texture::FilterType::MIN, Texture::Filter::NEAREST);
-
-            m_label_texture.setTextureData(Texture::Format::RED32UI,
-                                           iwidth, iheight,
-                                           map_data->getLabelMatrix().lock().get(),
-                                           GL_RED_INTEGER);
-        }
-        m_label_texture.bind(false);
+        updateLabelTexture();
     }
 
     auto [iwidth, iheight] = map_data->getDimensions();
@@ -248,7 +197,101 @@ void HMDT::GUI::GL::ProvinceRenderingView::onMapDataChanged(std::shared_ptr<cons
  */
 void HMDT::GUI::GL::ProvinceRenderingView::onSelectionChanged(std::optional<IMapDrawingAreaBase::SelectionInfo> selection)
 {
-    // TODO: We should show adjacency here if that option is turned on
+    // The masks are brought up to date the next time we render, so that many
+    //   changes in a row only cost a single update
+    m_is_selection_dirty = true;
+}
+
+/**
+ * @brief Rebuilds the label texture, which holds the dense index of the
+ *        province at each pixel.
+ */
+void HMDT::GUI::GL::ProvinceRenderingView::updateLabelTexture() {
+    auto opt_project = Driver::getInstance().getProject();
+    if(!opt_project) return;
+
+    auto& province_project = opt_project->get().getMapProject().getProvinceProject();
+
+    auto map_data = province_project.getMapData();
+    auto table = province_project.getProvinceTable();
+    auto index_matrix = province_project.buildProvinceIndexMatrix(*table);
+    if(index_matrix == nullptr) return;
+
+    auto [iwidth, iheight] = map_data->getDimensions();
+
+    m_label_texture.setTextureUnitID(Texture::Unit::TEX_UNIT1);
+
+    m_label_texture.bind();
+    {
+        WRITE_DEBUG("Building province index texture.");
+        m_label_texture.setWrapping(Texture::Axis::S, Texture::WrapMode::REPEAT);
+        m_label_texture.setWrapping(Texture::Axis::T, Texture::WrapMode::REPEAT);
+
+        m_label_texture.setFiltering(Texture::FilterType::MAG, Texture::Filter::NEAREST);
+        m_label_texture.setFiltering(Texture::FilterType::MIN, Texture::Filter::NEAREST);
+
+        m_label_texture.setTextureData(Texture::Format::RED32UI,
+                                       iwidth, iheight,
+                                       index_matrix.get(),
+                                       GL_RED_INTEGER);
+    }
+    m_label_texture.bind(false);
+
+    // Every label in the texture needs a slot in each mask
+    m_indexed_province_count = table->size();
+    m_selection_mask.resize(m_indexed_province_count + 1);
+    m_adjacency_mask.resize(m_indexed_province_count + 1);
+
+    m_is_selection_dirty = true;
+}
+
+/**
+ * @brief Brings the selection and adjacency masks up to date with the current
+ *        selection, and uploads whatever changed.
+ */
+void HMDT::GUI::GL::ProvinceRenderingView::updateSelectionMasks() {
+    auto opt_project = Driver::getInstance().getProject();
+    if(!opt_project) return;
+
+    auto& province_project = opt_project->get().getMapProject().getProvinceProject();
+    auto table = province_project.getProvinceTable();
+
+    // The dense indices shift whenever provinces are added or removed
+    if(table->size() != m_indexed_province_count) {
+        updateLabelTexture();
+    }
+
+    if(m_is_selection_dirty) {
+        const auto& selections = getOwningGLDrawingArea()->getSelections();
+
+        std::vector<SelectionMask::Label> selected_labels;
+        selected_labels.reserve(selections.size());
+        for(auto&& selection : selections) {
+            if(auto index = table->getIndex(selection.id); index) {
+                selected_labels.push_back(*index + 1);
+            }
+        }
+        m_selection_mask.assign(selected_labels);
+
+        // Adjacencies are only drawn for a single selected province
+        std::vector<SelectionMask::Label> adjacent_labels;
+        if(selections.size() == 1) {
+            if(auto index = table->getIndex(selections.begin()->id); index) {
+                for(auto adjacent : table->getAdjacentProvinces(*index)) {
+                    adjacent_labels.push_back(adjacent + 1);
+                }
+            } else {
+                WRITE_WARN("Unable to render adjacency for invalid province ID ",
+                           selections.begin()->id);
+            }
+        }
+        m_adjacency_mask.assign(adjacent_labels);
+
+        m_is_selection_dirty = false;
+    }
+
+    uploadSelectionMask(m_selection_mask, m_selection_mask_texture);
+    uploadSelectionMask(m_adjacency_mask, m_adjacency_mask_texture);
 }
 
 auto HMDT::GUI::GL::ProvinceRenderingView::getPrograms() -> ProgramList {
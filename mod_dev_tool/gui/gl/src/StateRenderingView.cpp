@@ -37,6 +37,8 @@ void HMDT::GUI::GL::StateRenderingView::init() {
 
         updateStateIDTexture();
     }
+
+    initSelectionMaskTexture(m_selection_mask_texture, Texture::Unit::TEX_UNIT5);
 }
 
 void HMDT::GUI::GL::StateRenderingView::beginRender() {
@@ -86,9 +88,12 @@ void HMDT::GUI::GL::StateRenderingView::render() {
     if(m_map_data == nullptr) return;
 
     if(auto opt_project = Driver::getInstance().getProject(); opt_project) {
-        auto& map_project = opt_project->get().getMapProject();
         auto& history_project = opt_project->get().getHistoryProject();
 
+        // Upload any changes to the selection first, as uploading changes
+        //   which texture is bound
+        updateSelectionMask();
+
         getMapProgram().uniform("tex_dimensions", glm::ivec2(m_state_id_texture.getWidth(),
                                                              m_state_id_texture.getHeight()));
         getMapProgram().uniform("state_id_matrix", m_state_id_texture);
@@ -99,21 +104,8 @@ void HMDT::GUI::GL::StateRenderingView::render() {
             getMapProgram().uniform("selection", getSelectionTexture());
             getSelectionTexture().activate();
 
-            auto selections = getOwningGLDrawingArea()->getSelections();
-
-            std::set<uint32_t> selection_ids;
-            std::transform(selections.begin(), selections.end(),
-                           std::inserter(selection_ids, selection_ids.begin()),
-                           [&map_project](const auto& s) {
-                               return map_project.getProvinceProject().isValidProvinceID(s.id) ?
-                                      map_project.getProvinceProject().getProvinceForID(s.id).state :
-                                      0;
-                           });
-
-            getMapProgram().uniform("selected_state_ids",
-                                    std::vector<uint32_t>(selection_ids.begin(),
-                                                          selection_ids.end()));
-            getMapProgram().uniform("num_selected", static_cast<uint32_t>(selection_ids.size()));
+            getMapProgram().uniform("selection_mask", m_selection_mask_texture);
+            m_selection_mask_texture.activate();
         }
 
         // Render the normal map first for each state that exists
@@ -160,6 +152,33 @@ void HMDT::GUI::GL::StateRenderingView::onMapDataChanged(std::shared_ptr<const M
 void HMDT::GUI::GL::StateRenderingView::onSelectionChanged(std::optional<IMapDrawingAreaBase::SelectionInfo> selection)
 {
     // TODO: We should show adjacency here if that option is turned on
+
+    m_is_selection_dirty = true;
+}
+
+/**
+ * @brief Brings the selection mask up to date with the states of the
+ *        currently selected provinces, and uploads whatever changed.
+ */
+void HMDT::GUI::GL::StateRenderingView::updateSelectionMask() {
+    if(m_is_selection_dirty) {
+        if(auto opt_project = Driver::getInstance().getProject(); opt_project) {
+            auto& province_project = opt_project->get().getMapProject().getProvinceProject();
+
+            std::vector<SelectionMask::Label> selected_states;
+            for(auto&& selection : getOwningGLDrawingArea()->getSelections()) {
+                if(province_project.isValidProvinceID(selection.id)) {
+                    selected_states.push_back(province_project.getProvinceForID(selection.id).state);
+                }
+            }
+
+            m_selection_mask.assign(selected_states);
+        }
+
+        m_is_selection_dirty = false;
+    }
+
+    uploadSelectionMask(m_selection_mask, m_selection_mask_texture);
 }
 
 auto HMDT::GUI::GL::StateRenderingView::getStateIDMatrixTexture() -> Texture& {
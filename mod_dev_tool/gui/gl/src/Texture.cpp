@@ -108,6 +108,34 @@ void HMDT::GUI::GL::Texture::setTextureData(Format internal_format,
     m_height = height;
 }
 
+/**
+ * @brief Replaces part of the texture data already on the GPU.
+ *
+ * @details Implicitly calls bind()
+ *
+ * @param x The left edge of the region to replace
+ * @param y The top edge of the region to replace
+ * @param width The width of the region to replace
+ * @param height The height of the region to replace
+ * @param data_type The data type being passed in
+ * @param data The data to send to the GPU
+ * @param format The CPU-side format of the data
+ */
+void HMDT::GUI::GL::Texture::updateTextureData(uint32_t x, uint32_t y,
+                                               uint32_t width, uint32_t height,
+                                               uint32_t data_type,
+                                               const void* data,
+                                               uint32_t format)
+{
+    auto gl_target = targetToGLTarget(m_target);
+
+    bind();
+
+    glTexSubImage2D(gl_target, 0 /* mipmapping */,
+                    x, y, width, height, format, data_type, data);
+    HMDT_LOG_GL_ERRORS();
+}
+
 uint32_t HMDT::GUI::GL::Texture::getTextureUnitID() const {
     return m_texture_unit;
 }
@@ -2,6 +2,9 @@
 # define IMAPDRAWINGAREA_H
 
 # include <functional>
+# include <optional>
+# include <utility>
+# include <vector>
 
 # include "gdkmm/event.h"
 # include "gtkmm/widget.h"
@@ -34,6 +37,17 @@ namespace HMDT::GUI {
             };
 
             using SelectionCallback = std::function<void(uint32_t, uint32_t)>;
+
+            //! Called with the corners of a dragged-out box, and whether the
+            //!   box should add to the current selection
+            using BoxSelectionCallback = std::function<void(uint32_t, uint32_t,
+                                                            uint32_t, uint32_t,
+                                                            bool)>;
+
+            //! Called with every point of a drawn-out lasso, and whether the
+            //!   lasso should add to the current selection
+            using LassoSelectionCallback = std::function<void(const std::vector<Point2D>&,
+                                                              bool)>;
             using SelectionList = std::set<SelectionInfo, SelectionInfoLess>;
 
             enum class ZoomDirection {
@@ -72,6 +86,8 @@ namespace HMDT::GUI {
 
             void setOnProvinceSelectCallback(const SelectionCallback&);
             void setOnMultiProvinceSelectionCallback(const SelectionCallback&);
+            void setOnBoxProvinceSelectionCallback(const BoxSelectionCallback&);
+            void setOnLassoProvinceSelectionCallback(const LassoSelectionCallback&);
 
             void setSelection();
             void setSelection(const SelectionInfo&);
@@ -104,6 +120,8 @@ namespace HMDT::GUI {
 
             const SelectionCallback& getOnSelect() const;
             const SelectionCallback& getOnMultiSelect() const;
+            const BoxSelectionCallback& getOnBoxSelect() const;
+            const LassoSelectionCallback& getOnLassoSelect() const;
 
         private:
             std::shared_ptr<const MapData> m_map_data;
@@ -114,6 +132,12 @@ namespace HMDT::GUI {
             //! Called when a province is multi-selected (shift+click)
             SelectionCallback m_on_multiselect;
 
+            //! Called when a box is dragged out over the map (ctrl+drag)
+            BoxSelectionCallback m_on_box_select;
+
+            //! Called when a lasso is drawn out over the map (alt+drag)
+            LassoSelectionCallback m_on_lasso_select;
+
             //! The current selection
             SelectionList m_selections;
 
@@ -135,7 +159,9 @@ namespace HMDT::GUI {
         public:
             IMapDrawingArea() {
                 // Mark that we want to receive button presses
-                BaseGtkWidget::add_events(Gdk::BUTTON_PRESS_MASK);
+                BaseGtkWidget::add_events(Gdk::BUTTON_PRESS_MASK |
+                                          Gdk::BUTTON_RELEASE_MASK |
+                                          Gdk::BUTTON1_MOTION_MASK);
             }
 
             virtual ~IMapDrawingArea() = default;
@@ -191,6 +217,20 @@ namespace HMDT::GUI {
                     auto x = event->x * (1 / getScaleFactor());
                     auto y = event->y * (1 / getScaleFactor());
 
+                    // Start dragging out a box, which gets selected once the
+                    //   button is released
+                    if(event->state & GDK_CONTROL_MASK) {
+                        m_box_start = std::make_pair(x, y);
+                        return true;
+                    }
+
+                    // Start drawing out a lasso, which gets selected once the
+                    //   button is released
+                    if(event->state & GDK_MOD1_MASK) {
+                        m_lasso_points = { toPoint(x, y) };
+                        return true;
+                    }
+
                     if(event->state & GDK_SHIFT_MASK) {
                         getOnMultiSelect()(x, y);
                     } else {
@@ -201,9 +241,70 @@ namespace HMDT::GUI {
                 return true;
             }
 
+            virtual bool on_motion_notify_event(GdkEventMotion* event) override {
+                if(!hasData() || !m_lasso_points) {
+                    return BaseGtkWidget::on_motion_notify_event(event);
+                }
+
+                // Only keep a point each time the lasso moves onto a new pixel
+                auto point = toPoint(event->x * (1 / getScaleFactor()),
+                                     event->y * (1 / getScaleFactor()));
+                if(const auto& last = m_lasso_points->back();
+                        last.x != point.x || last.y != point.y)
+                {
+                    m_lasso_points->push_back(point);
+                }
+
+                return true;
+            }
+
+            virtual bool on_button_release_event(GdkEventButton* event) override {
+                if(!hasData() || event->button != 1) {
+                    return true;
+                }
+
+                auto x = event->x * (1 / getScaleFactor());
+                auto y = event->y * (1 / getScaleFactor());
+
+                if(m_box_start) {
+                    auto [start_x, start_y] = *m_box_start;
+                    m_box_start.reset();
+
+                    // Include the pixels under both corners
+                    getOnBoxSelect()(toPixel(std::min(start_x, x)),
+                                     toPixel(std::min(start_y, y)),
+                                     toPixel(std::max(start_x, x)) + 1,
+                                     toPixel(std::max(start_y, y)) + 1,
+                                     event->state & GDK_SHIFT_MASK);
+                } else if(m_lasso_points) {
+                    auto polygon = std::move(*m_lasso_points);
+                    m_lasso_points.reset();
+
+                    // The lasso is closed off back to where it started
+                    getOnLassoSelect()(polygon, event->state & GDK_SHIFT_MASK);
+                }
+
+                return true;
+            }
+
             virtual void setSizeRequest(int width = -1, int height = -1) {
                 BaseGtkWidget::set_size_request(width, height);
             }
+
+        private:
+            static uint32_t toPixel(double v) {
+                return v < 0 ? 0 : static_cast<uint32_t>(v);
+            }
+
+            static Point2D toPoint(double x, double y) {
+                return Point2D{ toPixel(x), toPixel(y) };
+            }
+
+            //! Where the current box selection started, if one is being made
+            std::optional<std::pair<double, double>> m_box_start;
+
+            //! Every point of the current lasso selection, if one is being made
+            std::optional<std::vector<Point2D>> m_lasso_points;
     };
 
     std::ostream& operator<<(std::ostream&,
@@ -61,6 +61,9 @@ namespace HMDT::GUI {
             void onProjectOpened();
             void onProjectClosed();
 
+            void openEditJournal();
+            void closeEditJournal();
+
             void saveProject();
             void saveProjectAs(const std::string& = "Save As...");
 
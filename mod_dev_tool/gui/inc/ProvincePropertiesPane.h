@@ -5,6 +5,9 @@
 
 # include <set>
 # include <string>
+# include <vector>
+# include <string_view>
+# include <functional>
 
 # include "gtkmm/scrolledwindow.h"
 # include "gtkmm/checkbutton.h"
@@ -23,6 +26,8 @@ namespace HMDT::GUI {
      */
     class ProvincePropertiesPane: public WidgetContainer {
         public:
+            using PropertiesChangedCallback = std::function<void(const std::vector<ProvinceID>&, std::string_view)>;
+
             ProvincePropertiesPane();
 
             Gtk::ScrolledWindow& getParent();
@@ -34,6 +39,8 @@ namespace HMDT::GUI {
             void setProvince(Province*, ProvincePreviewDrawingArea::DataPtr, bool = false);
             Province* getProvince();
 
+            void setOnPropertiesChangedCallback(const PropertiesChangedCallback&);
+
             void onResize();
 
             void updateProperties(bool);
@@ -60,10 +67,15 @@ namespace HMDT::GUI {
 
             void setPreview(ProvincePreviewDrawingArea::DataPtr);
 
+            std::function<void(const std::vector<ProvinceID>&, std::string_view)> getBulkChangedCallback();
+
         private:
             //! The province currently being acted upon
             Province* m_province;
 
+            //! Whether edits should apply to every selected province
+            bool m_is_multiselect;
+
             Gtk::Box m_box;
             Gtk::ScrolledWindow m_parent;
 
@@ -87,6 +99,9 @@ namespace HMDT::GUI {
 
             //! A list of all provinces that are merged with the currently set one
             ProvinceListWindow* m_merged_list_window;
+
+            //! Called once an edit to every selected province is done or undone
+            PropertiesChangedCallback m_on_properties_changed;
     };
 }
 
@@ -1,15 +1,28 @@
 #ifndef SELECTION_MANAGER_H
 # define SELECTION_MANAGER_H
 
-# include <set>
 # include <functional>
+# include <optional>
+# include <unordered_map>
+# include <vector>
 
 # include "Types.h"
+# include "DenseBitSet.h"
 # include "MapProject.h"
 
 namespace HMDT::GUI {
     /**
      * @brief Final singleton class which manages all selection logic
+     *
+     * @details Selections are stored as bitsets, with each province given a
+     *          dense index the first time it is seen and each state indexed
+     *          by its ID, so checking whether something is selected never
+     *          needs to walk a tree. The lists of selected IDs, provinces and
+     *          states are cached until the selection next changes.
+     *
+     * @par Bulk operations, such as selectProvinces(), fire a single
+     *      callback for the whole batch rather than one per province, so that
+     *      selecting a large region only causes a single redraw.
      */
     class SelectionManager final {
         public:
@@ -25,6 +38,17 @@ namespace HMDT::GUI {
 
             static constexpr StateID INVALID_STATE_ID = -1;
 
+            using ProvinceCallback = std::function<void(const ProvinceID&, Action)>;
+            using StateCallback = std::function<void(StateID, Action)>;
+
+            //! Called once for a whole batch of provinces
+            using BulkProvinceCallback = std::function<void(const std::vector<ProvinceID>&,
+                                                            Action)>;
+
+            //! Called once for a whole batch of states
+            using BulkStateCallback = std::function<void(const std::vector<StateID>&,
+                                                         Action)>;
+
             static SelectionManager& getInstance();
 
             void selectProvince(const ProvinceID&, bool = false);
@@ -32,6 +56,16 @@ namespace HMDT::GUI {
             void removeProvinceSelection(const ProvinceID&, bool = false);
             void clearProvinceSelection(bool = false);
 
+            void selectProvinces(const std::vector<ProvinceID>&, bool = false);
+            void removeProvinceSelections(const std::vector<ProvinceID>&);
+
+            void selectProvincesInRect(uint32_t, uint32_t, uint32_t, uint32_t,
+                                       bool = false);
+            void selectProvincesInPolygon(const std::vector<Point2D>&,
+                                          bool = false);
+
+            ProvinceID pickProvince(uint32_t, uint32_t) const;
+
             void selectState(StateID);
             void addStateSelection(StateID);
             void removeStateSelection(StateID);
@@ -39,17 +73,19 @@ namespace HMDT::GUI {
 
             RefVector<const Province> getSelectedProvinces() const;
             RefVector<Province> getSelectedProvinces();
-            const std::set<ProvinceID>& getSelectedProvinceLabels() const;
+            const std::vector<ProvinceID>& getSelectedProvinceLabels() const;
 
             RefVector<const State> getSelectedStates() const;
             RefVector<State> getSelectedStates();
-            const std::set<uint32_t>& getSelectedStateIDs() const;
+            const std::vector<StateID>& getSelectedStateIDs() const;
 
             bool isProvinceSelected(const ProvinceID&) const;
             bool isStateSelected(const StateID&) const;
 
-            void setOnSelectProvinceCallback(const std::function<void(const ProvinceID&, Action)>&);
-            void setOnSelectStateCallback(const std::function<void(StateID, Action)>&);
+            void setOnSelectProvinceCallback(const ProvinceCallback&);
+            void setOnSelectStateCallback(const StateCallback&);
+            void setOnBulkSelectProvincesCallback(const BulkProvinceCallback&);
+            void setOnBulkSelectStatesCallback(const BulkStateCallback&);
 
             size_t getSelectedProvinceCount() const;
             size_t getSelectedStateCount() const;
@@ -62,20 +98,55 @@ namespace HMDT::GUI {
         private:
             SelectionManager();
 
+            DenseBitSet::Index getProvinceIndex(const ProvinceID&);
+            std::optional<DenseBitSet::Index> findProvinceIndex(const ProvinceID&) const;
+
+            bool insertProvince(const ProvinceID&);
+            bool eraseProvince(const ProvinceID&);
+
+            void invalidateProvinceViews() noexcept;
+            bool areProvinceRefsValid(const Project::IProvinceProject&) const noexcept;
+
             OptionalReference<Project::IRootMapProject> getCurrentMapProject() const;
             OptionalReference<Project::IRootHistoryProject> getCurrentHistoryProject() const;
 
-            //! The currently selected provinces
-            std::set<ProvinceID> m_selected_provinces;
+            //! The dense index given to each province that has been seen
+            std::unordered_map<ProvinceID, DenseBitSet::Index> m_province_indices;
 
-            //! The currently selected states
-            std::set<StateID> m_selected_states;
+            //! The province for each dense index
+            std::vector<ProvinceID> m_province_ids;
+
+            //! The indices of the currently selected provinces
+            DenseBitSet m_selected_provinces;
+
+            //! The currently selected states, indexed by StateID
+            DenseBitSet m_selected_states;
+
+            //! The IDs of every selected province, built on demand
+            mutable std::vector<ProvinceID> m_selected_province_ids;
+
+            //! Whether m_selected_province_ids is up to date
+            mutable bool m_is_selected_province_ids_valid;
+
+            //! Every selected province, built on demand
+            mutable RefVector<Province> m_selected_province_refs;
+
+            //! The generation of the province list that
+            //!   m_selected_province_refs points into, or std::nullopt if it
+            //!   is not up to date
+            mutable std::optional<std::uint64_t> m_selected_province_refs_generation;
 
             //! Callback for when a province is selected
-            std::function<void(const ProvinceID&, Action)> m_on_province_selected_callback;
+            ProvinceCallback m_on_province_selected_callback;
 
             //! Callback for when a province is selected
-            std::function<void(StateID, Action)> m_on_state_selected_callback;
+            StateCallback m_on_state_selected_callback;
+
+            //! Callback for when many provinces are selected at once
+            BulkProvinceCallback m_on_provinces_selected_callback;
+
+            //! Callback for when many states are selected at once
+            BulkStateCallback m_on_states_selected_callback;
     };
 }
 
@@ -3,6 +3,10 @@
 
 # include "WidgetContainer.h"
 
+# include <vector>
+# include <string_view>
+# include <functional>
+
 # include "ProvinceListWindow.h"
 
 # include "gtkmm/scrolledwindow.h"
@@ -22,6 +26,8 @@ namespace HMDT::GUI {
      */
     class StatePropertiesPane: public WidgetContainer {
         public:
+            using PropertiesChangedCallback = std::function<void(const std::vector<StateID>&, std::string_view)>;
+
             StatePropertiesPane();
 
             Gtk::ScrolledWindow& getParent();
@@ -34,6 +40,8 @@ namespace HMDT::GUI {
 
             void onResize();
 
+            void setOnPropertiesChangedCallback(const PropertiesChangedCallback&);
+
             void updateProperties(bool);
 
         protected:
@@ -52,10 +60,15 @@ namespace HMDT::GUI {
             void buildSelectAllProvincesButton();
             void buildDeleteStateButton();
 
+            std::function<void(const std::vector<StateID>&, std::string_view)> getBulkChangedCallback();
+
         private:
             //! The state currently being acted upon
             State* m_state;
 
+            //! Whether edits should apply to every selected state
+            bool m_is_multiselect;
+
             Gtk::Box m_box;
             Gtk::ScrolledWindow m_parent;
 
@@ -72,6 +85,9 @@ namespace HMDT::GUI {
             Gtk::Button* m_delete_state_button;
 
             bool m_is_updating_properties;
+
+            //! Called once an edit to every selected state is done or undone
+            PropertiesChangedCallback m_on_properties_changed;
     };
 }
 
@@ -11,6 +11,8 @@ HMDT::GUI::IMapDrawingAreaBase::IMapDrawingAreaBase():
     m_map_data(nullptr),
     m_on_select([](auto...) { }),      // The default callback does nothing
     m_on_multiselect([](auto...) { }),
+    m_on_box_select([](auto...) { }),
+    m_on_lasso_select([](auto...) { }),
     m_selections(),
     m_scale_factor(DEFAULT_ZOOM),
     m_viewing_mode(DEFAULT_VIEWING_MODE)
@@ -67,6 +69,16 @@ void HMDT::GUI::IMapDrawingAreaBase::setOnMultiProvinceSelectionCallback(const S
     m_on_multiselect = callback;
 }
 
+void HMDT::GUI::IMapDrawingAreaBase::setOnBoxProvinceSelectionCallback(const BoxSelectionCallback& callback)
+{
+    m_on_box_select = callback;
+}
+
+void HMDT::GUI::IMapDrawingAreaBase::setOnLassoProvinceSelectionCallback(const LassoSelectionCallback& callback)
+{
+    m_on_lasso_select = callback;
+}
+
 void HMDT::GUI::IMapDrawingAreaBase::setSelection() {
     onSelectionChanged(std::nullopt);
     m_selections.clear();
@@ -160,6 +172,18 @@ auto HMDT::GUI::IMapDrawingAreaBase::getOnMultiSelect() const
     return m_on_multiselect;
 }
 
+auto HMDT::GUI::IMapDrawingAreaBase::getOnBoxSelect() const
+    -> const BoxSelectionCallback&
+{
+    return m_on_box_select;
+}
+
+auto HMDT::GUI::IMapDrawingAreaBase::getOnLassoSelect() const
+    -> const LassoSelectionCallback&
+{
+    return m_on_lasso_select;
+}
+
 auto HMDT::GUI::IMapDrawingAreaBase::getSelections() const
     -> const SelectionList&
 {
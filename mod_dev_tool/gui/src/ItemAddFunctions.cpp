@@ -12,6 +12,7 @@
 #include "MainWindow.h"
 #include "GraphicalDebugger.h"
 #include "ProgressBarDialog.h"
+#include "SelectionManager.h"
 
 namespace {
     struct AddProvinceMapData {
@@ -273,6 +274,12 @@ HMDT::MaybeVoid HMDT::GUI::endAddProvinceMap(Window& window, std::any data) {
         WRITE_DEBUG("Assigning the found data to the map project.");
         project.getMapProject().import(*apd_data.shape_finder, apd_data.map_data);
 
+        // Every province has been replaced, so nothing selected before the
+        //   import exists anymore. Forget the old selection before telling
+        //   anyone that it was cleared, so they never look up an old province.
+        SelectionManager::getInstance().onProjectLoaded();
+        SelectionManager::getInstance().clearProvinceSelection();
+
         WRITE_INFO("Calculating coastal provinces...");
         project.getMapProject().calculateCoastalProvinces();
 
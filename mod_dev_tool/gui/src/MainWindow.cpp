@@ -1,5 +1,6 @@
 #include "MainWindow.h"
 
+#include <atomic>
 #include <thread>
 #include <sstream>
 
@@ -20,6 +21,8 @@
 #include "ShapeFinder2.h" // ShapeFinder
 
 #include "ActionManager.h"
+#include "EditJournal.h"
+#include "HierarchyEdits.h"
 
 #include "GraphicalDebugger.h"
 #include "Application.h"
@@ -93,8 +96,10 @@ void HMDT::GUI::MainWindow::initializeFileActions() {
     });
     close_action->set_enabled(false);
 
-    add_action("quit", []() {
+    add_action("quit", [this]() {
         // TODO: Confirmation menu first
+        closeEditJournal();
+
         std::exit(0);
     });
 
@@ -523,6 +528,10 @@ void HMDT::GUI::MainWindow::initializeCallbacks() {
 
                                     m_drawing_area->addSelection({preview_data, province->bounding_box, province->id});
                                 }
+
+                                // Warm up the previews around the selection
+                                //   in case the user clicks on one of them next
+                                province_project.prefetchAdjacentPreviews(&province_project.getProvinceForID(prov_id));
                             }
                             m_drawing_area->queueDraw();
                         }
@@ -571,6 +580,106 @@ void HMDT::GUI::MainWindow::initializeCallbacks() {
                 }
             });
 
+        // Bulk selections update the drawing area and properties panes once
+        //   for the whole batch, rather than once per province
+        SelectionManager::getInstance().setOnBulkSelectProvincesCallback(
+            [this](const std::vector<ProvinceID>& prov_ids, SelectionManager::Action action)
+            {
+                auto& province_project = Driver::getInstance().getProject()->get().getMapProject().getProvinceProject();
+
+                WRITE_DEBUG("Updating the selection of ", prov_ids.size(),
+                            " provinces at once.");
+
+                switch(action) {
+                    case SelectionManager::Action::SET:
+                    case SelectionManager::Action::ADD:
+                        if(action == SelectionManager::Action::SET) {
+                            m_drawing_area->setSelection();
+
+                            ProvincePreviewDrawingArea::DataPtr null_data; // Do not construct
+                            getProvincePropertiesPane().setProvince(nullptr, null_data);
+                        }
+
+                        for(auto&& prov_id : prov_ids) {
+                            for(auto&& merged_prov : province_project.getMergedProvinces(prov_id)) {
+                                if(merged_prov != prov_id &&
+                                   !SelectionManager::getInstance().isProvinceSelected(merged_prov))
+                                {
+                                    SelectionManager::getInstance().addProvinceSelection(merged_prov, true);
+                                }
+
+                                auto* province = &province_project.getProvinceForID(merged_prov);
+                                auto preview_data = province_project.getPreviewData(province);
+
+                                m_drawing_area->addSelection({preview_data, province->bounding_box, province->id});
+                            }
+                        }
+
+                        // Only the first province in a brand new selection
+                        //   gets shown in the properties pane
+                        if(action == SelectionManager::Action::SET && !prov_ids.empty()) {
+                            auto* province = &province_project.getProvinceForID(prov_ids.front());
+                            getProvincePropertiesPane().setProvince(province,
+                                                                    province_project.getPreviewData(province),
+                                                                    prov_ids.size() > 1);
+                        }
+                        break;
+                    case SelectionManager::Action::REMOVE:
+                        {
+                            auto* ppp_province = getProvincePropertiesPane().getProvince();
+
+                            for(auto&& prov_id : prov_ids) {
+                                for(auto&& merged_prov : province_project.getMergedProvinces(prov_id)) {
+                                    if(ppp_province != nullptr && ppp_province->id == merged_prov) {
+                                        ProvincePreviewDrawingArea::DataPtr null_data; // Do not construct
+                                        getProvincePropertiesPane().setProvince(nullptr, null_data);
+                                        ppp_province = nullptr;
+                                    }
+
+                                    m_drawing_area->removeSelection({nullptr, {}, merged_prov});
+                                }
+                            }
+                        }
+                        break;
+                    case SelectionManager::Action::CLEAR:
+                        {
+                            ProvincePreviewDrawingArea::DataPtr null_data; // Do not construct
+                            getProvincePropertiesPane().setProvince(nullptr, null_data);
+
+                            m_drawing_area->setSelection();
+                        }
+                        break;
+                }
+
+                m_drawing_area->queueDraw();
+            });
+
+        SelectionManager::getInstance().setOnBulkSelectStatesCallback(
+            [this](const std::vector<StateID>& state_ids, SelectionManager::Action action)
+            {
+                auto& history_project = Driver::getInstance().getProject()->get().getHistoryProject();
+
+                switch(action) {
+                    case SelectionManager::Action::SET:
+                    case SelectionManager::Action::ADD:
+                        if(state_ids.empty()) {
+                            getStatePropertiesPane().setState(nullptr);
+                            break;
+                        }
+
+                        // Only show the most recently selected state
+                        history_project.getStateProject().getStateForID(state_ids.back()).andThen([this](auto state_ref)
+                        {
+                            getStatePropertiesPane().setState(&state_ref.get());
+                        });
+                        break;
+                    case SelectionManager::Action::REMOVE:
+                    case SelectionManager::Action::CLEAR:
+                        getStatePropertiesPane().setState(nullptr);
+                        break;
+                }
+            });
+
         SelectionManager::getInstance().setOnSelectStateCallback(
             [this](StateID state_id, SelectionManager::Action action)
             {
@@ -603,31 +712,83 @@ void HMDT::GUI::MainWindow::initializeCallbacks() {
 
     // ActionManager callbacks
     {
-        Action::ActionManager::getInstance().setOnDoActionCallback([this](const auto&...)
-        {
-            m_toolbar->updateUndoRedoButtons();
+        // Merge rapid successive edits of the same field (such as typing into
+        //   a text box) into a single history entry
+        Action::ActionManager::getInstance().setCoalesceWindow(std::chrono::milliseconds(500));
 
-            // Update each properties pane that an action has been performed
-            getProvincePropertiesPane().updateProperties(SelectionManager::getInstance().getSelectedProvinceCount() > 1);
-            getStatePropertiesPane().updateProperties(SelectionManager::getInstance().getSelectedStateCount() > 1);
-        });
-        Action::ActionManager::getInstance().setOnUndoActionCallback([this](const auto&...)
-        {
+        // Called whenever an action is performed, undone, or redone
+        auto on_action_update = [this](const auto&...) {
             m_toolbar->updateUndoRedoButtons();
 
-            // Update each properties pane that an action has been undone
-            getProvincePropertiesPane().updateProperties(SelectionManager::getInstance().getSelectedProvinceCount() > 1);
-            getStatePropertiesPane().updateProperties(SelectionManager::getInstance().getSelectedStateCount() > 1);
-        });
-        Action::ActionManager::getInstance().setOnRedoActionCallback([this](const auto&...)
-        {
-            m_toolbar->updateUndoRedoButtons();
+            // Any action may have changed a province, so bring the province
+            //   table up to date with it
+            if(auto opt_project = Driver::getInstance().getProject(); opt_project) {
+                opt_project->get().getMapProject().getProvinceProject().rebuildProvinceTable();
+            }
 
-            // Update each properties pane that an action has been redone
+            // Update each properties pane
             getProvincePropertiesPane().updateProperties(SelectionManager::getInstance().getSelectedProvinceCount() > 1);
             getStatePropertiesPane().updateProperties(SelectionManager::getInstance().getSelectedStateCount() > 1);
-        });
+        };
+
+        Action::ActionManager::getInstance().setOnDoActionCallback(on_action_update);
+        Action::ActionManager::getInstance().setOnUndoActionCallback(on_action_update);
+        Action::ActionManager::getInstance().setOnRedoActionCallback(on_action_update);
+
+        // Keep the hierarchy index in step with every edit, falling back to
+        //   rebuilding it if the edits change more than property values
+        Action::ActionManager::getInstance().setOnEditsCallback(
+            [](const Action::JournalDeltaList& deltas, bool is_complete) {
+                auto opt_project = Driver::getInstance().getProject();
+                if(!opt_project) return;
+
+                auto& project = opt_project->get();
 
+                std::optional<std::vector<std::string>> paths;
+                if(is_complete) {
+                    paths = Action::getChangedPropertyPaths(deltas, project);
+                }
+
+                if(paths) {
+                    project.updateHierarchyIndex(*paths);
+                } else {
+                    project.invalidateHierarchyIndex();
+                }
+            });
+
+        // Bring everything that is worked out from the edited field up to date
+        //   once per bulk edit, and only for the provinces that it touched
+        getProvincePropertiesPane().setOnPropertiesChangedCallback(
+            [](const std::vector<ProvinceID>& ids, std::string_view field) {
+                auto opt_project = Driver::getInstance().getProject();
+                if(!opt_project) return;
+
+                auto& map_project = opt_project->get().getMapProject();
+
+                // Only these provinces and their neighbors can have become (or
+                //   stopped being) coastal
+                if(field == "type") {
+                    // The table is otherwise only rebuilt once the action has
+                    //   finished, but it must already hold the new types
+                    map_project.getProvinceProject().rebuildProvinceTable();
+                    map_project.calculateCoastalProvinces(ids);
+                }
+            });
+
+        // Make sure that edits never sit in the journal's buffer for too long,
+        //   even if no more edits are made to push them out
+        auto flush_interval = std::chrono::duration_cast<std::chrono::seconds>(
+                Action::EditJournal::FLUSH_INTERVAL);
+        Glib::signal_timeout().connect_seconds([]() {
+            if(const auto& journal = Action::ActionManager::getInstance().getJournal();
+                    journal != nullptr)
+            {
+                auto result = journal->flush();
+                WRITE_IF_ERROR(result);
+            }
+
+            return true;
+        }, flush_interval.count());
     }
 }
 
@@ -708,6 +869,9 @@ void HMDT::GUI::MainWindow::newProject() {
 
             // TODO: If a project is already open, make sure we close it first
 
+            // Any project being replaced is being closed on purpose
+            closeEditJournal();
+
             Driver::getInstance().setProject(std::move(project));
 
             // We are technically "opening" the project by creating it
@@ -755,6 +919,42 @@ void HMDT::GUI::MainWindow::openProject() {
             err_diag.run();
             return;
         }
+
+        // Any project being replaced is being closed on purpose
+        closeEditJournal();
+
+        // A journal is only left holding edits if the program did not shut
+        //   down cleanly, so offer to recover them
+        auto journal_path = project->getMetaRoot() / EDIT_JOURNAL_FILENAME;
+        if(auto deltas = Action::EditJournal::read(journal_path);
+                IS_SUCCESS(deltas) && !deltas->empty())
+        {
+            std::stringstream message_ss;
+            message_ss << deltas->size()
+                       << gettext(" edits were made after the project was last saved, but were never saved. Recover them?");
+
+            Gtk::MessageDialog dialog(*this, message_ss.str(), false,
+                                      Gtk::MESSAGE_QUESTION,
+                                      Gtk::BUTTONS_YES_NO);
+
+            if(dialog.run() == Gtk::RESPONSE_YES) {
+                if(auto num_recovered = Action::EditJournal::replay(journal_path, *project);
+                        IS_FAILURE(num_recovered))
+                {
+                    WRITE_ERROR("Failed to recover unsaved edits from ", journal_path);
+                }
+            } else {
+                WRITE_INFO("Discarding ", deltas->size(), " unsaved edits from ",
+                           journal_path);
+
+                std::error_code ec;
+                std::filesystem::remove(journal_path, ec);
+                if(ec) {
+                    WRITE_ERROR("Failed to remove journal ", journal_path,
+                                ". Reason: ", ec.message());
+                }
+            }
+        }
     }
 
     if(project->getToolVersion() != TOOL_VERSION) {
@@ -797,6 +997,10 @@ void HMDT::GUI::MainWindow::onProjectOpened() {
     getAction("generate_template_rivers")->set_enabled(true);
     getAction("add_item")->set_enabled(true);
 
+    SelectionManager::getInstance().onProjectLoaded();
+
+    openEditJournal();
+
     // Issue callback to the properties pane to inform it that a project has
     //   been opened
     MainWindowPropertiesPanePart::onProjectOpened();
@@ -821,7 +1025,11 @@ void HMDT::GUI::MainWindow::onProjectClosed() {
     getAction("generate_template_rivers")->set_enabled(false);
     getAction("add_item")->set_enabled(false);
 
+    closeEditJournal();
+
     {
+        SelectionManager::getInstance().onProjectUnloaded();
+
         ProvincePreviewDrawingArea::DataPtr null_data; // Do not construct
         getProvincePropertiesPane().setProvince(nullptr, null_data);
 
@@ -830,15 +1038,119 @@ void HMDT::GUI::MainWindow::onProjectClosed() {
     }
 }
 
+/**
+ * @brief Starts recording every edit into the journal of the currently set
+ *        Driver project, replacing any journal which was already open.
+ */
+void HMDT::GUI::MainWindow::openEditJournal() {
+    auto& action_manager = Action::ActionManager::getInstance();
+
+    // Close the old journal first, in case it is the same file
+    action_manager.setJournal(nullptr);
+
+    if(auto opt_project = Driver::getInstance().getProject(); opt_project) {
+        auto journal_path = opt_project->get().getMetaRoot() / EDIT_JOURNAL_FILENAME;
+
+        auto journal = Action::EditJournal::open(journal_path);
+        if(IS_FAILURE(journal)) {
+            WRITE_ERROR("Failed to open edit journal ", journal_path,
+                        ". Unsaved edits will not be recoverable.");
+            return;
+        }
+
+        action_manager.setJournal(*journal);
+    }
+}
+
+/**
+ * @brief Stops recording edits, and drops every edit in the journal.
+ * @details Only called when the project is closed on purpose, as any edits
+ *          which were not saved by then were not meant to be kept. The
+ *          journal is only left behind if the program stops without getting
+ *          here, which is what tells openProject() to offer to recover it.
+ */
+void HMDT::GUI::MainWindow::closeEditJournal() {
+    auto& action_manager = Action::ActionManager::getInstance();
+
+    if(const auto& journal = action_manager.getJournal(); journal != nullptr) {
+        auto result = journal->clear();
+        WRITE_IF_ERROR(result);
+    }
+
+    action_manager.setJournal(nullptr);
+}
+
 /**
  * @brief Saves the currently set Driver project (if one is in fact set)
+ * @details The project is written in the background, so the UI stays
+ *          responsive while large maps are saved.
  */
 void HMDT::GUI::MainWindow::saveProject() {
     if(auto opt_project = Driver::getInstance().getProject(); opt_project) {
         auto& project = opt_project->get();
 
-        // Make sure the user is notified if we failed to save the project
-        if(IS_FAILURE(project.save())) {
+        auto failed = std::make_shared<std::atomic_bool>(false);
+
+        // Every edit made so far will be in the save, so once it has been
+        //   written they no longer need to be kept in the journal
+        auto journal = Action::ActionManager::getInstance().getJournal();
+        auto journal_sequence = journal != nullptr ? journal->getSequence() : 0;
+        auto discardSavedEdits = [journal, journal_sequence]() {
+            if(journal != nullptr) {
+                auto result = journal->discardThrough(journal_sequence);
+                WRITE_IF_ERROR(result);
+            }
+        };
+
+        // Make sure the user is notified if we failed to save the project.
+        //   This has to happen on the UI thread, so set up a dispatcher for
+        //   the save to notify once it has finished.
+        auto maybe_dispatcher_id = setupDispatcher([this, failed](uint32_t dispatch_id) -> void {
+            if(*failed) {
+                Gtk::MessageDialog dialog(*this, gettext("Failed to save file."),
+                                          false, Gtk::MESSAGE_ERROR);
+                dialog.run();
+            }
+
+            // remove ourselves
+            auto res = teardownDispatcher(dispatch_id);
+            WRITE_IF_ERROR(res);
+        });
+
+        // If we can't be told when the save finishes, then just save normally
+        if(IS_FAILURE(maybe_dispatcher_id)) {
+            WRITE_IF_ERROR(maybe_dispatcher_id);
+
+            if(IS_FAILURE(project.save())) {
+                Gtk::MessageDialog dialog(*this, gettext("Failed to save file."), false,
+                                          Gtk::MESSAGE_ERROR);
+                dialog.run();
+            } else {
+                discardSavedEdits();
+            }
+            return;
+        }
+
+        auto save_dispatcher_id = *maybe_dispatcher_id;
+
+        auto res = project.saveAsync([this, failed, save_dispatcher_id,
+                                      discardSavedEdits](Project::HoI4Project::SaveResult result)
+        {
+            *failed = IS_FAILURE(result);
+
+            if(!*failed) {
+                WRITE_INFO("Saved ", result->size(), " files.");
+                discardSavedEdits();
+            }
+
+            auto res = notifyDispatcher(save_dispatcher_id);
+            WRITE_IF_ERROR(res);
+        });
+
+        if(IS_FAILURE(res)) {
+            auto teardown_res = teardownDispatcher(save_dispatcher_id);
+            WRITE_IF_ERROR(teardown_res);
+
             Gtk::MessageDialog dialog(*this, gettext("Failed to save file."), false,
                                       Gtk::MESSAGE_ERROR);
             dialog.run();
@@ -871,6 +1183,9 @@ void HMDT::GUI::MainWindow::saveProjectAs(const std::string& dtitle) {
 
                     project.setPathAndName(paths.front());
                     saveProject();
+
+                    // Edits from now on belong to the project at its new path
+                    openEditJournal();
               }).show();
     }
 }
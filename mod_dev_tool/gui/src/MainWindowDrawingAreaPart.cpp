@@ -24,7 +24,6 @@ void HMDT::GUI::MainWindowDrawingAreaPart::MainWindowDrawingAreaPart::buildDrawi
                 auto& history_project = project.getHistoryProject();
 
                 auto map_data = project.getMapProject().getMapData();
-                auto lmatrix = map_data->getProvinces().lock();
 
                 // If the click happens outside of the bounds of the image, then
                 //   deselect the province
@@ -34,8 +33,8 @@ void HMDT::GUI::MainWindowDrawingAreaPart::MainWindowDrawingAreaPart::buildDrawi
                     return;
                 }
 
-                // Get the label for the pixel that got clicked on
-                auto label = lmatrix[xyToIndex(map_data->getWidth(), x, y)];
+                // Get the province for the pixel that got clicked on
+                auto label = SelectionManager::getInstance().pickProvince(x, y);
 
                 WRITE_DEBUG("Selecting province with ID ", label);
                 SelectionManager::getInstance().selectProvince(label);
@@ -68,28 +67,17 @@ void HMDT::GUI::MainWindowDrawingAreaPart::MainWindowDrawingAreaPart::buildDrawi
                 auto& map_project = project.getMapProject();
 
                 auto map_data = map_project.getMapData();
-                auto lmatrix = map_data->getProvinces().lock();
 
                 // Multiselect out of bounds will simply not add to the selections
                 if(x > map_data->getWidth() || y > map_data->getHeight()) {
                     return;
                 }
 
-                auto label = lmatrix[xyToIndex(map_data->getWidth(), x, y)];
+                auto label = SelectionManager::getInstance().pickProvince(x, y);
 
                 // Go over the list of already selected provinces and check if
                 //  we have clicked on one that is _already_ selected
-                const auto& selected_labels = SelectionManager::getInstance().getSelectedProvinceLabels();
-                bool is_already_selected = selected_labels.count(label);
-
-                // Perform a check here to make sure we don't go over the maximum
-                //   number of selectable provinces if we are not deselecting one
-                if(!is_already_selected && selected_labels.size() == MAX_SELECTED_PROVINCES)
-                {
-                    WRITE_WARN("Maximum number of provinces selected! Cannot select more than ",
-                               MAX_SELECTED_PROVINCES, " at once!");
-                    return;
-                }
+                bool is_already_selected = SelectionManager::getInstance().isProvinceSelected(label);
 
                 // Do not mark this province as selected if we are deselecting it
                 if(is_already_selected) {
@@ -109,6 +97,23 @@ void HMDT::GUI::MainWindowDrawingAreaPart::MainWindowDrawingAreaPart::buildDrawi
                 }
             }
         });
+
+        drawing_area->setOnBoxProvinceSelectionCallback([](uint32_t x0, uint32_t y0,
+                                                           uint32_t x1, uint32_t y1,
+                                                           bool add)
+        {
+            WRITE_DEBUG("Selecting every province in (", x0, ',', y0, ")->(",
+                        x1, ',', y1, ')');
+            SelectionManager::getInstance().selectProvincesInRect(x0, y0, x1, y1, add);
+        });
+
+        drawing_area->setOnLassoProvinceSelectionCallback([](const std::vector<Point2D>& polygon,
+                                                             bool add)
+        {
+            WRITE_DEBUG("Selecting every province in a lasso of ",
+                        polygon.size(), " points");
+            SelectionManager::getInstance().selectProvincesInPolygon(polygon, add);
+        });
     };
 
     // Setup each drawing area type
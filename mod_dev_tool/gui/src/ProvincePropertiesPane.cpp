@@ -13,6 +13,7 @@
 
 #include "ActionManager.h"
 #include "SetPropertyAction.h"
+#include "BulkSetPropertyAction.h"
 #include "CreateRemoveContinentAction.h"
 
 #include "Driver.h"
@@ -20,8 +21,10 @@
 
 HMDT::GUI::ProvincePropertiesPane::ProvincePropertiesPane():
     m_province(nullptr),
+    m_is_multiselect(false),
     m_box(Gtk::ORIENTATION_VERTICAL),
-    m_is_updating_properties(false)
+    m_is_updating_properties(false),
+    m_on_properties_changed([](const auto&...) { })
 { }
 
 Gtk::ScrolledWindow& HMDT::GUI::ProvincePropertiesPane::getParent() {
@@ -75,7 +78,17 @@ void HMDT::GUI::ProvincePropertiesPane::buildIsCoastalField() {
     m_is_coastal_button->signal_toggled().connect([this]() {
         if(m_is_updating_properties) return;
 
-        if(m_province != nullptr) {
+        // Once clicked, the button holds a single value for every province
+        m_is_coastal_button->set_inconsistent(false);
+
+        if(m_province != nullptr && m_is_multiselect) {
+            Action::ActionManager::getInstance().doAction(
+                NewBulkSetPropertyActionWithCallback(SelectionManager::getInstance().getSelectedProvinces(),
+                                                     coastal,
+                                                     m_is_coastal_button->get_active(),
+                                                     getBulkChangedCallback())
+            );
+        } else if(m_province != nullptr) {
             Action::ActionManager::getInstance().doAction(
                 NewSetPropertyAction(m_province, coastal,
                                      m_is_coastal_button->get_active())
@@ -101,8 +114,14 @@ void HMDT::GUI::ProvincePropertiesPane::buildProvinceTypeField() {
         if(m_province != nullptr) {
             // Only set the province type if it is set to a valid one
             if(auto current = m_provtype_menu->get_active_row_number();
-                    current != -1)
+                    current != -1 && m_is_multiselect)
             {
+                Action::ActionManager::getInstance().doAction(
+                    NewBulkSetPropertyActionWithCallback(SelectionManager::getInstance().getSelectedProvinces(),
+                                                         type,
+                                                         static_cast<ProvinceType>(current + 1),
+                                                         getBulkChangedCallback()));
+            } else if(current != -1) {
                 Action::ActionManager::getInstance().doAction(
                     NewSetPropertyAction(m_province, type,
                                          static_cast<ProvinceType>(current + 1)));
@@ -134,9 +153,17 @@ void HMDT::GUI::ProvincePropertiesPane::buildTerrainTypeField() {
 
         if(m_province != nullptr) {
             // TODO: Verify that the active text is a valid terrain type
-            Action::ActionManager::getInstance().doAction(
-                NewSetPropertyAction(m_province, terrain,
-                                     m_terrain_menu->get_active_text()));
+            if(m_is_multiselect) {
+                Action::ActionManager::getInstance().doAction(
+                    NewBulkSetPropertyActionWithCallback(SelectionManager::getInstance().getSelectedProvinces(),
+                                                         terrain,
+                                                         m_terrain_menu->get_active_text(),
+                                                         getBulkChangedCallback()));
+            } else {
+                Action::ActionManager::getInstance().doAction(
+                    NewSetPropertyAction(m_province, terrain,
+                                         m_terrain_menu->get_active_text()));
+            }
         }
     });
 }
@@ -150,7 +177,13 @@ void HMDT::GUI::ProvincePropertiesPane::buildContinentField() {
     m_continent_menu->signal_changed().connect([this]() {
         if(m_is_updating_properties) return;
 
-        if(m_province != nullptr) {
+        if(m_province != nullptr && m_is_multiselect) {
+            Action::ActionManager::getInstance().doAction(
+                NewBulkSetPropertyActionWithCallback(SelectionManager::getInstance().getSelectedProvinces(),
+                                                     continent,
+                                                     m_continent_menu->get_active_text(),
+                                                     getBulkChangedCallback()));
+        } else if(m_province != nullptr) {
             Action::ActionManager::getInstance().doAction(
                 NewSetPropertyAction(m_province, continent,
                                      m_continent_menu->get_active_text()));
@@ -301,8 +334,13 @@ void HMDT::GUI::ProvincePropertiesPane::buildStateCreationButton() {
             auto& history_project = opt_project->get().getHistoryProject();
 
             auto selected = SelectionManager::getInstance().getSelectedProvinceLabels();
-            auto id = history_project.getStateProject().addNewState(std::vector<ProvinceID>(selected.begin(),
-                                                                                            selected.end()));
+            std::vector<ProvinceID> provinces(selected.begin(), selected.end());
+
+            auto id = history_project.getStateProject().addNewState(provinces);
+            Action::ActionManager::getInstance().recordEdits({
+                Action::JournalDelta::createState(id, provinces)
+            });
+
             SelectionManager::getInstance().selectState(id);
 
             // TODO: If we have a State view, we should switch to it here
@@ -333,13 +371,20 @@ void HMDT::GUI::ProvincePropertiesPane::buildMergeProvincesButton() {
                 return;
             }
 
+            Action::JournalDeltaList merges;
             for(; it != selected.end(); ++it) {
                 // Merge all selected provinces together (but take care not to
                 //   merge the root into itself
                 if(*it != root_id->get().id) {
-                    province_project.mergeProvinces(root_id->get().id, *it);
+                    if(auto result = province_project.mergeProvinces(root_id->get().id, *it);
+                       !IS_FAILURE(result))
+                    {
+                        merges.push_back(Action::JournalDelta::mergeProvinces(root_id->get().id,
+                                                                              *it));
+                    }
                 }
             }
+            Action::ActionManager::getInstance().recordEdits(merges);
 
             // Re-select the merged province now to update the pane.
             //   We only need to do this on one of them, and it will trigger the
@@ -395,6 +440,10 @@ void HMDT::GUI::ProvincePropertiesPane::buildMergedListWindow() {
                         {
                             WRITE_ERROR("Failed with error to unmerge province ",
                                         id, " from its parent.");
+                        } else {
+                            Action::ActionManager::getInstance().recordEdits({
+                                Action::JournalDelta::unmergeProvince(id)
+                            });
                         }
                     } else {
                         WRITE_WARN("Invalid province ID ", id, ". Cannot unmerge.");
@@ -461,14 +510,20 @@ void HMDT::GUI::ProvincePropertiesPane::setProvince(Province* prov,
                                                     bool is_multiselect)
 {
     m_province = prov;
+    m_is_multiselect = is_multiselect;
 
     setPreview(preview_data);
 
     setEnabled(m_province != nullptr && !is_multiselect);
 
-    // Set this to be enabled afterwards without worrying about multiselect
-    if(is_multiselect) {
-        m_create_state_button->set_sensitive(m_province != nullptr);
+    // Only fields which can be set on every selected province at once are
+    //   enabled for a multi-selection
+    if(m_province != nullptr && is_multiselect) {
+        m_is_coastal_button->set_sensitive(true);
+        m_provtype_menu->set_sensitive(true);
+        m_terrain_menu->set_sensitive(true);
+        m_continent_menu->set_sensitive(true);
+        m_create_state_button->set_sensitive(true);
     }
 
     updateProperties(prov, is_multiselect);
@@ -478,6 +533,38 @@ auto HMDT::GUI::ProvincePropertiesPane::getProvince() -> Province* {
     return m_province;
 }
 
+/**
+ * @brief Sets the callback to be called whenever an edit made through this
+ *        pane has been applied to (or reverted on) every selected province
+ *
+ * @param callback The callback, which is given the ID of every province that was
+ *                 changed and the name of the field that was changed on them
+ */
+void HMDT::GUI::ProvincePropertiesPane::setOnPropertiesChangedCallback(const PropertiesChangedCallback& callback)
+{
+    m_on_properties_changed = callback;
+}
+
+/**
+ * @brief Gets the callback given to every bulk edit made through this pane.
+ * @details Bulk edits can be undone long after the selection has changed, so
+ *          this re-reads the current selection rather than the provinces that
+ *          were edited.
+ *
+ * @return A callback which passes the change on to everyone listening to
+ *         this pane, and then refreshes it
+ */
+auto HMDT::GUI::ProvincePropertiesPane::getBulkChangedCallback()
+    -> std::function<void(const std::vector<ProvinceID>&, std::string_view)>
+{
+    return [this](const std::vector<ProvinceID>& ids, std::string_view field) {
+        // Listeners may change more fields in response, so only refresh
+        //   once they are done
+        m_on_properties_changed(ids, field);
+        updateProperties(SelectionManager::getInstance().getSelectedProvinceCount() > 1);
+    };
+}
+
 void HMDT::GUI::ProvincePropertiesPane::setPreview(ProvincePreviewDrawingArea::DataPtr preview_data)
 {
     if(m_province == nullptr) {
@@ -508,7 +595,38 @@ void HMDT::GUI::ProvincePropertiesPane::updateProperties(const Province* prov,
 {
     m_is_updating_properties = true;
 
-    if(prov == nullptr || is_multiselect) {
+    m_is_coastal_button->set_inconsistent(false);
+
+    if(prov != nullptr && is_multiselect) {
+        // Show the value shared by every selected province, or nothing at all
+        //   if they don't all share the same value
+        auto selected = SelectionManager::getInstance().getSelectedProvinces();
+
+        if(auto coastal = getCommonValue(selected, &Province::coastal); coastal) {
+            m_is_coastal_button->set_active(*coastal);
+        } else {
+            m_is_coastal_button->set_active(false);
+            m_is_coastal_button->set_inconsistent(true);
+        }
+
+        if(auto type = getCommonValue(selected, &Province::type); type) {
+            m_provtype_menu->set_active(static_cast<int>(*type) - 1);
+        } else {
+            m_provtype_menu->set_active(-1);
+        }
+
+        if(auto terrain = getCommonValue(selected, &Province::terrain); terrain) {
+            m_terrain_menu->set_active_text(terrain->empty() ? "unknown" : terrain->c_str());
+        } else {
+            m_terrain_menu->set_active(-1);
+        }
+
+        if(auto continent = getCommonValue(selected, &Province::continent); continent) {
+            m_continent_menu->set_active_text(continent->empty() ? "None" : continent->c_str());
+        } else {
+            m_continent_menu->set_active(-1);
+        }
+    } else if(prov == nullptr) {
         // Set every field to some sort of sane default
         m_is_coastal_button->set_active(false);
         m_provtype_menu->set_active(0);
@@ -2,9 +2,13 @@
 #include "SelectionManager.h"
 
 #include <algorithm>
+#include <utility>
 
 #include "Driver.h"
 #include "Constants.h"
+#include "Logger.h"
+#include "Util.h"
+#include "MapData.h"
 
 auto HMDT::GUI::SelectionManager::getInstance() -> SelectionManager& {
     static SelectionManager instance;
@@ -22,7 +26,9 @@ void HMDT::GUI::SelectionManager::selectProvince(const ProvinceID& label,
         if(!skip_callback) {
             m_on_province_selected_callback(label, Action::SET);
         }
-        m_selected_provinces = {label};
+        m_selected_provinces.clear();
+        invalidateProvinceViews();
+        insertProvince(label);
     }
 }
 
@@ -36,7 +42,7 @@ void HMDT::GUI::SelectionManager::addProvinceSelection(const ProvinceID& label,
         if(!skip_callback) {
             m_on_province_selected_callback(label, Action::ADD);
         }
-        m_selected_provinces.insert(label);
+        insertProvince(label);
     }
 }
 
@@ -46,7 +52,7 @@ void HMDT::GUI::SelectionManager::removeProvinceSelection(const ProvinceID& labe
     if(!skip_callback) {
         m_on_province_selected_callback(label, Action::REMOVE);
     }
-    m_selected_provinces.erase(label);
+    eraseProvince(label);
 }
 
 void HMDT::GUI::SelectionManager::clearProvinceSelection(bool skip_callback) {
@@ -54,6 +60,165 @@ void HMDT::GUI::SelectionManager::clearProvinceSelection(bool skip_callback) {
         m_on_province_selected_callback(INVALID_PROVINCE, Action::CLEAR);
     }
     m_selected_provinces.clear();
+    invalidateProvinceViews();
+}
+
+/**
+ * @brief Selects many provinces at once, along with the states they are in.
+ * @details Unlike calling addProvinceSelection() for each province, the bulk
+ *          callbacks are only called once for the whole batch, after the
+ *          selection has been changed.
+ *
+ * @param provinces The provinces to select
+ * @param add Whether to add to the current selection rather than replace it
+ */
+void HMDT::GUI::SelectionManager::selectProvinces(const std::vector<ProvinceID>& provinces,
+                                                  bool add)
+{
+    auto opt_mproj = getCurrentMapProject();
+    if(!opt_mproj) return;
+
+    auto& province_project = opt_mproj->get().getProvinceProject();
+    auto opt_hproj = getCurrentHistoryProject();
+
+    if(!add) {
+        m_selected_provinces.clear();
+        m_selected_states.clear();
+        invalidateProvinceViews();
+    }
+
+    std::vector<ProvinceID> added_provinces;
+    std::vector<StateID> added_states;
+
+    for(auto&& id : provinces) {
+        if(!province_project.isValidProvinceID(id) || isProvinceSelected(id)) {
+            continue;
+        }
+
+        insertProvince(id);
+        added_provinces.push_back(id);
+
+        auto state_id = province_project.getProvinceForID(id).state;
+        if(opt_hproj &&
+           opt_hproj->get().getStateProject().isValidStateID(state_id) &&
+           m_selected_states.set(state_id))
+        {
+            added_states.push_back(state_id);
+        }
+    }
+
+    // A replaced selection always needs to be reported, even if nothing new
+    //   was selected, since everything that was selected before is now gone
+    if(!add) {
+        m_on_provinces_selected_callback(added_provinces, Action::SET);
+        m_on_states_selected_callback(added_states, Action::SET);
+    } else {
+        if(!added_provinces.empty()) {
+            m_on_provinces_selected_callback(added_provinces, Action::ADD);
+        }
+        if(!added_states.empty()) {
+            m_on_states_selected_callback(added_states, Action::ADD);
+        }
+    }
+}
+
+/**
+ * @brief Deselects many provinces at once, calling the bulk province callback
+ *        only once for the whole batch.
+ *
+ * @param provinces The provinces to deselect
+ */
+void HMDT::GUI::SelectionManager::removeProvinceSelections(const std::vector<ProvinceID>& provinces)
+{
+    std::vector<ProvinceID> removed_provinces;
+
+    for(auto&& id : provinces) {
+        if(eraseProvince(id)) {
+            removed_provinces.push_back(id);
+        }
+    }
+
+    if(!removed_provinces.empty()) {
+        m_on_provinces_selected_callback(removed_provinces, Action::REMOVE);
+    }
+}
+
+/**
+ * @brief Selects every province with at least one pixel in a rectangle
+ *
+ * @param x0 The left edge of the rectangle
+ * @param y0 The top edge of the rectangle
+ * @param x1 One past the right edge of the rectangle
+ * @param y1 One past the bottom edge of the rectangle
+ * @param add Whether to add to the current selection rather than replace it
+ */
+void HMDT::GUI::SelectionManager::selectProvincesInRect(uint32_t x0, uint32_t y0,
+                                                        uint32_t x1, uint32_t y1,
+                                                        bool add)
+{
+    if(auto opt_mproj = getCurrentMapProject(); opt_mproj) {
+        const auto& spatial_index = opt_mproj->get().getProvinceProject().getSpatialIndex();
+
+        selectProvinces(spatial_index.queryRect(x0, y0, x1, y1), add);
+    }
+}
+
+/**
+ * @brief Selects every province with at least one pixel inside of a lasso
+ *
+ * @param polygon The points of the lasso, in order
+ * @param add Whether to add to the current selection rather than replace it
+ */
+void HMDT::GUI::SelectionManager::selectProvincesInPolygon(const std::vector<Point2D>& polygon,
+                                                           bool add)
+{
+    if(auto opt_mproj = getCurrentMapProject(); opt_mproj) {
+        const auto& spatial_index = opt_mproj->get().getProvinceProject().getSpatialIndex();
+
+        selectProvinces(spatial_index.queryPolygon(polygon), add);
+    }
+}
+
+/**
+ * @brief Finds which province a pixel on the map belongs to.
+ * @details If the pixel does not belong to any province (such as a border
+ *          pixel left over from shape finding), then the closest province is
+ *          picked instead, so long as it is within MAX_PROVINCE_PICK_DISTANCE.
+ *
+ * @param x The x coordinate of the pixel
+ * @param y The y coordinate of the pixel
+ *
+ * @return The picked province, or INVALID_PROVINCE if there is none
+ */
+auto HMDT::GUI::SelectionManager::pickProvince(uint32_t x, uint32_t y) const
+    -> ProvinceID
+{
+    auto opt_mproj = getCurrentMapProject();
+    if(!opt_mproj) {
+        return INVALID_PROVINCE;
+    }
+
+    const auto& province_project = opt_mproj->get().getProvinceProject();
+    auto map_data = opt_mproj->get().getMapData();
+
+    if(x >= map_data->getWidth() || y >= map_data->getHeight()) {
+        return INVALID_PROVINCE;
+    }
+
+    auto label = map_data->getProvinces().lock()[xyToIndex(map_data->getWidth(), x, y)];
+    if(province_project.isValidProvinceID(label)) {
+        return label;
+    }
+
+    if(auto nearest = province_project.getSpatialIndex().queryNearest(x, y, 1);
+            !nearest.empty() && nearest.front().second <= MAX_PROVINCE_PICK_DISTANCE)
+    {
+        WRITE_DEBUG("No province at (", x, ',', y, "), picking ",
+                    nearest.front().first, " instead.");
+        return nearest.front().first;
+    }
+
+    return INVALID_PROVINCE;
 }
 
 void HMDT::GUI::SelectionManager::selectState(StateID state_id) {
@@ -62,7 +227,8 @@ void HMDT::GUI::SelectionManager::selectState(StateID state_id) {
             opt_hproj && opt_hproj->get().getStateProject().isValidStateID(state_id))
     {
         m_on_state_selected_callback(state_id, Action::SET);
-        m_selected_states = {state_id};
+        m_selected_states.clear();
+        m_selected_states.set(state_id);
     }
 }
 
@@ -72,13 +238,13 @@ void HMDT::GUI::SelectionManager::addStateSelection(StateID state_id) {
             opt_hproj && opt_hproj->get().getStateProject().isValidStateID(state_id))
     {
         m_on_state_selected_callback(state_id, Action::ADD);
-        m_selected_states.insert(state_id);
+        m_selected_states.set(state_id);
     }
 }
 
 void HMDT::GUI::SelectionManager::removeStateSelection(StateID state_id) {
     m_on_state_selected_callback(state_id, Action::REMOVE);
-    m_selected_states.erase(state_id);
+    m_selected_states.reset(state_id);
 }
 
 void HMDT::GUI::SelectionManager::clearStateSelection() {
@@ -86,22 +252,43 @@ void HMDT::GUI::SelectionManager::clearStateSelection() {
     m_selected_states.clear();
 }
 
-void HMDT::GUI::SelectionManager::setOnSelectProvinceCallback(const std::function<void(const ProvinceID&, Action)>& on_province_selected_callback)
+void HMDT::GUI::SelectionManager::setOnSelectProvinceCallback(const ProvinceCallback& on_province_selected_callback)
 {
     m_on_province_selected_callback = on_province_selected_callback;
 }
 
-void HMDT::GUI::SelectionManager::setOnSelectStateCallback(const std::function<void(StateID, Action)>& on_state_selected_callback)
+void HMDT::GUI::SelectionManager::setOnSelectStateCallback(const StateCallback& on_state_selected_callback)
 {
     m_on_state_selected_callback = on_state_selected_callback;
 }
 
+/**
+ * @brief Sets the callback for when many provinces are selected or deselected
+ *        at once.
+ * @details If this is never set, then the single province callback is called
+ *          for each province instead.
+ */
+void HMDT::GUI::SelectionManager::setOnBulkSelectProvincesCallback(const BulkProvinceCallback& on_provinces_selected_callback)
+{
+    m_on_provinces_selected_callback = on_provinces_selected_callback;
+}
+
+/**
+ * @brief Sets the callback for when many states are selected at once
+ * @details If this is never set, then the single state callback is called for
+ *          each state instead.
+ */
+void HMDT::GUI::SelectionManager::setOnBulkSelectStatesCallback(const BulkStateCallback& on_states_selected_callback)
+{
+    m_on_states_selected_callback = on_states_selected_callback;
+}
+
 size_t HMDT::GUI::SelectionManager::getSelectedProvinceCount() const {
-    return m_selected_provinces.size();
+    return m_selected_provinces.count();
 }
 
 size_t HMDT::GUI::SelectionManager::getSelectedStateCount() const {
-    return m_selected_states.size();
+    return m_selected_states.count();
 }
 
 /**
@@ -112,16 +299,26 @@ size_t HMDT::GUI::SelectionManager::getSelectedStateCount() const {
 auto HMDT::GUI::SelectionManager::getSelectedProvinces() const
     -> RefVector<const Province>
 {
-    RefVector<const Province> provinces;
+    auto opt_mproj = getCurrentMapProject();
+    if(!opt_mproj) {
+        return {};
+    }
 
-    if(auto opt_mproj = getCurrentMapProject(); opt_mproj)
-    {
-        auto& mproj = opt_mproj->get();
-        std::transform(m_selected_provinces.begin(), m_selected_provinces.end(),
-                       std::back_inserter(provinces),
-                       [&mproj](const ProvinceID& prov_id) {
-                           return std::ref(mproj.getProvinceProject().getProvinceForID(prov_id));
-                       });
+    const auto& province_project = std::as_const(opt_mproj->get()).getProvinceProject();
+
+    if(areProvinceRefsValid(province_project)) {
+        return RefVector<const Province>(m_selected_province_refs.begin(),
+                                         m_selected_province_refs.end());
+    }
+
+    // Look the provinces up without filling in the cache, as that would need
+    //   mutable access to the provinces
+    const auto& labels = getSelectedProvinceLabels();
+
+    RefVector<const Province> provinces;
+    provinces.reserve(labels.size());
+    for(auto&& id : labels) {
+        provinces.push_back(std::cref(province_project.getProvinceForID(id)));
     }
 
     return provinces;
@@ -134,23 +331,51 @@ auto HMDT::GUI::SelectionManager::getSelectedProvinces() const
  */
 auto HMDT::GUI::SelectionManager::getSelectedProvinces() -> RefVector<Province>
 {
-    RefVector<Province> provinces;
-    if(auto opt_mproj = getCurrentMapProject(); opt_mproj)
-    {
-        auto& mproj = opt_mproj->get();
-        std::transform(m_selected_provinces.begin(), m_selected_provinces.end(),
-                       std::back_inserter(provinces),
-                       [&mproj](const ProvinceID& prov_id) {
-                           return std::ref(mproj.getProvinceProject().getProvinceForID(prov_id));
-                       });
+    auto opt_mproj = getCurrentMapProject();
+    if(!opt_mproj) {
+        return {};
     }
-    return provinces;
+
+    auto& province_project = opt_mproj->get().getProvinceProject();
+
+    // Only look each province up again if the selection has changed, or if
+    //   the provinces have been replaced since they were last looked up
+    if(!areProvinceRefsValid(province_project)) {
+        const auto& labels = getSelectedProvinceLabels();
+
+        m_selected_province_refs.clear();
+        m_selected_province_refs.reserve(labels.size());
+        for(auto&& id : labels) {
+            m_selected_province_refs.push_back(std::ref(province_project.getProvinceForID(id)));
+        }
+
+        m_selected_province_refs_generation = province_project.getProvincesGeneration();
+    }
+
+    return m_selected_province_refs;
 }
 
+/**
+ * @brief Gets the ID of every selected province
+ *
+ * @return A reference to the cached list of IDs, which remains valid until
+ *         the selection next changes.
+ */
 auto HMDT::GUI::SelectionManager::getSelectedProvinceLabels() const
-    -> const std::set<ProvinceID>&
+    -> const std::vector<ProvinceID>&
 {
-    return m_selected_provinces;
+    if(!m_is_selected_province_ids_valid) {
+        m_selected_province_ids.clear();
+        m_selected_province_ids.reserve(m_selected_provinces.count());
+
+        m_selected_provinces.forEach([this](DenseBitSet::Index index) {
+            m_selected_province_ids.push_back(m_province_ids[index]);
+        });
+
+        m_is_selected_province_ids_valid = true;
+    }
+
+    return m_selected_province_ids;
 }
 
 /**
@@ -165,7 +390,9 @@ auto HMDT::GUI::SelectionManager::getSelectedStates() const
     if(auto opt_hproj = getCurrentHistoryProject(); opt_hproj)
     {
         auto& hproj = opt_hproj->get();
-        std::transform(m_selected_states.begin(), m_selected_states.end(),
+        const auto& state_ids = getSelectedStateIDs();
+        states.reserve(state_ids.size());
+        std::transform(state_ids.begin(), state_ids.end(),
                        std::back_inserter(states),
                        [&hproj](StateID state_id) -> const State& {
                            return hproj.getStateProject().getStateForID(state_id)->get();
@@ -184,7 +411,9 @@ auto HMDT::GUI::SelectionManager::getSelectedStates() -> RefVector<State> {
     if(auto opt_hproj = getCurrentHistoryProject(); opt_hproj)
     {
         auto& hproj = opt_hproj->get();
-        std::transform(m_selected_states.begin(), m_selected_states.end(),
+        const auto& state_ids = getSelectedStateIDs();
+        states.reserve(state_ids.size());
+        std::transform(state_ids.begin(), state_ids.end(),
                        std::back_inserter(states),
                        [&hproj](StateID state_id) -> State& {
                            return hproj.getStateProject().getStateForID(state_id)->get();
@@ -193,10 +422,16 @@ auto HMDT::GUI::SelectionManager::getSelectedStates() -> RefVector<State> {
     return states;
 }
 
+/**
+ * @brief Gets the ID of every selected state, in ascending order
+ *
+ * @return A reference to the cached list of IDs, which remains valid until
+ *         the selection next changes.
+ */
 auto HMDT::GUI::SelectionManager::getSelectedStateIDs() const
-    -> const std::set<uint32_t>&
+    -> const std::vector<StateID>&
 {
-    return m_selected_states;
+    return m_selected_states.getIndices();
 }
 
 /**
@@ -206,7 +441,9 @@ auto HMDT::GUI::SelectionManager::getSelectedStateIDs() const
  */
 bool HMDT::GUI::SelectionManager::isProvinceSelected(const ProvinceID& id) const
 {
-    return m_selected_provinces.count(id) != 0;
+    auto index = findProvinceIndex(id);
+
+    return index && m_selected_provinces.test(*index);
 }
 
 /**
@@ -215,24 +452,161 @@ bool HMDT::GUI::SelectionManager::isProvinceSelected(const ProvinceID& id) const
  * @param id The state ID to check
  */
 bool HMDT::GUI::SelectionManager::isStateSelected(const StateID& id) const {
-    return m_selected_states.count(id) != 0;
+    return m_selected_states.test(id);
+}
+
+/**
+ * @brief Gives every province in the newly loaded project a dense index up
+ *        front, so that the selection bitset never needs to grow.
+ */
+void HMDT::GUI::SelectionManager::onProjectLoaded() {
+    onProjectUnloaded();
+
+    if(auto opt_mproj = getCurrentMapProject(); opt_mproj) {
+        auto table = opt_mproj->get().getProvinceProject().getProvinceTable();
+        const auto& ids = table->getIDs();
+
+        m_province_indices.reserve(ids.size());
+        m_province_ids.reserve(ids.size());
+        for(auto&& id : ids) {
+            getProvinceIndex(id);
+        }
+
+        m_selected_provinces.reserve(ids.size());
+    }
 }
 
 /**
  * @brief Clears out all selection information
  */
 void HMDT::GUI::SelectionManager::onProjectUnloaded() {
-    m_selected_provinces.clear();
+    m_province_indices.clear();
+    m_province_ids.clear();
+    m_selected_provinces = DenseBitSet();
     m_selected_states.clear();
+    invalidateProvinceViews();
 }
 
 HMDT::GUI::SelectionManager::SelectionManager():
+    m_province_indices(),
+    m_province_ids(),
     m_selected_provinces(),
     m_selected_states(),
+    m_selected_province_ids(),
+    m_is_selected_province_ids_valid(true),
+    m_selected_province_refs(),
+    m_selected_province_refs_generation(std::nullopt),
     m_on_province_selected_callback([](auto...) { }),
-    m_on_state_selected_callback([](auto...) { })
+    m_on_state_selected_callback([](auto...) { }),
+    // By default, fall back to reporting each selection one at a time
+    m_on_provinces_selected_callback([this](const std::vector<ProvinceID>& ids,
+                                            Action action)
+    {
+        if(action == Action::SET && ids.empty()) {
+            m_on_province_selected_callback(INVALID_PROVINCE, Action::CLEAR);
+        }
+
+        for(auto&& id : ids) {
+            m_on_province_selected_callback(id, action);
+
+            // Only the first province replaces the selection
+            if(action == Action::SET) action = Action::ADD;
+        }
+    }),
+    m_on_states_selected_callback([this](const std::vector<StateID>& ids,
+                                         Action action)
+    {
+        if(action == Action::SET && ids.empty()) {
+            m_on_state_selected_callback(INVALID_STATE_ID, Action::CLEAR);
+        }
+
+        for(auto&& id : ids) {
+            m_on_state_selected_callback(id, action);
+
+            if(action == Action::SET) action = Action::ADD;
+        }
+    })
 { }
 
+/**
+ * @brief Gets the dense index of a province, giving it one if it doesn't
+ *        have one yet.
+ */
+auto HMDT::GUI::SelectionManager::getProvinceIndex(const ProvinceID& id)
+    -> DenseBitSet::Index
+{
+    auto [it, inserted] = m_province_indices.try_emplace(id, m_province_ids.size());
+    if(inserted) {
+        m_province_ids.push_back(id);
+    }
+
+    return it->second;
+}
+
+/**
+ * @brief Gets the dense index of a province, if it has been given one
+ */
+auto HMDT::GUI::SelectionManager::findProvinceIndex(const ProvinceID& id) const
+    -> std::optional<DenseBitSet::Index>
+{
+    if(auto it = m_province_indices.find(id); it != m_province_indices.end()) {
+        return it->second;
+    }
+
+    return std::nullopt;
+}
+
+/**
+ * @brief Marks a province as selected
+ *
+ * @return True if the province was not already selected
+ */
+bool HMDT::GUI::SelectionManager::insertProvince(const ProvinceID& id) {
+    if(m_selected_provinces.set(getProvinceIndex(id))) {
+        invalidateProvinceViews();
+        return true;
+    }
+
+    return false;
+}
+
+/**
+ * @brief Marks a province as not selected
+ *
+ * @return True if the province was selected
+ */
+bool HMDT::GUI::SelectionManager::eraseProvince(const ProvinceID& id) {
+    if(auto index = findProvinceIndex(id);
+            index && m_selected_provinces.reset(*index))
+    {
+        invalidateProvinceViews();
+        return true;
+    }
+
+    return false;
+}
+
+/**
+ * @brief Marks every cached list of selected provinces as out of date
+ */
+void HMDT::GUI::SelectionManager::invalidateProvinceViews() noexcept {
+    m_is_selected_province_ids_valid = false;
+    m_selected_province_refs_generation = std::nullopt;
+}
+
+/**
+ * @brief Checks whether the cached selected provinces can still be used
+ *
+ * @param province_project The project the provinces should be looked up in
+ *
+ * @return False if the selection has changed, or if the provinces have been
+ *         replaced, since the cache was last filled in.
+ */
+bool HMDT::GUI::SelectionManager::areProvinceRefsValid(const Project::IProvinceProject& province_project) const noexcept
+{
+    return m_selected_province_refs_generation == province_project.getProvincesGeneration();
+}
+
 auto HMDT::GUI::SelectionManager::getCurrentMapProject() const
     -> OptionalReference<Project::IRootMapProject>
 {
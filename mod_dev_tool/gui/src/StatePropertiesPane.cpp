@@ -11,6 +11,7 @@
 
 #include "ActionManager.h"
 #include "SetPropertyAction.h"
+#include "BulkSetPropertyAction.h"
 
 #include "Driver.h"
 #include "StyleClasses.h"
@@ -18,7 +19,10 @@
 
 HMDT::GUI::StatePropertiesPane::StatePropertiesPane():
     m_state(nullptr),
-    m_box(Gtk::ORIENTATION_VERTICAL)
+    m_is_multiselect(false),
+    m_box(Gtk::ORIENTATION_VERTICAL),
+    m_is_updating_properties(false),
+    m_on_properties_changed([](const auto&...) { })
 { }
 
 Gtk::ScrolledWindow& HMDT::GUI::StatePropertiesPane::getParent() {
@@ -99,8 +103,19 @@ void HMDT::GUI::StatePropertiesPane::buildManpowerField() {
     m_manpower_field->signal_activate().connect([this]() {
         if(m_is_updating_properties) return;
 
-        if(m_state != nullptr &&
-           m_state->manpower != std::atoi(m_manpower_field->get_text().c_str()))
+        // Fields are left blank when the selected states don't share a value,
+        //   so only apply to all of them if something was actually entered.
+        //   States which already hold the value are left alone by the action
+        if(m_state != nullptr && m_is_multiselect &&
+           !m_manpower_field->get_text().empty())
+        {
+            Action::ActionManager::getInstance().doAction(
+                NewBulkSetPropertyActionWithCallback(SelectionManager::getInstance().getSelectedStates(),
+                                                     manpower,
+                                                     std::atoi(m_manpower_field->get_text().c_str()),
+                                                     getBulkChangedCallback()));
+        } else if(m_state != nullptr && !m_is_multiselect &&
+                  m_state->manpower != std::atoi(m_manpower_field->get_text().c_str()))
         {
             Action::ActionManager::getInstance().doAction(
                 NewSetPropertyAction(m_state, manpower,
@@ -128,8 +143,16 @@ void HMDT::GUI::StatePropertiesPane::buildBuildingsMaxLevelFactorField() {
     m_buildings_max_level_factor_field->signal_activate().connect([this]() {
         if(m_is_updating_properties) return;
 
-        if(m_state != nullptr &&
-           m_state->buildings_max_level_factor != std::atof(m_buildings_max_level_factor_field->get_text().c_str()))
+        if(m_state != nullptr && m_is_multiselect &&
+           !m_buildings_max_level_factor_field->get_text().empty())
+        {
+            Action::ActionManager::getInstance().doAction(
+                NewBulkSetPropertyActionWithCallback(SelectionManager::getInstance().getSelectedStates(),
+                                                     buildings_max_level_factor,
+                                                     std::atof(m_buildings_max_level_factor_field->get_text().c_str()),
+                                                     getBulkChangedCallback()));
+        } else if(m_state != nullptr && !m_is_multiselect &&
+                  m_state->buildings_max_level_factor != std::atof(m_buildings_max_level_factor_field->get_text().c_str()))
         {
             Action::ActionManager::getInstance().doAction(
                 NewSetPropertyAction(m_state, buildings_max_level_factor,
@@ -149,7 +172,16 @@ void HMDT::GUI::StatePropertiesPane::buildIsImpassableField() {
     m_is_impassable_button->signal_toggled().connect([this]() {
         if(m_is_updating_properties) return;
 
-        if(m_state != nullptr) {
+        // Once clicked, the button holds a single value for every state
+        m_is_impassable_button->set_inconsistent(false);
+
+        if(m_state != nullptr && m_is_multiselect) {
+            Action::ActionManager::getInstance().doAction(
+                NewBulkSetPropertyActionWithCallback(SelectionManager::getInstance().getSelectedStates(),
+                                                     impassable,
+                                                     m_is_impassable_button->get_active(),
+                                                     getBulkChangedCallback()));
+        } else if(m_state != nullptr) {
             Action::ActionManager::getInstance().doAction(
                 NewSetPropertyAction(m_state, impassable,
                                      m_is_impassable_button->get_active()));
@@ -192,6 +224,9 @@ void HMDT::GUI::StatePropertiesPane::buildProvinceListField() {
 
                         // Remove from the state as well, do this after all deselections
                         map_project.removeProvinceFromState(province);
+                        Action::ActionManager::getInstance().recordEdits({
+                            Action::JournalDelta::removeProvinceFromState(id)
+                        });
                     } else {
                         WRITE_WARN("Invalid province ID ", id, ". Cannot remove from the state.");
                     }
@@ -254,6 +289,10 @@ void HMDT::GUI::StatePropertiesPane::buildDeleteStateButton() {
                 return;
             }
 
+            Action::ActionManager::getInstance().recordEdits({
+                Action::JournalDelta::removeState(m_state->id)
+            });
+
             SelectionManager::getInstance().removeStateSelection(m_state->id);
         }
     });
@@ -283,14 +322,52 @@ void HMDT::GUI::StatePropertiesPane::setEnabled(bool enabled) {
 void HMDT::GUI::StatePropertiesPane::setState(State* state, bool is_multiselect)
 {
     m_state = state;
+    m_is_multiselect = is_multiselect;
 
     setEnabled(m_state != nullptr && !is_multiselect);
 
+    // Only fields which make sense to share between states may be edited on
+    //   every selected state at once
+    if(m_state != nullptr && is_multiselect) {
+        m_manpower_field->set_sensitive(true);
+        m_buildings_max_level_factor_field->set_sensitive(true);
+        m_is_impassable_button->set_sensitive(true);
+    }
+
     updateProperties(state, is_multiselect);
 }
 
 void HMDT::GUI::StatePropertiesPane::onResize() { }
 
+/**
+ * @brief Sets the callback to be called whenever an edit made through this
+ *        pane has been applied to (or reverted on) every selected state
+ *
+ * @param callback The callback, which is given the ID of every state that was
+ *                 changed and the name of the field that was changed on them
+ */
+void HMDT::GUI::StatePropertiesPane::setOnPropertiesChangedCallback(const PropertiesChangedCallback& callback)
+{
+    m_on_properties_changed = callback;
+}
+
+/**
+ * @brief Gets the callback given to every bulk edit made through this pane.
+ *
+ * @return A callback which passes the change on to everyone listening to
+ *         this pane, and then refreshes it
+ */
+auto HMDT::GUI::StatePropertiesPane::getBulkChangedCallback()
+    -> std::function<void(const std::vector<StateID>&, std::string_view)>
+{
+    return [this](const std::vector<StateID>& ids, std::string_view field) {
+        // Listeners may change more fields in response, so only refresh
+        //   once they are done
+        m_on_properties_changed(ids, field);
+        updateProperties(SelectionManager::getInstance().getSelectedStateCount() > 1);
+    };
+}
+
 void HMDT::GUI::StatePropertiesPane::updateProperties(bool is_multiselect) {
     updateProperties(m_state, is_multiselect);
 }
@@ -306,7 +383,37 @@ void HMDT::GUI::StatePropertiesPane::updateProperties(const State* state,
 {
     m_is_updating_properties = true;
 
-    if(state == nullptr || is_multiselect) {
+    m_is_impassable_button->set_inconsistent(false);
+
+    if(state != nullptr && is_multiselect) {
+        // Show the value shared by every selected state. Fields are left blank
+        //   (or inconsistent) if the states don't all share the same value, so
+        //   that nothing accidentally gets applied to all of them
+        auto selected = SelectionManager::getInstance().getSelectedStates();
+
+        m_name_field->set_text("");
+        m_category_field->set_text("");
+
+        if(auto manpower = getCommonValue(selected, &State::manpower); manpower) {
+            m_manpower_field->set_text(std::to_string(*manpower));
+        } else {
+            m_manpower_field->set_text("");
+        }
+
+        if(auto factor = getCommonValue(selected, &State::buildings_max_level_factor); factor)
+        {
+            m_buildings_max_level_factor_field->set_text(std::to_string(*factor));
+        } else {
+            m_buildings_max_level_factor_field->set_text("");
+        }
+
+        if(auto impassable = getCommonValue(selected, &State::impassable); impassable) {
+            m_is_impassable_button->set_active(*impassable);
+        } else {
+            m_is_impassable_button->set_active(false);
+            m_is_impassable_button->set_inconsistent(true);
+        }
+    } else if(state == nullptr) {
         // Set every field to some sort of sane default
         m_name_field->set_text("");
         m_manpower_field->set_text("");
@@ -317,7 +424,7 @@ void HMDT::GUI::StatePropertiesPane::updateProperties(const State* state,
         // Set every field to state
         m_name_field->set_text(state->name);
         m_manpower_field->set_text(std::to_string(state->manpower));
-        m_category_field->set_text(state->category);
+        m_category_field->set_text(state->category.str());
         m_buildings_max_level_factor_field->set_text(std::to_string(state->buildings_max_level_factor));
         m_is_impassable_button->set_active(state->impassable);
     }
@@ -14,7 +14,6 @@ namespace HMDT::Project::Hierarchy {
             virtual ~GroupNode() = default;
 
             virtual const Children& getChildren() const noexcept override;
-            virtual Children getChildren() noexcept override;
 
             virtual const std::string& getName() const noexcept override;
             virtual Type getType() const noexcept override;
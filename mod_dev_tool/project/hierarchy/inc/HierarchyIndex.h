@@ -0,0 +1,132 @@
+#ifndef PROJECT_HIERARCHY_HIERARCHYINDEX_H
+# define PROJECT_HIERARCHY_HIERARCHYINDEX_H
+
+# include <optional>
+# include <string>
+# include <unordered_map>
+# include <unordered_set>
+# include <vector>
+
+# include "Maybe.h"
+
+# include "INode.h"
+# include "Query.h"
+
+namespace HMDT::Project::Hierarchy {
+    /**
+     * @brief Indexes every node in a hierarchy so that they can be found
+     *        without walking the tree.
+     *
+     * @details Three indexes are kept: one from the path of each node to the
+     *          node itself, one from each node type to every node of that
+     *          type, and one from each property name and value to every
+     *          property with that name and value.
+     *
+     * @par The values of properties are cached when they are indexed. When a
+     *      property is changed, updateProperty() must be called with its path
+     *      to move it to its new place in the value index. If nodes are added
+     *      to or removed from the hierarchy, the index must be rebuilt.
+     *
+     * @par The children of an IndexedGroupNode are only indexed once they are
+     *      needed, so that building the index does not build every one of
+     *      them. Looking up a path only builds the children along that path,
+     *      a query only builds the groups its path can reach, and only
+     *      findByValue() and getNodesOfType() build everything. As a result,
+     *      nodes are returned in the order they were indexed, which is only
+     *      the hierarchy order within each group.
+     *
+     * @par HoI4Project::getHierarchyIndex() keeps an index of the whole project
+     *      up to date in this way.
+     */
+    class HierarchyIndex {
+        public:
+            /**
+             * @brief A single indexed node
+             */
+            struct Entry {
+                //! The full path to the node, relative to the root
+                std::string path;
+
+                //! Every part of the path
+                std::vector<std::string> parts;
+
+                //! The node itself
+                INodePtr node;
+
+                //! The cached value of the node, if it is a property
+                std::optional<std::string> value;
+            };
+
+            HierarchyIndex() = default;
+
+            MaybeVoid build(INodePtr) noexcept;
+            void clear() noexcept;
+
+            Maybe<INodePtr> lookup(const std::string&) const noexcept;
+
+            std::vector<INodePtr> getNodesOfType(Node::Type) const noexcept;
+            std::vector<INodePtr> findByValue(const std::string&,
+                                              const std::string&) const noexcept;
+
+            Maybe<std::vector<INodePtr>> query(const Query&) const noexcept;
+            Maybe<std::vector<INodePtr>> query(const std::string&) const noexcept;
+
+            MaybeVoid updateProperty(const std::string&) noexcept;
+            void refreshValues() noexcept;
+
+            std::size_t size() const noexcept;
+
+        protected:
+            //! The entry of the parent of nodes directly below the root
+            constexpr static std::size_t NO_PARENT = static_cast<std::size_t>(-1);
+
+            /**
+             * @brief An IndexedGroupNode whose children have not all been
+             *        indexed yet
+             */
+            struct PendingGroup {
+                //! The entry of the group, or NO_PARENT if it is the root
+                std::size_t entry;
+
+                //! The group itself
+                INodePtr node;
+            };
+
+            std::size_t addNode(const INodePtr&, std::size_t) const noexcept;
+            void addChildren(const INodePtr&, std::size_t, bool) const noexcept;
+            void addEntry(Entry&&) const noexcept;
+            void setValue(std::size_t, const std::optional<std::string>&) noexcept;
+
+            std::optional<std::size_t> findEntry(const std::string&) const noexcept;
+            std::optional<std::size_t> expandChild(std::size_t,
+                                                   const std::string&) const noexcept;
+            void expandGroup(std::size_t) const noexcept;
+            void expandMatching(const Query&) const noexcept;
+            void expandAll() const noexcept;
+
+            std::vector<INodePtr> getNodes(const std::vector<std::size_t>&) const noexcept;
+
+        private:
+            //! Every indexed node in the hierarchy, excluding the root. Along
+            //!   with the indexes below, this is filled in as groups get
+            //!   expanded, which may happen while answering a lookup.
+            mutable std::vector<Entry> m_entries;
+
+            //! Index into m_entries by path
+            mutable std::unordered_map<std::string, std::size_t> m_path_index;
+
+            //! Indices into m_entries by node type
+            mutable std::unordered_map<Node::Type, std::vector<std::size_t>> m_type_index;
+
+            //! Indices into m_entries by property name, then by value
+            mutable std::unordered_map<std::string,
+                                       std::unordered_map<std::string,
+                                                          std::unordered_set<std::size_t>>> m_value_index;
+
+            //! Every IndexedGroupNode which has not been fully indexed yet
+            mutable std::vector<PendingGroup> m_pending_groups;
+    };
+}
+
+#endif
+
@@ -8,7 +8,9 @@
 
 # include <any>
 # include <map>
-# include <stack>
+# include <vector>
+# include <functional>
+# include <unordered_map>
 # include <string>
 # include <memory>
 # include <typeindex>
@@ -30,6 +32,8 @@ namespace HMDT::Project::Hierarchy {
     }
 
     class INode;
+    class IGroupNode;
+    class IndexedGroupNode;
 
     //! Helper alias for an INode pointer
     using INodePtr = std::shared_ptr<INode>;
@@ -59,6 +63,10 @@ namespace HMDT::Project::Hierarchy {
         public:
             /**
              * @brief A forward-only iterator
+             * @details Walks the hierarchy in pre-order. Children are only
+             *          fetched from a group when the iterator steps into it,
+             *          so lazy groups only build the nodes that are actually
+             *          reached.
              *
              * @tparam The NodePtr type used for this iterator (used to generify
              *         this iterator between const and non-const)
@@ -66,8 +74,23 @@ namespace HMDT::Project::Hierarchy {
             template<typename NodePtr>
             class IteratorImpl {
                 protected:
-                    //! A stack of INodes to iterate over next
-                    using NodeStack = std::stack<NodePtr>;
+                    /**
+                     * @brief A group which is currently being walked
+                     */
+                    struct Frame {
+                        //! The group being walked
+                        NodePtr group;
+
+                        //! The children of group, if it is not an
+                        //!   IndexedGroupNode (which builds them on demand)
+                        std::vector<NodePtr> children;
+
+                        //! The number of children in group
+                        std::size_t size;
+
+                        //! The index of the next child to step into
+                        std::size_t next;
+                    };
 
                 public:
                     IteratorImpl() = default;
@@ -101,41 +124,28 @@ namespace HMDT::Project::Hierarchy {
                      */
                     template<typename T>
                     bool operator==(const IteratorImpl<T>& it) const noexcept {
-                        // TODO: Convert this into a boolean expression and
-                        //   remove branching
-                        if(isEnd() && it.isEnd()) {
-                            return true;
-                        } else if(isEnd() || it.isEnd()) {
-                            return false;
+                        if(isEnd() || it.isEnd()) {
+                            return isEnd() == it.isEnd();
                         }
 
                         // IteratorImpl is the same as another if they are currently
                         //  looking at the same node.
-                        return m_nodes.top().get() == it.m_nodes.top().get();
+                        return (**this).get() == (*it).get();
                     }
 
                     bool isEnd() const noexcept;
 
                 protected:
                     void advance() noexcept;
-
-                    /**
-                     * @brief Gets m_nodes.
-                     */
-                    NodeStack& getNodeStack() noexcept {
-                        return m_nodes;
-                    }
-
-                    /**
-                     * @brief Gets m_nodes.
-                     */
-                    const NodeStack& getNodeStack() const noexcept {
-                        return m_nodes;
-                    }
+                    void pushFrame(const NodePtr&) noexcept;
 
                 private:
-                    //! The stack of nodes being iterated over.
-                    NodeStack m_nodes;
+                    //! The node currently being looked at
+                    NodePtr m_current;
+
+                    //! Every group between the root and m_current which
+                    //!   still has children left to visit
+                    std::vector<Frame> m_frames;
             };
 
             //! A non-const iterator over an INode hierarchy
@@ -154,6 +164,9 @@ namespace HMDT::Project::Hierarchy {
 
             virtual MaybeVoid visit(INodeVisitor) noexcept;
 
+            virtual const IGroupNode* asGroup() const noexcept;
+            virtual IGroupNode* asGroup() noexcept;
+
             ConstIterator begin() const noexcept;
             ConstIterator end() const noexcept;
 
@@ -199,6 +212,9 @@ namespace HMDT::Project::Hierarchy {
             //! Helper alias for the children of this group
             using Children = std::unordered_map<std::string, ChildNode>;
 
+            //! Helper alias for a function called on each child of this group
+            using ChildCallback = std::function<MaybeVoid(const ChildNode&)>;
+
             IGroupNode() = default;
             IGroupNode(const IGroupNode&) = delete;
 
@@ -206,8 +222,16 @@ namespace HMDT::Project::Hierarchy {
 
             virtual MaybeVoid visit(INodeVisitor) noexcept override;
 
+            virtual const IGroupNode* asGroup() const noexcept override;
+            virtual IGroupNode* asGroup() noexcept override;
+
+            virtual const IndexedGroupNode* asIndexedGroup() const noexcept;
+
             virtual const Children& getChildren() const noexcept = 0;
-            virtual Children getChildren() noexcept = 0;
+
+            virtual std::size_t getChildCount() const noexcept;
+            virtual MaybeVoid forEachChild(const ChildCallback&) const noexcept;
+            virtual Maybe<ChildNode> lookupChild(const std::string&) const noexcept;
 
             Maybe<ConstChildNode> operator[](const std::string&) const noexcept;
             Maybe<ChildNode> operator[](const std::string&) noexcept;
@@ -0,0 +1,81 @@
+#ifndef PROJECT_HIERARCHY_INDEXEDGROUPNODE_H
+# define PROJECT_HIERARCHY_INDEXEDGROUPNODE_H
+
+# include <optional>
+# include <vector>
+
+# include "INode.h"
+
+namespace HMDT::Project::Hierarchy {
+    /**
+     * @brief Represents a group of nodes which are only built when they are
+     *        first asked for.
+     *
+     * @details Rather than holding every child, this group holds an index
+     *          which knows how many children there are, what each one is
+     *          called, and how to build one. Looking up a single child only
+     *          builds that child, and once built a child is kept so that the
+     *          same node is handed out every time.
+     *
+     * @par Note that getChildren() has to build every child in order to return
+     *      them as a map, so prefer getChildCount(), getChildAt() and
+     *      lookupChild() where possible. Iterating over the hierarchy with
+     *      INode::begin() only builds each child as it is reached.
+     */
+    class IndexedGroupNode: public IGroupNode {
+        public:
+            /**
+             * @brief Describes the children of an IndexedGroupNode
+             */
+            struct Index {
+                //! The number of children
+                std::size_t size;
+
+                //! Gets the name of the child at an index
+                std::function<std::string(std::size_t)> key_at;
+
+                //! Finds the index of the child with the given name
+                std::function<std::optional<std::size_t>(const std::string&)> find;
+
+                //! Builds the child at an index
+                std::function<Maybe<ChildNode>(std::size_t)> make_child;
+            };
+
+            IndexedGroupNode(const std::string&, const Index&);
+            virtual ~IndexedGroupNode() = default;
+
+            virtual const IndexedGroupNode* asIndexedGroup() const noexcept override;
+
+            virtual const Children& getChildren() const noexcept override;
+
+            virtual std::size_t getChildCount() const noexcept override;
+            virtual MaybeVoid forEachChild(const ChildCallback&) const noexcept override;
+            virtual Maybe<ChildNode> lookupChild(const std::string&) const noexcept override;
+
+            virtual const std::string& getName() const noexcept override;
+            virtual Type getType() const noexcept override;
+
+            Maybe<ChildNode> getChildAt(std::size_t) const noexcept;
+
+            std::size_t getBuiltChildCount() const noexcept;
+
+        private:
+            //! The name of this group
+            std::string m_name;
+
+            //! The index used to find and build children
+            Index m_index;
+
+            //! Every child that has been built so far, by index
+            mutable std::vector<ChildNode> m_built_children;
+
+            //! The number of non-null entries in m_built_children
+            mutable std::size_t m_num_built_children;
+
+            //! Every child keyed by name, only filled in by getChildren()
+            mutable std::optional<Children> m_children;
+    };
+}
+
+#endif
+
@@ -0,0 +1,68 @@
+#ifndef PROJECT_HIERARCHY_QUERY_H
+# define PROJECT_HIERARCHY_QUERY_H
+
+# include <optional>
+# include <string>
+# include <vector>
+
+# include "Maybe.h"
+
+# include "INode.h"
+
+namespace HMDT::Project::Hierarchy {
+    /**
+     * @brief A path expression used to find nodes in a hierarchy
+     *
+     * @details Queries are written as a list of node names separated by '/',
+     *          relative to the node the query is run against. A name of '*'
+     *          matches every child of a group. The path may optionally be
+     *          followed by <tt>== VALUE</tt> or <tt>!= VALUE</tt>, in which
+     *          case only property nodes whose value (as a string) compares
+     *          accordingly are matched. VALUE may be quoted.
+     *
+     * @par For example: <tt>Map/Provinces/Provinces/ * /Terrain == "plains"</tt>
+     *      (without the spaces around the '*').
+     */
+    class Query {
+        public:
+            //! The comparison made against the value of each matched node
+            enum class Comparison {
+                NONE,
+                EQUAL,
+                NOT_EQUAL
+            };
+
+            //! The path segment which matches any child
+            constexpr static char WILDCARD[] = "*";
+
+            static Maybe<Query> parse(const std::string&) noexcept;
+
+            Maybe<std::vector<INodePtr>> execute(INodePtr) const noexcept;
+
+            bool matchesPath(const std::vector<std::string>&) const noexcept;
+            bool matchesValue(const std::optional<std::string>&) const noexcept;
+
+            const std::vector<std::string>& getSegments() const noexcept;
+            Comparison getComparison() const noexcept;
+            const std::string& getValue() const noexcept;
+
+            bool hasWildcards() const noexcept;
+
+        private:
+            Query() = default;
+
+            //! Every name in the path
+            std::vector<std::string> m_segments;
+
+            //! How to compare the value of matched nodes
+            Comparison m_comparison = Comparison::NONE;
+
+            //! The value to compare against
+            std::string m_value;
+    };
+
+    std::optional<std::string> getValueString(const IPropertyNode&) noexcept;
+}
+
+#endif
+
@@ -23,7 +23,7 @@ namespace HMDT::Project::Hierarchy {
                             const INodeVisitor&) noexcept;
             MaybeVoid setManpower(const IPropertyNode::ValueLookup<size_t>&,
                                   const INodeVisitor&) noexcept;
-            MaybeVoid setCategory(const IPropertyNode::ValueLookup<std::string>&,
+            MaybeVoid setCategory(const IPropertyNode::ValueLookup<StateCategory>&,
                                   const INodeVisitor&) noexcept;
             MaybeVoid setBuildingsMaxLevelFactor(const IPropertyNode::ValueLookup<float>&,
                                                  const INodeVisitor&) noexcept;
@@ -41,16 +41,6 @@ auto HMDT::Project::Hierarchy::GroupNode::getType() const noexcept -> Type {
     return Type::GROUP;
 }
 
-/**
- * @brief Gets the collection of nodes held in this group
- *
- * @return The collection of nodes held in this group
- */
-auto HMDT::Project::Hierarchy::GroupNode::getChildren() noexcept -> Children
-{
-    return m_children;
-}
-
 /**
  * @brief Adds a child to this Group.
  *
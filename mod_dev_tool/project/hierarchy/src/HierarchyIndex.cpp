@@ -0,0 +1,515 @@
+
+#include "HierarchyIndex.h"
+
+#include <algorithm>
+#include <utility>
+
+/**
+ * @brief Builds the index from the given hierarchy, replacing anything that
+ *        was previously indexed.
+ * @details The children of IndexedGroupNodes are not indexed here, but only
+ *          once a lookup or query needs them.
+ *
+ * @param root The root of the hierarchy. Paths are relative to this node, so
+ *             the root itself is not indexed.
+ *
+ * @return STATUS_SUCCESS, or STATUS_PARAM_CANNOT_BE_NULL if root is null.
+ */
+auto HMDT::Project::Hierarchy::HierarchyIndex::build(INodePtr root) noexcept
+    -> MaybeVoid
+{
+    RETURN_ERROR_IF(root == nullptr, STATUS_PARAM_CANNOT_BE_NULL);
+
+    clear();
+
+    addChildren(root, NO_PARENT, false);
+
+    return STATUS_SUCCESS;
+}
+
+/**
+ * @brief Removes everything from this index
+ */
+void HMDT::Project::Hierarchy::HierarchyIndex::clear() noexcept {
+    m_entries.clear();
+    m_path_index.clear();
+    m_type_index.clear();
+    m_value_index.clear();
+    m_pending_groups.clear();
+}
+
+/**
+ * @brief Looks up a single node by its path
+ *
+ * @param path The path to the node, relative to the root
+ *
+ * @return The node, or STATUS_VALUE_NOT_FOUND if no node has that path
+ */
+auto HMDT::Project::Hierarchy::HierarchyIndex::lookup(const std::string& path) const noexcept
+    -> Maybe<INodePtr>
+{
+    if(auto index = findEntry(path); index) {
+        return m_entries[*index].node;
+    }
+
+    RETURN_ERROR(STATUS_VALUE_NOT_FOUND);
+}
+
+/**
+ * @brief Gets every node of the given type
+ *
+ * @param type The type of node to get
+ *
+ * @return Every node of the given type, in the order they were indexed
+ */
+auto HMDT::Project::Hierarchy::HierarchyIndex::getNodesOfType(Node::Type type) const noexcept
+    -> std::vector<INodePtr>
+{
+    expandAll();
+
+    if(auto it = m_type_index.find(type); it != m_type_index.end()) {
+        return getNodes(it->second);
+    }
+
+    return {};
+}
+
+/**
+ * @brief Finds every property with the given name and value
+ *
+ * @param name The name of the property
+ * @param value The value of the property, as a string
+ *
+ * @return Every matching property, in the order they were indexed
+ */
+auto HMDT::Project::Hierarchy::HierarchyIndex::findByValue(const std::string& name,
+                                                           const std::string& value) const noexcept
+    -> std::vector<INodePtr>
+{
+    expandAll();
+
+    auto name_it = m_value_index.find(name);
+    if(name_it == m_value_index.end()) {
+        return {};
+    }
+
+    auto value_it = name_it->second.find(value);
+    if(value_it == name_it->second.end()) {
+        return {};
+    }
+
+    std::vector<std::size_t> indices(value_it->second.begin(),
+                                     value_it->second.end());
+    std::sort(indices.begin(), indices.end());
+
+    return getNodes(indices);
+}
+
+/**
+ * @brief Runs a query against the index
+ * @details Queries without wildcards are answered by the path index, and
+ *          queries which check that the last segment is equal to some value
+ *          are answered by the value index. Anything else is answered by
+ *          checking every entry. Before any of that, every group that the
+ *          query could reach is indexed.
+ *
+ * @param query The query to run
+ *
+ * @return Every matching node, in the order they were indexed
+ */
+auto HMDT::Project::Hierarchy::HierarchyIndex::query(const Query& query) const noexcept
+    -> Maybe<std::vector<INodePtr>>
+{
+    const auto& segments = query.getSegments();
+
+    std::vector<std::size_t> indices;
+
+    if(query.hasWildcards()) {
+        expandMatching(query);
+    }
+
+    if(!query.hasWildcards()) {
+        std::string path;
+        for(auto&& segment : segments) {
+            if(!path.empty()) path += '/';
+            path += segment;
+        }
+
+        if(auto index = findEntry(path);
+                index && query.matchesValue(m_entries[*index].value))
+        {
+            indices.push_back(*index);
+        }
+    } else if(query.getComparison() == Query::Comparison::EQUAL &&
+              segments.back() != Query::WILDCARD)
+    {
+        if(auto name_it = m_value_index.find(segments.back());
+                name_it != m_value_index.end())
+        {
+            if(auto value_it = name_it->second.find(query.getValue());
+                    value_it != name_it->second.end())
+            {
+                for(auto index : value_it->second) {
+                    if(query.matchesPath(m_entries[index].parts)) {
+                        indices.push_back(index);
+                    }
+                }
+                std::sort(indices.begin(), indices.end());
+            }
+        }
+    } else {
+        for(std::size_t i = 0; i < m_entries.size(); ++i) {
+            if(query.matchesPath(m_entries[i].parts) &&
+               query.matchesValue(m_entries[i].value))
+            {
+                indices.push_back(i);
+            }
+        }
+    }
+
+    return getNodes(indices);
+}
+
+/**
+ * @brief Parses and runs a query against the index
+ *
+ * @param expression The query to run
+ *
+ * @return Every matching node, in the order they were indexed, or
+ *         STATUS_INVALID_QUERY if
+ *         the query could not be parsed.
+ */
+auto HMDT::Project::Hierarchy::HierarchyIndex::query(const std::string& expression) const noexcept
+    -> Maybe<std::vector<INodePtr>>
+{
+    auto parsed = Query::parse(expression);
+    RETURN_IF_ERROR(parsed);
+
+    return query(*parsed);
+}
+
+/**
+ * @brief Re-reads the value of a single property, moving it to the right
+ *        place in the value index.
+ *
+ * @param path The path to the property
+ *
+ * @return STATUS_SUCCESS, STATUS_VALUE_NOT_FOUND if there is no node at path,
+ *         or STATUS_INVALID_TYPE if the node is not a property.
+ */
+auto HMDT::Project::Hierarchy::HierarchyIndex::updateProperty(const std::string& path) noexcept
+    -> MaybeVoid
+{
+    auto index = findEntry(path);
+    RETURN_ERROR_IF(!index, STATUS_VALUE_NOT_FOUND);
+
+    auto pnode = std::dynamic_pointer_cast<IPropertyNode>(m_entries[*index].node);
+    RETURN_ERROR_IF(pnode == nullptr, STATUS_INVALID_TYPE);
+
+    setValue(*index, getValueString(*pnode));
+
+    return STATUS_SUCCESS;
+}
+
+/**
+ * @brief Re-reads the value of every property which has been indexed so far
+ */
+void HMDT::Project::Hierarchy::HierarchyIndex::refreshValues() noexcept {
+    for(std::size_t i = 0; i < m_entries.size(); ++i) {
+        if(auto pnode = std::dynamic_pointer_cast<IPropertyNode>(m_entries[i].node);
+                pnode != nullptr)
+        {
+            setValue(i, getValueString(*pnode));
+        }
+    }
+}
+
+/**
+ * @brief Gets the number of nodes which have been indexed so far
+ */
+std::size_t HMDT::Project::Hierarchy::HierarchyIndex::size() const noexcept {
+    return m_entries.size();
+}
+
+/**
+ * @brief Indexes a single node
+ *
+ * @param node The node to index
+ * @param parent The entry of the parent of node, or NO_PARENT
+ *
+ * @return The entry of the new node
+ */
+std::size_t HMDT::Project::Hierarchy::HierarchyIndex::addNode(const INodePtr& node,
+                                                              std::size_t parent) const noexcept
+{
+    Entry entry;
+    if(parent == NO_PARENT) {
+        entry.path = node->getName();
+    } else {
+        entry.parts.reserve(m_entries[parent].parts.size() + 1);
+        entry.parts = m_entries[parent].parts;
+        entry.path = m_entries[parent].path + '/' + node->getName();
+    }
+    entry.parts.push_back(node->getName());
+    entry.node = node;
+
+    if(auto pnode = std::dynamic_pointer_cast<IPropertyNode>(node);
+            pnode != nullptr)
+    {
+        entry.value = getValueString(*pnode);
+    }
+
+    addEntry(std::move(entry));
+
+    return m_entries.size() - 1;
+}
+
+/**
+ * @brief Indexes every child of a node, depth-first
+ * @details IndexedGroupNodes below node are not walked, but are remembered
+ *          so that they can be expanded later. Children which have already
+ *          been indexed are skipped.
+ *
+ * @param node The node to index the children of
+ * @param parent The entry of node, or NO_PARENT if it is the root
+ * @param expand Whether node should be walked even if it is an
+ *               IndexedGroupNode
+ */
+void HMDT::Project::Hierarchy::HierarchyIndex::addChildren(const INodePtr& node,
+                                                           std::size_t parent,
+                                                           bool expand) const noexcept
+{
+    auto* group = node->asGroup();
+    if(group == nullptr) return;
+
+    if(!expand && group->asIndexedGroup() != nullptr) {
+        m_pending_groups.push_back(PendingGroup{parent, node});
+        return;
+    }
+
+    std::vector<INodePtr> children;
+    children.reserve(group->getChildCount());
+    group->forEachChild([&children](auto&& child) -> MaybeVoid {
+        children.push_back(child);
+        return STATUS_SUCCESS;
+    });
+
+    auto prefix = parent == NO_PARENT ? std::string{}
+                                      : m_entries[parent].path + '/';
+
+    for(auto&& child : children) {
+        if(m_path_index.count(prefix + child->getName()) != 0) {
+            continue;
+        }
+
+        auto index = addNode(child, parent);
+        addChildren(child, index, false);
+    }
+}
+
+/**
+ * @brief Adds a new entry to every index
+ *
+ * @param entry The entry to add
+ */
+void HMDT::Project::Hierarchy::HierarchyIndex::addEntry(Entry&& entry) const noexcept
+{
+    auto index = m_entries.size();
+
+    m_path_index[entry.path] = index;
+    m_type_index[entry.node->getType()].push_back(index);
+
+    if(entry.value) {
+        m_value_index[entry.parts.back()][*entry.value].insert(index);
+    }
+
+    m_entries.push_back(std::move(entry));
+}
+
+/**
+ * @brief Changes the cached value of an entry, updating the value index
+ *
+ * @param index The index of the entry
+ * @param value The new value of the entry
+ */
+void HMDT::Project::Hierarchy::HierarchyIndex::setValue(std::size_t index,
+                                                        const std::optional<std::string>& value) noexcept
+{
+    auto& entry = m_entries[index];
+    if(entry.value == value) {
+        return;
+    }
+
+    auto& by_value = m_value_index[entry.parts.back()];
+
+    if(entry.value) {
+        if(auto it = by_value.find(*entry.value); it != by_value.end()) {
+            it->second.erase(index);
+            if(it->second.empty()) {
+                by_value.erase(it);
+            }
+        }
+    }
+
+    entry.value = value;
+
+    if(entry.value) {
+        by_value[*entry.value].insert(index);
+    }
+}
+
+/**
+ * @brief Finds the entry for a path, indexing the children along that path
+ *        which have not been indexed yet.
+ *
+ * @param path The path to find
+ *
+ * @return The entry with that path, or std::nullopt if there is none
+ */
+auto HMDT::Project::Hierarchy::HierarchyIndex::findEntry(const std::string& path) const noexcept
+    -> std::optional<std::size_t>
+{
+    if(auto it = m_path_index.find(path); it != m_path_index.end()) {
+        return it->second;
+    }
+
+    for(std::size_t i = 0; i < m_pending_groups.size(); ++i) {
+        auto entry = m_pending_groups[i].entry;
+        auto prefix = entry == NO_PARENT ? std::string{}
+                                         : m_entries[entry].path + '/';
+
+        if(path.size() <= prefix.size() ||
+           path.compare(0, prefix.size(), prefix) != 0)
+        {
+            continue;
+        }
+
+        auto end = path.find('/', prefix.size());
+        auto name = path.substr(prefix.size(), end == std::string::npos ?
+                                                   std::string::npos :
+                                                   end - prefix.size());
+
+        // If this child is already indexed, then whatever is missing is
+        //   further down, under another pending group
+        if(m_path_index.count(prefix + name) != 0) {
+            continue;
+        }
+
+        if(expandChild(i, name)) {
+            return findEntry(path);
+        }
+    }
+
+    return std::nullopt;
+}
+
+/**
+ * @brief Indexes a single child of a pending group, and everything below it
+ *        which is not in another IndexedGroupNode.
+ *
+ * @param pending The index of the group in m_pending_groups
+ * @param name The name of the child
+ *
+ * @return The entry of the child, or std::nullopt if the group has no child
+ *         with that name.
+ */
+auto HMDT::Project::Hierarchy::HierarchyIndex::expandChild(std::size_t pending,
+                                                           const std::string& name) const noexcept
+    -> std::optional<std::size_t>
+{
+    // Copy, since indexing the child may add more pending groups
+    auto group = m_pending_groups[pending];
+
+    auto child = group.node->asGroup()->lookupChild(name);
+    if(IS_FAILURE(child)) {
+        return std::nullopt;
+    }
+
+    auto index = addNode(*child, group.entry);
+    addChildren(*child, index, false);
+
+    return index;
+}
+
+/**
+ * @brief Indexes every child of a pending group, and removes it from the
+ *        list of pending groups.
+ *
+ * @param pending The index of the group in m_pending_groups
+ */
+void HMDT::Project::Hierarchy::HierarchyIndex::expandGroup(std::size_t pending) const noexcept
+{
+    std::swap(m_pending_groups[pending], m_pending_groups.back());
+    auto group = std::move(m_pending_groups.back());
+    m_pending_groups.pop_back();
+
+    addChildren(group.node, group.entry, true);
+}
+
+/**
+ * @brief Indexes everything in the pending groups that a query could match
+ * @details A group is only expanded in full if the query has a wildcard for
+ *          its children, otherwise only the named child is indexed.
+ *
+ * @param query The query to index for
+ */
+void HMDT::Project::Hierarchy::HierarchyIndex::expandMatching(const Query& query) const noexcept
+{
+    const auto& segments = query.getSegments();
+
+    // Groups added while expanding end up at the back, so get checked too
+    for(std::size_t i = 0; i < m_pending_groups.size(); ) {
+        auto entry = m_pending_groups[i].entry;
+        static const std::vector<std::string> NO_PARTS;
+        const auto& parts = entry == NO_PARENT ? NO_PARTS : m_entries[entry].parts;
+
+        bool reachable = parts.size() < segments.size();
+        for(std::size_t s = 0; reachable && s < parts.size(); ++s) {
+            reachable = segments[s] == Query::WILDCARD || segments[s] == parts[s];
+        }
+
+        if(!reachable) {
+            ++i;
+            continue;
+        }
+
+        const auto& next = segments[parts.size()];
+        if(next == Query::WILDCARD) {
+            // The last pending group gets swapped into i, so don't move on
+            expandGroup(i);
+        } else {
+            auto path = parts.empty() ? next
+                                      : m_entries[entry].path + '/' + next;
+            if(m_path_index.count(path) == 0) {
+                expandChild(i, next);
+            }
+            ++i;
+        }
+    }
+}
+
+/**
+ * @brief Indexes the children of every pending group
+ */
+void HMDT::Project::Hierarchy::HierarchyIndex::expandAll() const noexcept {
+    while(!m_pending_groups.empty()) {
+        expandGroup(m_pending_groups.size() - 1);
+    }
+}
+
+/**
+ * @brief Gets the node for every given entry index
+ */
+auto HMDT::Project::Hierarchy::HierarchyIndex::getNodes(const std::vector<std::size_t>& indices) const noexcept
+    -> std::vector<INodePtr>
+{
+    std::vector<INodePtr> nodes;
+    nodes.reserve(indices.size());
+
+    for(auto index : indices) {
+        nodes.push_back(m_entries[index].node);
+    }
+
+    return nodes;
+}
+
@@ -1,5 +1,6 @@
 
 #include "INode.h"
+#include "IndexedGroupNode.h"
 #include "Util.h"
 
 /**
@@ -9,12 +10,9 @@
  */
 template<typename NodePtr>
 HMDT::Project::Hierarchy::INode::IteratorImpl<NodePtr>::IteratorImpl(NodePtr node):
-    m_nodes()
-{
-    if(node != nullptr) {
-        m_nodes.push(node);
-    }
-}
+    m_current(std::move(node)),
+    m_frames()
+{ }
 
 /**
  * @brief Increments the iterator by one
@@ -24,7 +22,7 @@ HMDT::Project::Hierarchy::INode::IteratorImpl<NodePtr>::IteratorImpl(NodePtr nod
 template<typename NodePtr>
 auto HMDT::Project::Hierarchy::INode::IteratorImpl<NodePtr>::operator++() -> IteratorImpl& {
     // Do not attempt to increment if we are at the end
-    if(m_nodes.empty()) {
+    if(isEnd()) {
         return *this;
     }
 
@@ -43,7 +41,7 @@ template<typename NodePtr>
 auto HMDT::Project::Hierarchy::INode::IteratorImpl<NodePtr>::operator*() const noexcept
     -> NodePtr
 {
-    return this->getNodeStack().top();
+    return m_current;
 }
 
 /**
@@ -55,7 +53,7 @@ template<typename NodePtr>
 auto HMDT::Project::Hierarchy::INode::IteratorImpl<NodePtr>::operator->() const noexcept
     -> NodePtr
 {
-    return this->getNodeStack().top();
+    return m_current;
 }
 
 /**
@@ -65,34 +63,74 @@ auto HMDT::Project::Hierarchy::INode::IteratorImpl<NodePtr>::operator->() const
  */
 template<typename NodePtr>
 bool HMDT::Project::Hierarchy::INode::IteratorImpl<NodePtr>::isEnd() const noexcept {
-    return m_nodes.empty();
+    return m_current == nullptr;
 }
 
 /**
  * @brief Advances the iterator by one node.
- * @details Performs one single step of a breadth-first
- *          search of the node tree. Will assume that
- *          m_nodes is not empty.
+ * @details Steps into the current node if it is a group, otherwise moves on to
+ *          the next child of the closest group which has any left. Will assume
+ *          that the iterator is not at the end.
  */
 template<typename NodePtr>
 void HMDT::Project::Hierarchy::INode::IteratorImpl<NodePtr>::advance() noexcept {
-    // _MKM_DEBUG_OUTPUT << "advance()" << std::endl;
-    auto node = m_nodes.top();
-    m_nodes.pop();
-
-    // If the node is some sort of group node, then add all of its children to
-    //   m_nodes. Use dynamic_pointer_cast instead of getType() as we want to do
-    //   this for any subclass of IGroupNode, not just for GroupNodes.
-    if(auto gnode = std::dynamic_pointer_cast<const IGroupNode>(node);
-            gnode != nullptr)
-    {
-        auto&& children = gnode->getChildren();
-        for(auto&& [_, child] : children) {
-            m_nodes.push(child);
+    // Use asGroup() rather than getType() as we want to do this for any
+    //   subclass of IGroupNode, not just for GroupNodes.
+    if(m_current->asGroup() != nullptr) {
+        pushFrame(m_current);
+    }
+
+    m_current = nullptr;
+
+    while(!m_frames.empty() && m_current == nullptr) {
+        auto& frame = m_frames.back();
+
+        if(frame.next >= frame.size) {
+            m_frames.pop_back();
+            continue;
+        }
+
+        auto index = frame.next++;
+
+        if(auto* igroup = frame.group->asGroup()->asIndexedGroup();
+                igroup != nullptr)
+        {
+            // Children which fail to build are skipped over
+            if(auto child = igroup->getChildAt(index); IS_SUCCESS(child)) {
+                m_current = *child;
+            }
+        } else {
+            m_current = std::move(frame.children[index]);
         }
     }
 }
 
+/**
+ * @brief Starts walking the children of a group
+ * @details Only an IndexedGroupNode's child count is looked at here, so none
+ *          of its children are built until they are stepped into.
+ *
+ * @param node The group node to walk
+ */
+template<typename NodePtr>
+void HMDT::Project::Hierarchy::INode::IteratorImpl<NodePtr>::pushFrame(const NodePtr& node) noexcept
+{
+    const auto* gnode = node->asGroup();
+
+    Frame frame{ node, {}, gnode->getChildCount(), 0 };
+
+    if(gnode->asIndexedGroup() == nullptr) {
+        frame.children.reserve(frame.size);
+        gnode->forEachChild([&frame](auto&& child) -> MaybeVoid {
+            frame.children.push_back(child);
+            return STATUS_SUCCESS;
+        });
+        frame.size = frame.children.size();
+    }
+
+    m_frames.push_back(std::move(frame));
+}
+
 // Explicitly instantiate const and non-const iterators
 template class HMDT::Project::Hierarchy::INode::IteratorImpl<HMDT::Project::Hierarchy::INodePtr>;
 template class HMDT::Project::Hierarchy::INode::IteratorImpl<HMDT::Project::Hierarchy::ConstINodePtr>;
@@ -113,6 +151,26 @@ auto HMDT::Project::Hierarchy::INode::visit(INodeVisitor visitor) noexcept
     return STATUS_SUCCESS;
 }
 
+/**
+ * @brief Gets this node as an IGroupNode
+ *
+ * @return nullptr, as this node is not a group.
+ */
+auto HMDT::Project::Hierarchy::INode::asGroup() const noexcept
+    -> const IGroupNode*
+{
+    return nullptr;
+}
+
+/**
+ * @brief Gets this node as an IGroupNode
+ *
+ * @return nullptr, as this node is not a group.
+ */
+auto HMDT::Project::Hierarchy::INode::asGroup() noexcept -> IGroupNode* {
+    return nullptr;
+}
+
 /**
  * @brief Gets a const iterator to the start of the hierarchy
  */
@@ -154,15 +212,85 @@ auto HMDT::Project::Hierarchy::IGroupNode::visit(INodeVisitor visitor) noexcept
     auto result = INode::visit(visitor);
     RETURN_IF_ERROR(result);
 
-    const Children& children = getChildren();
-    for(auto&& [_, child] : children) {
-        result = child->visit(visitor);
+    result = forEachChild([&visitor](const ChildNode& child) {
+        return child->visit(visitor);
+    });
+    RETURN_IF_ERROR(result);
+
+    return STATUS_SUCCESS;
+}
+
+auto HMDT::Project::Hierarchy::IGroupNode::asGroup() const noexcept
+    -> const IGroupNode*
+{
+    return this;
+}
+
+auto HMDT::Project::Hierarchy::IGroupNode::asGroup() noexcept -> IGroupNode* {
+    return this;
+}
+
+/**
+ * @brief Gets this node as an IndexedGroupNode
+ *
+ * @return nullptr, as this group holds all of its children up front.
+ */
+auto HMDT::Project::Hierarchy::IGroupNode::asIndexedGroup() const noexcept
+    -> const IndexedGroupNode*
+{
+    return nullptr;
+}
+
+/**
+ * @brief Gets the number of children held by this group
+ *
+ * @return The number of children held by this group
+ */
+auto HMDT::Project::Hierarchy::IGroupNode::getChildCount() const noexcept
+    -> std::size_t
+{
+    return getChildren().size();
+}
+
+/**
+ * @brief Calls a function on every child of this group
+ * @details Stops early if the callback returns a failure
+ *
+ * @param callback The function to call on each child
+ *
+ * @return STATUS_SUCCESS, or the first failure returned by callback
+ */
+auto HMDT::Project::Hierarchy::IGroupNode::forEachChild(const ChildCallback& callback) const noexcept
+    -> MaybeVoid
+{
+    for(auto&& [_, child] : getChildren()) {
+        auto result = callback(child);
         RETURN_IF_ERROR(result);
     }
 
     return STATUS_SUCCESS;
 }
 
+/**
+ * @brief Looks up a single child held by this group
+ *
+ * @param name The name of the child
+ *
+ * @return A Maybe containing the child, or STATUS_VALUE_NOT_FOUND if it
+ *         doesn't exist
+ */
+auto HMDT::Project::Hierarchy::IGroupNode::lookupChild(const std::string& name) const noexcept
+    -> Maybe<ChildNode>
+{
+    const Children& children = getChildren();
+
+    if(auto it = children.find(name); it != children.end()) {
+        return it->second;
+    }
+
+    RETURN_ERROR(STATUS_VALUE_NOT_FOUND);
+}
+
 /**
  * @brief Looks up a node held by this group
  *
@@ -174,11 +302,10 @@ auto HMDT::Project::Hierarchy::IGroupNode::visit(INodeVisitor visitor) noexcept
 auto HMDT::Project::Hierarchy::IGroupNode::operator[](const std::string& name) const noexcept
     -> Maybe<ConstChildNode>
 {
-    if(getChildren().count(name) != 0) {
-        return getChildren().at(name);
-    } else {
-        RETURN_ERROR(STATUS_VALUE_NOT_FOUND);
-    }
+    auto result = lookupChild(name);
+    RETURN_IF_ERROR(result);
+
+    return ConstChildNode(*result);
 }
 
 /**
@@ -192,12 +319,13 @@ auto HMDT::Project::Hierarchy::IGroupNode::operator[](const std::string& name) c
 auto HMDT::Project::Hierarchy::IGroupNode::operator[](const std::string& name) noexcept
     -> Maybe<ChildNode>
 {
-    if(getChildren().count(name) != 0) {
-        return getChildren().at(name);
-    } else {
+    auto result = lookupChild(name);
+    if(IS_FAILURE(result)) {
         WRITE_ERROR("Could not find ", name, " in ", std::to_string(*this));
-        RETURN_ERROR(STATUS_VALUE_NOT_FOUND);
     }
+    RETURN_IF_ERROR(result);
+
+    return *result;
 }
 
 /**
@@ -257,12 +385,10 @@ auto HMDT::Project::Hierarchy::Key::lookup(INodePtr root) const noexcept
     -> Maybe<INodePtr>
 {
     for(auto&& part : m_parts) {
-        RETURN_ERROR_IF(root->getType() != Node::Type::PROJECT &&
-                        root->getType() != Node::Type::GROUP &&
-                        root->getType() != Node::Type::STATE &&
-                        root->getType() != Node::Type::PROVINCE,
-                        STATUS_INVALID_TYPE);
-        auto result = std::dynamic_pointer_cast<IGroupNode>(root)->getChild(part);
+        auto* group = root->asGroup();
+        RETURN_ERROR_IF(group == nullptr, STATUS_INVALID_TYPE);
+
+        auto result = group->getChild(part);
         RETURN_IF_ERROR(result);
         root = *result;
     }
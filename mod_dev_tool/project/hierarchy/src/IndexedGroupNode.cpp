@@ -0,0 +1,158 @@
+
+#include "IndexedGroupNode.h"
+
+/**
+ * @brief Builds a new indexed group node
+ *
+ * @param name The name of this node
+ * @param index The index describing the children of this node
+ */
+HMDT::Project::Hierarchy::IndexedGroupNode::IndexedGroupNode(const std::string& name,
+                                                             const Index& index):
+    m_name(name),
+    m_index(index),
+    m_built_children(index.size),
+    m_num_built_children(0),
+    m_children(std::nullopt)
+{ }
+
+/**
+ * @brief Gets this node as an IndexedGroupNode
+ *
+ * @return This node
+ */
+auto HMDT::Project::Hierarchy::IndexedGroupNode::asIndexedGroup() const noexcept
+    -> const IndexedGroupNode*
+{
+    return this;
+}
+
+/**
+ * @brief Gets the collection of nodes held in this group
+ * @details Builds every child which hasn't been built yet.
+ *
+ * @return The collection of nodes held in this group
+ */
+auto HMDT::Project::Hierarchy::IndexedGroupNode::getChildren() const noexcept
+    -> const Children&
+{
+    if(!m_children) {
+        m_children.emplace();
+        m_children->reserve(m_index.size);
+
+        for(std::size_t i = 0; i < m_index.size; ++i) {
+            if(auto child = getChildAt(i); IS_SUCCESS(child)) {
+                m_children->emplace(m_index.key_at(i), *child);
+            }
+        }
+    }
+
+    return *m_children;
+}
+
+auto HMDT::Project::Hierarchy::IndexedGroupNode::getChildCount() const noexcept
+    -> std::size_t
+{
+    return m_index.size;
+}
+
+/**
+ * @brief Calls a function on every child of this group, in index order
+ * @details Builds every child which hasn't been built yet.
+ *
+ * @param callback The function to call on each child
+ *
+ * @return STATUS_SUCCESS, or the first failure returned by callback or while
+ *         building a child
+ */
+auto HMDT::Project::Hierarchy::IndexedGroupNode::forEachChild(const ChildCallback& callback) const noexcept
+    -> MaybeVoid
+{
+    for(std::size_t i = 0; i < m_index.size; ++i) {
+        auto child = getChildAt(i);
+        RETURN_IF_ERROR(child);
+
+        auto result = callback(*child);
+        RETURN_IF_ERROR(result);
+    }
+
+    return STATUS_SUCCESS;
+}
+
+/**
+ * @brief Looks up a single child held by this group, building only that child
+ *
+ * @param name The name of the child
+ *
+ * @return A Maybe containing the child, or STATUS_VALUE_NOT_FOUND if it
+ *         doesn't exist
+ */
+auto HMDT::Project::Hierarchy::IndexedGroupNode::lookupChild(const std::string& name) const noexcept
+    -> Maybe<ChildNode>
+{
+    auto index = m_index.find(name);
+    if(!index) {
+        RETURN_ERROR(STATUS_VALUE_NOT_FOUND);
+    }
+
+    return getChildAt(*index);
+}
+
+/**
+ * @brief Gets the name of this node
+ *
+ * @return The name of this group
+ */
+auto HMDT::Project::Hierarchy::IndexedGroupNode::getName() const noexcept
+    -> const std::string&
+{
+    return m_name;
+}
+
+/**
+ * @brief Gets the type of IndexedGroupNode
+ *
+ * @return Node::Type::GROUP
+ */
+auto HMDT::Project::Hierarchy::IndexedGroupNode::getType() const noexcept -> Type
+{
+    return Type::GROUP;
+}
+
+/**
+ * @brief Gets the child at the given index, building it if necessary
+ *
+ * @param index The index of the child
+ *
+ * @return A Maybe containing the child, STATUS_VALUE_NOT_FOUND if index is not a
+ *         valid index, or any error that occurred while building the child.
+ */
+auto HMDT::Project::Hierarchy::IndexedGroupNode::getChildAt(std::size_t index) const noexcept
+    -> Maybe<ChildNode>
+{
+    RETURN_ERROR_IF(index >= m_index.size, STATUS_VALUE_NOT_FOUND);
+
+    auto& child = m_built_children[index];
+
+    if(child == nullptr) {
+        auto result = m_index.make_child(index);
+        RETURN_IF_ERROR(result);
+
+        RETURN_ERROR_IF(*result == nullptr, STATUS_PARAM_CANNOT_BE_NULL);
+
+        child = *result;
+        ++m_num_built_children;
+    }
+
+    return child;
+}
+
+/**
+ * @brief Gets how many children have been built so far
+ */
+auto HMDT::Project::Hierarchy::IndexedGroupNode::getBuiltChildCount() const noexcept
+    -> std::size_t
+{
+    return m_num_built_children;
+}
+
@@ -0,0 +1,312 @@
+
+#include "Query.h"
+
+#include <sstream>
+#include <any>
+
+#include "Types.h"
+#include "Uuid.h"
+#include "Version.h"
+#include "Util.h"
+
+namespace {
+    /**
+     * @brief Converts a value held by an any to a string, if it holds a T
+     *
+     * @tparam T The type to try and get out of value
+     * @param value The value to convert
+     *
+     * @return The value as a string, or std::nullopt if value does not hold a
+     *         T.
+     */
+    template<typename T>
+    std::optional<std::string> getValueStringAs(const std::any& value) {
+        const T* v = std::any_cast<T>(&value);
+        if(v == nullptr) {
+            return std::nullopt;
+        }
+
+        if constexpr(std::is_same_v<T, std::string>) {
+            return *v;
+        } else if constexpr(HMDT::IsSymbol_v<T>) {
+            return v->str();
+        } else if constexpr(std::is_same_v<T, bool>) {
+            return *v ? "true" : "false";
+        } else if constexpr(std::is_same_v<T, HMDT::UUID>) {
+            return std::to_string(*v);
+        } else {
+            std::stringstream ss;
+            ss << *v;
+            return ss.str();
+        }
+    }
+
+    /**
+     * @brief Converts a value held by an any to a string, trying each type in
+     *        order.
+     *
+     * @tparam Ts Every type to try
+     * @param value The value to convert
+     *
+     * @return The value as a string, or std::nullopt if value holds none of Ts
+     */
+    template<typename... Ts>
+    std::optional<std::string> getValueStringAsAnyOf(const std::any& value) {
+        std::optional<std::string> result;
+
+        ((result = result ? result : getValueStringAs<Ts>(value)), ...);
+
+        return result;
+    }
+}
+
+/**
+ * @brief Parses a query expression
+ *
+ * @param expression The expression to parse
+ *
+ * @return The parsed query, or STATUS_INVALID_QUERY if the expression is not
+ *         valid.
+ */
+auto HMDT::Project::Hierarchy::Query::parse(const std::string& expression) noexcept
+    -> Maybe<Query>
+{
+    Query query;
+
+    // Split off the comparison first, if there is one
+    std::string path = expression;
+    if(auto pos = expression.find_first_of("=!"); pos != std::string::npos) {
+        if(pos + 1 >= expression.size() || expression[pos + 1] != '=') {
+            WRITE_ERROR("Expected '==' or '!=' at position ", pos, " of query '", expression, "'");
+            RETURN_ERROR(STATUS_INVALID_QUERY);
+        }
+
+        query.m_comparison = expression[pos] == '=' ? Comparison::EQUAL
+                                                    : Comparison::NOT_EQUAL;
+        path = expression.substr(0, pos);
+
+        std::string value = expression.substr(pos + 2);
+        trim(value);
+        if(value.empty()) {
+            WRITE_ERROR("Missing value to compare against in query '", expression, "'");
+            RETURN_ERROR(STATUS_INVALID_QUERY);
+        }
+
+        if(value.front() == '"') {
+            // Strip the quotes, allowing for escaped quotes inside
+            bool escaped = false;
+            bool closed = false;
+            for(auto it = value.begin() + 1; it != value.end(); ++it) {
+                if(closed) {
+                    WRITE_ERROR("Unexpected characters after value in query '", expression, "'");
+                    RETURN_ERROR(STATUS_INVALID_QUERY);
+                } else if(escaped) {
+                    query.m_value += *it;
+                    escaped = false;
+                } else if(*it == '\\') {
+                    escaped = true;
+                } else if(*it == '"') {
+                    closed = true;
+                } else {
+                    query.m_value += *it;
+                }
+            }
+
+            if(!closed) {
+                WRITE_ERROR("Unterminated string in query '", expression, "'");
+                RETURN_ERROR(STATUS_INVALID_QUERY);
+            }
+        } else {
+            query.m_value = value;
+        }
+    }
+
+    trim(path);
+
+    // A leading '/' is allowed, but means the same thing as not having one
+    if(!path.empty() && path.front() == '/') {
+        path.erase(0, 1);
+    }
+
+    if(path.empty()) {
+        WRITE_ERROR("Query '", expression, "' has no path.");
+        RETURN_ERROR(STATUS_INVALID_QUERY);
+    }
+
+    std::string::size_type start = 0;
+    while(start <= path.size()) {
+        auto end = path.find('/', start);
+        if(end == std::string::npos) {
+            end = path.size();
+        }
+
+        if(end == start) {
+            WRITE_ERROR("Empty path segment at position ", start, " of query '", expression, "'");
+            RETURN_ERROR(STATUS_INVALID_QUERY);
+        }
+
+        query.m_segments.push_back(path.substr(start, end - start));
+        start = end + 1;
+    }
+
+    return query;
+}
+
+/**
+ * @brief Runs this query against a hierarchy, without the help of an index
+ * @details Literal segments are looked up directly, so only groups which have
+ *          a wildcard segment applied to them have every child visited.
+ *
+ * @param root The node to start the query from.
+ *
+ * @return Every matching node, in the order they were found.
+ */
+auto HMDT::Project::Hierarchy::Query::execute(INodePtr root) const noexcept
+    -> Maybe<std::vector<INodePtr>>
+{
+    RETURN_ERROR_IF(root == nullptr, STATUS_PARAM_CANNOT_BE_NULL);
+
+    std::vector<INodePtr> current{ root };
+    std::vector<INodePtr> next;
+
+    for(auto&& segment : m_segments) {
+        next.clear();
+
+        for(auto&& node : current) {
+            auto* group = node->asGroup();
+            if(group == nullptr) continue;
+
+            if(segment == WILDCARD) {
+                next.reserve(next.size() + group->getChildCount());
+                group->forEachChild([&next](auto&& child) -> MaybeVoid {
+                    next.push_back(child);
+                    return STATUS_SUCCESS;
+                });
+            } else if(auto child = group->lookupChild(segment);
+                      IS_SUCCESS(child))
+            {
+                next.push_back(*child);
+            }
+        }
+
+        std::swap(current, next);
+    }
+
+    if(m_comparison == Comparison::NONE) {
+        return current;
+    }
+
+    std::vector<INodePtr> results;
+    for(auto&& node : current) {
+        auto pnode = std::dynamic_pointer_cast<IPropertyNode>(node);
+        if(pnode == nullptr) continue;
+
+        if(matchesValue(getValueString(*pnode))) {
+            results.push_back(node);
+        }
+    }
+
+    return results;
+}
+
+/**
+ * @brief Checks if a path matches the path of this query
+ *
+ * @param parts Every part of the path, relative to the queried node.
+ *
+ * @return True if the path matches, false otherwise.
+ */
+bool HMDT::Project::Hierarchy::Query::matchesPath(const std::vector<std::string>& parts) const noexcept
+{
+    if(parts.size() != m_segments.size()) {
+        return false;
+    }
+
+    for(std::size_t i = 0; i < parts.size(); ++i) {
+        if(m_segments[i] != WILDCARD && m_segments[i] != parts[i]) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/**
+ * @brief Checks if a value satisfies the comparison made by this query
+ *
+ * @param value The value to check, or std::nullopt if there is no value
+ *
+ * @return True if the value satisfies the comparison, false otherwise. Nodes
+ *         without a value only satisfy queries that make no comparison.
+ */
+bool HMDT::Project::Hierarchy::Query::matchesValue(const std::optional<std::string>& value) const noexcept
+{
+    switch(m_comparison) {
+        case Comparison::NONE:
+            return true;
+        case Comparison::EQUAL:
+            return value && *value == m_value;
+        case Comparison::NOT_EQUAL:
+            return value && *value != m_value;
+    }
+
+    UNREACHABLE();
+}
+
+auto HMDT::Project::Hierarchy::Query::getSegments() const noexcept
+    -> const std::vector<std::string>&
+{
+    return m_segments;
+}
+
+auto HMDT::Project::Hierarchy::Query::getComparison() const noexcept
+    -> Comparison
+{
+    return m_comparison;
+}
+
+auto HMDT::Project::Hierarchy::Query::getValue() const noexcept
+    -> const std::string&
+{
+    return m_value;
+}
+
+/**
+ * @brief Checks if any segment of this query is a wildcard
+ */
+bool HMDT::Project::Hierarchy::Query::hasWildcards() const noexcept {
+    for(auto&& segment : m_segments) {
+        if(segment == WILDCARD) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+/**
+ * @brief Gets the value of a property as a string, so that it can be compared
+ *        against the value in a Query.
+ *
+ * @param node The property to get the value of
+ *
+ * @return The value as a string, or std::nullopt if the node has no value or
+ *         the type of value cannot be converted to a string.
+ */
+auto HMDT::Project::Hierarchy::getValueString(const IPropertyNode& node) noexcept
+    -> std::optional<std::string>
+{
+    auto value = node.getAnyValue();
+    if(IS_FAILURE(value)) {
+        return std::nullopt;
+    }
+
+    return getValueStringAsAnyOf<std::string, bool,
+                                 int, unsigned int,
+                                 long, unsigned long,
+                                 long long, unsigned long long,
+                                 float, double,
+                                 UUID, ProvinceType, Color, Version,
+                                 TerrainID, Continent, StateCategory>(*value);
+}
+
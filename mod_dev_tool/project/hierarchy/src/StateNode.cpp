@@ -82,13 +82,13 @@ auto HMDT::Project::Hierarchy::StateNode::setManpower(const IPropertyNode::Value
  *
  * @return A status code
  */
-auto HMDT::Project::Hierarchy::StateNode::setCategory(const IPropertyNode::ValueLookup<std::string>& lookup,
+auto HMDT::Project::Hierarchy::StateNode::setCategory(const IPropertyNode::ValueLookup<StateCategory>& lookup,
                                                       const INodeVisitor& visitor) noexcept
     -> MaybeVoid
 {
-    auto category_node = std::make_shared<PropertyNode<std::string>>(StateKeys::CATEGORY,
+    auto category_node = std::make_shared<PropertyNode<StateCategory>>(StateKeys::CATEGORY,
             lookup,
-            [lookup](const std::string& category) -> MaybeVoid {
+            [lookup](const StateCategory& category) -> MaybeVoid {
                 auto result = lookup();
                 RETURN_IF_ERROR(result);
                 result->get() = category;
@@ -14,8 +14,10 @@ namespace HMDT::Project {
             virtual ~ContinentProject() = default;
 
             virtual const ContinentSet& getContinentList() const override;
+            virtual Maybe<std::size_t> getContinentIndex(const Continent&) const noexcept override;
 
-            virtual MaybeVoid save(const std::filesystem::path&) override;
+            virtual MaybeVoid prepareSave(const std::filesystem::path&,
+                                          ProjectSnapshot&) const override;
             virtual MaybeVoid load(const std::filesystem::path&) override;
             virtual MaybeVoid export_(const std::filesystem::path&) const noexcept override;
 
@@ -34,6 +36,9 @@ namespace HMDT::Project {
 
             virtual Maybe<std::shared_ptr<Hierarchy::INode>> visit(const std::function<MaybeVoid(std::shared_ptr<Hierarchy::INode>)>&) const noexcept override;
 
+        protected:
+            void buildContinentIndices() const noexcept;
+
         private:
             virtual ContinentSet& getContinents() override;
 
@@ -43,6 +48,16 @@ namespace HMDT::Project {
             //! All continents defined for this project
             std::set<std::string> m_continents;
 
+            //! The index of each continent in m_continents, by Continent ID.
+            //!   Continents which aren't in m_continents are NO_INDEX.
+            mutable std::vector<std::size_t> m_continent_indices;
+
+            //! Whether m_continent_indices matches m_continents
+            mutable bool m_are_continent_indices_valid;
+
+            //! Marks a Continent which is not in m_continents
+            constexpr static std::size_t NO_INDEX = static_cast<std::size_t>(-1);
+
             // We friend this so that it can access getContinents()
             friend class MapProject;
     };
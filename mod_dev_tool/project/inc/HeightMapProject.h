@@ -15,7 +15,8 @@ namespace HMDT::Project {
 
             virtual ~HeightMapProject() = default;
 
-            virtual MaybeVoid save(const std::filesystem::path&) override;
+            virtual MaybeVoid prepareSave(const std::filesystem::path&,
+                                          ProjectSnapshot&) const override;
             virtual MaybeVoid load(const std::filesystem::path&) override;
             virtual MaybeVoid export_(const std::filesystem::path&) const noexcept override;
 
@@ -34,6 +35,9 @@ namespace HMDT::Project {
 
             virtual MaybeVoid loadFile(const std::filesystem::path&) noexcept override;
 
+            MaybeVoid readFile(const std::filesystem::path&) noexcept;
+            MaybeVoid applyBitMap() noexcept;
+
             virtual Maybe<std::shared_ptr<Hierarchy::INode>> visit(const std::function<MaybeVoid(std::shared_ptr<Hierarchy::INode>)>&) const noexcept override;
 
             MonadOptionalRef<const BitMap2> getBitMap() const;
@@ -2,18 +2,27 @@
 # define HISTORYPROJECT_H
 
 # include <filesystem>
+# include <string>
+# include <vector>
 
 # include "IProject.h"
+# include "LoadScheduler.h"
 # include "StateProject.h"
 
 namespace HMDT::Project {
     class HistoryProject: public IRootHistoryProject {
         public:
+            //! The names of each stage of loading, see scheduleLoad()
+            static inline const std::string STATES_LOAD_STAGE = "history.states";
+
             HistoryProject(IProject&);
             virtual ~HistoryProject();
 
-            virtual MaybeVoid save(const std::filesystem::path&) override;
+            virtual MaybeVoid prepareSave(const std::filesystem::path&,
+                                          ProjectSnapshot&) const override;
             virtual MaybeVoid load(const std::filesystem::path&) override;
+            void scheduleLoad(LoadScheduler&, const std::filesystem::path&,
+                              const std::vector<std::string>& = {});
             virtual MaybeVoid export_(const std::filesystem::path&) const noexcept override;
 
             virtual IRootProject& getRootParent() override;
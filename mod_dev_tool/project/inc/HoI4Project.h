@@ -4,10 +4,14 @@
 # include <string>
 # include <vector>
 # include <filesystem>
+# include <functional>
+# include <future>
 
 # include "Version.h"
 
 # include "IProject.h"
+# include "LoadScheduler.h"
+# include "HierarchyIndex.h"
 # include "MapProject.h"
 # include "HistoryProject.h"
 
@@ -17,13 +21,20 @@ namespace HMDT::Project {
      */
     class HoI4Project: public IRootProject {
         public:
+            //! The path of every file that a save updated
+            using SaveResult = Maybe<std::vector<std::filesystem::path>>;
+
+            //! Called with the result of a background save, on the thread
+            //!   which did the saving
+            using SaveCallback = std::function<void(SaveResult)>;
+
             HoI4Project();
 
             HoI4Project(HoI4Project&&);
 
             HoI4Project(const std::filesystem::path&);
 
-            virtual ~HoI4Project() = default;
+            virtual ~HoI4Project();
 
             virtual const std::filesystem::path& getPath() const override;
             virtual std::filesystem::path getRoot() const override;
@@ -55,8 +66,15 @@ namespace HMDT::Project {
 
             virtual Maybe<std::shared_ptr<Hierarchy::INode>> visit(const std::function<MaybeVoid(std::shared_ptr<Hierarchy::INode>)>&) const noexcept override;
 
+            const Hierarchy::HierarchyIndex& getHierarchyIndex() const noexcept;
+            void updateHierarchyIndex(const std::vector<std::string>&) noexcept;
+            void invalidateHierarchyIndex() noexcept;
+
             MaybeVoid load();
+            const std::vector<LoadScheduler::StageTiming>& getLoadTimings() const noexcept;
             MaybeVoid save(bool = true);
+            MaybeVoid saveAsync(const SaveCallback& = {});
+            void waitForPendingSave();
             MaybeVoid export_() const noexcept;
 
             void setPath(const std::filesystem::path&);
@@ -75,6 +93,11 @@ namespace HMDT::Project {
             virtual MaybeVoid save(const std::filesystem::path&) override;
             virtual MaybeVoid load(const std::filesystem::path&) override;
 
+            virtual MaybeVoid prepareSave(const std::filesystem::path&,
+                                          ProjectSnapshot&) const override;
+            MaybeVoid prepareProjectFile(const std::filesystem::path&,
+                                         ProjectSnapshot&) const;
+
             virtual MaybeVoid export_(const std::filesystem::path&) const noexcept override;
 
         private:
@@ -107,6 +130,22 @@ namespace HMDT::Project {
 
             //! The path to export into.
             std::filesystem::path m_export_root;
+
+            //! The most recently started background save
+            std::future<void> m_pending_save;
+
+            //! How long each stage of the last load took
+            std::vector<LoadScheduler::StageTiming> m_load_timings;
+
+            //! Every node in the hierarchy of this project, built on demand
+            mutable Hierarchy::HierarchyIndex m_hierarchy_index;
+
+            //! Whether m_hierarchy_index matches the hierarchy
+            mutable bool m_is_hierarchy_index_valid;
+
+            //! The provinces generation m_hierarchy_index was built against,
+            //!   as a new set of provinces means a new set of nodes
+            mutable std::uint64_t m_hierarchy_provinces_generation;
     };
 
     using Project = HoI4Project;
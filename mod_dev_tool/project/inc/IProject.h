@@ -15,6 +15,8 @@
 # include "Version.h"
 
 # include "Terrain.h"
+# include "ProvinceTable.h"
+# include "ProvinceSpatialIndex.h"
 
 # include "INode.h"
 
@@ -26,6 +28,7 @@ namespace HMDT {
 
 namespace HMDT::Project {
     struct IRootProject;
+    class ProjectSnapshot;
 
     /**
      * @brief The interface for a project
@@ -50,9 +53,12 @@ namespace HMDT::Project {
         IProject();
         virtual ~IProject() = default;
 
-        virtual MaybeVoid save(const std::filesystem::path&) = 0;
+        virtual MaybeVoid save(const std::filesystem::path&);
         virtual MaybeVoid load(const std::filesystem::path&) = 0;
 
+        virtual MaybeVoid prepareSave(const std::filesystem::path&,
+                                      ProjectSnapshot&) const = 0;
+
         virtual MaybeVoid export_(const std::filesystem::path&) const noexcept = 0;
 
         virtual IRootProject& getRootParent() = 0;
@@ -109,6 +115,7 @@ namespace HMDT::Project {
      */
     struct IProvinceProject: public IMapProject {
         using ProvinceDataPtr = std::shared_ptr<unsigned char[]>;
+        using ProvinceTablePtr = std::shared_ptr<const ProvinceTable>;
 
         bool isValidProvinceLabel(uint32_t) const;
         bool isValidProvinceID(ProvinceID) const;
@@ -123,10 +130,19 @@ namespace HMDT::Project {
 
         virtual ProvinceDataPtr getPreviewData(ProvinceID) = 0;
         virtual ProvinceDataPtr getPreviewData(const Province*) = 0;
+        virtual void prefetchAdjacentPreviews(const Province*) = 0;
 
         virtual ProvinceList& getProvinces() = 0;
         virtual const ProvinceList& getProvinces() const = 0;
 
+        virtual ProvinceTablePtr getProvinceTable() const = 0;
+        virtual void rebuildProvinceTable() = 0;
+
+        virtual std::uint64_t getProvincesGeneration() const noexcept = 0;
+
+        virtual const ProvinceSpatialIndex& getSpatialIndex() const = 0;
+        virtual std::unique_ptr<uint32_t[]> buildProvinceIndexMatrix(const ProvinceTable&) const = 0;
+
         virtual const std::unordered_map<uint32_t, UUID>& getOldIDToUUIDMap() const noexcept = 0;
 
         virtual uint32_t getIDForProvinceID(const ProvinceID&) const noexcept = 0;
@@ -158,6 +174,7 @@ namespace HMDT::Project {
         virtual ~IContinentProject() = default;
 
         virtual const ContinentSet& getContinentList() const = 0;
+        virtual Maybe<std::size_t> getContinentIndex(const Continent&) const noexcept = 0;
 
         void addNewContinent(const std::string&);
         void removeContinent(const std::string&);
@@ -232,6 +249,8 @@ namespace HMDT::Project {
         virtual void removeProvinceFromState(Province&, bool = true) = 0;
 
         virtual void calculateCoastalProvinces(bool = false) = 0;
+        virtual void calculateCoastalProvinces(const std::vector<ProvinceID>&,
+                                               bool = false) = 0;
 
         // TODO: This should be its own sub-project
         virtual const std::vector<Terrain>& getTerrains() const = 0;
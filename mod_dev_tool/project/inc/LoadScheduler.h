@@ -0,0 +1,106 @@
+/**
+ * @file LoadScheduler.h
+ *
+ * @brief Defines a scheduler which runs the stages of loading a project
+ *        concurrently, in an order decided by the dependencies between them.
+ */
+
+#ifndef LOAD_SCHEDULER_H
+# define LOAD_SCHEDULER_H
+
+# include <chrono>
+# include <functional>
+# include <string>
+# include <vector>
+
+# include "Maybe.h"
+
+namespace HMDT::Project {
+    /**
+     * @brief Runs a set of named load stages, each on its own thread as soon as
+     *        every stage it depends on has finished.
+     *
+     * @details Stages which do not depend on each other (such as decoding the
+     *          heightmap and parsing the province data) are run at the same
+     *          time, so loading a project takes about as long as its longest
+     *          chain of dependent stages rather than as long as every stage
+     *          put together.
+     *
+     * @par Stages which may need to prompt the user must be added with
+     *      Affinity::CALLER, which runs them on the thread that called run().
+     *
+     * @par Once run() returns, getTimings() reports when each stage started
+     *      and how long it took.
+     */
+    class LoadScheduler {
+        public:
+            using Clock = std::chrono::steady_clock;
+
+            /**
+             * @brief A single stage of loading
+             */
+            using StageFunc = std::function<MaybeVoid()>;
+
+            /**
+             * @brief Which thread a stage may be run on
+             */
+            enum class Affinity {
+                //! The stage may be run on any thread
+                ANY,
+
+                //! The stage must be run on the thread that called run()
+                CALLER
+            };
+
+            /**
+             * @brief How long a single stage took to run
+             */
+            struct StageTiming {
+                //! The name of the stage
+                std::string name;
+
+                //! How long after run() was called that the stage started
+                Clock::duration start;
+
+                //! How long the stage took to run
+                Clock::duration duration;
+
+                //! Whether the stage was run at all
+                bool was_run;
+            };
+
+            void addStage(const std::string&, StageFunc,
+                          const std::vector<std::string>& = {},
+                          Affinity = Affinity::ANY);
+            bool hasStage(const std::string&) const noexcept;
+
+            MaybeVoid run();
+
+            const std::vector<StageTiming>& getTimings() const noexcept;
+            Clock::duration getTotalTime() const noexcept;
+            Clock::duration getCriticalPathTime() const noexcept;
+
+        private:
+            struct Stage {
+                std::string name;
+                StageFunc func;
+                std::vector<std::string> dependencies;
+                Affinity affinity;
+            };
+
+            //! Every stage, in the order they were added
+            std::vector<Stage> m_stages;
+
+            //! How long each stage took during the last call to run()
+            std::vector<StageTiming> m_timings;
+
+            //! How long the last call to run() took
+            Clock::duration m_total_time = Clock::duration::zero();
+
+            //! How long the longest chain of dependent stages took
+            Clock::duration m_critical_path_time = Clock::duration::zero();
+    };
+}
+
+#endif
+
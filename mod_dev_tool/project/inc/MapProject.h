@@ -15,6 +15,7 @@
 # include "Terrain.h"
 
 # include "IProject.h"
+# include "LoadScheduler.h"
 # include "ProvinceProject.h"
 # include "StateProject.h"
 # include "ContinentProject.h"
@@ -27,11 +28,22 @@ namespace HMDT::Project {
      */
     class MapProject: public IRootMapProject {
         public:
+            //! The names of each stage of loading, see scheduleLoad()
+            static inline const std::string INPUT_LOAD_STAGE = "map.input";
+            static inline const std::string PROVINCES_LOAD_STAGE = "map.provinces";
+            static inline const std::string CONTINENTS_LOAD_STAGE = "map.continents";
+            static inline const std::string HEIGHTMAP_READ_LOAD_STAGE = "map.heightmap.read";
+            static inline const std::string HEIGHTMAP_LOAD_STAGE = "map.heightmap";
+            static inline const std::string RIVERS_READ_LOAD_STAGE = "map.rivers.read";
+            static inline const std::string RIVERS_LOAD_STAGE = "map.rivers";
+
             MapProject(IProject&);
             virtual ~MapProject();
 
-            virtual MaybeVoid save(const std::filesystem::path&) override;
+            virtual MaybeVoid prepareSave(const std::filesystem::path&,
+                                          ProjectSnapshot&) const override;
             virtual MaybeVoid load(const std::filesystem::path&) override;
+            void scheduleLoad(LoadScheduler&, const std::filesystem::path&);
             virtual MaybeVoid export_(const std::filesystem::path&) const noexcept override;
 
             virtual std::shared_ptr<MapData> getMapData() override;
@@ -64,11 +76,17 @@ namespace HMDT::Project {
             virtual const std::vector<Terrain>& getTerrains() const override;
 
             virtual void calculateCoastalProvinces(bool = false) override;
+            virtual void calculateCoastalProvinces(const std::vector<ProvinceID>&,
+                                                   bool = false) override;
 
             virtual Maybe<std::shared_ptr<Hierarchy::INode>> visit(const std::function<MaybeVoid(std::shared_ptr<Hierarchy::INode>)>&) const noexcept override;
 
         protected:
-            MaybeVoid validateProvinceStateID(StateID, ProvinceID);
+            MaybeVoid loadInputImage(const std::filesystem::path&);
+
+            void updateCoastalProvinces(const ProvinceTable&,
+                                        const std::vector<ProvinceTable::Index>&,
+                                        bool);
 
         private:
             //! The Provinces project
@@ -0,0 +1,82 @@
+/**
+ * @file ProjectSnapshot.h
+ *
+ * @brief Defines a self-contained copy of everything a project needs to write
+ *        when it is saved.
+ */
+
+#ifndef PROJECT_SNAPSHOT_H
+# define PROJECT_SNAPSHOT_H
+
+# include <filesystem>
+# include <functional>
+# include <string>
+# include <vector>
+
+# include "Maybe.h"
+
+namespace HMDT::Project {
+    /**
+     * @brief A list of files to write, each of which holds onto its own copy
+     *        of the data it writes.
+     *
+     * @details Projects fill a snapshot in with IProject::prepareSave(),
+     *          which must copy (or share read-only references to) any data
+     *          that is written. Once it is filled in, the snapshot no longer
+     *          refers to the project at all, so it may be written on another
+     *          thread while the project continues to be edited.
+     *
+     * @par Only the provinces layer of the MapData is shared copy-on-write,
+     *      through MapData::shareProvinces(). The heightmap and rivers
+     *      bitmaps are shared as they are, since they are only ever replaced
+     *      and never changed. Everything else, such as the province, state
+     *      and continent data, is deep copied by prepareSave().
+     *
+     * @par Every file is first written to a temporary file next to it, all at
+     *      once, and flushed to disk. The temporary files are only renamed
+     *      over the real files once all of them have been written
+     *      successfully, and the original files are kept as backups until
+     *      every rename has succeeded, so a failed save never leaves a
+     *      project half-written.
+     */
+    class ProjectSnapshot {
+        public:
+            /**
+             * @brief Writes a single file
+             *
+             * @param path The path to write to. This is a temporary path, not
+             *             the path the file was added with.
+             */
+            using WriteFunc = std::function<MaybeVoid(const std::filesystem::path&)>;
+
+            //! The extension added to the path of each file while writing it
+            static inline const std::string TEMP_EXTENSION = ".tmp";
+
+            //! The extension added to the path of each original file while
+            //!   the new files are being moved into place
+            static inline const std::string BACKUP_EXTENSION = ".bak";
+
+            void addDirectory(const std::filesystem::path&);
+            void addFile(const std::filesystem::path&, WriteFunc);
+
+            Maybe<std::vector<std::filesystem::path>> write() const;
+
+            std::size_t size() const noexcept;
+            bool empty() const noexcept;
+
+        private:
+            struct File {
+                std::filesystem::path path;
+                WriteFunc write;
+            };
+
+            //! Every directory which must exist before writing, in order
+            std::vector<std::filesystem::path> m_directories;
+
+            //! Every file to write
+            std::vector<File> m_files;
+    };
+}
+
+#endif
+
@@ -0,0 +1,111 @@
+/**
+ * @file ProvincePreviewCache.h
+ *
+ * @brief Defines a thread-safe cache of province previews, which can build
+ *        previews ahead of time on a background thread.
+ */
+
+#ifndef PROVINCE_PREVIEW_CACHE_H
+# define PROVINCE_PREVIEW_CACHE_H
+
+# include <condition_variable>
+# include <cstdint>
+# include <deque>
+# include <functional>
+# include <memory>
+# include <mutex>
+# include <thread>
+# include <utility>
+# include <vector>
+
+# include "Types.h"
+# include "LRUCache.h"
+
+namespace HMDT::Project {
+    /**
+     * @brief Caches the preview image of each province.
+     *
+     * @details Previews are kept in an LRUCache whose budget is in bytes, so
+     *          a few very large provinces can't push every small one out, and
+     *          many small provinces don't use up a fixed number of slots.
+     *
+     * @par Previews can also be prefetched, in which case they are built on a
+     *      background thread. Each call to prefetch() replaces any previews
+     *      still waiting to be built, since the caller is expected to prefetch
+     *      whatever is near the current selection.
+     *
+     * @par Every method may be called from any thread.
+     */
+    class ProvincePreviewCache {
+        public:
+            using DataPtr = std::shared_ptr<unsigned char[]>;
+
+            //! Builds the preview of a single province
+            using Builder = std::function<DataPtr(const ProvinceID&,
+                                                  const BoundingBox&)>;
+
+            ProvincePreviewCache(const Builder&, std::size_t);
+            ~ProvincePreviewCache();
+
+            ProvincePreviewCache(const ProvincePreviewCache&) = delete;
+            ProvincePreviewCache& operator=(const ProvincePreviewCache&) = delete;
+
+            DataPtr get(const ProvinceID&, const BoundingBox&);
+            DataPtr find(const ProvinceID&);
+
+            void prefetch(const std::vector<std::pair<ProvinceID, BoundingBox>>&);
+            void waitForPrefetch();
+            void cancelPrefetch();
+
+            void clear();
+
+            void setByteBudget(std::size_t);
+
+            std::size_t size() const;
+            std::size_t getTotalBytes() const;
+
+            static std::size_t getPreviewSize(const BoundingBox&) noexcept;
+
+        protected:
+            void prefetchWorker();
+
+        private:
+            //! Builds each preview
+            Builder m_builder;
+
+            //! Guards m_cache and m_generation
+            mutable std::mutex m_cache_mutex;
+
+            //! Every cached preview
+            LRUCache<ProvinceID, DataPtr> m_cache;
+
+            //! Incremented every time the cache is cleared, so that previews
+            //!   which were being built at the time can be thrown away
+            std::uint64_t m_generation;
+
+            //! Guards every member below
+            std::mutex m_prefetch_mutex;
+
+            //! Signalled when there is something to prefetch, or when the
+            //!   worker should stop
+            std::condition_variable m_prefetch_cv;
+
+            //! Signalled when the worker has nothing left to do
+            std::condition_variable m_prefetch_done_cv;
+
+            //! Every preview still waiting to be prefetched
+            std::deque<std::pair<ProvinceID, BoundingBox>> m_prefetch_queue;
+
+            //! Whether the worker is currently building a preview
+            bool m_is_prefetching;
+
+            //! Whether the worker should stop
+            bool m_stop_prefetching;
+
+            //! Builds prefetched previews. Only started on the first prefetch.
+            std::thread m_prefetch_thread;
+    };
+}
+
+#endif
+
@@ -3,6 +3,8 @@
 
 # include "IProject.h"
 # include "Types.h"
+# include "ProvincePreviewCache.h"
+# include "ProvinceSpanIndex.h"
 
 namespace HMDT::Project {
     /**
@@ -13,7 +15,8 @@ namespace HMDT::Project {
             ProvinceProject(IRootMapProject&);
             virtual ~ProvinceProject();
 
-            virtual MaybeVoid save(const std::filesystem::path&) override;
+            virtual MaybeVoid prepareSave(const std::filesystem::path&,
+                                          ProjectSnapshot&) const override;
             virtual MaybeVoid load(const std::filesystem::path&) override;
             virtual MaybeVoid export_(const std::filesystem::path&) const noexcept override;
             virtual void import(const ShapeFinder&, std::shared_ptr<MapData>) override;
@@ -32,8 +35,18 @@ namespace HMDT::Project {
             virtual ProvinceList& getProvinces() override;
             virtual const ProvinceList& getProvinces() const override;
 
+            virtual ProvinceTablePtr getProvinceTable() const override;
+            virtual void rebuildProvinceTable() override;
+
+            virtual std::uint64_t getProvincesGeneration() const noexcept override;
+
+            virtual const ProvinceSpatialIndex& getSpatialIndex() const override;
+            virtual std::unique_ptr<uint32_t[]> buildProvinceIndexMatrix(const ProvinceTable&) const override;
+
             virtual ProvinceDataPtr getPreviewData(ProvinceID) override;
             virtual ProvinceDataPtr getPreviewData(const Province*) override;
+            virtual void prefetchAdjacentPreviews(const Province*) override;
+            void cancelPreviewPrefetch();
 
             virtual const std::unordered_map<uint32_t, UUID>& getOldIDToUUIDMap() const noexcept override;
 
@@ -45,8 +58,11 @@ namespace HMDT::Project {
 
             void buildProvinceOutlines();
         protected:
-            MaybeVoid saveShapeLabels(const std::filesystem::path&);
-            MaybeVoid saveProvinceData(const std::filesystem::path&, bool = false) const noexcept;
+            MaybeVoid prepareShapeLabels(const std::filesystem::path&,
+                                         ProjectSnapshot&) const;
+            MaybeVoid prepareProvinceData(const std::filesystem::path&,
+                                          ProjectSnapshot&) const;
+            MaybeVoid exportProvinceData(const std::filesystem::path&) const noexcept;
 
             MaybeVoid loadShapeLabels(const std::filesystem::path&);
             MaybeVoid loadShapeLabels2(const std::filesystem::path&);
@@ -58,9 +74,11 @@ namespace HMDT::Project {
             std::unique_ptr<unsigned char[]> getProvinceColorsForExport() const noexcept;
 
             void rebuildUUIDToIDMap() noexcept;
+            void rebuildSpanIndex();
 
         private:
-            void buildProvinceCache(const Province*);
+            ProvinceDataPtr buildProvincePreview(const ProvinceID&,
+                                                 const BoundingBox&) const;
 
             //! The parent project that this MapProject belongs to
             IRootMapProject& m_parent_project;
@@ -68,14 +86,26 @@ namespace HMDT::Project {
             //! List of all provinces
             ProvinceList m_provinces;
 
-            /**
-             * @brief A cache of province previews
-             * @details Note: We use nlohmann::fifo_map for this so that we can
-             *          do hash-based lookup while still retaining FIFO access.
-             *          This is so that the least accessed (first in) can get
-             *          garbage collected and cleaned out
-             */
-            nlohmann::fifo_map<ProvinceID, ProvinceDataPtr> m_data_cache;
+            //! A struct-of-arrays copy of m_provinces. Replaced as a whole
+            //!   (with std::atomic_store) whenever it is rebuilt, as it may be
+            //!   read from other threads.
+            std::shared_ptr<const ProvinceTable> m_province_table;
+
+            //! Bumped every time m_provinces is replaced as a whole, which
+            //!   leaves any reference into it dangling
+            std::uint64_t m_provinces_generation;
+
+            //! The row spans of every province, which previews are drawn
+            //!   from. Replaced as a whole (with std::atomic_store) whenever
+            //!   it is rebuilt, as previews may be reading it from another
+            //!   thread.
+            std::shared_ptr<const ProvinceSpanIndex> m_span_index;
+
+            //! Finds provinces by region, built from m_span_index
+            ProvinceSpatialIndex m_spatial_index;
+
+            //! A cache of province previews
+            ProvincePreviewCache m_preview_cache;
 
             //! Maps old IDs to UUIDs (only used when converting old projects)
             std::unordered_map<uint32_t, UUID> m_oldid_to_uuid;
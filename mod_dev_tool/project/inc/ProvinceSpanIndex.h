@@ -0,0 +1,69 @@
+/**
+ * @file ProvinceSpanIndex.h
+ *
+ * @brief Defines an index of the horizontal runs of pixels which make up each
+ *        province.
+ */
+
+#ifndef PROVINCE_SPAN_INDEX_H
+# define PROVINCE_SPAN_INDEX_H
+
+# include <cstdint>
+# include <unordered_map>
+# include <vector>
+
+# include "Types.h"
+
+namespace HMDT::Project {
+    /**
+     * @brief Stores every province as a list of row spans.
+     *
+     * @details A span is a horizontal run of pixels in a single row which all
+     *          belong to the same province. The spans of each province are
+     *          stored in row-major order, so walking them visits every pixel
+     *          of the province exactly once without looking at any pixel
+     *          outside of it.
+     *
+     * @par This is built from, and does not replace, the province label
+     *      matrix, so it must be rebuilt whenever the labels change.
+     */
+    class ProvinceSpanIndex {
+        public:
+            /**
+             * @brief A run of pixels in a single row
+             */
+            struct Span {
+                //! The row of the span
+                std::uint32_t y;
+
+                //! The first column of the span
+                std::uint32_t x_begin;
+
+                //! One past the last column of the span
+                std::uint32_t x_end;
+            };
+
+            using SpanList = std::vector<Span>;
+            using SpanMap = std::unordered_map<ProvinceID, SpanList>;
+
+            ProvinceSpanIndex() = default;
+            ProvinceSpanIndex(const ProvinceID*, std::uint32_t, std::uint32_t);
+
+            void build(const ProvinceID*, std::uint32_t, std::uint32_t);
+            void clear() noexcept;
+
+            const SpanList* getSpans(const ProvinceID&) const noexcept;
+            std::size_t getPixelCount(const ProvinceID&) const noexcept;
+
+            const SpanMap& getAllSpans() const noexcept;
+
+            std::size_t size() const noexcept;
+
+        private:
+            //! The spans of every province
+            SpanMap m_spans;
+    };
+}
+
+#endif
+
@@ -0,0 +1,106 @@
+/**
+ * @file ProvinceSpatialIndex.h
+ *
+ * @brief Defines a spatial index for finding which provinces are in or near
+ *        some region of the map.
+ */
+
+#ifndef PROVINCE_SPATIAL_INDEX_H
+# define PROVINCE_SPATIAL_INDEX_H
+
+# include <cstdint>
+# include <memory>
+# include <utility>
+# include <vector>
+
+# include "Types.h"
+
+# include "ProvinceSpanIndex.h"
+
+namespace HMDT::Project {
+    /**
+     * @brief Answers region queries over the provinces of a map.
+     *
+     * @details The map is split into a uniform grid of CELL_SIZE x CELL_SIZE
+     *          cells, and each cell lists every province with at least one
+     *          pixel inside of it. Queries first use the grid to find which
+     *          provinces could match, and then check the row spans of only
+     *          those provinces, so the cost depends on the size of the region
+     *          and not on the size of the map.
+     *
+     * @par A pixel is considered to be inside of a lasso if its center is
+     *      inside of the polygon, using the even-odd rule.
+     *
+     * @par This is built from a ProvinceSpanIndex, and must be rebuilt
+     *      whenever that is.
+     */
+    class ProvinceSpatialIndex {
+        public:
+            //! The width and height of each grid cell, in pixels
+            constexpr static std::uint32_t CELL_SIZE = 64;
+
+            //! A province and its distance from the queried point
+            using Neighbor = std::pair<ProvinceID, double>;
+
+            ProvinceSpatialIndex() = default;
+
+            void build(std::shared_ptr<const ProvinceSpanIndex>,
+                       std::uint32_t, std::uint32_t);
+            void clear() noexcept;
+
+            std::vector<ProvinceID> queryRect(std::uint32_t, std::uint32_t,
+                                              std::uint32_t, std::uint32_t) const;
+            std::vector<ProvinceID> queryPolygon(const std::vector<Point2D>&) const;
+            std::vector<Neighbor> queryNearest(std::uint32_t, std::uint32_t,
+                                               std::size_t) const;
+
+            std::size_t size() const noexcept;
+
+        protected:
+            /**
+             * @brief A single indexed province
+             */
+            struct Entry {
+                ProvinceID id;
+                const ProvinceSpanIndex::SpanList* spans;
+            };
+
+            using EntryIndex = std::uint32_t;
+
+            template<typename F>
+            void forEachCandidate(std::uint32_t, std::uint32_t,
+                                  std::uint32_t, std::uint32_t,
+                                  F&&) const;
+
+            const std::vector<EntryIndex>& getCell(std::uint32_t,
+                                                   std::uint32_t) const noexcept;
+
+            static double getDistance(const ProvinceSpanIndex::SpanList&,
+                                      std::uint32_t, std::uint32_t) noexcept;
+
+        private:
+            //! The spans that every entry points into
+            std::shared_ptr<const ProvinceSpanIndex> m_span_index;
+
+            //! Every indexed province
+            std::vector<Entry> m_entries;
+
+            //! The entries with pixels in each cell, in row-major order
+            std::vector<std::vector<EntryIndex>> m_cells;
+
+            //! The width of the map, in pixels
+            std::uint32_t m_width = 0;
+
+            //! The height of the map, in pixels
+            std::uint32_t m_height = 0;
+
+            //! The number of columns of cells
+            std::uint32_t m_cells_x = 0;
+
+            //! The number of rows of cells
+            std::uint32_t m_cells_y = 0;
+    };
+}
+
+#endif
+
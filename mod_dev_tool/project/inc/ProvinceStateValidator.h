@@ -0,0 +1,97 @@
+/**
+ * @file ProvinceStateValidator.h
+ *
+ * @brief Defines a validator which checks that every province and every state
+ *        agree on which provinces belong to which state.
+ */
+
+#ifndef PROVINCE_STATE_VALIDATOR_H
+# define PROVINCE_STATE_VALIDATOR_H
+
+# include <cstddef>
+# include <map>
+# include <utility>
+# include <vector>
+
+# include "Types.h"
+
+# include "ProvinceTable.h"
+
+namespace HMDT::Project {
+    /**
+     * @brief Finds every disagreement between the state each province says it
+     *        is in and the provinces each state says it holds.
+     *
+     * @details A province's own state ID is treated as the source of truth.
+     *          The provinces listed by every state are indexed once, so that
+     *          each province can then be checked on its own, in parallel,
+     *          without searching through any state.
+     *
+     * @par Fixes are applied in bulk: fixState() rebuilds the province list of
+     *      a single state in one pass, and fixProvinces() resets every
+     *      province whose state ID is invalid. Apply fixState() to every state
+     *      in getStatesToFix() before calling fixProvinces(), as the fixes are
+     *      worked out from the province table that was validated.
+     */
+    class ProvinceStateValidator {
+        public:
+            using StateMap = std::map<uint32_t, State>;
+
+            //! The state ID of a province which is not in any state
+            static constexpr StateID NO_STATE = -1;
+
+            /**
+             * @brief A single disagreement between a province and a state
+             */
+            struct Issue {
+                enum class Type {
+                    //! The province's state ID does not exist
+                    INVALID_STATE_ID,
+
+                    //! The province's state does not list the province
+                    NOT_IN_STATE,
+
+                    //! The province's state lists the province more than once
+                    DUPLICATE,
+
+                    //! A state lists a province which does not exist
+                    MISSING_PROVINCE,
+
+                    //! A state lists a province which is in a different state
+                    ORPHANED
+                };
+
+                Type type;
+                ProvinceID province;
+                StateID state;
+            };
+
+            using IssueList = std::vector<Issue>;
+
+            void validate(const ProvinceTable&, const StateMap&);
+            void clear() noexcept;
+
+            const IssueList& getIssues() const noexcept;
+            std::size_t count(Issue::Type) const noexcept;
+            bool hasErrors() const noexcept;
+
+            const std::vector<StateID>& getStatesToFix() const noexcept;
+
+            void fixState(const ProvinceTable&, State&) const;
+            void fixProvinces(ProvinceList&) const;
+
+        private:
+            //! Every issue found, grouped by province
+            IssueList m_issues;
+
+            //! Every state which fixState() would change, in ascending order
+            std::vector<StateID> m_states_to_fix;
+
+            //! Every province which needs to be added to a state, sorted by
+            //!   state
+            std::vector<std::pair<StateID, ProvinceID>> m_additions;
+    };
+}
+
+#endif
+
@@ -0,0 +1,146 @@
+/**
+ * @file ProvinceTable.h
+ *
+ * @brief Defines a struct-of-arrays view over every province in a project.
+ */
+
+#ifndef PROVINCE_TABLE_H
+# define PROVINCE_TABLE_H
+
+# include <cstdint>
+# include <limits>
+# include <optional>
+# include <unordered_map>
+# include <vector>
+
+# include "Types.h"
+
+namespace HMDT::Project {
+    /**
+     * @brief Stores every province as a set of parallel arrays.
+     *
+     * @details Each province is given a dense index in [0, size()), ordered by
+     *          ProvinceID. Every field is stored in its own contiguous array
+     *          which can be indexed directly, terrains and continents are
+     *          stored as interned symbols, and adjacency
+     *          and child lists are stored in compressed sparse row form. The
+     *          only hash lookup is getIndex(), which is only needed when
+     *          starting from a ProvinceID.
+     *
+     * @par This is built from, and does not replace, a ProvinceList, so it
+     *      must be rebuilt whenever the provinces change.
+     */
+    class ProvinceTable {
+        public:
+            //! A dense index of a province in this table
+            using Index = std::uint32_t;
+
+            //! Refers to no province at all
+            constexpr static Index INVALID_INDEX = std::numeric_limits<Index>::max();
+
+            /**
+             * @brief A contiguous range of province indices
+             */
+            class IndexRange {
+                public:
+                    using value_type = Index;
+                    using const_iterator = const Index*;
+
+                    IndexRange(const Index* first, const Index* last) noexcept:
+                        m_first(first), m_last(last)
+                    { }
+
+                    const Index* begin() const noexcept { return m_first; }
+                    const Index* end() const noexcept { return m_last; }
+
+                    std::size_t size() const noexcept { return m_last - m_first; }
+                    bool empty() const noexcept { return m_first == m_last; }
+
+                    Index operator[](std::size_t i) const noexcept {
+                        return m_first[i];
+                    }
+
+                private:
+                    const Index* m_first;
+                    const Index* m_last;
+            };
+
+            ProvinceTable() = default;
+            explicit ProvinceTable(const ProvinceList&);
+
+            void build(const ProvinceList&);
+            void clear() noexcept;
+
+            std::size_t size() const noexcept;
+            bool empty() const noexcept;
+
+            std::optional<Index> getIndex(const ProvinceID&) const noexcept;
+
+            const ProvinceID& getID(Index) const noexcept;
+            const Color& getColor(Index) const noexcept;
+            ProvinceType getType(Index) const noexcept;
+            bool isCoastal(Index) const noexcept;
+            StateID getState(Index) const noexcept;
+            const BoundingBox& getBoundingBox(Index) const noexcept;
+            TerrainID getTerrain(Index) const noexcept;
+            Continent getContinent(Index) const noexcept;
+            Index getParent(Index) const noexcept;
+
+            IndexRange getAdjacentProvinces(Index) const noexcept;
+            IndexRange getChildren(Index) const noexcept;
+
+            const std::vector<ProvinceID>& getIDs() const noexcept;
+            const std::vector<ProvinceType>& getTypes() const noexcept;
+            const std::vector<std::uint8_t>& getCoastalFlags() const noexcept;
+            const std::vector<StateID>& getStates() const noexcept;
+            const std::vector<TerrainID>& getTerrains() const noexcept;
+            const std::vector<Continent>& getContinents() const noexcept;
+
+        private:
+            //! Maps each ProvinceID to its index
+            std::unordered_map<ProvinceID, Index> m_index_of;
+
+            //! The ID of each province
+            std::vector<ProvinceID> m_ids;
+
+            //! The unique color of each province
+            std::vector<Color> m_colors;
+
+            //! The type of each province
+            std::vector<ProvinceType> m_types;
+
+            //! Whether each province is coastal (not a vector<bool> so that it
+            //!   can be read without any bit manipulation)
+            std::vector<std::uint8_t> m_coastal;
+
+            //! The state each province belongs to
+            std::vector<StateID> m_states;
+
+            //! The bounding box of each province
+            std::vector<BoundingBox> m_bounding_boxes;
+
+            //! The terrain of each province
+            std::vector<TerrainID> m_terrains;
+
+            //! The continent of each province
+            std::vector<Continent> m_continents;
+
+            //! The parent of each province, or INVALID_INDEX
+            std::vector<Index> m_parents;
+
+            //! Where each province's adjacent provinces start in m_adjacency
+            std::vector<std::size_t> m_adjacency_offsets;
+
+            //! The adjacent provinces of every province, back to back
+            std::vector<Index> m_adjacency;
+
+            //! Where each province's children start in m_children
+            std::vector<std::size_t> m_children_offsets;
+
+            //! The children of every province, back to back
+            std::vector<Index> m_children;
+    };
+}
+
+#endif
+
@@ -1,6 +1,9 @@
 #ifndef RIVERS_PROJECT_H
 # define RIVERS_PROJECT_H
 
+# include <cstdint>
+# include <vector>
+
 # include "BitMap.h"
 
 # include "IProject.h"
@@ -15,7 +18,8 @@ namespace HMDT::Project {
 
             virtual ~RiversProject() = default;
 
-            virtual MaybeVoid save(const std::filesystem::path&) override;
+            virtual MaybeVoid prepareSave(const std::filesystem::path&,
+                                          ProjectSnapshot&) const override;
             virtual MaybeVoid load(const std::filesystem::path&) override;
             virtual MaybeVoid export_(const std::filesystem::path&) const noexcept override;
 
@@ -34,14 +38,29 @@ namespace HMDT::Project {
 
             virtual MaybeVoid loadFile(const std::filesystem::path&) noexcept override;
 
+            MaybeVoid readFile(const std::filesystem::path&) noexcept;
+            MaybeVoid applyBitMap() noexcept;
+
             MonadOptionalRef<const BitMap2> getBitMap() const;
 
             virtual MaybeVoid writeTemplate(const std::filesystem::path&) const noexcept override;
 
             virtual Maybe<std::shared_ptr<Hierarchy::INode>> visit(const std::function<MaybeVoid(std::shared_ptr<Hierarchy::INode>)>&) const noexcept override;
 
+            //! Maps the dense index of every province (plus one) to the river
+            //!   palette index of its type. Entry 0 is for pixels with no
+            //!   province.
+            using PaletteTable = std::vector<uint8_t>;
+
+            static PaletteTable generatePaletteTable(const ProvinceTable&);
+            static std::uint64_t fillTemplate(uint8_t*, const uint32_t*,
+                                              const PaletteTable&,
+                                              std::uint64_t) noexcept;
+
         protected:
             MaybeVoid generateTemplate(std::unique_ptr<unsigned char[]>&) const noexcept;
+
+            static uint8_t getTemplatePaletteIndex(const ProvinceType&) noexcept;
             static ColorTable generateColorTable() noexcept;
 
         private:
@@ -5,10 +5,13 @@
 # include <map>
 # include <memory>
 # include <filesystem>
+# include <string>
+# include <vector>
 
 # include "IProject.h"
 # include "Types.h"
 # include "Maybe.h"
+# include "UniqueColorGenerator.h"
 
 namespace HMDT::Project {
     /**
@@ -26,7 +29,8 @@ namespace HMDT::Project {
             StateProject(IRootHistoryProject&);
             virtual ~StateProject();
 
-            virtual MaybeVoid save(const std::filesystem::path&) override;
+            virtual MaybeVoid prepareSave(const std::filesystem::path&,
+                                          ProjectSnapshot&) const override;
             virtual MaybeVoid load(const std::filesystem::path&) override;
             virtual MaybeVoid export_(const std::filesystem::path&) const noexcept override;
 
@@ -59,6 +63,10 @@ namespace HMDT::Project {
             Maybe<std::shared_ptr<Hierarchy::IGroupNode>> visitStates(const std::function<MaybeVoid(std::shared_ptr<Hierarchy::INode>)>&) const noexcept;
 
             StateMap& getStateMap(Token) { return getStateMap(); };
+
+            static void renderStateFile(const State&,
+                                        const std::vector<uint32_t>&,
+                                        std::string&);
         protected:
             virtual StateMap& getStateMap() override;
 
@@ -71,6 +79,9 @@ namespace HMDT::Project {
 
             //! All states defined for this project
             StateMap m_states;
+
+            //! Gives out the color of each state
+            UniqueColorAllocator m_color_allocator;
     };
 }
 
@@ -7,6 +7,7 @@
 #include "Logger.h"
 #include "Constants.h"
 #include "StatusCodes.h"
+#include "ProjectSnapshot.h"
 
 #include "GroupNode.h"
 #include "ProjectNode.h"
@@ -15,7 +16,9 @@
 
 HMDT::Project::ContinentProject::ContinentProject(IRootMapProject& parent):
     m_parent_project(parent),
-    m_continents()
+    m_continents(),
+    m_continent_indices(),
+    m_are_continent_indices_valid(false)
 { }
 
 auto HMDT::Project::ContinentProject::getContinentList() const
@@ -25,28 +28,78 @@ auto HMDT::Project::ContinentProject::getContinentList() const
 }
 
 /**
- * @brief Writes all continent data to root/$CONTINENTDATA_FILENAME
+ * @brief Gets the position of a continent in the continent list
  *
- * @param root The root where all continent data should go
- * @param ec The error code
+ * @param continent The continent to look for
  *
- * @return True if continent data was successfully loaded, false otherwise
+ * @return The 0-based index of continent, or STATUS_VALUE_NOT_FOUND if it is
+ *         not in the continent list.
  */
-auto HMDT::Project::ContinentProject::save(const std::filesystem::path& root)
-    -> MaybeVoid
+auto HMDT::Project::ContinentProject::getContinentIndex(const Continent& continent) const noexcept
+    -> Maybe<std::size_t>
 {
-    auto path = root / CONTINENTDATA_FILENAME;
+    if(!m_are_continent_indices_valid) {
+        buildContinentIndices();
+    }
 
-    // Try to open the continent file for reading.
-    if(std::ofstream out(path); out) {
-        for(auto&& continent : m_continents) {
-            out << continent << '\n';
+    if(auto id = continent.getID();
+            id < m_continent_indices.size() && m_continent_indices[id] != NO_INDEX)
+    {
+        return m_continent_indices[id];
+    }
+
+    RETURN_ERROR(STATUS_VALUE_NOT_FOUND);
+}
+
+/**
+ * @brief Rebuilds the lookup table used by getContinentIndex()
+ */
+void HMDT::Project::ContinentProject::buildContinentIndices() const noexcept {
+    m_continent_indices.clear();
+
+    std::size_t index = 0;
+    for(auto&& name : m_continents) {
+        auto id = Continent(name).getID();
+
+        if(id >= m_continent_indices.size()) {
+            m_continent_indices.resize(id + 1, NO_INDEX);
         }
-    } else {
-        WRITE_ERROR("Failed to open file ", path, ". Reason: ", std::strerror(errno));
-        RETURN_ERROR(std::make_error_code(static_cast<std::errc>(errno)));
+        m_continent_indices[id] = index++;
     }
 
+    m_are_continent_indices_valid = true;
+}
+
+/**
+ * @brief Adds all continent data to a snapshot, to be written to
+ *        root/$CONTINENTDATA_FILENAME
+ *
+ * @param root The root where all continent data should go
+ * @param snapshot The snapshot to add to
+ *
+ * @return STATUS_SUCCESS
+ */
+auto HMDT::Project::ContinentProject::prepareSave(const std::filesystem::path& root,
+                                                  ProjectSnapshot& snapshot) const
+    -> MaybeVoid
+{
+    snapshot.addFile(root / CONTINENTDATA_FILENAME,
+        [continents = m_continents](const std::filesystem::path& path)
+            -> MaybeVoid
+        {
+            // Try to open the continent file for reading.
+            if(std::ofstream out(path); out) {
+                for(auto&& continent : continents) {
+                    out << continent << '\n';
+                }
+            } else {
+                WRITE_ERROR("Failed to open file ", path, ". Reason: ", std::strerror(errno));
+                RETURN_ERROR(std::make_error_code(static_cast<std::errc>(errno)));
+            }
+
+            return STATUS_SUCCESS;
+        });
+
     return STATUS_SUCCESS;
 }
 
@@ -80,6 +133,8 @@ auto HMDT::Project::ContinentProject::load(const std::filesystem::path& root)
 
             m_continents.insert(line);
         }
+
+        m_are_continent_indices_valid = false;
     } else {
         WRITE_ERROR("Failed to open file ", path);
         RETURN_ERROR(std::make_error_code(static_cast<std::errc>(errno)));
@@ -157,6 +212,9 @@ auto HMDT::Project::ContinentProject::getRootMapParent() const
 }
 
 auto HMDT::Project::ContinentProject::getContinents() -> ContinentSet& {
+    // The caller may change the set, so the indices can't be trusted anymore
+    m_are_continent_indices_valid = false;
+
     return m_continents;
 }
 
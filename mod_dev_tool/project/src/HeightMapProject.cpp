@@ -9,6 +9,7 @@
 
 #include "Constants.h"
 #include "StatusCodes.h"
+#include "ProjectSnapshot.h"
 #include "MapData.h"
 #include "Util.h"
 
@@ -24,14 +25,17 @@ HMDT::Project::HeightMapProject::HeightMapProject(IRootMapProject& parent):
 { }
 
 /**
- * @brief Writes all continent data to root/$HEIGHTMAP_FILENAME
+ * @brief Adds the heightmap to a snapshot, to be written to
+ *        root/$HEIGHTMAP_FILENAME
  *
  * @param root The root where the heightmap should go
- * @param ec The error code
+ * @param snapshot The snapshot to add to
  *
- * @return True if the heightmap was successfully saved, false otherwise
+ * @return STATUS_SUCCESS on success, or STATUS_NO_DATA_LOADED if there is no
+ *         heightmap to save.
  */
-auto HMDT::Project::HeightMapProject::save(const std::filesystem::path& root)
+auto HMDT::Project::HeightMapProject::prepareSave(const std::filesystem::path& root,
+                                                  ProjectSnapshot& snapshot) const
     -> MaybeVoid
 {
     if(m_heightmap_bmp == nullptr) {
@@ -39,11 +43,13 @@ auto HMDT::Project::HeightMapProject::save(const std::filesystem::path& root)
         RETURN_ERROR(STATUS_NO_DATA_LOADED);
     }
 
-    auto path = root / HEIGHTMAP_FILENAME;
-
-    // Write the heightmap to a file
-    auto res = writeBMP(path, m_heightmap_bmp);
-    RETURN_IF_ERROR(res);
+    // The bitmap is only ever replaced, never changed, so it is safe to keep
+    //   writing this one even if a new one gets loaded
+    snapshot.addFile(root / HEIGHTMAP_FILENAME,
+        [bmp = std::shared_ptr<const BitMap2>(m_heightmap_bmp)](const std::filesystem::path& path)
+        {
+            return writeBMP(path, bmp);
+        });
 
     return STATUS_SUCCESS;
 }
@@ -89,7 +95,7 @@ auto HMDT::Project::HeightMapProject::export_(const std::filesystem::path& root)
     {
         // Normal map is a 24-bit bitmap
         auto normal_data_size = getMapData()->getWidth() *
-                                getMapData()->getWidth() * 3;
+                                getMapData()->getHeight() * 3;
         std::unique_ptr<unsigned char[]> normal_data;
         try {
             normal_data.reset(new unsigned char[normal_data_size]);
@@ -147,8 +153,29 @@ auto HMDT::Project::HeightMapProject::getRootMapParent() const
     return m_parent_project.getRootMapParent();
 }
 
+/**
+ * @brief Reads a heightmap file and copies it into the MapData
+ *
+ * @param path The path to the heightmap file
+ */
 auto HMDT::Project::HeightMapProject::loadFile(const std::filesystem::path& path) noexcept
     -> MaybeVoid
+{
+    auto res = readFile(path);
+    RETURN_IF_ERROR(res);
+
+    return applyBitMap();
+}
+
+/**
+ * @brief Decodes a heightmap file, without touching the MapData.
+ * @details This may be done before the MapData has been loaded, or at the
+ *          same time as it is loaded.
+ *
+ * @param path The path to the heightmap file
+ */
+auto HMDT::Project::HeightMapProject::readFile(const std::filesystem::path& path) noexcept
+    -> MaybeVoid
 {
     try {
         m_heightmap_bmp.reset(new BitMap2);
@@ -162,6 +189,19 @@ auto HMDT::Project::HeightMapProject::loadFile(const std::filesystem::path& path
 
     WRITE_DEBUG(*m_heightmap_bmp);
 
+    return STATUS_SUCCESS;
+}
+
+/**
+ * @brief Copies the heightmap read by readFile() into the MapData
+ * @details The MapData must already be loaded, as the heightmap must match its
+ *          dimensions.
+ */
+auto HMDT::Project::HeightMapProject::applyBitMap() noexcept -> MaybeVoid {
+    RETURN_ERROR_IF(m_heightmap_bmp == nullptr, STATUS_NO_DATA_LOADED);
+
+    MaybeVoid res;
+
     if(auto d = getMapData()->getDimensions();
             d.first != m_heightmap_bmp->info_header.v1.width ||
             d.second != m_heightmap_bmp->info_header.v1.height)
@@ -2,6 +2,7 @@
 #include "HistoryProject.h"
 
 #include "StatusCodes.h"
+#include "ProjectSnapshot.h"
 
 #include "ProjectNode.h"
 #include "NodeKeyNames.h"
@@ -47,16 +48,23 @@ auto HMDT::Project::HistoryProject::getRootHistoryParent() const noexcept
     return *this;
 }
 
-HMDT::MaybeVoid HMDT::Project::HistoryProject::save(const std::filesystem::path& path)
+/**
+ * @brief Adds all history data to a snapshot
+ *
+ * @param path The root path of all history related data
+ * @param snapshot The snapshot to add to
+ *
+ * @return STATUS_SUCCESS on success, or the first error encountered otherwise
+ */
+auto HMDT::Project::HistoryProject::prepareSave(const std::filesystem::path& path,
+                                                ProjectSnapshot& snapshot) const
+    -> MaybeVoid
 {
     WRITE_DEBUG("Saving all history projects to ", path);
 
-    if(!std::filesystem::exists(path)) {
-        WRITE_DEBUG("Creating directory ", path);
-        std::filesystem::create_directory(path);
-    }
+    snapshot.addDirectory(path);
 
-    auto states_result = getStateProject().save(path);
+    auto states_result = getStateProject().prepareSave(path, snapshot);
     RETURN_IF_ERROR(states_result);
 
     return STATUS_SUCCESS;
@@ -64,15 +72,35 @@ HMDT::MaybeVoid HMDT::Project::HistoryProject::save(const std::filesystem::path&
 
 HMDT::MaybeVoid HMDT::Project::HistoryProject::load(const std::filesystem::path& path)
 {
-    WRITE_DEBUG("Loading all history projects from ", path);
+    LoadScheduler scheduler;
+    scheduleLoad(scheduler, path);
 
-    if(auto result = getStateProject().load(path);
-            result.error() != std::errc::no_such_file_or_directory)
-    {
-        RETURN_IF_ERROR(result);
-    }
+    return scheduler.run();
+}
 
-    return STATUS_SUCCESS;
+/**
+ * @brief Adds every stage of loading the history data to a scheduler.
+ *
+ * @param scheduler The scheduler to add the stages to
+ * @param path The root path of all history related data
+ * @param dependencies The stages which must finish before any history data
+ *                     can be loaded.
+ */
+void HMDT::Project::HistoryProject::scheduleLoad(LoadScheduler& scheduler,
+                                                 const std::filesystem::path& path,
+                                                 const std::vector<std::string>& dependencies)
+{
+    scheduler.addStage(STATES_LOAD_STAGE, [this, path]() -> MaybeVoid {
+        WRITE_DEBUG("Loading all history projects from ", path);
+
+        if(auto result = getStateProject().load(path);
+                result.error() != std::errc::no_such_file_or_directory)
+        {
+            RETURN_IF_ERROR(result);
+        }
+
+        return STATUS_SUCCESS;
+    }, dependencies);
 }
 
 HMDT::MaybeVoid HMDT::Project::HistoryProject::export_(const std::filesystem::path& root) const noexcept
@@ -1,6 +1,7 @@
 
 #include "HoI4Project.h"
 
+#include <chrono>
 #include <fstream>
 #include <iomanip>
 #include <cstring>
@@ -11,12 +12,24 @@
 #include "Logger.h"
 #include "Constants.h"
 #include "StatusCodes.h"
+#include "ProjectSnapshot.h"
 
 #include "GroupNode.h"
 #include "ProjectNode.h"
 #include "PropertyNode.h"
 #include "NodeKeyNames.h"
 
+namespace {
+    /**
+     * @brief Converts a duration into a whole number of milliseconds, for
+     *        logging
+     */
+    auto toMilliseconds(HMDT::Project::LoadScheduler::Clock::duration duration)
+    {
+        return std::chrono::duration_cast<std::chrono::milliseconds>(duration).count();
+    }
+}
+
 HMDT::Project::HoI4Project::HoI4Project():
     m_path(),
     m_root(),
@@ -26,7 +39,10 @@ HMDT::Project::HoI4Project::HoI4Project():
     m_tags(),
     m_overrides(),
     m_map_project(*this),
-    m_history_project(*this)
+    m_history_project(*this),
+    m_hierarchy_index(),
+    m_is_hierarchy_index_valid(false),
+    m_hierarchy_provinces_generation(0)
 { }
 
 HMDT::Project::HoI4Project::HoI4Project(const std::filesystem::path& path):
@@ -38,7 +54,10 @@ HMDT::Project::HoI4Project::HoI4Project(const std::filesystem::path& path):
     m_tags(),
     m_overrides(),
     m_map_project(*this),
-    m_history_project(*this)
+    m_history_project(*this),
+    m_hierarchy_index(),
+    m_is_hierarchy_index_valid(false),
+    m_hierarchy_provinces_generation(0)
 {
 }
 
@@ -51,9 +70,24 @@ HMDT::Project::HoI4Project::HoI4Project(HoI4Project&& other):
     m_tags(std::move(other.m_tags)),
     m_overrides(std::move(other.m_overrides)),
     m_map_project(*this),
-    m_history_project(*this)
+    m_history_project(*this),
+    m_export_root(std::move(other.m_export_root)),
+    m_pending_save(std::move(other.m_pending_save)),
+    m_load_timings(std::move(other.m_load_timings)),
+    // The nodes in other's index refer to other, so it cannot be moved over
+    m_hierarchy_index(),
+    m_is_hierarchy_index_valid(false),
+    m_hierarchy_provinces_generation(0)
 { }
 
+/**
+ * @brief Destroys the project, after waiting for any background save to
+ *        finish.
+ */
+HMDT::Project::HoI4Project::~HoI4Project() {
+    waitForPendingSave();
+}
+
 const std::filesystem::path& HMDT::Project::HoI4Project::getPath() const {
     return m_path;
 }
@@ -163,6 +197,9 @@ auto HMDT::Project::HoI4Project::load(const std::filesystem::path& path)
 {
     using json = nlohmann::json;
 
+    // Everything in the hierarchy is about to be replaced
+    invalidateHierarchyIndex();
+
     if(std::ifstream in(path); in) {
         json proj;
 
@@ -245,11 +282,31 @@ auto HMDT::Project::HoI4Project::load(const std::filesystem::path& path)
         return STATUS_SUCCESS;
     }
 
-    // Load in sub-projects
-    auto result = m_map_project.load(getMapRoot());
-    RETURN_IF_ERROR(result);
+    // Load in sub-projects, running every stage that does not depend on
+    //   another at the same time
+    LoadScheduler scheduler;
+    m_map_project.scheduleLoad(scheduler, getMapRoot());
+
+    // States refer to their provinces, so they can only be loaded once the
+    //   provinces are
+    m_history_project.scheduleLoad(scheduler, getHistoryRoot(),
+                                   { MapProject::PROVINCES_LOAD_STAGE });
+
+    auto result = scheduler.run();
+
+    m_load_timings = scheduler.getTimings();
+    for(auto&& timing : m_load_timings) {
+        if(!timing.was_run) continue;
+
+        WRITE_DEBUG("Load stage '", timing.name, "' started at ",
+                    toMilliseconds(timing.start), "ms and took ",
+                    toMilliseconds(timing.duration), "ms");
+    }
+    WRITE_INFO("Loaded project data in ",
+               toMilliseconds(scheduler.getTotalTime()), "ms, of which the "
+               "longest chain of load stages took ",
+               toMilliseconds(scheduler.getCriticalPathTime()), "ms");
 
-    result = m_history_project.load(getHistoryRoot());
     RETURN_IF_ERROR(result);
 
     ////////////////////////////////////////////////////////////////////////////
@@ -274,6 +331,60 @@ auto HMDT::Project::HoI4Project::save(const std::filesystem::path& path)
 
 /**
  * @brief Saves a project to the file specified by path.
+ *
+ * @param path
+ * @param do_save_subprojects Should subprojects get saved recursively as well?
+ *
+ * @return STATUS_SUCCESS on success, or the first error encountered otherwise.
+ */
+auto HMDT::Project::HoI4Project::save(const std::filesystem::path& path,
+                                      bool do_save_subprojects)
+    -> MaybeVoid
+{
+    // Make sure that a background save can't write over us
+    waitForPendingSave();
+
+    ProjectSnapshot snapshot;
+
+    auto result = do_save_subprojects ? prepareSave(path, snapshot)
+                                      : prepareProjectFile(path, snapshot);
+    RETURN_IF_ERROR(result);
+
+    auto updated = snapshot.write();
+    RETURN_IF_ERROR(updated);
+
+    WRITE_DEBUG("Saved ", updated->size(), " files.");
+
+    return STATUS_SUCCESS;
+}
+
+/**
+ * @brief Adds the project file and every sub-project to a snapshot.
+ *
+ * @param path The path to the project file
+ * @param snapshot The snapshot to add to
+ *
+ * @return STATUS_SUCCESS on success, or the first error encountered otherwise.
+ */
+auto HMDT::Project::HoI4Project::prepareSave(const std::filesystem::path& path,
+                                             ProjectSnapshot& snapshot) const
+    -> MaybeVoid
+{
+    auto result = prepareProjectFile(path, snapshot);
+    RETURN_IF_ERROR(result);
+
+    // Save sub-projects
+    result = m_map_project.prepareSave(getMapRoot(), snapshot);
+    RETURN_IF_ERROR(result);
+
+    result = m_history_project.prepareSave(getHistoryRoot(), snapshot);
+    RETURN_IF_ERROR(result);
+
+    return STATUS_SUCCESS;
+}
+
+/**
+ * @brief Adds just the project file to a snapshot.
  * @details Format of the project file should be as follows:
  * @code
  *     {
@@ -285,51 +396,94 @@ auto HMDT::Project::HoI4Project::save(const std::filesystem::path& path)
  *     }
  * @endcode
  *
- * @param path
- * @param do_save_subprojects Should subprojects get saved recursively as well?
+ * @param path The path to the project file
+ * @param snapshot The snapshot to add to
  *
- * @return 
+ * @return STATUS_SUCCESS
  */
-auto HMDT::Project::HoI4Project::save(const std::filesystem::path& path,
-                                      bool do_save_subprojects)
+auto HMDT::Project::HoI4Project::prepareProjectFile(const std::filesystem::path& path,
+                                                    ProjectSnapshot& snapshot) const
     -> MaybeVoid
 {
     using json = nlohmann::json;
 
-    if(std::ofstream out(path); out) {
-        json proj;
+    json proj;
 
-        proj["name"] = m_name;
-        proj["tool_version"] = m_tool_version.str();
-        proj["hoi4_version"] = m_hoi4_version.str();
-        proj["tags"] = m_tags;
-        proj["overrides"] = m_overrides;
+    proj["name"] = m_name;
+    proj["tool_version"] = m_tool_version.str();
+    proj["hoi4_version"] = m_hoi4_version.str();
+    proj["tags"] = m_tags;
+    proj["overrides"] = m_overrides;
 
-        out << std::setw(4) << proj << std::endl;
-    } else {
-        WRITE_ERROR("Failed to write file to ", path, ". Reason: ", std::strerror(errno));
-        RETURN_ERROR(std::make_error_code(static_cast<std::errc>(errno)));
-    }
+    snapshot.addFile(path, [contents = proj.dump(4)](const std::filesystem::path& path)
+        -> MaybeVoid
+    {
+        if(std::ofstream out(path); out) {
+            out << contents << std::endl;
+        } else {
+            WRITE_ERROR("Failed to write file to ", path, ". Reason: ", std::strerror(errno));
+            RETURN_ERROR(std::make_error_code(static_cast<std::errc>(errno)));
+        }
+
+        return STATUS_SUCCESS;
+    });
 
     // Make the directory that the sub-projects will get saved to
-    if(!std::filesystem::exists(getMetaRoot())) {
-        std::filesystem::create_directory(getMetaRoot());
-    }
+    snapshot.addDirectory(getMetaRoot());
 
-    if(!do_save_subprojects) {
-        return STATUS_SUCCESS;
-    }
+    return STATUS_SUCCESS;
+}
 
-    // Save sub-projects
-    auto result = m_map_project.save(getMapRoot());
-    RETURN_IF_ERROR(result);
+/**
+ * @brief Saves the project in the background.
+ * @details A snapshot of the project is taken before this returns, and is then
+ *          written out on another thread, so the project may keep being changed
+ *          while it is saved. Background saves are written one at a time, in
+ *          the order they were started.
+ *
+ * @param callback Called with the result once the save has finished, which
+ *                 lists every file that was updated. Note that this is
+ *                 called on the thread that did the saving.
+ *
+ * @return STATUS_SUCCESS if the save was started, or an error if a snapshot
+ *         of the project could not be taken.
+ */
+auto HMDT::Project::HoI4Project::saveAsync(const SaveCallback& callback)
+    -> MaybeVoid
+{
+    auto snapshot = std::make_shared<ProjectSnapshot>();
 
-    result = m_history_project.save(getHistoryRoot());
+    auto result = prepareSave(m_path, *snapshot);
     RETURN_IF_ERROR(result);
 
+    WRITE_DEBUG("Saving ", snapshot->size(), " files in the background.");
+
+    m_pending_save = std::async(std::launch::async,
+        [snapshot, callback, previous = std::move(m_pending_save)]() mutable {
+            // Never let two saves write the same files at the same time
+            if(previous.valid()) {
+                previous.wait();
+            }
+
+            auto result = snapshot->write();
+
+            if(callback) {
+                callback(std::move(result));
+            }
+        });
+
     return STATUS_SUCCESS;
 }
 
+/**
+ * @brief Blocks until every background save has finished
+ */
+void HMDT::Project::HoI4Project::waitForPendingSave() {
+    if(m_pending_save.valid()) {
+        m_pending_save.wait();
+    }
+}
+
 auto HMDT::Project::HoI4Project::export_(const std::filesystem::path& root) const noexcept
     -> MaybeVoid
 {
@@ -382,6 +536,15 @@ auto HMDT::Project::HoI4Project::export_(const std::filesystem::path& root) cons
     return STATUS_SUCCESS;
 }
 
+/**
+ * @brief Gets how long each stage of the last load took
+ */
+auto HMDT::Project::HoI4Project::getLoadTimings() const noexcept
+    -> const std::vector<LoadScheduler::StageTiming>&
+{
+    return m_load_timings;
+}
+
 HMDT::MaybeVoid HMDT::Project::HoI4Project::load() {
     return load(m_path);
 }
@@ -520,3 +683,73 @@ auto HMDT::Project::HoI4Project::visit(const std::function<MaybeVoid(std::shared
     return hoi4_project_node;
 }
 
+/**
+ * @brief Gets an index of every node in this project's hierarchy, building it
+ *        first if the hierarchy may have changed since it was last built.
+ *
+ * @par Changing a property without telling the index about it through
+ *      updateHierarchyIndex() leaves its value out of date in the index, and
+ *      anything which adds or removes nodes must call
+ *      invalidateHierarchyIndex().
+ *
+ * @return The hierarchy index. If the hierarchy fails to build, then it will
+ *         be empty.
+ */
+auto HMDT::Project::HoI4Project::getHierarchyIndex() const noexcept
+    -> const Hierarchy::HierarchyIndex&
+{
+    auto provinces_generation = getMapProject().getProvinceProject().getProvincesGeneration();
+
+    if(!m_is_hierarchy_index_valid ||
+       m_hierarchy_provinces_generation != provinces_generation)
+    {
+        m_hierarchy_index.clear();
+
+        MaybeVoid result = visit([](auto&&...) -> MaybeVoid {
+                return STATUS_SUCCESS;
+            })
+            .andThen([this](auto root) -> MaybeVoid {
+                return m_hierarchy_index.build(root);
+            });
+        WRITE_IF_ERROR(result);
+
+        // Mark it as valid even on failure, so that a broken hierarchy is not
+        //   rebuilt on every single call
+        m_is_hierarchy_index_valid = true;
+        m_hierarchy_provinces_generation = provinces_generation;
+    }
+
+    return m_hierarchy_index;
+}
+
+/**
+ * @brief Tells the hierarchy index that properties have changed
+ * @details If a path is not in the index, then the index no longer matches
+ *          the hierarchy, and will be rebuilt the next time it is asked for.
+ *          Does nothing if the index has not been built yet.
+ *
+ * @param paths The path to every property which changed
+ */
+void HMDT::Project::HoI4Project::updateHierarchyIndex(const std::vector<std::string>& paths) noexcept
+{
+    if(!m_is_hierarchy_index_valid) return;
+
+    for(auto&& path : paths) {
+        if(auto result = m_hierarchy_index.updateProperty(path); IS_FAILURE(result))
+        {
+            WRITE_DEBUG("Could not update ", path, " in the hierarchy index, it"
+                        " will be rebuilt.");
+            invalidateHierarchyIndex();
+            return;
+        }
+    }
+}
+
+/**
+ * @brief Marks the hierarchy index as needing to be rebuilt, for when nodes
+ *        are added to or removed from the hierarchy.
+ */
+void HMDT::Project::HoI4Project::invalidateHierarchyIndex() noexcept {
+    m_is_hierarchy_index_valid = false;
+    m_hierarchy_index.clear();
+}
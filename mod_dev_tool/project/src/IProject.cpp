@@ -6,10 +6,37 @@
 #include "StatusCodes.h"
 #include "Constants.h"
 
+#include "ProjectSnapshot.h"
+
 HMDT::Project::IProject::IProject() {
     resetPromptCallback();
 }
 
+/**
+ * @brief Saves the project to the given path.
+ * @details The project is first copied into a snapshot by prepareSave(), and
+ *          then every file in the snapshot is written.
+ *
+ * @param path The path to save to
+ *
+ * @return STATUS_SUCCESS on success, or the first error encountered otherwise.
+ */
+auto HMDT::Project::IProject::save(const std::filesystem::path& path)
+    -> MaybeVoid
+{
+    ProjectSnapshot snapshot;
+
+    auto result = prepareSave(path, snapshot);
+    RETURN_IF_ERROR(result);
+
+    auto updated = snapshot.write();
+    RETURN_IF_ERROR(updated);
+
+    WRITE_DEBUG("Saved ", updated->size(), " files.");
+
+    return STATUS_SUCCESS;
+}
+
 /**
  * @brief Sets the prompt callback
  *
@@ -0,0 +1,266 @@
+
+#include "LoadScheduler.h"
+
+#include <algorithm>
+#include <condition_variable>
+#include <exception>
+#include <future>
+#include <mutex>
+#include <unordered_map>
+
+#include "Logger.h"
+
+#include "StatusCodes.h"
+
+/**
+ * @brief Adds a stage to be run
+ *
+ * @param name The name of the stage, which other stages may depend on
+ * @param func The function which runs the stage. It may be called on another
+ *             thread, at the same time as any stage it does not depend on.
+ * @param dependencies The names of every stage which must finish first
+ * @param affinity Which thread the stage may be run on
+ */
+void HMDT::Project::LoadScheduler::addStage(const std::string& name,
+                                            StageFunc func,
+                                            const std::vector<std::string>& dependencies,
+                                            Affinity affinity)
+{
+    m_stages.push_back(Stage{ name, std::move(func), dependencies, affinity });
+}
+
+/**
+ * @brief Checks if a stage of the given name has been added
+ */
+bool HMDT::Project::LoadScheduler::hasStage(const std::string& name) const noexcept
+{
+    return std::any_of(m_stages.begin(), m_stages.end(),
+                       [&name](const Stage& stage) {
+                           return stage.name == name;
+                       });
+}
+
+/**
+ * @brief Runs every stage, starting each one as soon as everything it depends
+ *        on has finished.
+ * @details If any stage fails, then no more stages are started, but any which
+ *          are already running are allowed to finish.
+ *
+ * @return STATUS_SUCCESS if every stage succeeded, or the error of the first
+ *         stage (in the order they were added) that failed otherwise.
+ */
+auto HMDT::Project::LoadScheduler::run() -> MaybeVoid {
+    const auto count = m_stages.size();
+
+    m_timings.clear();
+    m_timings.reserve(count);
+    for(auto&& stage : m_stages) {
+        m_timings.push_back(StageTiming{ stage.name, Clock::duration::zero(),
+                                         Clock::duration::zero(), false });
+    }
+    m_total_time = Clock::duration::zero();
+    m_critical_path_time = Clock::duration::zero();
+
+    // Resolve every dependency name to the stage it refers to
+    std::unordered_map<std::string, std::size_t> indices;
+    for(std::size_t i = 0; i < count; ++i) {
+        if(!indices.emplace(m_stages[i].name, i).second) {
+            WRITE_ERROR("Multiple load stages are named '", m_stages[i].name, "'.");
+            RETURN_ERROR(STATUS_KEY_EXISTS);
+        }
+    }
+
+    std::vector<std::vector<std::size_t>> dependencies(count);
+    std::vector<std::vector<std::size_t>> dependents(count);
+    for(std::size_t i = 0; i < count; ++i) {
+        for(auto&& name : m_stages[i].dependencies) {
+            auto it = indices.find(name);
+            if(it == indices.end()) {
+                WRITE_ERROR("Load stage '", m_stages[i].name,
+                            "' depends on unknown stage '", name, "'.");
+                RETURN_ERROR(STATUS_KEY_NOT_FOUND);
+            }
+
+            dependencies[i].push_back(it->second);
+            dependents[it->second].push_back(i);
+        }
+    }
+
+    const auto run_start = Clock::now();
+
+    std::mutex mutex;
+    std::condition_variable finished_cv;
+
+    // Every stage which has finished but not yet been looked at, guarded by
+    //   mutex
+    std::vector<std::size_t> finished;
+
+    std::vector<std::error_code> errors(count);
+
+    auto run_stage = [&](std::size_t i) {
+        auto start = Clock::now();
+
+        std::error_code ec;
+        try {
+            if(auto result = m_stages[i].func(); IS_FAILURE(result)) {
+                ec = result.error();
+            }
+        } catch(const std::exception& e) {
+            WRITE_ERROR("Load stage '", m_stages[i].name, "' threw: ", e.what());
+            ec = STATUS_UNEXPECTED;
+        } catch(...) {
+            WRITE_ERROR("Load stage '", m_stages[i].name, "' threw.");
+            ec = STATUS_UNEXPECTED;
+        }
+
+        auto end = Clock::now();
+
+        std::lock_guard<std::mutex> lock(mutex);
+        m_timings[i].start = start - run_start;
+        m_timings[i].duration = end - start;
+        m_timings[i].was_run = true;
+        errors[i] = ec;
+
+        finished.push_back(i);
+        finished_cv.notify_one();
+    };
+
+    std::vector<std::future<void>> futures;
+    futures.reserve(count);
+
+    // Stages which must be run on this thread, and are ready to be
+    std::vector<std::size_t> caller_ready;
+
+    // How many stages have been started, but not yet looked at after finishing
+    std::size_t outstanding = 0;
+
+    auto start_stage = [&](std::size_t i) {
+        ++outstanding;
+
+        if(m_stages[i].affinity == Affinity::CALLER) {
+            caller_ready.push_back(i);
+        } else {
+            futures.push_back(std::async(std::launch::async, run_stage, i));
+        }
+    };
+
+    std::vector<std::size_t> remaining(count);
+    for(std::size_t i = 0; i < count; ++i) {
+        remaining[i] = dependencies[i].size();
+
+        if(remaining[i] == 0) {
+            start_stage(i);
+        }
+    }
+
+    // How long the longest chain of stages ending at each stage took
+    std::vector<Clock::duration> path_times(count, Clock::duration::zero());
+
+    bool failed = false;
+    std::size_t completed = 0;
+    while(outstanding > 0) {
+        if(!caller_ready.empty()) {
+            auto i = caller_ready.front();
+            caller_ready.erase(caller_ready.begin());
+
+            if(failed) {
+                --outstanding;
+                continue;
+            }
+
+            run_stage(i);
+        }
+
+        std::vector<std::size_t> done;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            finished_cv.wait(lock, [&finished]() { return !finished.empty(); });
+            done.swap(finished);
+        }
+
+        for(auto i : done) {
+            --outstanding;
+            ++completed;
+
+            // Every stage this one depends on has already been looked at, so
+            //   their path times are final
+            auto longest_dependency = Clock::duration::zero();
+            for(auto d : dependencies[i]) {
+                longest_dependency = std::max(longest_dependency, path_times[d]);
+            }
+            path_times[i] = longest_dependency + m_timings[i].duration;
+
+            if(errors[i]) {
+                WRITE_ERROR("Load stage '", m_stages[i].name, "' failed: ",
+                            errors[i].message());
+                failed = true;
+            }
+
+            if(failed) continue;
+
+            for(auto d : dependents[i]) {
+                if(--remaining[d] == 0) {
+                    start_stage(d);
+                }
+            }
+        }
+    }
+
+    m_total_time = Clock::now() - run_start;
+    if(!path_times.empty()) {
+        m_critical_path_time = *std::max_element(path_times.begin(),
+                                                 path_times.end());
+    }
+
+    if(failed) {
+        auto first_error = std::find_if(errors.begin(), errors.end(),
+                                        [](const std::error_code& ec) {
+                                            return static_cast<bool>(ec);
+                                        });
+        RETURN_ERROR(*first_error);
+    }
+
+    // If every stage we could run succeeded but some were never started, then
+    //   they must be waiting on each other
+    if(completed != count) {
+        for(std::size_t i = 0; i < count; ++i) {
+            if(!m_timings[i].was_run) {
+                WRITE_ERROR("Load stage '", m_stages[i].name,
+                            "' could not be run, as its dependencies form a cycle.");
+            }
+        }
+        RETURN_ERROR(STATUS_LOAD_STAGE_CYCLE);
+    }
+
+    return STATUS_SUCCESS;
+}
+
+/**
+ * @brief Gets how long each stage took during the last call to run(), in the
+ *        order the stages were added.
+ */
+auto HMDT::Project::LoadScheduler::getTimings() const noexcept
+    -> const std::vector<StageTiming>&
+{
+    return m_timings;
+}
+
+/**
+ * @brief Gets how long the last call to run() took from start to finish
+ */
+auto HMDT::Project::LoadScheduler::getTotalTime() const noexcept
+    -> Clock::duration
+{
+    return m_total_time;
+}
+
+/**
+ * @brief Gets how long the longest chain of dependent stages took during the
+ *        last call to run(), which is the least time run() could have taken.
+ */
+auto HMDT::Project::LoadScheduler::getCriticalPathTime() const noexcept
+    -> Clock::duration
+{
+    return m_critical_path_time;
+}
+
@@ -4,14 +4,19 @@
 #include <fstream>
 #include <cstring>
 #include <cerrno>
+#include <numeric>
+#include <algorithm>
 
 #include "Options.h"
 #include "Logger.h"
 #include "Constants.h"
 #include "Util.h"
 #include "StatusCodes.h"
+#include "ProjectSnapshot.h"
+#include "LoadScheduler.h"
 
 #include "ProvinceMapBuilder.h"
+#include "ProvinceStateValidator.h"
 
 #include "HoI4Project.h"
 
@@ -27,47 +32,50 @@ HMDT::Project::MapProject::MapProject(IProject& parent_project):
     m_terrains(getDefaultTerrains()),
     m_parent_project(parent_project)
 {
+    // Intern every known terrain up front, so that they get the smallest IDs
+    for(auto&& terrain : m_terrains) {
+        TerrainID{terrain.getIdentifier()};
+    }
 }
 
 HMDT::Project::MapProject::~MapProject() {
 }
 
 /**
- * @brief Saves all map data
+ * @brief Adds all map data to a snapshot
  *
- * @param path The root path of all map relatedd data
+ * @param path The root path of all map related data
+ * @param snapshot The snapshot to add to
  *
- * @return True if all data was ablee to be successfully loaded, false otherwise
+ * @return STATUS_SUCCESS on success, or the first error encountered otherwise
  */
-auto HMDT::Project::MapProject::save(const std::filesystem::path& path)
+auto HMDT::Project::MapProject::prepareSave(const std::filesystem::path& path,
+                                            ProjectSnapshot& snapshot) const
     -> MaybeVoid
 {
-    if(!std::filesystem::exists(path)) {
-        WRITE_DEBUG("Creating directory ", path);
-        std::filesystem::create_directory(path);
-    }
+    snapshot.addDirectory(path);
 
     MaybeVoid result = STATUS_SUCCESS;
 
-    result = m_provinces_project.save(path);
+    result = m_provinces_project.prepareSave(path, snapshot);
     if(result == STATUS_NO_DATA_LOADED) {
         result = STATUS_SUCCESS;
     }
     RETURN_IF_ERROR(result);
 
-    result = m_continent_project.save(path);
+    result = m_continent_project.prepareSave(path, snapshot);
     if(result == STATUS_NO_DATA_LOADED) {
         result = STATUS_SUCCESS;
     }
     RETURN_IF_ERROR(result);
 
-    result = m_heightmap_project.save(path);
+    result = m_heightmap_project.prepareSave(path, snapshot);
     if(result == STATUS_NO_DATA_LOADED) {
         result = STATUS_SUCCESS;
     }
     RETURN_IF_ERROR(result);
 
-    result = m_rivers_project.save(path);
+    result = m_rivers_project.prepareSave(path, snapshot);
     if(result == STATUS_NO_DATA_LOADED) {
         result = STATUS_SUCCESS;
     }
@@ -85,6 +93,102 @@ auto HMDT::Project::MapProject::save(const std::filesystem::path& path)
  */
 auto HMDT::Project::MapProject::load(const std::filesystem::path& path)
     -> MaybeVoid
+{
+    LoadScheduler scheduler;
+    scheduleLoad(scheduler, path);
+
+    return scheduler.run();
+}
+
+/**
+ * @brief Adds every stage of loading the map data to a scheduler.
+ * @details The input image must be loaded first, as everything else is
+ *          checked against its dimensions. The heightmap and rivers are
+ *          decoded alongside it though, and the continents do not depend on it
+ *          at all.
+ *
+ * @param scheduler The scheduler to add the stages to
+ * @param path The root path of all map related data
+ */
+void HMDT::Project::MapProject::scheduleLoad(LoadScheduler& scheduler,
+                                             const std::filesystem::path& path)
+{
+    // Which of the optional bitmaps actually exist. These are shared between
+    //   stages, which may run after this function has returned.
+    auto has_heightmap = std::make_shared<bool>(false);
+    auto has_rivers = std::make_shared<bool>(false);
+
+    scheduler.addStage(INPUT_LOAD_STAGE, [this, path]() {
+        return loadInputImage(path);
+    });
+
+    // This data is required
+    scheduler.addStage(PROVINCES_LOAD_STAGE, [this, path]() {
+        return m_provinces_project.load(path);
+    }, { INPUT_LOAD_STAGE });
+
+    // This data is not required (only fail if loading it failed), not if it 
+    //  doesn't exist
+    scheduler.addStage(CONTINENTS_LOAD_STAGE, [this, path]() -> MaybeVoid {
+        if(auto result = m_continent_project.load(path);
+                result.error() != std::errc::no_such_file_or_directory)
+        {
+            RETURN_IF_ERROR(result);
+        }
+
+        return STATUS_SUCCESS;
+    });
+
+    scheduler.addStage(HEIGHTMAP_READ_LOAD_STAGE,
+        [this, path, has_heightmap]() -> MaybeVoid {
+            auto heightmap_path = path / HEIGHTMAP_FILENAME;
+            if(std::error_code ec; !std::filesystem::exists(heightmap_path, ec)) {
+                RETURN_ERROR_IF(ec.value() != 0, ec);
+
+                WRITE_WARN("No data to load! No heightmap currently exists!");
+                return STATUS_SUCCESS;
+            }
+
+            *has_heightmap = true;
+            return m_heightmap_project.readFile(heightmap_path);
+        });
+
+    // Applying the heightmap may need to ask the user to convert it first
+    scheduler.addStage(HEIGHTMAP_LOAD_STAGE, [this, has_heightmap]() -> MaybeVoid {
+        if(!*has_heightmap) return STATUS_SUCCESS;
+
+        return m_heightmap_project.applyBitMap();
+    }, { INPUT_LOAD_STAGE, HEIGHTMAP_READ_LOAD_STAGE },
+    LoadScheduler::Affinity::CALLER);
+
+    scheduler.addStage(RIVERS_READ_LOAD_STAGE,
+        [this, path, has_rivers]() -> MaybeVoid {
+            auto rivers_path = path / RIVERS_FILENAME;
+            if(std::error_code ec; !std::filesystem::exists(rivers_path, ec)) {
+                RETURN_ERROR_IF(ec.value() != 0, ec);
+
+                WRITE_WARN("No data to load! No rivers currently exists!");
+                return STATUS_SUCCESS;
+            }
+
+            *has_rivers = true;
+            return m_rivers_project.readFile(rivers_path);
+        });
+
+    scheduler.addStage(RIVERS_LOAD_STAGE, [this, has_rivers]() -> MaybeVoid {
+        if(!*has_rivers) return STATUS_SUCCESS;
+
+        return m_rivers_project.applyBitMap();
+    }, { INPUT_LOAD_STAGE, RIVERS_READ_LOAD_STAGE });
+}
+
+/**
+ * @brief Loads the input map back up, and resizes the MapData to match it.
+ *
+ * @param path The root path of all map related data
+ */
+auto HMDT::Project::MapProject::loadInputImage(const std::filesystem::path& path)
+    -> MaybeVoid
 {
     // If there is no root path for this subproject, then don't bother trying
     //  to load
@@ -117,6 +221,8 @@ auto HMDT::Project::MapProject::load(const std::filesystem::path& path)
         auto iwidth = input_image->info_header.width;
         auto iheight = input_image->info_header.height;
 
+        m_provinces_project.cancelPreviewPrefetch();
+
         // Do a placement new so we keep the same memory location but update all
         //  of the data inside the shared MapData instead, so that all
         //  references are also updated too
@@ -130,30 +236,6 @@ auto HMDT::Project::MapProject::load(const std::filesystem::path& path)
     std::copy(input_data.get(), input_data.get() + m_map_data->getInputSize(),
               input_image->data);
 
-    // Now load the other related data
-    // This data is required
-    RETURN_IF_ERROR(m_provinces_project.load(path));
-
-    // This data is not required (only fail if loading it failed), not if it 
-    //  doesn't exist
-    if(auto result = m_continent_project.load(path);
-            result.error() != std::errc::no_such_file_or_directory)
-    {
-        RETURN_IF_ERROR(result);
-    }
-
-    if(auto result = m_heightmap_project.load(path);
-            result.error() != std::errc::no_such_file_or_directory)
-    {
-        RETURN_IF_ERROR(result);
-    }
-
-    if(auto result = m_rivers_project.load(path);
-            result.error() != std::errc::no_such_file_or_directory)
-    {
-        RETURN_IF_ERROR(result);
-    }
-
     return STATUS_SUCCESS;
 }
 
@@ -258,24 +340,14 @@ auto HMDT::Project::MapProject::export_(const std::filesystem::path& root) const
 
         // cities.bmp
         {
-            // Fill the map with 0x081F82
-            {
-                auto cities_data = getMapData()->getCities().lock();
-                std::generate(cities_data.get(),
-                              cities_data.get() + getMapData()->getCitiesSize(),
-                              [i = 0]() mutable {
-                                  constexpr uint8_t cdata[] = { 0x82, 0x1F, 0x08 };
-                                  auto v = cdata[i % 3];
-                                  i = (i+1) % 3;
-                                  return v;
-                              });
-            }
-
-            // TODO: writeBMP does not actually return any errors out to us, so we
-            //  need to be careful here in case it does fail
-            writeBMP(root / CITIESBMP_FILENAME,
-                     getMapData()->getCities().lock().get(),
-                     getMapData()->getWidth(), getMapData()->getHeight());
+            // Fill the map with 0x081F82. Every row is generated as it is
+            //   written, so no map-sized buffer is ever needed for this
+            auto res = writeBMPFill(root / CITIESBMP_FILENAME,
+                                    getMapData()->getWidth(),
+                                    getMapData()->getHeight(),
+                                    { 0x08, 0x1F, 0x82 },
+                                    BMPHeaderToUse::V1);
+            RETURN_IF_ERROR(res);
         }
 
         // cities.txt
@@ -286,96 +358,85 @@ auto HMDT::Project::MapProject::export_(const std::filesystem::path& root) const
     return STATUS_SUCCESS;
 }
 
-auto HMDT::Project::MapProject::validateProvinceStateID(StateID province_state_id,
-                                                        ProvinceID province_id)
-    -> MaybeVoid
-{
-    if(province_state_id != -1) {
-        const auto& state_project = getRootParent().getHistoryProject().getStateProject();
+/**
+ * @brief Validates every sub-project, and that every province and state agree
+ *        on which provinces are in which state.
+ * @details If prog_opts.fix_warnings_on_load is set, then every disagreement
+ *          between provinces and states will be fixed, all at once.
+ *
+ * @return True if the project is valid (or was fixed), false otherwise.
+ */
+bool HMDT::Project::MapProject::validateData() {
+    WRITE_DEBUG("Validating all project data.");
 
-        if(!state_project.isValidStateID(province_state_id)) {
-            WRITE_WARN("Province ", province_id, " has state ID of ", province_state_id, " which is invalid!");
-            return STATUS_PROVINCE_INVALID_STATE_ID;
-        }
+    if(!m_provinces_project.validateData()) {
+        return false;
+    }
 
-        MaybeRef<const State> state = state_project.getStateForID(province_state_id);
-        return state.andThen([&](auto state_ref) {
-            auto& state = state_ref.get();
-            if(std::find(state.provinces.begin(), state.provinces.end(), province_id) == state.provinces.end())
-            {
-                WRITE_WARN("State ", state.id, " does not contain province #", province_id, "!");
+    auto& state_project = getRootParent().getHistoryProject().getStateProject();
+    auto table = m_provinces_project.getProvinceTable();
 
-                return STATUS_PROVINCE_NOT_IN_STATE;
-            }
+    ProvinceStateValidator validator;
+    validator.validate(*table, state_project.getStates());
 
-            return STATUS_SUCCESS;
-        });
+    const auto& issues = validator.getIssues();
+    if(issues.empty()) {
+        return true;
     }
 
-    return STATUS_SUCCESS;
-}
+    using Type = ProvinceStateValidator::Issue::Type;
+    for(auto&& issue : issues) {
+        switch(issue.type) {
+            case Type::INVALID_STATE_ID:
+                WRITE_WARN("Province ", issue.province, " has state ID of ", issue.state, " which is invalid!");
+                break;
+            case Type::NOT_IN_STATE:
+                WRITE_WARN("State ", issue.state, " does not contain province #", issue.province, "!");
+                break;
+            case Type::DUPLICATE:
+                WRITE_WARN("State ", issue.state, " contains province #", issue.province, " more than once!");
+                break;
+            case Type::MISSING_PROVINCE:
+                WRITE_WARN("State ", issue.state, " contains province #", issue.province, " which does not exist!");
+                break;
+            case Type::ORPHANED:
+                WRITE_WARN("State ", issue.state, " contains province #", issue.province, " which belongs to a different state!");
+                break;
+        }
+    }
 
-bool HMDT::Project::MapProject::validateData() {
-    WRITE_DEBUG("Validating all project data.");
+    WRITE_WARN("Found ", issues.size(), " problems with the provinces of ",
+               "states: ",
+               validator.count(Type::INVALID_STATE_ID), " invalid state IDs, ",
+               validator.count(Type::NOT_IN_STATE), " missing from their state, ",
+               validator.count(Type::DUPLICATE), " duplicated, ",
+               validator.count(Type::MISSING_PROVINCE), " which do not exist, ",
+               validator.count(Type::ORPHANED), " in the wrong state.");
 
-    bool success = true;
-
-    success = success && m_provinces_project.validateData();
-
-    for(auto&& [_, local_province] : m_provinces_project.getProvinces()) {
-        auto& province = local_province;
-
-        auto result = validateProvinceStateID(province.state, province.id);
-
-        if(IS_FAILURE(result)) {
-            if(prog_opts.fix_warnings_on_load) {
-                WRITE_INFO("Attempting to fix warnings...");
-                if(result.error() == STATUS_PROVINCE_INVALID_STATE_ID) {
-                    WRITE_INFO("Setting province state ID to -1.");
-                    province.state = -1;
-                } else if(result.error() == STATUS_PROVINCE_NOT_IN_STATE) {
-                    getRootParent().getHistoryProject().getStateProject().getStateForID(province.state).andThen([&](auto prov_state_ref)
-                    {
-                        auto& prov_state = prov_state_ref.get();
-
-                        WRITE_INFO("Adding province ", province.id, " to state ", prov_state.id);
-                        prov_state.provinces.push_back(province.id);
-                    }).orElse<void>([&province]() {
-                        WRITE_ERROR("Unable to remove province ", province.id,
-                                    " from its old state ", province.state,
-                                    " as that state does not exist. Will"
-                                    " attempt to add it to the correct state"
-                                    " anyway.");
-                    });
-
-                    WRITE_INFO("Searching for any state that currently has this province...");
-                    std::vector<ProvinceID>::const_iterator province_it;
-                    auto it = std::find_if(getRootParent().getHistoryProject().getStateProject().getStates().begin(),
-                                           getRootParent().getHistoryProject().getStateProject().getStates().end(),
-                                           [&province, &province_it](auto& id_state_pair)
-                                           {
-                                               return (province_it = std::find(id_state_pair.second.provinces.begin(),
-                                                                               id_state_pair.second.provinces.end(),
-                                                                               province.id)) != id_state_pair.second.provinces.end();
-                                           });
-
-                    if(it == getRootParent().getHistoryProject().getStateProject().getStates().end()) {
-                        WRITE_INFO("No states found containing this province.");
-                    } else {
-                        WRITE_INFO("Found state ", it->second.id, " that contains province ", province.id, ". Removing the province from the state.");
-                        State& state = getRootParent().getHistoryProject().getStateProject().getStateForIterator(it);
-                        state.provinces.erase(province_it);
-                    }
-                }
-            } else {
-                success = false;
-            }
+    if(!prog_opts.fix_warnings_on_load) {
+        return !validator.hasErrors();
+    }
 
-            continue;
-        }
+    WRITE_INFO("Attempting to fix warnings...");
+
+    // States must be fixed first, since they are fixed based on the state IDs
+    //   the provinces had when they were validated
+    for(auto state_id : validator.getStatesToFix()) {
+        state_project.getStateForID(state_id).andThen([&](auto state_ref) {
+            validator.fixState(*table, state_ref.get());
+        });
     }
 
-    return success;
+    validator.fixProvinces(m_provinces_project.getProvinces());
+
+    // Provinces may have been moved out of their invalid states
+    if(validator.count(Type::INVALID_STATE_ID) != 0) {
+        state_project.updateStateIDMatrix();
+    }
+
+    WRITE_INFO("Fixed ", validator.getStatesToFix().size(), " states.");
+
+    return true;
 }
 
 HMDT::Project::IRootProject& HMDT::Project::MapProject::getRootParent() {
@@ -406,6 +467,10 @@ const HMDT::Project::IRootMapProject& HMDT::Project::MapProject::getRootMapParen
 void HMDT::Project::MapProject::import(const ShapeFinder& sf,
                                        std::shared_ptr<MapData> map_data)
 {
+    // Previews may be built from the map data in the background, so stop
+    //   that before replacing it
+    m_provinces_project.cancelPreviewPrefetch();
+
     // Do a placement new to make sure that we use the same memory location
     m_map_data->~MapData();
     new (m_map_data.get()) MapData(map_data.get());
@@ -535,33 +600,111 @@ void HMDT::Project::MapProject::removeProvinceFromState(Province& province,
  */
 void HMDT::Project::MapProject::calculateCoastalProvinces(bool dry) {
     WRITE_INFO("Calculating coastal provinces...");
-    for(auto&& [_, province] : getProvinceProject().getProvinces()) {
+
+    // Work off of the province table so that checking adjacent provinces is
+    //   just a scan over contiguous indices rather than a hash lookup for each
+    auto table = getProvinceProject().getProvinceTable();
+
+    std::vector<ProvinceTable::Index> indices(table->size());
+    std::iota(indices.begin(), indices.end(), 0);
+
+    updateCoastalProvinces(*table, indices, dry);
+    WRITE_INFO("Done.");
+}
+
+/**
+ * @brief Re-calculates whether the given provinces, and every province
+ *        adjacent to them, are coastal or not
+ * @details Meant to be used after the type of only a few provinces has
+ *          changed, as only those provinces and their neighbors can have had
+ *          their coastal status change. Will overwrite any manual coastal
+ *          configuration done by the user on those provinces.
+ *
+ * @param ids The provinces which have changed
+ * @param dry Whether or not this should actually modify the stored provinces
+ */
+void HMDT::Project::MapProject::calculateCoastalProvinces(const std::vector<ProvinceID>& ids,
+                                                          bool dry)
+{
+    auto table = getProvinceProject().getProvinceTable();
+
+    std::vector<ProvinceTable::Index> indices;
+    for(auto&& id : ids) {
+        if(auto index = table->getIndex(id); index) {
+            indices.push_back(*index);
+
+            auto adjacent = table->getAdjacentProvinces(*index);
+            indices.insert(indices.end(), adjacent.begin(), adjacent.end());
+        } else {
+            WRITE_WARN("Cannot calculate coastal status of province ", id,
+                       " as it does not exist.");
+        }
+    }
+
+    // Neighboring provinces are very likely to share neighbors, so make sure
+    //   we only check each one once
+    std::sort(indices.begin(), indices.end());
+    indices.erase(std::unique(indices.begin(), indices.end()), indices.end());
+
+    WRITE_DEBUG("Calculating coastal status of ", indices.size(),
+                " provinces affected by changes to ", ids.size(), " provinces.");
+    updateCoastalProvinces(*table, indices, dry);
+}
+
+/**
+ * @brief Calculates whether each of the given provinces is coastal or not
+ *
+ * @param table The province table to calculate from
+ * @param indices The indices into table of every province to check
+ * @param dry Whether or not this should actually modify the stored provinces
+ */
+void HMDT::Project::MapProject::updateCoastalProvinces(const ProvinceTable& table,
+                                                       const std::vector<ProvinceTable::Index>& indices,
+                                                       bool dry)
+{
+    const auto& types = table.getTypes();
+
+    // Holds the value each changed province should end up with, rather than
+    //   just which ones changed, so that a stale table can never flip a
+    //   province to the wrong value
+    std::vector<std::pair<ProvinceTable::Index, bool>> changed;
+    for(auto i : indices) {
         // Only allow LAND provinces to be auto-marked as coastal
         //   I'm not actually sure if the game will allow LAKE and SEA to be
         //   coasts, but the cases where we would want that should be rare
         //   enough that I think it's fine to just require the user to configure
         //   that manually.
-        if(province.type != ProvinceType::LAND) {
-            WRITE_DEBUG("Skipping province ", province.id, " as it's not LAND.");
+        if(types[i] != ProvinceType::LAND) {
+            WRITE_DEBUG("Skipping province ", table.getID(i), " as it's not LAND.");
             continue;
         }
 
         // A province is coastal if it is adjacent to any SEA province.
-        bool is_coastal = std::any_of(province.adjacent_provinces.begin(),
-                                      province.adjacent_provinces.end(),
-                                      [this](const auto& adj_prov_id) {
-                                          return m_provinces_project.getProvinceForID(adj_prov_id).type == ProvinceType::SEA;
+        auto adjacent = table.getAdjacentProvinces(i);
+        bool is_coastal = std::any_of(adjacent.begin(), adjacent.end(),
+                                      [&types](auto adj_index) {
+                                          return types[adj_index] == ProvinceType::SEA;
                                       });
 
-        WRITE_DEBUG("Calculated that province '", province.id, "' is ",
-                   (is_coastal ? "not " : ""), "coastal.");
-        if(!dry) {
-            province.coastal = is_coastal;
-        } else {
-            WRITE_DEBUG("Dry-Run enabled. Not modifying stored provinces.");
+        WRITE_DEBUG("Calculated that province '", table.getID(i), "' is ",
+                   (is_coastal ? "" : "not "), "coastal.");
+        if(is_coastal != table.isCoastal(i)) {
+            changed.emplace_back(i, is_coastal);
         }
     }
-    WRITE_INFO("Done.");
+
+    if(!dry) {
+        auto& provinces = getProvinceProject().getProvinces();
+        for(auto&& [i, is_coastal] : changed) {
+            provinces.at(table.getID(i)).coastal = is_coastal;
+        }
+
+        if(!changed.empty()) {
+            getProvinceProject().rebuildProvinceTable();
+        }
+    } else {
+        WRITE_DEBUG("Dry-Run enabled. Not modifying stored provinces.");
+    }
 }
 
 /**
@@ -0,0 +1,291 @@
+
+#include "ProjectSnapshot.h"
+
+#include <cerrno>
+#include <cstdio>
+#include <mutex>
+#include <set>
+
+#ifdef _WIN32
+# include <io.h>
+#else
+# include <fcntl.h>
+# include <unistd.h>
+#endif
+
+#include "Logger.h"
+
+#include "Util.h"
+#include "StatusCodes.h"
+
+namespace {
+    /**
+     * @brief Gets the temporary path that a file is written to before it is
+     *        renamed into place
+     */
+    std::filesystem::path getTempPath(const std::filesystem::path& path) {
+        auto temp_path = path;
+        temp_path += HMDT::Project::ProjectSnapshot::TEMP_EXTENSION;
+        return temp_path;
+    }
+
+    /**
+     * @brief Gets the path that an original file is kept at while the new
+     *        files are renamed into place
+     */
+    std::filesystem::path getBackupPath(const std::filesystem::path& path) {
+        auto backup_path = path;
+        backup_path += HMDT::Project::ProjectSnapshot::BACKUP_EXTENSION;
+        return backup_path;
+    }
+
+    /**
+     * @brief Makes sure everything written to a file has reached the disk, so
+     *        that it can't be renamed over the original file before then.
+     *
+     * @return An empty error code on success, or the reason it failed.
+     */
+    std::error_code syncFile(const std::filesystem::path& path) noexcept {
+        std::FILE* file = std::fopen(path.string().c_str(), "r+b");
+        if(file == nullptr) {
+            return std::error_code(errno, std::generic_category());
+        }
+
+#ifdef _WIN32
+        auto result = _commit(_fileno(file));
+#else
+        auto result = ::fsync(::fileno(file));
+#endif
+        std::error_code ec;
+        if(result != 0) {
+            ec = std::error_code(errno, std::generic_category());
+        }
+
+        std::fclose(file);
+
+        return ec;
+    }
+
+    /**
+     * @brief Makes sure that renames within a directory have reached the disk
+     * @details Only POSIX systems need this, and failures are ignored as not
+     *          every filesystem allows directories to be synced.
+     */
+    void syncDirectory([[maybe_unused]] const std::filesystem::path& path) noexcept
+    {
+#ifndef _WIN32
+        if(auto fd = ::open(path.c_str(), O_RDONLY); fd >= 0) {
+            ::fsync(fd);
+            ::close(fd);
+        }
+#endif
+    }
+}
+
+/**
+ * @brief Adds a directory which must exist before any file is written
+ *
+ * @param path The directory
+ */
+void HMDT::Project::ProjectSnapshot::addDirectory(const std::filesystem::path& path)
+{
+    m_directories.push_back(path);
+}
+
+/**
+ * @brief Adds a file to write
+ *
+ * @param path The path that the file should end up at
+ * @param write The function which writes the file. It must not refer to the
+ *              project, as it may be called on another thread.
+ */
+void HMDT::Project::ProjectSnapshot::addFile(const std::filesystem::path& path,
+                                             WriteFunc write)
+{
+    m_files.push_back(File{ path, std::move(write) });
+}
+
+/**
+ * @brief Writes every file
+ * @details Every file is written to a temporary path at the same time, and
+ *          flushed to disk. Each original file is then kept at a backup path
+ *          while the temporary files are renamed into place, and the backups
+ *          are only removed once every rename has succeeded.
+ *
+ * @par If any file fails to be written, every temporary file is removed and
+ *      none of the original files are touched. If any rename fails, then the
+ *      files which were already renamed are restored from their backups.
+ *      Any file which cannot be restored is logged, along with where its
+ *      backup was left.
+ *
+ * @return The path of every file which was updated, in the order they were
+ *         added, or the first error that was encountered.
+ */
+auto HMDT::Project::ProjectSnapshot::write() const
+    -> Maybe<std::vector<std::filesystem::path>>
+{
+    for(auto&& directory : m_directories) {
+        if(std::error_code fs_ec; !std::filesystem::exists(directory, fs_ec)) {
+            WRITE_DEBUG("Creating directory ", directory);
+
+            std::filesystem::create_directories(directory, fs_ec);
+            if(fs_ec) {
+                WRITE_ERROR("Failed to create directory ", directory, ". Reason: ", fs_ec.message());
+                RETURN_ERROR(fs_ec);
+            }
+        }
+    }
+
+    auto remove_temp_files = [this]() {
+        for(auto&& file : m_files) {
+            std::error_code fs_ec;
+            std::filesystem::remove(getTempPath(file.path), fs_ec);
+        }
+    };
+
+    std::mutex failures_mutex;
+    std::vector<std::pair<std::size_t, std::error_code>> failures;
+
+    parallelForRange(0, m_files.size(),
+        [&](std::uint64_t first, std::uint64_t last) {
+            for(auto i = first; i < last; ++i) {
+                const auto& file = m_files[i];
+                auto temp_path = getTempPath(file.path);
+
+                std::error_code ec;
+                if(auto result = file.write(temp_path); IS_FAILURE(result)) {
+                    ec = result.error();
+                } else {
+                    ec = syncFile(temp_path);
+                }
+
+                if(ec) {
+                    std::lock_guard<std::mutex> lock(failures_mutex);
+                    failures.emplace_back(i, ec);
+                }
+            }
+        });
+
+    if(!failures.empty()) {
+        for(auto&& [i, ec] : failures) {
+            WRITE_ERROR("Failed to save ", m_files[i].path, ". Reason: ", ec.message());
+        }
+
+        // Don't leave anything half-written lying around
+        remove_temp_files();
+
+        // Report the first file that failed, no matter which thread got to it
+        //   first
+        auto first_failure = std::min_element(failures.begin(), failures.end());
+        RETURN_ERROR(first_failure->second);
+    }
+
+    // Keep every original file around until all of the new ones are in place.
+    //   Hard links are used so that the originals never leave their paths,
+    //   falling back to a copy where the filesystem doesn't support them.
+    std::vector<bool> has_backup(m_files.size(), false);
+
+    auto remove_backups = [this, &has_backup]() {
+        for(std::size_t i = 0; i < m_files.size(); ++i) {
+            if(has_backup[i]) {
+                std::error_code fs_ec;
+                std::filesystem::remove(getBackupPath(m_files[i].path), fs_ec);
+            }
+        }
+    };
+
+    for(std::size_t i = 0; i < m_files.size(); ++i) {
+        const auto& path = m_files[i].path;
+        auto backup_path = getBackupPath(path);
+
+        std::error_code fs_ec;
+        if(!std::filesystem::is_regular_file(path, fs_ec)) {
+            continue;
+        }
+
+        std::filesystem::remove(backup_path, fs_ec);
+        std::filesystem::create_hard_link(path, backup_path, fs_ec);
+        if(fs_ec) {
+            fs_ec.clear();
+            std::filesystem::copy_file(path, backup_path, fs_ec);
+        }
+
+        if(fs_ec) {
+            WRITE_ERROR("Failed to back up ", path, " to ", backup_path, ". Reason: ", fs_ec.message());
+
+            remove_backups();
+            remove_temp_files();
+            RETURN_ERROR(fs_ec);
+        }
+
+        has_backup[i] = true;
+    }
+
+    for(std::size_t i = 0; i < m_files.size(); ++i) {
+        const auto& path = m_files[i].path;
+
+        std::error_code fs_ec;
+        std::filesystem::rename(getTempPath(path), path, fs_ec);
+        if(!fs_ec) {
+            continue;
+        }
+
+        WRITE_ERROR("Failed to move ", getTempPath(path), " to ", path, ". Reason: ", fs_ec.message());
+
+        // Put back everything that was already moved into place
+        for(std::size_t j = 0; j < i; ++j) {
+            const auto& moved_path = m_files[j].path;
+
+            std::error_code restore_ec;
+            if(has_backup[j]) {
+                std::filesystem::rename(getBackupPath(moved_path), moved_path, restore_ec);
+                if(restore_ec) {
+                    WRITE_ERROR("Failed to restore ", moved_path, ", which has been updated. The original was left at ", getBackupPath(moved_path), ". Reason: ", restore_ec.message());
+                }
+
+                // Either the backup is back in place, or it is now the only
+                //   copy of the original, so don't remove it either way
+                has_backup[j] = false;
+            } else {
+                std::filesystem::remove(moved_path, restore_ec);
+                if(restore_ec) {
+                    WRITE_ERROR("Failed to remove ", moved_path, ", which did not exist before saving. Reason: ", restore_ec.message());
+                }
+            }
+        }
+
+        remove_backups();
+        remove_temp_files();
+        RETURN_ERROR(fs_ec);
+    }
+
+    remove_backups();
+
+    std::vector<std::filesystem::path> updated;
+    updated.reserve(m_files.size());
+
+    std::set<std::filesystem::path> parent_directories;
+
+    for(auto&& file : m_files) {
+        updated.push_back(file.path);
+        parent_directories.insert(file.path.parent_path());
+    }
+
+    for(auto&& directory : parent_directories) {
+        syncDirectory(directory);
+    }
+
+    return updated;
+}
+
+/**
+ * @brief Gets how many files will be written
+ */
+std::size_t HMDT::Project::ProjectSnapshot::size() const noexcept {
+    return m_files.size();
+}
+
+bool HMDT::Project::ProjectSnapshot::empty() const noexcept {
+    return m_files.empty();
+}
+
@@ -0,0 +1,263 @@
+
+#include "ProvincePreviewCache.h"
+
+#include <algorithm>
+
+#include "Logger.h"
+#include "Util.h"
+
+/**
+ * @brief Constructs an empty cache
+ *
+ * @param builder Builds the preview of a single province
+ * @param byte_budget The maximum number of bytes of previews to keep
+ */
+HMDT::Project::ProvincePreviewCache::ProvincePreviewCache(const Builder& builder,
+                                                          std::size_t byte_budget):
+    m_builder(builder),
+    m_cache_mutex(),
+    m_cache(byte_budget),
+    m_generation(0),
+    m_prefetch_mutex(),
+    m_prefetch_cv(),
+    m_prefetch_done_cv(),
+    m_prefetch_queue(),
+    m_is_prefetching(false),
+    m_stop_prefetching(false),
+    m_prefetch_thread()
+{ }
+
+HMDT::Project::ProvincePreviewCache::~ProvincePreviewCache() {
+    {
+        std::lock_guard lock(m_prefetch_mutex);
+        m_stop_prefetching = true;
+        m_prefetch_queue.clear();
+    }
+    m_prefetch_cv.notify_all();
+
+    if(m_prefetch_thread.joinable()) {
+        m_prefetch_thread.join();
+    }
+}
+
+/**
+ * @brief Gets the preview of a province, building it if it isn't cached
+ *
+ * @param id The province to get the preview of
+ * @param bounding_box The bounding box of the province
+ *
+ * @return The preview data
+ */
+auto HMDT::Project::ProvincePreviewCache::get(const ProvinceID& id,
+                                              const BoundingBox& bounding_box)
+    -> DataPtr
+{
+    std::uint64_t generation;
+    {
+        std::lock_guard lock(m_cache_mutex);
+        if(auto* data = m_cache.get(id); data != nullptr) {
+            return *data;
+        }
+
+        generation = m_generation;
+    }
+
+    // We are about to build it ourselves, so there's no point in the worker
+    //   building it as well
+    {
+        std::lock_guard lock(m_prefetch_mutex);
+        m_prefetch_queue.erase(std::remove_if(m_prefetch_queue.begin(),
+                                              m_prefetch_queue.end(),
+                                              [&id](auto&& p) {
+                                                  return p.first == id;
+                                              }),
+                               m_prefetch_queue.end());
+    }
+
+    WRITE_DEBUG("No preview data for province ", id, ". Building...");
+
+    auto data = m_builder(id, bounding_box);
+
+    std::lock_guard lock(m_cache_mutex);
+    if(generation == m_generation) {
+        m_cache.put(id, data, getPreviewSize(bounding_box));
+    }
+
+    return data;
+}
+
+/**
+ * @brief Gets the preview of a province only if it is already cached
+ *
+ * @param id The province to get the preview of
+ *
+ * @return The preview data, or nullptr if it isn't cached
+ */
+auto HMDT::Project::ProvincePreviewCache::find(const ProvinceID& id) -> DataPtr
+{
+    std::lock_guard lock(m_cache_mutex);
+    if(auto* data = m_cache.get(id); data != nullptr) {
+        return *data;
+    }
+
+    return nullptr;
+}
+
+/**
+ * @brief Builds the given previews in the background, replacing anything
+ *        which was still waiting to be prefetched.
+ *
+ * @param previews The ID and bounding box of every preview to build, in the
+ *                 order they should be built.
+ */
+void HMDT::Project::ProvincePreviewCache::prefetch(const std::vector<std::pair<ProvinceID, BoundingBox>>& previews)
+{
+    {
+        std::lock_guard lock(m_prefetch_mutex);
+
+        m_prefetch_queue.clear();
+
+        {
+            std::lock_guard cache_lock(m_cache_mutex);
+            for(auto&& preview : previews) {
+                if(!m_cache.contains(preview.first)) {
+                    m_prefetch_queue.push_back(preview);
+                }
+            }
+        }
+
+        if(m_prefetch_queue.empty()) {
+            return;
+        }
+
+        if(!m_prefetch_thread.joinable()) {
+            m_prefetch_thread = std::thread(&ProvincePreviewCache::prefetchWorker,
+                                            this);
+        }
+    }
+
+    m_prefetch_cv.notify_one();
+}
+
+/**
+ * @brief Blocks until every prefetched preview has been built
+ */
+void HMDT::Project::ProvincePreviewCache::waitForPrefetch() {
+    std::unique_lock lock(m_prefetch_mutex);
+    m_prefetch_done_cv.wait(lock, [this]() {
+        return m_prefetch_queue.empty() && !m_is_prefetching;
+    });
+}
+
+/**
+ * @brief Drops every preview still waiting to be prefetched, and blocks until
+ *        the worker has finished the one it is building, if any.
+ * @details Meant to be called before anything the builder reads from is
+ *          replaced, so that the worker can never see it half-replaced.
+ */
+void HMDT::Project::ProvincePreviewCache::cancelPrefetch() {
+    std::unique_lock lock(m_prefetch_mutex);
+
+    m_prefetch_queue.clear();
+    m_prefetch_done_cv.wait(lock, [this]() {
+        return !m_is_prefetching;
+    });
+}
+
+/**
+ * @brief Removes every preview from the cache, and cancels any pending
+ *        prefetches.
+ */
+void HMDT::Project::ProvincePreviewCache::clear() {
+    {
+        std::lock_guard lock(m_prefetch_mutex);
+        m_prefetch_queue.clear();
+    }
+
+    std::lock_guard lock(m_cache_mutex);
+    m_cache.clear();
+    ++m_generation;
+}
+
+/**
+ * @brief Changes how many bytes of previews may be cached
+ */
+void HMDT::Project::ProvincePreviewCache::setByteBudget(std::size_t byte_budget)
+{
+    std::lock_guard lock(m_cache_mutex);
+    m_cache.setByteBudget(byte_budget);
+}
+
+std::size_t HMDT::Project::ProvincePreviewCache::size() const {
+    std::lock_guard lock(m_cache_mutex);
+    return m_cache.size();
+}
+
+std::size_t HMDT::Project::ProvincePreviewCache::getTotalBytes() const {
+    std::lock_guard lock(m_cache_mutex);
+    return m_cache.getTotalBytes();
+}
+
+/**
+ * @brief Gets how many bytes the preview of a province takes up
+ *
+ * @param bounding_box The bounding box of the province
+ */
+std::size_t HMDT::Project::ProvincePreviewCache::getPreviewSize(const BoundingBox& bounding_box) noexcept
+{
+    auto [width, height] = calcDims(bounding_box);
+
+    // Previews are RGBA
+    return static_cast<std::size_t>(width) * height * 4;
+}
+
+/**
+ * @brief Builds prefetched previews until told to stop
+ */
+void HMDT::Project::ProvincePreviewCache::prefetchWorker() {
+    std::unique_lock lock(m_prefetch_mutex);
+
+    while(true) {
+        m_prefetch_cv.wait(lock, [this]() {
+            return m_stop_prefetching || !m_prefetch_queue.empty();
+        });
+
+        if(m_stop_prefetching) {
+            break;
+        }
+
+        auto [id, bounding_box] = m_prefetch_queue.front();
+        m_prefetch_queue.pop_front();
+        m_is_prefetching = true;
+
+        lock.unlock();
+
+        std::uint64_t generation;
+        bool is_cached;
+        {
+            std::lock_guard cache_lock(m_cache_mutex);
+            is_cached = m_cache.contains(id);
+            generation = m_generation;
+        }
+
+        if(!is_cached) {
+            auto data = m_builder(id, bounding_box);
+
+            std::lock_guard cache_lock(m_cache_mutex);
+            if(generation == m_generation && !m_cache.contains(id)) {
+                m_cache.put(id, data, getPreviewSize(bounding_box));
+            }
+        }
+
+        lock.lock();
+        m_is_prefetching = false;
+
+        if(m_prefetch_queue.empty()) {
+            m_prefetch_done_cv.notify_all();
+        }
+    }
+
+    m_is_prefetching = false;
+    m_prefetch_done_cv.notify_all();
+}
+
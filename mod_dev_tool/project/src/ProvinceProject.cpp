@@ -4,11 +4,13 @@
 #include <fstream>
 #include <cerrno>
 #include <cstring>
+#include <algorithm>
 
 #include "Constants.h"
 #include "MapData.h"
 #include "Util.h"
 #include "StatusCodes.h"
+#include "ProjectSnapshot.h"
 #include "Options.h"
 #include "BitMap.h"
 
@@ -20,18 +22,28 @@
 
 #include "ProjectNode.h"
 #include "ProvinceNode.h"
+#include "IndexedGroupNode.h"
 #include "NodeKeyNames.h"
 
 HMDT::Project::ProvinceProject::ProvinceProject(IRootMapProject& parent_project):
     m_parent_project(parent_project),
-    m_provinces()
+    m_provinces(),
+    m_province_table(std::make_shared<const ProvinceTable>()),
+    m_provinces_generation(0),
+    m_span_index(),
+    m_spatial_index(),
+    m_preview_cache([this](const ProvinceID& id, const BoundingBox& bb) {
+                        return buildProvincePreview(id, bb);
+                    },
+                    MAX_PROVINCE_PREVIEW_CACHE_BYTES)
 {
 }
 
 HMDT::Project::ProvinceProject::~ProvinceProject() {
 }
 
-auto HMDT::Project::ProvinceProject::save(const std::filesystem::path& path)
+auto HMDT::Project::ProvinceProject::prepareSave(const std::filesystem::path& path,
+                                                 ProjectSnapshot& snapshot) const
     -> MaybeVoid
 {
     if(m_provinces.empty()) {
@@ -39,10 +51,10 @@ auto HMDT::Project::ProvinceProject::save(const std::filesystem::path& path)
         return STATUS_SUCCESS;
     }
 
-    auto shapelabels_result = saveShapeLabels(path);
+    auto shapelabels_result = prepareShapeLabels(path, snapshot);
     RETURN_IF_ERROR(shapelabels_result);
 
-    auto provdata_result = saveProvinceData(path);
+    auto provdata_result = prepareProvinceData(path, snapshot);
     RETURN_IF_ERROR(provdata_result);
 
     return STATUS_SUCCESS;
@@ -51,6 +63,10 @@ auto HMDT::Project::ProvinceProject::save(const std::filesystem::path& path)
 auto HMDT::Project::ProvinceProject::load(const std::filesystem::path& path)
     -> MaybeVoid
 {
+    // The label matrix is about to be overwritten, so make sure that no
+    //   preview is being built from it in the background
+    cancelPreviewPrefetch();
+
     if(getRootParent().getToolVersion() <= "0.25.0"_V) {
         WRITE_WARN("Tool version mismatch. Attempting to load province data "
                    "from version ", getRootParent().getToolVersion());
@@ -87,8 +103,11 @@ auto HMDT::Project::ProvinceProject::load(const std::filesystem::path& path)
     buildGraphicsData();
     buildProvinceOutlines();
 
+    rebuildSpanIndex();
+
     // Rebuild the uuid->id map last
     rebuildUUIDToIDMap();
+    rebuildProvinceTable();
 
     return STATUS_SUCCESS;
 }
@@ -125,7 +144,7 @@ auto HMDT::Project::ProvinceProject::export_(const std::filesystem::path& root)
     }
 
     // Next, export the definition.csv file.
-    result = saveProvinceData(root, true);
+    result = exportProvinceData(root);
     RETURN_IF_ERROR(result);
 
     // Next, export supply_nodes.txt and railways.txt
@@ -159,15 +178,18 @@ auto HMDT::Project::ProvinceProject::export_(const std::filesystem::path& root)
 
 void HMDT::Project::ProvinceProject::import(const ShapeFinder& sf, std::shared_ptr<MapData>)
 {
-    m_provinces = createProvincesFromShapeList(sf.getShapes());
+    cancelPreviewPrefetch();
 
-    // Clear out the province preview data
-    m_data_cache.clear();
+    m_provinces = createProvincesFromShapeList(sf.getShapes());
+    ++m_provinces_generation;
 
     buildProvinceOutlines();
 
+    rebuildSpanIndex();
+
     // Rebuild the uuid->id map last
     rebuildUUIDToIDMap();
+    rebuildProvinceTable();
 }
 
 bool HMDT::Project::ProvinceProject::validateData() {
@@ -205,83 +227,143 @@ auto HMDT::Project::ProvinceProject::getMapData() const
 }
 
 /**
- * @brief Writes all shape label data to a file.
+ * @brief Adds all shape label data to a snapshot.
+ * @details The provinces matrix is shared with the snapshot rather than
+ *          copied. MapData will make its own copy if the matrix gets changed
+ *          before the snapshot is finished with it. This is the only layer
+ *          that is shared like this.
  *
  * @param root The root where the shape label data should be written to
+ * @param snapshot The snapshot to add to
  *
- * @return True if the data was able to be successfully written, false otherwise.
+ * @return STATUS_SUCCESS
  */
-auto HMDT::Project::ProvinceProject::saveShapeLabels(const std::filesystem::path& root)
+auto HMDT::Project::ProvinceProject::prepareShapeLabels(const std::filesystem::path& root,
+                                                        ProjectSnapshot& snapshot) const
     -> MaybeVoid
 {
-    auto path = root / SHAPEDATA_FILENAME;
+    auto map_data = getMapData();
 
-    // write the shape finder data in a way that we can re-load it later
-    if(std::ofstream out(path, std::ios::binary | std::ios::out); out)
-    {
-        out << SHAPEDATA_MAGIC;
+    auto width = map_data->getWidth();
+    auto height = map_data->getHeight();
+    auto num_bytes = map_data->getProvincesSize() * sizeof(UUID);
 
-        writeData(out, getMapData()->getWidth(), 
-                       getMapData()->getHeight());
+    snapshot.addFile(root / SHAPEDATA_FILENAME,
+        [width, height, num_bytes, provinces = map_data->shareProvinces()]
+        (const std::filesystem::path& path) -> MaybeVoid
+        {
+            // write the shape finder data in a way that we can re-load it later
+            if(std::ofstream out(path, std::ios::binary | std::ios::out); out)
+            {
+                out << SHAPEDATA_MAGIC;
+
+                writeData(out, width, height);
+
+                // Write the entire label matrix to the file
+                WRITE_DEBUG("Writing province ID data [", width, " by ",
+                            height, ": ", num_bytes, " bytes.");
+                out.write(reinterpret_cast<const char*>(provinces.get()),
+                          num_bytes);
+                out << '\0';
+
+                // This is by far the largest file, so make sure that it was
+                //   actually written before it replaces the old one
+                if(!out) {
+                    WRITE_ERROR("Failed to write to file ", path);
+                    RETURN_ERROR(std::make_error_code(std::errc::io_error));
+                }
+            } else {
+                WRITE_ERROR("Failed to open file ", path);
+                RETURN_ERROR(std::make_error_code(static_cast<std::errc>(errno)));
+            }
 
-        auto num_bytes = getMapData()->getProvincesSize() * sizeof(UUID);
+            return STATUS_SUCCESS;
+        });
 
-        // Write the entire label matrix to the file
-        WRITE_DEBUG("Writing province ID data [", getMapData()->getWidth(),
-                    " by ", getMapData()->getHeight(), ": ", num_bytes,
-                    " bytes.");
-        out.write(reinterpret_cast<const char*>(getMapData()->getProvinces().lock().get()),
-                  num_bytes);
-        out << '\0';
-    } else {
-        WRITE_ERROR("Failed to open file ", path);
-        RETURN_ERROR(std::make_error_code(static_cast<std::errc>(errno)));
-    }
+    return STATUS_SUCCESS;
+}
+
+/**
+ * @brief Adds all province data to a snapshot, to be written to a .csv file
+ *
+ * @param root The root where the csv file should be written to
+ * @param snapshot The snapshot to add to
+ *
+ * @return STATUS_SUCCESS
+ */
+auto HMDT::Project::ProvinceProject::prepareProvinceData(const std::filesystem::path& root,
+                                                         ProjectSnapshot& snapshot) const
+    -> MaybeVoid
+{
+    snapshot.addFile(root / PROVINCEDATA_FILENAME,
+        [provinces = m_provinces](const std::filesystem::path& path)
+            -> MaybeVoid
+        {
+            if(std::ofstream out(path); out) {
+                // Write one line to the CSV for each province
+                for(auto&& [id, province] : provinces) {
+                    out << province.id << ';'
+                        << static_cast<int>(province.unique_color.r) << ';'
+                        << static_cast<int>(province.unique_color.g) << ';'
+                        << static_cast<int>(province.unique_color.b) << ';'
+                        << province.type << ';'
+                        << (province.coastal ? "true" : "false")
+                        << ';' << province.terrain << ';'
+                        << province.continent << ';'
+                        << province.bounding_box.bottom_left.x << ';'
+                        << province.bounding_box.bottom_left.y << ';'
+                        << province.bounding_box.top_right.x << ';'
+                        << province.bounding_box.top_right.y << ';'
+                        << province.state << ';'
+                        << province.parent_id;
+
+                    out << std::endl;
+                }
+            } else {
+                WRITE_ERROR("Failed to open file ", path);
+                RETURN_ERROR(std::make_error_code(static_cast<std::errc>(errno)));
+            }
+
+            return STATUS_SUCCESS;
+        });
 
     return STATUS_SUCCESS;
 }
 
 /**
- * @brief Writes all province data to a .csv file (the same sort of file as
- *        would be loaded by HoI4
+ * @brief Exports all province data to a .csv file (the same sort of file as
+ *        would be loaded by HoI4), with only the data that is used by HoI4
  *
  * @param root The root where the csv file should be written to
- * @param is_export Whether or not to include extra (i.e: non-HoI4) data, or
- *                  only data that is used by HoI4
  *
  * @return True if the file was able to be successfully written, false otherwise.
  */
-auto HMDT::Project::ProvinceProject::saveProvinceData(const std::filesystem::path& root,
-                                                      bool is_export) const noexcept
+auto HMDT::Project::ProvinceProject::exportProvinceData(const std::filesystem::path& root) const noexcept
     -> MaybeVoid
 {
     auto path = root / PROVINCEDATA_FILENAME;
 
     if(std::ofstream out(path); out) {
-        const auto& continents = getRootMapParent().getContinentProject().getContinentList();
+        const auto& continents = getRootMapParent().getContinentProject();
 
         bool assume_unknown_continents = false;
 
         // Write one line to the CSV for each province
         for(auto&& [id, province] : m_provinces) {
-            // If we are exporting, then we need to output a numeric ID number,
-            //   not the internal UUID we use
-            if(is_export) {
-                // For provinces that have been merged with another, skip
-                //   actually writing them when exporting because we want to
-                //   only export their parent's information
-                if(province.parent_id != INVALID_PROVINCE) {
-                    continue;
-                }
+            // For provinces that have been merged with another, skip actually
+            //   writing them when exporting because we want to only export
+            //   their parent's information
+            if(province.parent_id != INVALID_PROVINCE) {
+                continue;
+            }
 
-                // Sanity check
-                RETURN_ERROR_IF(m_uuid_to_oldid.count(id) == 0,
-                                STATUS_VALUE_NOT_FOUND);
+            // Sanity check
+            RETURN_ERROR_IF(m_uuid_to_oldid.count(id) == 0,
+                            STATUS_VALUE_NOT_FOUND);
 
-                out << getIDForProvinceID(id) << ';';
-            } else {
-                out << province.id << ';';
-            }
+            // We need to output a numeric ID number, not the internal UUID we
+            //   use
+            out << getIDForProvinceID(id) << ';';
 
             out << static_cast<int>(province.unique_color.r) << ';'
                 << static_cast<int>(province.unique_color.g) << ';'
@@ -290,47 +372,37 @@ auto HMDT::Project::ProvinceProject::saveProvinceData(const std::filesystem::pat
                 << (province.coastal ? "true" : "false")
                 << ';' << province.terrain << ';';
 
-            if(!is_export) {
-                out << province.continent << ';'
-                    << province.bounding_box.bottom_left.x << ';'
-                    << province.bounding_box.bottom_left.y << ';'
-                    << province.bounding_box.top_right.x << ';'
-                    << province.bounding_box.top_right.y << ';'
-                    << province.state << ';'
-                    << province.parent_id;
-            } else {
-                auto index = getIndexInSet(continents, province.continent);
-                if(IS_FAILURE(index)) {
-                    // Make sure we don't prompt the user for every single issue
-                    if(!assume_unknown_continents) {
-                        WRITE_WARN("Unknown continent '", province.continent,
-                                   "' detected for province ID=", province.id);
-
-                        std::stringstream ss;
-                        ss << "An unknown continent '" << province.continent
-                           << "' was detected for province ID=" << province.id
-                           << ".\nContinuing will assume all unknown "
-                              "continents are blank/0.";
-                        auto result = prompt(ss.str(),
-                                             {"Continue", "Stop Exporting"},
-                                             PromptType::ERROR);
-
-                        if(IS_FAILURE(result) || *result == 1) {
-                            RETURN_IF_ERROR(index);
-                        } else {
-                            assume_unknown_continents = true;
-                        }
+            auto index = continents.getContinentIndex(province.continent);
+            if(IS_FAILURE(index)) {
+                // Make sure we don't prompt the user for every single issue
+                if(!assume_unknown_continents) {
+                    WRITE_WARN("Unknown continent '", province.continent,
+                               "' detected for province ID=", province.id);
+
+                    std::stringstream ss;
+                    ss << "An unknown continent '" << province.continent
+                       << "' was detected for province ID=" << province.id
+                       << ".\nContinuing will assume all unknown "
+                          "continents are blank/0.";
+                    auto result = prompt(ss.str(),
+                                         {"Continue", "Stop Exporting"},
+                                         PromptType::ERROR);
+
+                    if(IS_FAILURE(result) || *result == 1) {
+                        RETURN_IF_ERROR(index);
+                    } else {
+                        assume_unknown_continents = true;
                     }
-
-                    index = 0;
-                } else {
-                    // Continents are 1 based, so convert the index to the ID
-                    ++(*index);
                 }
 
-                out << *index;
+                index = 0;
+            } else {
+                // Continents are 1 based, so convert the index to the ID
+                ++(*index);
             }
 
+            out << *index;
+
             out << std::endl;
         }
     } else {
@@ -562,6 +634,7 @@ auto HMDT::Project::ProvinceProject::loadProvinceData(const std::filesystem::pat
 
         // Make sure we don't have any provinces in the list first
         m_provinces.clear();
+        ++m_provinces_generation;
 
         // Get every line from the CSV file for parsing
         for(uint32_t line_num = 1; std::getline(in, line); ++line_num) {
@@ -640,6 +713,7 @@ auto HMDT::Project::ProvinceProject::loadProvinceData2(const std::filesystem::pa
 
         // Make sure we don't have any provinces in the list first
         m_provinces.clear();
+        ++m_provinces_generation;
 
         // Get every line from the CSV file for parsing
         for(uint32_t line_num = 1; std::getline(in, line); ++line_num) {
@@ -704,6 +778,13 @@ auto HMDT::Project::ProvinceProject::loadProvinceData2(const std::filesystem::pa
     return STATUS_SUCCESS;
 }
 
+/**
+ * @brief Gets every province
+ * @details Anything which modifies provinces through the returned reference
+ *          must call rebuildProvinceTable() once it is done.
+ *
+ * @return Every province
+ */
 HMDT::ProvinceList& HMDT::Project::ProvinceProject::getProvinces() {
     return m_provinces;
 }
@@ -713,40 +794,138 @@ const HMDT::ProvinceList& HMDT::Project::ProvinceProject::getProvinces() const {
 }
 
 /**
- * @brief Will build the province preview for the given province. If more than
- *        MAX_CACHED_PROVINCE_PREVIEWS are already stored, then the least
- *        accessed preview will be kicked out of the cache before a new preview
- *        is constructed.
+ * @brief Gets every province as a struct-of-arrays table.
+ * @details The table holds the provinces as they were when
+ *          rebuildProvinceTable() was last called. It is never modified once
+ *          built, so it may be read from any thread for as long as the
+ *          returned pointer is held, even after a newer table replaces it.
  *
- * @param province_ptr
+ * @return The province table
  */
-void HMDT::Project::ProvinceProject::buildProvinceCache(const Province* province_ptr)
+auto HMDT::Project::ProvinceProject::getProvinceTable() const
+    -> ProvinceTablePtr
 {
-    const auto& province = *province_ptr;
-    auto id = province.id;
-
-    // If there are too many cached provinces, then remove the least accessed
-    //  one (which should be the first one in the cache)
-    if(m_data_cache.size() > MAX_CACHED_PROVINCE_PREVIEWS) {
-        // Do not clear out the first value if it is the one we are trying to
-        //  create.
-        if(m_data_cache.begin()->first == id) {
-            m_data_cache.erase(std::next(m_data_cache.begin()));
-        } else {
-            m_data_cache.erase(m_data_cache.begin());
+    return std::atomic_load(&m_province_table);
+}
+
+/**
+ * @brief Gets the spatial index of every province, for finding provinces by
+ *        region.
+ */
+auto HMDT::Project::ProvinceProject::getSpatialIndex() const
+    -> const ProvinceSpatialIndex&
+{
+    return m_spatial_index;
+}
+
+/**
+ * @brief Builds a matrix of which province is at each pixel, where each
+ *        province is given by its dense index in the given table.
+ * @details Each pixel holds the index of its province plus one, so that 0 can
+ *          mean that the pixel has no province. Unlike the label matrix, this
+ *          is small and dense enough to be used as an index into a lookup
+ *          table, such as a selection mask on the GPU.
+ *
+ * @par The matrix is filled from the row spans of each province, so only one
+ *      hash lookup is needed per province rather than per pixel. If the spans
+ *      have not been built yet, it is filled from the provinces matrix
+ *      instead, with one lookup per run of pixels in the same province.
+ *
+ * @param table The table to take indices from. Callers which also index into
+ *              other data by these indices should pass the same snapshot of
+ *              getProvinceTable() that they built that data from.
+ *
+ * @return The matrix, or nullptr if there is no map data
+ */
+auto HMDT::Project::ProvinceProject::buildProvinceIndexMatrix(const ProvinceTable& table) const
+    -> std::unique_ptr<uint32_t[]>
+{
+    // Const, so that reading the provinces doesn't detach them from a snapshot
+    std::shared_ptr<const MapData> map_data = getMapData();
+    if(map_data == nullptr) {
+        return nullptr;
+    }
+
+    auto width = map_data->getWidth();
+    std::unique_ptr<uint32_t[]> matrix(new uint32_t[map_data->getMatrixSize()]{ 0 });
+
+    auto span_index = std::atomic_load(&m_span_index);
+    if(span_index == nullptr) {
+        auto provinces = map_data->getProvinces().lock();
+        if(provinces == nullptr) {
+            return matrix;
+        }
+
+        std::optional<ProvinceID> last_id;
+        uint32_t last_value = 0;
+
+        for(std::size_t i = 0; i < map_data->getProvincesSize(); ++i) {
+            if(!last_id || provinces[i] != *last_id) {
+                auto index = table.getIndex(provinces[i]);
+
+                last_id = provinces[i];
+                last_value = index ? *index + 1 : 0;
+            }
+
+            matrix[i] = last_value;
         }
+
+        return matrix;
     }
 
-    auto& data = m_data_cache[id];
+    for(auto&& [id, spans] : span_index->getAllSpans()) {
+        auto index = table.getIndex(id);
+        if(!index) continue;
 
-    WRITE_DEBUG("No preview data for province ", id, ". Building...");
+        for(auto&& span : spans) {
+            std::fill(matrix.get() + xyToIndex(width, span.x_begin, span.y),
+                      matrix.get() + xyToIndex(width, span.x_end, span.y),
+                      *index + 1);
+        }
+    }
 
-    // Some references first, to make the following code easier to read
-    //  id also starts at 1, so make sure we offset it down
-    auto label_matrix = getMapData()->getProvinces().lock();
-    auto iwidth = getMapData()->getWidth();
+    return matrix;
+}
+
+/**
+ * @brief Rebuilds the province table from the current provinces, and hands it
+ *        out from every later call to getProvinceTable().
+ * @details Must be called by whatever modifies the provinces once it is done,
+ *          on the same thread that modified them.
+ */
+void HMDT::Project::ProvinceProject::rebuildProvinceTable() {
+    std::atomic_store(&m_province_table,
+                      std::make_shared<const ProvinceTable>(m_provinces));
+}
+
+/**
+ * @brief Gets a number which changes every time the list of provinces is
+ *        replaced as a whole, such as by a load or an import.
+ * @details Any reference to a province which was taken while this returned a
+ *          different number is no longer valid.
+ */
+auto HMDT::Project::ProvinceProject::getProvincesGeneration() const noexcept
+    -> std::uint64_t
+{
+    return m_provinces_generation;
+}
+
+/**
+ * @brief Builds the preview for the given province.
+ * @details This does not touch m_provinces, so that it can be called from the
+ *          preview cache's background thread.
+ *
+ * @param id The ID of the province
+ * @param bb The bounding box of the province
+ *
+ * @return The preview data
+ */
+auto HMDT::Project::ProvinceProject::buildProvincePreview(const ProvinceID& id,
+                                                          const BoundingBox& bb) const
+    -> ProvinceDataPtr
+{
+    ProvinceDataPtr data;
 
-    auto&& bb = province.bounding_box;
     auto&& [width, height] = calcDims(bb);
 
     constexpr auto depth = 4;
@@ -756,25 +935,47 @@ void HMDT::Project::ProvinceProject::buildProvinceCache(const Province* province
     data.reset(new unsigned char[width * height * depth]());
 
     WRITE_DEBUG("Allocated space for ", width * height * depth, " bytes.");
-    for(auto x = bb.bottom_left.x; x < bb.top_right.x; ++x) {
-        for(auto y = bb.top_right.y; y < bb.bottom_left.y; ++y) {
-            // Get the index into the label matrix
-            auto lindex = xyToIndex(iwidth, x, y);
 
-            // Offset the x,y so that we get 0-preview width/height
-            auto relx = x - bb.bottom_left.x;
-            auto rely = y - bb.top_right.y;
+    auto* pixels = reinterpret_cast<uint32_t*>(data.get());
 
-            // Index into the cached data
-            //  Need a special one since the depth is different from the
-            //  stored graphics data
-            auto dindex = xyToIndex(width * depth, relx * depth, rely);
+    if(auto span_index = std::atomic_load(&m_span_index); span_index != nullptr)
+    {
+        // Only visit the pixels that are actually in the province
+        if(const auto* spans = span_index->getSpans(id); spans != nullptr) {
+            for(auto&& span : *spans) {
+                // Clip to the preview, which doesn't include the last row
+                //   or column of the bounding box
+                if(span.y < bb.top_right.y || span.y >= bb.bottom_left.y) {
+                    continue;
+                }
 
-            auto label = label_matrix[lindex];
+                auto x_begin = std::max(span.x_begin, bb.bottom_left.x);
+                auto x_end = std::min(span.x_end, bb.top_right.x);
+                if(x_begin >= x_end) continue;
 
-            if(label == id) {
                 // ARGB
-                *reinterpret_cast<uint32_t*>(&data[dindex]) = PROVINCE_HIGHLIGHT_COLOR;
+                std::fill(pixels + xyToIndex(width, x_begin - bb.bottom_left.x,
+                                             span.y - bb.top_right.y),
+                          pixels + xyToIndex(width, x_end - bb.bottom_left.x,
+                                             span.y - bb.top_right.y),
+                          PROVINCE_HIGHLIGHT_COLOR);
+            }
+        }
+    } else {
+        // No spans have been built yet, so fall back to checking every pixel
+        //   in the bounding box. This may be running on the prefetch thread,
+        //   so only read the label matrix, which is never replaced while a
+        //   prefetch is running (see cancelPreviewPrefetch()).
+        const auto& map_data = std::as_const(*getMapData());
+        auto label_matrix = map_data.getProvinces().lock();
+        auto iwidth = map_data.getWidth();
+
+        for(auto y = bb.top_right.y; y < bb.bottom_left.y; ++y) {
+            for(auto x = bb.bottom_left.x; x < bb.top_right.x; ++x) {
+                if(label_matrix[xyToIndex(iwidth, x, y)] == id) {
+                    pixels[xyToIndex(width, x - bb.bottom_left.x,
+                                     y - bb.top_right.y)] = PROVINCE_HIGHLIGHT_COLOR;
+                }
             }
         }
     }
@@ -800,6 +1001,8 @@ void HMDT::Project::ProvinceProject::buildProvinceCache(const Province* province
             }
         }
     }
+
+    return data;
 }
 
 void HMDT::Project::ProvinceProject::buildProvinceOutlines() {
@@ -982,23 +1185,38 @@ auto HMDT::Project::ProvinceProject::getPreviewData(ProvinceID id)
 auto HMDT::Project::ProvinceProject::getPreviewData(const Province* province_ptr)
     -> ProvinceDataPtr
 {
-    const auto& province = *province_ptr;
-    auto id = province.id;
+    return m_preview_cache.get(province_ptr->id, province_ptr->bounding_box);
+}
 
-    auto data = m_data_cache[id];
+/**
+ * @brief Builds the previews of every province adjacent to the given one in
+ *        the background, so that they are ready by the time they get
+ *        selected.
+ *
+ * @param province_ptr The province to prefetch the neighbors of
+ */
+void HMDT::Project::ProvinceProject::prefetchAdjacentPreviews(const Province* province_ptr)
+{
+    std::vector<std::pair<ProvinceID, BoundingBox>> previews;
+    previews.reserve(province_ptr->adjacent_provinces.size());
 
-    // If there is no cached data for the given province ID, then generate the
-    //  data for the preview
-    if(data == nullptr) {
-        buildProvinceCache(province_ptr);
+    for(auto&& adj_id : province_ptr->adjacent_provinces) {
+        if(isValidProvinceID(adj_id)) {
+            previews.emplace_back(adj_id, getProvinceForID(adj_id).bounding_box);
+        }
     }
 
-    // Reset access time, cycles the element to the end of the FIFO queue
-    data = m_data_cache[id];
-    m_data_cache.erase(id);
-    m_data_cache[id] = data;
+    m_preview_cache.prefetch(previews);
+}
 
-    return data;
+/**
+ * @brief Stops building previews in the background, waiting for any preview
+ *        which is currently being built.
+ * @details Must be called before the label matrix or the map data is
+ *          replaced, as previews may be built from it on another thread.
+ */
+void HMDT::Project::ProvinceProject::cancelPreviewPrefetch() {
+    m_preview_cache.cancelPrefetch();
 }
 
 auto HMDT::Project::ProvinceProject::getOldIDToUUIDMap() const noexcept
@@ -1012,6 +1230,27 @@ uint32_t HMDT::Project::ProvinceProject::getIDForProvinceID(const ProvinceID& id
     return m_uuid_to_oldid.at(id);
 }
 
+/**
+ * @brief Rebuilds the row spans of every province from the label matrix.
+ * @details This should be called every time the label matrix changes. Any
+ *          cached previews are thrown out, since they were drawn from the old
+ *          spans.
+ */
+void HMDT::Project::ProvinceProject::rebuildSpanIndex() {
+    auto map_data = getMapData();
+    auto label_matrix = map_data->getProvinces().lock();
+
+    auto span_index = std::make_shared<const ProvinceSpanIndex>(label_matrix.get(),
+                                                                map_data->getWidth(),
+                                                                map_data->getHeight());
+
+    std::atomic_store(&m_span_index, std::shared_ptr<const ProvinceSpanIndex>(span_index));
+
+    m_spatial_index.build(span_index, map_data->getWidth(), map_data->getHeight());
+
+    m_preview_cache.clear();
+}
+
 /**
  * @brief Rebuilds the mapping of UUID->ID.
  * @details This should be called every time m_provinces changes/is updated.
@@ -1055,6 +1294,15 @@ auto HMDT::Project::ProvinceProject::visit(const std::function<MaybeVoid(std::sh
 
 /**
  * @brief Builds the group node for holding all provinces
+ * @details The group is lazy: each ProvinceNode (and its properties) is only
+ *          built the first time it is looked up or iterated over. The visitor
+ *          is only called on the group itself, as nodes built later are built
+ *          long after this has returned. Walk the group to reach them.
+ *          Each child is bound to its slot in the province table as it was
+ *          when this was called, and to its province once it is built.
+ *          Properties refer to the province directly, and fail with
+ *          STATUS_VALUE_NOT_FOUND once the provinces have been replaced (for
+ *          example after a new province map is loaded).
  *
  * @param visitor The visitor callback
  *
@@ -1063,76 +1311,104 @@ auto HMDT::Project::ProvinceProject::visit(const std::function<MaybeVoid(std::sh
 auto HMDT::Project::ProvinceProject::visitProvinces(const std::function<MaybeVoid(std::shared_ptr<Hierarchy::INode>)>& visitor) const noexcept
     -> Maybe<std::shared_ptr<Hierarchy::IGroupNode>>
 {
-    // This should be a static group since the number of provinces will not
-    //   change unless a new province map is loaded
-    auto provinces_group_node = std::make_shared<Hierarchy::GroupNode>(Hierarchy::GroupKeys::PROVINCES);
+    // The table is ordered by ID, so each child's slot is its dense index.
+    //   The number of provinces will not change unless a new province map is
+    //   loaded, at which point the hierarchy must be rebuilt anyway.
+    auto table = getProvinceTable();
+    auto generation = m_provinces_generation;
+
+    // Properties are writable, so they need a non-const project to find their
+    //   provinces in.
+    IProvinceProject* project = &m_parent_project.getProvinceProject();
+
+    Hierarchy::IndexedGroupNode::Index index {
+        table->size() /* size */,
+        [table](std::size_t i) -> std::string {
+            return std::to_string(table->getID(i));
+        } /* key_at */,
+        [table](const std::string& name) -> std::optional<std::size_t> {
+            auto id = UUID::parse(name);
+            if(IS_FAILURE(id)) return std::nullopt;
+
+            return table->getIndex(*id);
+        } /* find */,
+        [table, project, generation](std::size_t i)
+            -> Maybe<Hierarchy::IGroupNode::ChildNode>
+        {
+            const ProvinceID& id = table->getID(i);
 
-    auto result = visitor(provinces_group_node);
-    RETURN_IF_ERROR(result);
+            RETURN_ERROR_IF(project->getProvincesGeneration() != generation,
+                            STATUS_VALUE_NOT_FOUND);
 
-    for(auto&& [id, province] : m_provinces) {
-        auto province_id = id;
-        auto name = std::to_string(province.id);
+            auto& provinces = project->getProvinces();
+            auto it = provinces.find(id);
+            RETURN_ERROR_IF(it == provinces.end(), STATUS_VALUE_NOT_FOUND);
 
-        auto province_node = std::make_shared<Hierarchy::ProvinceNode>(name);
+            // Provinces are never moved unless they are all replaced at once,
+            //   so this stays valid for as long as the generation matches
+            Province* province = &it->second;
 
-        result = visitor(province_node);
-        RETURN_IF_ERROR(result);
+            // Looks up a single field of this province
+            auto field = [project, province, generation](auto Province::* member) {
+                using T = std::remove_reference_t<decltype(std::declval<Province&>().*member)>;
 
-        result = province_node->setID([_this=const_cast<ProvinceProject*>(this),
-                                       province_id]() -> auto&
-            {
-                return _this->m_provinces[province_id].id;
-            }, visitor);
-        RETURN_IF_ERROR(result);
+                return [project, province, generation, member]() -> MaybeRef<T> {
+                    RETURN_ERROR_IF(project->getProvincesGeneration() != generation,
+                                    STATUS_VALUE_NOT_FOUND);
 
-        result = province_node->setColor([_this=const_cast<ProvinceProject*>(this),
-                                          province_id]() -> const auto&
-            {
-                return _this->m_provinces[province_id].unique_color;
-            }, visitor);
-        RETURN_IF_ERROR(result);
+                    return std::ref(province->*member);
+                };
+            };
 
-        result = province_node->setProvinceType([_this=const_cast<ProvinceProject*>(this),
-                                                 province_id]() -> auto& {
-                return _this->m_provinces[province_id].type;
-            }, visitor);
-        RETURN_IF_ERROR(result);
+            // Nodes are built after visitProvinces() has returned, so there is
+            //   no visitor left to call on them
+            auto no_visitor = [](auto&&...) -> MaybeVoid { return STATUS_SUCCESS; };
 
-        result = province_node->setCoastal([_this=const_cast<ProvinceProject*>(this),
-                                            province_id]() -> auto&
-            {
-                return _this->m_provinces[province_id].coastal;
-            }, visitor);
-        RETURN_IF_ERROR(result);
+            auto province_node = std::make_shared<Hierarchy::ProvinceNode>(std::to_string(id));
 
-        result = province_node->setTerrain([_this=const_cast<ProvinceProject*>(this),
-                                            province_id]() -> auto&
-            {
-                return _this->m_provinces[province_id].terrain;
-            }, visitor);
-        RETURN_IF_ERROR(result);
+            auto result = province_node->setID(field(&Province::id), no_visitor);
+            RETURN_IF_ERROR(result);
 
-        result = province_node->setContinent([_this=const_cast<ProvinceProject*>(this),
-                                              province_id]() -> auto&
-            {
-                return _this->m_provinces[province_id].continent;
-            }, visitor);
-        RETURN_IF_ERROR(result);
+            result = province_node->setColor([project, province, generation]() -> MaybeRef<const Color> {
+                RETURN_ERROR_IF(project->getProvincesGeneration() != generation,
+                                STATUS_VALUE_NOT_FOUND);
+
+                return std::cref(province->unique_color);
+            }, no_visitor);
+            RETURN_IF_ERROR(result);
+
+            result = province_node->setProvinceType(field(&Province::type), no_visitor);
+            RETURN_IF_ERROR(result);
+
+            result = province_node->setCoastal(field(&Province::coastal), no_visitor);
+            RETURN_IF_ERROR(result);
+
+            result = province_node->setTerrain(field(&Province::terrain), no_visitor);
+            RETURN_IF_ERROR(result);
+
+            result = province_node->setContinent(field(&Province::continent), no_visitor);
+            RETURN_IF_ERROR(result);
 
-        // TODO: States still use uint32_t for ID numbering. This needs to be
-        //   changed over to UUID before we can safely implement province->state
-        //   linkage.
+            // TODO: States still use uint32_t for ID numbering. This needs to be
+            //   changed over to UUID before we can safely implement province->state
+            //   linkage.
 #if 0
-        result = province_node->setState(province.state, visitor);
-        RETURN_IF_ERROR(result);
+            result = province_node->setState(province->state, no_visitor);
+            RETURN_IF_ERROR(result);
 
-        result = province_node->setAdjacentProvinces(province.adjacent_provinces, visitor);
-        RETURN_IF_ERROR(result);
+            result = province_node->setAdjacentProvinces(province->adjacent_provinces, no_visitor);
+            RETURN_IF_ERROR(result);
 #endif
 
-        provinces_group_node->addChild(name, province_node);
-    }
+            return province_node;
+        } /* make_child */
+    };
+
+    auto provinces_group_node = std::make_shared<Hierarchy::IndexedGroupNode>(Hierarchy::GroupKeys::PROVINCES,
+                                                                              index);
+
+    auto result = visitor(provinces_group_node);
+    RETURN_IF_ERROR(result);
 
     return provinces_group_node;
 }
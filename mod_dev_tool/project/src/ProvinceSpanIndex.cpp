@@ -0,0 +1,111 @@
+
+#include "ProvinceSpanIndex.h"
+
+/**
+ * @brief Builds an index from the given label matrix
+ *
+ * @param labels The province ID of every pixel, in row-major order
+ * @param width The width of the matrix
+ * @param height The height of the matrix
+ */
+HMDT::Project::ProvinceSpanIndex::ProvinceSpanIndex(const ProvinceID* labels,
+                                                    std::uint32_t width,
+                                                    std::uint32_t height)
+{
+    build(labels, width, height);
+}
+
+/**
+ * @brief Rebuilds this index from the given label matrix
+ *
+ * @param labels The province ID of every pixel, in row-major order
+ * @param width The width of the matrix
+ * @param height The height of the matrix
+ */
+void HMDT::Project::ProvinceSpanIndex::build(const ProvinceID* labels,
+                                             std::uint32_t width,
+                                             std::uint32_t height)
+{
+    clear();
+
+    if(labels == nullptr) return;
+
+    for(std::uint32_t y = 0; y < height; ++y) {
+        const auto* row = labels + static_cast<std::size_t>(y) * width;
+
+        std::uint32_t x = 0;
+        while(x < width) {
+            const auto& id = row[x];
+
+            // Find the end of this run first, so that we only do one lookup
+            //   per span rather than one per pixel
+            auto x_end = x + 1;
+            while(x_end < width && row[x_end] == id) {
+                ++x_end;
+            }
+
+            m_spans[id].push_back(Span{ y, x, x_end });
+
+            x = x_end;
+        }
+    }
+}
+
+/**
+ * @brief Removes every span from this index
+ */
+void HMDT::Project::ProvinceSpanIndex::clear() noexcept {
+    m_spans.clear();
+}
+
+/**
+ * @brief Gets every span of a province
+ *
+ * @param id The province to get the spans of
+ *
+ * @return The spans in row-major order, or nullptr if the province doesn't
+ *         cover any pixels.
+ */
+auto HMDT::Project::ProvinceSpanIndex::getSpans(const ProvinceID& id) const noexcept
+    -> const SpanList*
+{
+    if(auto it = m_spans.find(id); it != m_spans.end()) {
+        return &it->second;
+    }
+
+    return nullptr;
+}
+
+/**
+ * @brief Gets how many pixels a province covers
+ *
+ * @param id The province to count the pixels of
+ */
+std::size_t HMDT::Project::ProvinceSpanIndex::getPixelCount(const ProvinceID& id) const noexcept
+{
+    std::size_t count = 0;
+
+    if(const auto* spans = getSpans(id); spans != nullptr) {
+        for(auto&& span : *spans) {
+            count += span.x_end - span.x_begin;
+        }
+    }
+
+    return count;
+}
+
+/**
+ * @brief Gets the spans of every province
+ */
+auto HMDT::Project::ProvinceSpanIndex::getAllSpans() const noexcept
+    -> const SpanMap&
+{
+    return m_spans;
+}
+
+/**
+ * @brief Gets how many provinces are in this index
+ */
+std::size_t HMDT::Project::ProvinceSpanIndex::size() const noexcept {
+    return m_spans.size();
+}
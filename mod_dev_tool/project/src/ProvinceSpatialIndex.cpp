@@ -0,0 +1,375 @@
+
+#include "ProvinceSpatialIndex.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#include "Constants.h"
+
+namespace {
+    using HMDT::Project::ProvinceSpanIndex;
+
+    /**
+     * @brief Gets the first span of a province which is on or after a row
+     */
+    auto firstSpanAtOrAfter(const ProvinceSpanIndex::SpanList& spans,
+                            std::uint32_t y)
+    {
+        return std::lower_bound(spans.begin(), spans.end(), y,
+                                [](const ProvinceSpanIndex::Span& span,
+                                   std::uint32_t y)
+                                {
+                                    return span.y < y;
+                                });
+    }
+}
+
+/**
+ * @brief Builds the index
+ *
+ * @param span_index The row spans of every province
+ * @param width The width of the map
+ * @param height The height of the map
+ */
+void HMDT::Project::ProvinceSpatialIndex::build(std::shared_ptr<const ProvinceSpanIndex> span_index,
+                                                std::uint32_t width,
+                                                std::uint32_t height)
+{
+    clear();
+
+    if(span_index == nullptr) return;
+
+    m_span_index = std::move(span_index);
+    m_width = width;
+    m_height = height;
+    m_cells_x = (width + CELL_SIZE - 1) / CELL_SIZE;
+    m_cells_y = (height + CELL_SIZE - 1) / CELL_SIZE;
+    m_cells.resize(static_cast<std::size_t>(m_cells_x) * m_cells_y);
+
+    const auto& all_spans = m_span_index->getAllSpans();
+    m_entries.reserve(all_spans.size());
+
+    for(auto&& [id, spans] : all_spans) {
+        // Pixels which don't belong to any province are not worth finding
+        if(id == INVALID_PROVINCE) continue;
+
+        auto index = static_cast<EntryIndex>(m_entries.size());
+        m_entries.push_back(Entry{ id, &spans });
+
+        for(auto&& span : spans) {
+            auto cy = span.y / CELL_SIZE;
+            auto cx_last = (span.x_end - 1) / CELL_SIZE;
+
+            for(auto cx = span.x_begin / CELL_SIZE; cx <= cx_last; ++cx) {
+                // Every span of this province is visited before the next
+                //   province, so we only need to check the last entry to
+                //   avoid adding it to the same cell twice
+                auto& cell = m_cells[static_cast<std::size_t>(cy) * m_cells_x + cx];
+                if(cell.empty() || cell.back() != index) {
+                    cell.push_back(index);
+                }
+            }
+        }
+    }
+}
+
+/**
+ * @brief Removes everything from the index
+ */
+void HMDT::Project::ProvinceSpatialIndex::clear() noexcept {
+    m_span_index.reset();
+    m_entries.clear();
+    m_cells.clear();
+    m_width = m_height = 0;
+    m_cells_x = m_cells_y = 0;
+}
+
+/**
+ * @brief Finds every province with at least one pixel in a rectangle
+ *
+ * @param x0 The left edge of the rectangle
+ * @param y0 The top edge of the rectangle
+ * @param x1 One past the right edge of the rectangle
+ * @param y1 One past the bottom edge of the rectangle
+ *
+ * @return Every matching province, in no particular order
+ */
+auto HMDT::Project::ProvinceSpatialIndex::queryRect(std::uint32_t x0,
+                                                    std::uint32_t y0,
+                                                    std::uint32_t x1,
+                                                    std::uint32_t y1) const
+    -> std::vector<ProvinceID>
+{
+    std::vector<ProvinceID> results;
+
+    x1 = std::min(x1, m_width);
+    y1 = std::min(y1, m_height);
+    if(x0 >= x1 || y0 >= y1) {
+        return results;
+    }
+
+    forEachCandidate(x0, y0, x1, y1, [&](const Entry& entry) {
+        const auto& spans = *entry.spans;
+        for(auto it = firstSpanAtOrAfter(spans, y0);
+                 it != spans.end() && it->y < y1; ++it)
+        {
+            if(it->x_begin < x1 && it->x_end > x0) {
+                results.push_back(entry.id);
+                break;
+            }
+        }
+    });
+
+    return results;
+}
+
+/**
+ * @brief Finds every province with at least one pixel inside of a polygon
+ *
+ * @param polygon The vertices of the polygon, in order. The last vertex is
+ *                implicitly connected back to the first.
+ *
+ * @return Every matching province, in no particular order
+ */
+auto HMDT::Project::ProvinceSpatialIndex::queryPolygon(const std::vector<Point2D>& polygon) const
+    -> std::vector<ProvinceID>
+{
+    std::vector<ProvinceID> results;
+
+    if(polygon.size() < 3 || m_entries.empty()) {
+        return results;
+    }
+
+    std::uint32_t min_x = std::numeric_limits<std::uint32_t>::max();
+    std::uint32_t min_y = std::numeric_limits<std::uint32_t>::max();
+    std::uint32_t max_x = 0;
+    std::uint32_t max_y = 0;
+    for(auto&& point : polygon) {
+        min_x = std::min(min_x, point.x);
+        min_y = std::min(min_y, point.y);
+        max_x = std::max(max_x, point.x);
+        max_y = std::max(max_y, point.y);
+    }
+
+    max_x = std::min(max_x + 1, m_width);
+    max_y = std::min(max_y + 1, m_height);
+    if(min_x >= max_x || min_y >= max_y) {
+        return results;
+    }
+
+    // Work out which pixels of each row are inside the polygon, as a list
+    //   of [begin, end) intervals
+    using Interval = std::pair<std::uint32_t, std::uint32_t>;
+    std::vector<std::vector<Interval>> rows(max_y - min_y);
+    std::vector<double> crossings;
+
+    for(auto y = min_y; y < max_y; ++y) {
+        const double yc = y + 0.5;
+
+        crossings.clear();
+        for(std::size_t i = 0; i < polygon.size(); ++i) {
+            const auto& a = polygon[i];
+            const auto& b = polygon[(i + 1) % polygon.size()];
+
+            if((a.y <= yc) != (b.y <= yc)) {
+                crossings.push_back(a.x + (yc - a.y) *
+                                          (static_cast<double>(b.x) - a.x) /
+                                          (static_cast<double>(b.y) - a.y));
+            }
+        }
+        std::sort(crossings.begin(), crossings.end());
+
+        auto& row = rows[y - min_y];
+        for(std::size_t i = 0; i + 1 < crossings.size(); i += 2) {
+            // A pixel is inside if its center is
+            auto begin = std::max(std::ceil(crossings[i] - 0.5), 0.0);
+            auto end = std::min(std::ceil(crossings[i + 1] - 0.5),
+                                static_cast<double>(m_width));
+            if(begin < end) {
+                row.emplace_back(static_cast<std::uint32_t>(begin),
+                                 static_cast<std::uint32_t>(end));
+            }
+        }
+    }
+
+    forEachCandidate(min_x, min_y, max_x, max_y, [&](const Entry& entry) {
+        const auto& spans = *entry.spans;
+        for(auto it = firstSpanAtOrAfter(spans, min_y);
+                 it != spans.end() && it->y < max_y; ++it)
+        {
+            for(auto&& [begin, end] : rows[it->y - min_y]) {
+                if(it->x_begin < end && it->x_end > begin) {
+                    results.push_back(entry.id);
+                    return;
+                }
+            }
+        }
+    });
+
+    return results;
+}
+
+/**
+ * @brief Finds the provinces closest to a point
+ * @details Cells are searched in rings around the point, stopping as soon as
+ *          no unsearched cell could hold anything closer than what has
+ *          already been found.
+ *
+ * @param x The x coordinate of the point
+ * @param y The y coordinate of the point
+ * @param k How many provinces to find
+ *
+ * @return Up to k provinces, along with the distance from the point to their
+ *         closest pixel, closest first. A province containing the point has
+ *         a distance of 0.
+ */
+auto HMDT::Project::ProvinceSpatialIndex::queryNearest(std::uint32_t x,
+                                                       std::uint32_t y,
+                                                       std::size_t k) const
+    -> std::vector<Neighbor>
+{
+    std::vector<Neighbor> results;
+
+    if(k == 0 || m_entries.empty()) {
+        return results;
+    }
+
+    const auto cx = static_cast<std::int64_t>(std::min(x / CELL_SIZE, m_cells_x - 1));
+    const auto cy = static_cast<std::int64_t>(std::min(y / CELL_SIZE, m_cells_y - 1));
+
+    const auto max_ring = std::max({ cx, cy,
+                                     m_cells_x - 1 - cx,
+                                     m_cells_y - 1 - cy });
+
+    std::vector<bool> visited(m_entries.size());
+
+    auto visit_cell = [&](std::int64_t ccx, std::int64_t ccy) {
+        if(ccx < 0 || ccy < 0 || ccx >= m_cells_x || ccy >= m_cells_y) {
+            return;
+        }
+
+        for(auto index : getCell(ccx, ccy)) {
+            if(visited[index]) continue;
+            visited[index] = true;
+
+            const auto& entry = m_entries[index];
+            results.emplace_back(entry.id, getDistance(*entry.spans, x, y));
+        }
+    };
+
+    auto by_distance = [](const Neighbor& a, const Neighbor& b) {
+        return a.second < b.second;
+    };
+
+    for(std::int64_t ring = 0; ring <= max_ring; ++ring) {
+        // Everything in this ring is at least this far away
+        if(results.size() >= k) {
+            std::nth_element(results.begin(), results.begin() + (k - 1),
+                             results.end(), by_distance);
+
+            auto min_distance = static_cast<double>((ring - 1) * CELL_SIZE);
+            if(min_distance > results[k - 1].second) {
+                break;
+            }
+        }
+
+        if(ring == 0) {
+            visit_cell(cx, cy);
+            continue;
+        }
+
+        for(auto i = -ring; i <= ring; ++i) {
+            visit_cell(cx + i, cy - ring);
+            visit_cell(cx + i, cy + ring);
+        }
+        for(auto i = -ring + 1; i <= ring - 1; ++i) {
+            visit_cell(cx - ring, cy + i);
+            visit_cell(cx + ring, cy + i);
+        }
+    }
+
+    std::sort(results.begin(), results.end(), by_distance);
+    if(results.size() > k) {
+        results.resize(k);
+    }
+
+    return results;
+}
+
+/**
+ * @brief Gets how many provinces are in the index
+ */
+std::size_t HMDT::Project::ProvinceSpatialIndex::size() const noexcept {
+    return m_entries.size();
+}
+
+/**
+ * @brief Calls a function once for every province with a pixel in any cell
+ *        that overlaps a rectangle.
+ *
+ * @param x0 The left edge of the rectangle
+ * @param y0 The top edge of the rectangle
+ * @param x1 One past the right edge of the rectangle
+ * @param y1 One past the bottom edge of the rectangle
+ * @param func The function to call with each Entry
+ */
+template<typename F>
+void HMDT::Project::ProvinceSpatialIndex::forEachCandidate(std::uint32_t x0,
+                                                           std::uint32_t y0,
+                                                           std::uint32_t x1,
+                                                           std::uint32_t y1,
+                                                           F&& func) const
+{
+    std::vector<bool> visited(m_entries.size());
+
+    for(auto cy = y0 / CELL_SIZE; cy <= (y1 - 1) / CELL_SIZE; ++cy) {
+        for(auto cx = x0 / CELL_SIZE; cx <= (x1 - 1) / CELL_SIZE; ++cx) {
+            for(auto index : getCell(cx, cy)) {
+                if(visited[index]) continue;
+                visited[index] = true;
+
+                func(m_entries[index]);
+            }
+        }
+    }
+}
+
+auto HMDT::Project::ProvinceSpatialIndex::getCell(std::uint32_t cx,
+                                                  std::uint32_t cy) const noexcept
+    -> const std::vector<EntryIndex>&
+{
+    return m_cells[static_cast<std::size_t>(cy) * m_cells_x + cx];
+}
+
+/**
+ * @brief Gets the distance from a point to the closest pixel in some spans
+ */
+double HMDT::Project::ProvinceSpatialIndex::getDistance(const ProvinceSpanIndex::SpanList& spans,
+                                                        std::uint32_t x,
+                                                        std::uint32_t y) noexcept
+{
+    auto best = std::numeric_limits<double>::infinity();
+
+    for(auto&& span : spans) {
+        double dy = static_cast<double>(span.y) - y;
+
+        // Spans are sorted by row, so once we are further away vertically than
+        //   the best so far, nothing after this can be any closer
+        if(span.y > y && dy * dy >= best) {
+            break;
+        }
+
+        double dx = 0;
+        if(x < span.x_begin) {
+            dx = static_cast<double>(span.x_begin) - x;
+        } else if(x >= span.x_end) {
+            dx = static_cast<double>(x) - (span.x_end - 1);
+        }
+
+        best = std::min(best, dx * dx + dy * dy);
+    }
+
+    return std::sqrt(best);
+}
+
@@ -0,0 +1,248 @@
+
+#include "ProvinceStateValidator.h"
+
+#include <algorithm>
+#include <mutex>
+#include <unordered_set>
+
+#include "Util.h"
+
+namespace {
+    //! The fewest provinces worth handing to a single thread when validating
+    constexpr std::uint64_t VALIDATION_CHUNK_SIZE = 4096;
+}
+
+/**
+ * @brief Checks every province against every state
+ *
+ * @param table The table of every province
+ * @param states Every state
+ */
+void HMDT::Project::ProvinceStateValidator::validate(const ProvinceTable& table,
+                                                     const StateMap& states)
+{
+    using Index = ProvinceTable::Index;
+    using Type = Issue::Type;
+
+    clear();
+
+    // Index which states list each province, with the same layout as the
+    //   adjacency lists in ProvinceTable. This is done in two passes: one to
+    //   count how many states list each province, and one to fill them in.
+    std::vector<Index> listed_indices;
+    std::vector<std::size_t> offsets(table.size() + 1, 0);
+
+    for(auto&& [state_id, state] : states) {
+        for(auto&& province_id : state.provinces) {
+            if(auto index = table.getIndex(province_id); index) {
+                listed_indices.push_back(*index);
+                ++offsets[*index + 1];
+            } else {
+                listed_indices.push_back(ProvinceTable::INVALID_INDEX);
+                m_issues.push_back(Issue{ Type::MISSING_PROVINCE, province_id, state_id });
+            }
+        }
+    }
+
+    for(std::size_t i = 1; i < offsets.size(); ++i) {
+        offsets[i] += offsets[i - 1];
+    }
+
+    // Since states are visited in order, each province's states end up sorted
+    std::vector<StateID> listing_states(listed_indices.size());
+    {
+        auto next = offsets;
+        auto listed_it = listed_indices.begin();
+        for(auto&& [state_id, state] : states) {
+            for(std::size_t i = 0; i < state.provinces.size(); ++i, ++listed_it) {
+                if(*listed_it != ProvinceTable::INVALID_INDEX) {
+                    listing_states[next[*listed_it]++] = state_id;
+                }
+            }
+        }
+    }
+
+    // Every province can now be checked on its own
+    std::mutex results_mutex;
+    std::vector<std::pair<std::uint64_t, IssueList>> results;
+
+    parallelForRange(0, table.size(),
+        [&](std::uint64_t first, std::uint64_t last) {
+            IssueList issues;
+
+            for(auto i = first; i < last; ++i) {
+                auto index = static_cast<Index>(i);
+                const auto& province_id = table.getID(index);
+                auto state_id = table.getState(index);
+
+                bool state_exists = state_id != NO_STATE &&
+                                    states.count(state_id) != 0;
+                if(state_id != NO_STATE && !state_exists) {
+                    issues.push_back(Issue{ Type::INVALID_STATE_ID, province_id, state_id });
+                }
+
+                std::size_t times_in_own_state = 0;
+                for(auto j = offsets[i]; j < offsets[i + 1]; ++j) {
+                    auto listing_state = listing_states[j];
+
+                    if(state_exists && listing_state == state_id) {
+                        ++times_in_own_state;
+                    } else if(j == offsets[i] || listing_states[j - 1] != listing_state)
+                    {
+                        issues.push_back(Issue{ Type::ORPHANED, province_id, listing_state });
+                    }
+                }
+
+                if(state_exists && times_in_own_state == 0) {
+                    issues.push_back(Issue{ Type::NOT_IN_STATE, province_id, state_id });
+                } else if(times_in_own_state > 1) {
+                    issues.push_back(Issue{ Type::DUPLICATE, province_id, state_id });
+                }
+            }
+
+            if(!issues.empty()) {
+                std::lock_guard<std::mutex> lock(results_mutex);
+                results.emplace_back(first, std::move(issues));
+            }
+        }, VALIDATION_CHUNK_SIZE);
+
+    // Keep the results in province order no matter which thread finished first
+    std::sort(results.begin(), results.end(),
+              [](const auto& a, const auto& b) { return a.first < b.first; });
+
+    for(auto&& [_, issues] : results) {
+        m_issues.insert(m_issues.end(), issues.begin(), issues.end());
+    }
+
+    // Work out which states will need to be changed to fix everything
+    for(auto&& issue : m_issues) {
+        switch(issue.type) {
+            case Type::NOT_IN_STATE:
+                m_additions.emplace_back(issue.state, issue.province);
+                [[fallthrough]];
+            case Type::DUPLICATE:
+            case Type::MISSING_PROVINCE:
+            case Type::ORPHANED:
+                m_states_to_fix.push_back(issue.state);
+                break;
+            case Type::INVALID_STATE_ID:
+                break;
+        }
+    }
+
+    std::sort(m_states_to_fix.begin(), m_states_to_fix.end());
+    m_states_to_fix.erase(std::unique(m_states_to_fix.begin(),
+                                      m_states_to_fix.end()),
+                          m_states_to_fix.end());
+
+    std::stable_sort(m_additions.begin(), m_additions.end(),
+                     [](const auto& a, const auto& b) {
+                         return a.first < b.first;
+                     });
+}
+
+/**
+ * @brief Forgets about every issue
+ */
+void HMDT::Project::ProvinceStateValidator::clear() noexcept {
+    m_issues.clear();
+    m_states_to_fix.clear();
+    m_additions.clear();
+}
+
+/**
+ * @brief Gets every issue found by the last call to validate()
+ */
+auto HMDT::Project::ProvinceStateValidator::getIssues() const noexcept
+    -> const IssueList&
+{
+    return m_issues;
+}
+
+/**
+ * @brief Gets how many issues of a single type were found
+ */
+std::size_t HMDT::Project::ProvinceStateValidator::count(Issue::Type type) const noexcept
+{
+    return std::count_if(m_issues.begin(), m_issues.end(),
+                         [type](const Issue& issue) {
+                             return issue.type == type;
+                         });
+}
+
+/**
+ * @brief Checks if any issues were found which should fail validation.
+ * @details Only provinces which point at a state that is missing or which
+ *          doesn't hold them are errors. Every other issue is only a warning,
+ *          as the province's own state ID is still correct.
+ */
+bool HMDT::Project::ProvinceStateValidator::hasErrors() const noexcept {
+    return std::any_of(m_issues.begin(), m_issues.end(),
+                       [](const Issue& issue) {
+                           return issue.type == Issue::Type::INVALID_STATE_ID ||
+                                  issue.type == Issue::Type::NOT_IN_STATE;
+                       });
+}
+
+/**
+ * @brief Gets every state which must be passed to fixState()
+ */
+auto HMDT::Project::ProvinceStateValidator::getStatesToFix() const noexcept
+    -> const std::vector<StateID>&
+{
+    return m_states_to_fix;
+}
+
+/**
+ * @brief Fixes the province list of a single state
+ * @details Every province which no longer exists, belongs to another state, or
+ *          has already been listed is removed, and then every province which
+ *          belongs to this state but wasn't listed is added.
+ *
+ * @param table The same province table that was validated
+ * @param state The state to fix
+ */
+void HMDT::Project::ProvinceStateValidator::fixState(const ProvinceTable& table,
+                                                     State& state) const
+{
+    std::unordered_set<ProvinceTable::Index> seen;
+    seen.reserve(state.provinces.size());
+
+    state.provinces.erase(std::remove_if(state.provinces.begin(),
+                                         state.provinces.end(),
+                                         [&](const ProvinceID& province_id) {
+                                             auto index = table.getIndex(province_id);
+
+                                             return !index ||
+                                                    table.getState(*index) != state.id ||
+                                                    !seen.insert(*index).second;
+                                         }),
+                          state.provinces.end());
+
+    auto first = std::lower_bound(m_additions.begin(), m_additions.end(),
+                                  state.id,
+                                  [](const auto& addition, StateID id) {
+                                      return addition.first < id;
+                                  });
+    for(auto it = first; it != m_additions.end() && it->first == state.id; ++it)
+    {
+        state.provinces.push_back(it->second);
+    }
+}
+
+/**
+ * @brief Removes every province with an invalid state ID from its state
+ *
+ * @param provinces Every province
+ */
+void HMDT::Project::ProvinceStateValidator::fixProvinces(ProvinceList& provinces) const
+{
+    for(auto&& issue : m_issues) {
+        if(issue.type != Issue::Type::INVALID_STATE_ID) continue;
+
+        if(auto it = provinces.find(issue.province); it != provinces.end()) {
+            it->second.state = NO_STATE;
+        }
+    }
+}
+
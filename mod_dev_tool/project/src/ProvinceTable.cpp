@@ -0,0 +1,258 @@
+
+#include "ProvinceTable.h"
+
+#include <algorithm>
+
+/**
+ * @brief Builds a table out of the given provinces
+ *
+ * @param provinces The provinces to build the table from
+ */
+HMDT::Project::ProvinceTable::ProvinceTable(const ProvinceList& provinces) {
+    build(provinces);
+}
+
+/**
+ * @brief Rebuilds this table from the given provinces
+ *
+ * @param provinces The provinces to build the table from
+ */
+void HMDT::Project::ProvinceTable::build(const ProvinceList& provinces) {
+    clear();
+
+    // Order everything by ID so that the same provinces always produce the
+    //   same table
+    std::vector<const Province*> sorted;
+    sorted.reserve(provinces.size());
+    for(auto&& [_, province] : provinces) {
+        sorted.push_back(&province);
+    }
+    std::sort(sorted.begin(), sorted.end(),
+              [](const Province* a, const Province* b) {
+                  return a->id < b->id;
+              });
+
+    const auto size = sorted.size();
+
+    m_index_of.reserve(size);
+    m_ids.reserve(size);
+    m_colors.reserve(size);
+    m_types.reserve(size);
+    m_coastal.reserve(size);
+    m_states.reserve(size);
+    m_bounding_boxes.reserve(size);
+    m_terrains.reserve(size);
+    m_continents.reserve(size);
+
+    for(auto* province : sorted) {
+        m_index_of.emplace(province->id, static_cast<Index>(m_ids.size()));
+
+        m_ids.push_back(province->id);
+        m_colors.push_back(province->unique_color);
+        m_types.push_back(province->type);
+        m_coastal.push_back(province->coastal ? 1 : 0);
+        m_states.push_back(province->state);
+        m_bounding_boxes.push_back(province->bounding_box);
+        m_terrains.push_back(province->terrain);
+        m_continents.push_back(province->continent);
+    }
+
+    // Now that every province has an index, we can resolve the relations
+    //   between them. Anything which refers to a province that doesn't exist
+    //   gets dropped.
+    m_parents.reserve(size);
+    m_adjacency_offsets.reserve(size + 1);
+    m_children_offsets.reserve(size + 1);
+
+    m_adjacency_offsets.push_back(0);
+    m_children_offsets.push_back(0);
+
+    for(auto* province : sorted) {
+        auto parent = getIndex(province->parent_id);
+        m_parents.push_back(parent.value_or(INVALID_INDEX));
+
+        for(auto&& adj_id : province->adjacent_provinces) {
+            if(auto adj = getIndex(adj_id); adj) {
+                m_adjacency.push_back(*adj);
+            }
+        }
+        m_adjacency_offsets.push_back(m_adjacency.size());
+
+        for(auto&& child_id : province->children) {
+            if(auto child = getIndex(child_id); child) {
+                m_children.push_back(*child);
+            }
+        }
+        m_children_offsets.push_back(m_children.size());
+    }
+}
+
+/**
+ * @brief Removes every province from this table
+ */
+void HMDT::Project::ProvinceTable::clear() noexcept {
+    m_index_of.clear();
+    m_ids.clear();
+    m_colors.clear();
+    m_types.clear();
+    m_coastal.clear();
+    m_states.clear();
+    m_bounding_boxes.clear();
+    m_terrains.clear();
+    m_continents.clear();
+    m_parents.clear();
+    m_adjacency_offsets.clear();
+    m_adjacency.clear();
+    m_children_offsets.clear();
+    m_children.clear();
+}
+
+std::size_t HMDT::Project::ProvinceTable::size() const noexcept {
+    return m_ids.size();
+}
+
+bool HMDT::Project::ProvinceTable::empty() const noexcept {
+    return m_ids.empty();
+}
+
+/**
+ * @brief Gets the index of a province
+ *
+ * @param id The ID of the province
+ *
+ * @return The index of the province, or std::nullopt if it is not in this
+ *         table.
+ */
+auto HMDT::Project::ProvinceTable::getIndex(const ProvinceID& id) const noexcept
+    -> std::optional<Index>
+{
+    if(auto it = m_index_of.find(id); it != m_index_of.end()) {
+        return it->second;
+    }
+
+    return std::nullopt;
+}
+
+auto HMDT::Project::ProvinceTable::getID(Index index) const noexcept
+    -> const ProvinceID&
+{
+    return m_ids[index];
+}
+
+auto HMDT::Project::ProvinceTable::getColor(Index index) const noexcept
+    -> const Color&
+{
+    return m_colors[index];
+}
+
+auto HMDT::Project::ProvinceTable::getType(Index index) const noexcept
+    -> ProvinceType
+{
+    return m_types[index];
+}
+
+bool HMDT::Project::ProvinceTable::isCoastal(Index index) const noexcept {
+    return m_coastal[index] != 0;
+}
+
+auto HMDT::Project::ProvinceTable::getState(Index index) const noexcept
+    -> StateID
+{
+    return m_states[index];
+}
+
+auto HMDT::Project::ProvinceTable::getBoundingBox(Index index) const noexcept
+    -> const BoundingBox&
+{
+    return m_bounding_boxes[index];
+}
+
+auto HMDT::Project::ProvinceTable::getTerrain(Index index) const noexcept
+    -> TerrainID
+{
+    return m_terrains[index];
+}
+
+auto HMDT::Project::ProvinceTable::getContinent(Index index) const noexcept
+    -> Continent
+{
+    return m_continents[index];
+}
+
+/**
+ * @brief Gets the parent of a province
+ *
+ * @param index The index of the province
+ *
+ * @return The index of the parent, or INVALID_INDEX if it has none.
+ */
+auto HMDT::Project::ProvinceTable::getParent(Index index) const noexcept
+    -> Index
+{
+    return m_parents[index];
+}
+
+/**
+ * @brief Gets every province adjacent to a province
+ *
+ * @param index The index of the province
+ *
+ * @return The indices of every adjacent province
+ */
+auto HMDT::Project::ProvinceTable::getAdjacentProvinces(Index index) const noexcept
+    -> IndexRange
+{
+    return IndexRange(m_adjacency.data() + m_adjacency_offsets[index],
+                      m_adjacency.data() + m_adjacency_offsets[index + 1]);
+}
+
+/**
+ * @brief Gets every child of a province
+ *
+ * @param index The index of the province
+ *
+ * @return The indices of every child province
+ */
+auto HMDT::Project::ProvinceTable::getChildren(Index index) const noexcept
+    -> IndexRange
+{
+    return IndexRange(m_children.data() + m_children_offsets[index],
+                      m_children.data() + m_children_offsets[index + 1]);
+}
+
+auto HMDT::Project::ProvinceTable::getIDs() const noexcept
+    -> const std::vector<ProvinceID>&
+{
+    return m_ids;
+}
+
+auto HMDT::Project::ProvinceTable::getTypes() const noexcept
+    -> const std::vector<ProvinceType>&
+{
+    return m_types;
+}
+
+auto HMDT::Project::ProvinceTable::getCoastalFlags() const noexcept
+    -> const std::vector<std::uint8_t>&
+{
+    return m_coastal;
+}
+
+auto HMDT::Project::ProvinceTable::getStates() const noexcept
+    -> const std::vector<StateID>&
+{
+    return m_states;
+}
+
+auto HMDT::Project::ProvinceTable::getTerrains() const noexcept
+    -> const std::vector<TerrainID>&
+{
+    return m_terrains;
+}
+
+auto HMDT::Project::ProvinceTable::getContinents() const noexcept
+    -> const std::vector<Continent>&
+{
+    return m_continents;
+}
+
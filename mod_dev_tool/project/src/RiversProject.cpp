@@ -4,11 +4,14 @@
 #include <fstream>
 #include <cstring>
 #include <memory>
+#include <atomic>
+#include <algorithm>
 
 #include "Logger.h"
 
 #include "Constants.h"
 #include "StatusCodes.h"
+#include "ProjectSnapshot.h"
 #include "MapData.h"
 #include "Util.h"
 
@@ -24,14 +27,16 @@ HMDT::Project::RiversProject::RiversProject(IRootMapProject& parent):
 { }
 
 /**
- * @brief Writes all continent data to root/$RIVERS_FILENAME
+ * @brief Adds the rivers to a snapshot, to be written to root/$RIVERS_FILENAME
  *
  * @param root The root where the rivers should go
- * @param ec The error code
+ * @param snapshot The snapshot to add to
  *
- * @return True if the rivers was successfully saved, false otherwise
+ * @return STATUS_SUCCESS on success, or STATUS_NO_DATA_LOADED if there are no
+ *         rivers to save.
  */
-auto HMDT::Project::RiversProject::save(const std::filesystem::path& root)
+auto HMDT::Project::RiversProject::prepareSave(const std::filesystem::path& root,
+                                               ProjectSnapshot& snapshot) const
     -> MaybeVoid
 {
     if(m_rivers_bmp == nullptr) {
@@ -39,11 +44,13 @@ auto HMDT::Project::RiversProject::save(const std::filesystem::path& root)
         RETURN_ERROR(STATUS_NO_DATA_LOADED);
     }
 
-    auto path = root / RIVERS_FILENAME;
-
-    // Write the rivers to a file
-    auto res = writeBMP(path, m_rivers_bmp);
-    RETURN_IF_ERROR(res);
+    // The bitmap is only ever replaced, never changed, so it is safe to keep
+    //   writing this one even if a new one gets loaded
+    snapshot.addFile(root / RIVERS_FILENAME,
+        [bmp = std::shared_ptr<const BitMap2>(m_rivers_bmp)](const std::filesystem::path& path)
+        {
+            return writeBMP(path, bmp);
+        });
 
     return STATUS_SUCCESS;
 }
@@ -156,8 +163,29 @@ auto HMDT::Project::RiversProject::getRootMapParent() const
     return m_parent_project.getRootMapParent();
 }
 
+/**
+ * @brief Reads a rivers file and copies it into the MapData
+ *
+ * @param path The path to the rivers file
+ */
 auto HMDT::Project::RiversProject::loadFile(const std::filesystem::path& path) noexcept
     -> MaybeVoid
+{
+    auto res = readFile(path);
+    RETURN_IF_ERROR(res);
+
+    return applyBitMap();
+}
+
+/**
+ * @brief Decodes a rivers file, without touching the MapData.
+ * @details This may be done before the MapData has been loaded, or at the
+ *          same time as it is loaded.
+ *
+ * @param path The path to the rivers file
+ */
+auto HMDT::Project::RiversProject::readFile(const std::filesystem::path& path) noexcept
+    -> MaybeVoid
 {
     try {
         m_rivers_bmp.reset(new BitMap2);
@@ -171,6 +199,17 @@ auto HMDT::Project::RiversProject::loadFile(const std::filesystem::path& path) n
 
     WRITE_DEBUG(*m_rivers_bmp);
 
+    return STATUS_SUCCESS;
+}
+
+/**
+ * @brief Copies the rivers read by readFile() into the MapData
+ * @details The MapData must already be loaded, as the rivers must match its
+ *          dimensions.
+ */
+auto HMDT::Project::RiversProject::applyBitMap() noexcept -> MaybeVoid {
+    RETURN_ERROR_IF(m_rivers_bmp == nullptr, STATUS_NO_DATA_LOADED);
+
     if(auto d = getMapData()->getDimensions();
             d.first != m_rivers_bmp->info_header.v1.width ||
             d.second != m_rivers_bmp->info_header.v1.height)
@@ -233,45 +272,151 @@ auto HMDT::Project::RiversProject::writeTemplate(const std::filesystem::path& pa
     return STATUS_SUCCESS;
 }
 
+/**
+ * @brief Generates the template data for a rivers image.
+ * @details Every pixel is filled in with the comment color matching the type
+ *          of the province it belongs to. Any pixel which belongs to an
+ *          unknown province is still filled in (as UNKNOWN), and all such
+ *          pixels are reported together once the whole image is generated.
+ *
+ * @param data The buffer to allocate and fill in.
+ *
+ * @return STATUS_SUCCESS on success, STATUS_VALUE_NOT_FOUND if any pixel
+ *         belongs to an unknown province, STATUS_NO_DATA_LOADED if there is
+ *         no map data, or STATUS_BADALLOC if the buffer could not be
+ *         allocated.
+ */
 auto HMDT::Project::RiversProject::generateTemplate(std::unique_ptr<uint8_t[]>& data) const noexcept
     -> MaybeVoid
 {
+    std::shared_ptr<const MapData> map_data = getMapData();
+    const auto size = map_data->getRiversSize();
+    const auto& province_project = getRootMapParent().getProvinceProject();
+
+    // Both tables must come from the same snapshot, or the indices in one
+    //   will not line up with the other
+    auto table = province_project.getProvinceTable();
+
+    PaletteTable palette_table;
+    std::unique_ptr<uint32_t[]> index_matrix;
     try {
-        data.reset(new uint8_t[getMapData()->getRiversSize()]);
+        data.reset(new uint8_t[size]);
+        palette_table = generatePaletteTable(*table);
+        index_matrix = province_project.buildProvinceIndexMatrix(*table);
     } catch(const std::bad_alloc& e) {
         WRITE_ERROR(e.what());
         RETURN_ERROR(STATUS_BADALLOC);
     }
 
-    for(auto i = 0U; i < getMapData()->getRiversSize(); ++i) {
-        auto province_label = getMapData()->getProvinces().lock()[i];
+    RETURN_ERROR_IF(index_matrix == nullptr, STATUS_NO_DATA_LOADED);
 
-        if(!getRootMapParent().getProvinceProject().isValidProvinceID(province_label))
-        {
-            WRITE_ERROR("Province ID ", province_label, " at river index ", i,
-                        " is not valid.");
-            RETURN_ERROR(STATUS_VALUE_NOT_FOUND);
-        }
-
-        auto prov_type = getRootMapParent().getProvinceProject().getProvinceForID(province_label).type;
-
-        switch(prov_type) {
-            case ProvinceType::LAND:
-                data[i] = 12;
-                break;
-            case ProvinceType::LAKE:
-            case ProvinceType::SEA:
-                data[i] = 13;
-                break;
-            case ProvinceType::UNKNOWN:
-                data[i] = 14;
-                break;
-        }
+    auto num_invalid = fillTemplate(data.get(), index_matrix.get(),
+                                    palette_table, size);
+
+    if(num_invalid != 0) {
+        // Only bother finding where the first one is once we know that there
+        //   is one, so that filling in the template doesn't have to
+        auto first_invalid = std::find(index_matrix.get(),
+                                       index_matrix.get() + size,
+                                       0) - index_matrix.get();
+        auto provinces = map_data->getProvinces().lock();
+
+        WRITE_ERROR(num_invalid, " river pixels do not belong to a valid"
+                    " province. First invalid province ID is ",
+                    provinces[first_invalid], " at river index ",
+                    first_invalid, ".");
+        RETURN_ERROR(STATUS_VALUE_NOT_FOUND);
     }
 
     return STATUS_SUCCESS;
 }
 
+/**
+ * @brief Builds a table mapping the dense index of every province to the
+ *        river palette index for its type.
+ *
+ * @param table The table of every province
+ *
+ * @return The palette table, which is indexed by the values of
+ *         IProvinceProject::buildProvinceIndexMatrix().
+ */
+auto HMDT::Project::RiversProject::generatePaletteTable(const ProvinceTable& table)
+    -> PaletteTable
+{
+    const auto& types = table.getTypes();
+
+    PaletteTable palette_table(types.size() + 1);
+
+    palette_table[0] = getTemplatePaletteIndex(ProvinceType::UNKNOWN);
+    std::transform(types.begin(), types.end(), palette_table.begin() + 1,
+                   getTemplatePaletteIndex);
+
+    return palette_table;
+}
+
+/**
+ * @brief Fills in the template data for a rivers image.
+ * @details This is a plain gather from the palette table, so it is split up
+ *          across threads and each chunk is simple enough to be vectorized.
+ *
+ * @param out The buffer to fill in.
+ * @param index_matrix The dense index of the province (plus one) at each
+ *                     pixel, or 0 if the pixel has no province.
+ * @param palette_table The palette index for each value in index_matrix.
+ * @param size The number of pixels to fill in.
+ *
+ * @return The number of pixels which have no province.
+ */
+std::uint64_t HMDT::Project::RiversProject::fillTemplate(uint8_t* out,
+                                                         const uint32_t* index_matrix,
+                                                         const PaletteTable& palette_table,
+                                                         std::uint64_t size) noexcept
+{
+    //! The smallest number of pixels that are worth handing to another thread
+    constexpr std::uint64_t MIN_PIXELS_PER_CHUNK = 1 << 16;
+
+    const uint8_t* palette = palette_table.data();
+
+    std::atomic<std::uint64_t> num_invalid = 0;
+
+    parallelForRange(0, size,
+        [&](std::uint64_t first, std::uint64_t last) {
+            std::uint64_t chunk_invalid = 0;
+
+            for(auto i = first; i < last; ++i) {
+                out[i] = palette[index_matrix[i]];
+                chunk_invalid += (index_matrix[i] == 0);
+            }
+
+            num_invalid += chunk_invalid;
+        }, MIN_PIXELS_PER_CHUNK);
+
+    return num_invalid;
+}
+
+/**
+ * @brief Gets the index into the rivers color table for the given province
+ *        type.
+ *
+ * @param type The province type.
+ *
+ * @return The index of the comment color for the type.
+ */
+auto HMDT::Project::RiversProject::getTemplatePaletteIndex(const ProvinceType& type) noexcept
+    -> uint8_t
+{
+    switch(type) {
+        case ProvinceType::LAND:
+            return 12;
+        case ProvinceType::LAKE:
+        case ProvinceType::SEA:
+            return 13;
+        case ProvinceType::UNKNOWN:
+        default:
+            return 14;
+    }
+}
+
 /**
  * @brief Generates a color table for rivers.
  * @details See https://hoi4.paradoxwikis.com/Map_modding#Rivers for a
@@ -2,6 +2,8 @@
 #include "StateProject.h"
 
 #include <fstream>
+#include <mutex>
+#include <cstdio>
 #include <cstring>
 #include <cerrno>
 
@@ -11,6 +13,7 @@
 #include "Options.h"
 #include "Constants.h"
 #include "StatusCodes.h"
+#include "ProjectSnapshot.h"
 #include "UniqueColorGenerator.h"
 
 #include "HoI4Project.h"
@@ -20,64 +23,79 @@
 #include "StateNode.h"
 #include "NodeKeyNames.h"
 
+namespace {
+    //! The fewest states worth handing to a single thread when exporting
+    constexpr std::uint64_t STATE_EXPORT_CHUNK_SIZE = 16;
+
+    //! Roughly how many bytes a state file takes up, not counting provinces
+    constexpr std::size_t STATE_FILE_BASE_SIZE = 256;
+}
+
 HMDT::Project::StateProject::StateProject(IRootHistoryProject& parent_project):
     m_parent_project(parent_project),
     m_available_state_ids(),
-    m_states()
+    m_states(),
+    m_color_allocator()
 {
 }
 
 HMDT::Project::StateProject::~StateProject() { }
 
 /**
- * @brief Writes all state data to root/$STATEDATA_FILENAME
+ * @brief Adds all state data to a snapshot, to be written to
+ *        root/$STATEDATA_FILENAME
  *
  * @param root The root where all state data should go
- * @param ec The error code
+ * @param snapshot The snapshot to add to
  *
- * @return True if state data was successfully saved, false otherwise
+ * @return STATUS_SUCCESS
  */
-auto HMDT::Project::StateProject::save(const std::filesystem::path& root) 
+auto HMDT::Project::StateProject::prepareSave(const std::filesystem::path& root,
+                                              ProjectSnapshot& snapshot) const
     -> MaybeVoid
 {
-    auto path = root / STATEDATA_FILENAME;
+    snapshot.addFile(root / STATEDATA_FILENAME,
+        [states = m_states](const std::filesystem::path& path) -> MaybeVoid
+        {
+            if(std::ofstream out(path); out) {
+                WRITE_DEBUG("Saving states to ", path);
 
-    if(std::ofstream out(path); out) {
-        WRITE_DEBUG("Saving states to ", path);
+                // FORMAT:
+                //   ID;<State Name>;MANPOWER;<CATEGORY>;BUILDINGS_MAX_LEVEL_FACTOR;IMPASSABLE;PROVID1,PROVID2,...
 
-        // FORMAT:
-        //   ID;<State Name>;MANPOWER;<CATEGORY>;BUILDINGS_MAX_LEVEL_FACTOR;IMPASSABLE;PROVID1,PROVID2,...
+                // TODO: We may end up supporting State history as well. If we do, then
+                //   the best way to do so while still supporting this format is to
+                //   have another file holding this info that's tied to the state
+                //   (perhaps a 'hist/<STATEID>.hist' file)
 
-        // TODO: We may end up supporting State history as well. If we do, then
-        //   the best way to do so while still supporting this format is to
-        //   have another file holding this info that's tied to the state
-        //   (perhaps a 'hist/<STATEID>.hist' file)
+                for(auto&& [_, state] : states) {
+                    WRITE_DEBUG("Writing state ID ", state.id);
 
-        for(auto&& [_, state] : m_states) {
-            WRITE_DEBUG("Writing state ID ", state.id);
+                    out << state.id << ';'
+                        << state.name << ';'
+                        << state.manpower << ';'
+                        << state.category << ';'
+                        << state.buildings_max_level_factor << ';'
+                        << (size_t)state.impassable << ';';
 
-            out << state.id << ';'
-                << state.name << ';'
-                << state.manpower << ';'
-                << state.category << ';'
-                << state.buildings_max_level_factor << ';'
-                << (size_t)state.impassable << ';';
+                    for(ProvinceID p : state.provinces) {
+                        out << p << ',';
+                    }
+                    out << ';';
 
-            for(ProvinceID p : state.provinces) {
-                out << p << ',';
-            }
-            out << ';';
+                    out << static_cast<uint32_t>(state.color.r) << ';'
+                        << static_cast<uint32_t>(state.color.g) << ';'
+                        << static_cast<uint32_t>(state.color.b);
 
-            out << static_cast<uint32_t>(state.color.r) << ';'
-                << static_cast<uint32_t>(state.color.g) << ';'
-                << static_cast<uint32_t>(state.color.b);
+                    out << std::endl;
+                }
+            } else {
+                WRITE_ERROR("Failed to open file ", path);
+                RETURN_ERROR(std::make_error_code(static_cast<std::errc>(errno)));
+            }
 
-            out << std::endl;
-        }
-    } else {
-        WRITE_ERROR("Failed to open file ", path);
-        RETURN_ERROR(std::make_error_code(static_cast<std::errc>(errno)));
-    }
+            return STATUS_SUCCESS;
+        });
 
     return STATUS_SUCCESS;
 }
@@ -109,6 +127,10 @@ auto HMDT::Project::StateProject::load(const std::filesystem::path& root)
         // Make sure we clear out the states map first just in case there is
         //   some data in here (there shouldn't be)
         m_states.clear();
+        m_color_allocator.reset();
+
+        // Every state which needs a new color once everything is loaded
+        std::vector<StateID> states_without_color;
 
         // FORMAT:
         //   ID;<State Name>;MANPOWER;<CATEGORY>;BUILDINGS_MAX_LEVEL_FACTOR;IMPASSABLE;PROVID1,PROVID2,...
@@ -152,14 +174,6 @@ auto HMDT::Project::StateProject::load(const std::filesystem::path& root)
                         "}"
             );
 
-            // If we did not load a state color, then the color should be 0,0,0
-            // In that case, we want to generate a new unique color value
-            if(state.color == Color{0,0,0}) {
-                WRITE_WARN("Saved state data did not have a color value, generating a new one...");
-                state.color = generateUniqueColor(ProvinceType::UNKNOWN);
-            } else {
-                generateUniqueColor(ProvinceType::UNKNOWN); // "generate" a color to advance the number of colors by 1
-            }
 
             // We need to parse the provinces seperately
             bool err = false;
@@ -188,10 +202,27 @@ auto HMDT::Project::StateProject::load(const std::filesystem::path& root)
             } else {
                 WRITE_DEBUG("Successfully loaded state ID ", state.id,
                             " named ", state.name);
+
+                // If we did not load a state color, then the color should be
+                //   0,0,0. In that case, we want to generate a new unique color
+                //   value, but only once every loaded color is known so that
+                //   we don't hand out one which a later state already uses
+                if(state.color == Color{0,0,0}) {
+                    states_without_color.push_back(state.id);
+                } else if(!m_color_allocator.markInUse(state.color)) {
+                    WRITE_WARN("State ", state.id, " has the same color as another state.");
+                }
+
                 m_states[state.id] = state;
             }
         }
 
+        for(auto&& id : states_without_color) {
+            WRITE_WARN("Saved state data for state ", id,
+                       " did not have a color value, generating a new one...");
+            m_states.at(id).color = m_color_allocator.allocate(ProvinceType::UNKNOWN);
+        }
+
         // Now that we've loaded every single state, we need to track which IDs
         //  have not been used yet
         for(StateID id = 1; id < m_states.size(); ++id) {
@@ -228,109 +259,66 @@ auto HMDT::Project::StateProject::export_(const std::filesystem::path& root) con
 
     const auto& prov_project = getRootParent().getMapProject().getProvinceProject();
 
+    // Flatten the states out so that they can be split up between threads
+    std::vector<const State*> states;
+    states.reserve(m_states.size());
     for(auto&& [id, state] : m_states) {
-        auto filename = std::to_string(id) + "-" + state.name + ".txt";
-        auto state_path = root / filename;
+        states.push_back(&state);
+    }
 
-        if(std::ofstream out(state_path); out) {
-            std::stringstream provinces_ss;
-            for(auto&& id : state.provinces) {
-                provinces_ss << prov_project.getIDForProvinceID(id) << ' ';
-            }
+    std::mutex failures_mutex;
+    std::vector<std::pair<std::filesystem::path, std::error_code>> failures;
+
+    // Each chunk only ever has a single file open at a time, so limiting the
+    //   number of threads also limits the number of open files
+    parallelForRange(0, states.size(),
+        [&](std::uint64_t first, std::uint64_t last) {
+            // Reused for every state in this chunk, so that we only have to
+            //   allocate once per thread rather than once per state
+            std::string buffer;
+            std::vector<uint32_t> province_ids;
+
+            for(auto i = first; i < last; ++i) {
+                const auto& state = *states[i];
+
+                province_ids.clear();
+                province_ids.reserve(state.provinces.size());
+                for(auto&& id : state.provinces) {
+                    province_ids.push_back(prov_project.getIDForProvinceID(id));
+                }
 
-            out << "state={" << std::endl;
-            // General state information
-            out << "\tid=" << id << std::endl;
-            out << "\tname=\"" << state.name << '"' << std::endl; // TODO: HoI4 uses STATE_{ID} here, is that for localization?
-            out << "\tmanpower=" << state.manpower << std::endl;
-            out << "\tstate_category = " << state.category << std::endl;
-
-            // Leave this out of the export if it's left as the default 1.0
-            if(state.buildings_max_level_factor != 1.0) {
-                // TODO: wiki recommends avoiding this. Should we not support it at all?
-                out << "\tbuildings_max_level_factor=" << state.buildings_max_level_factor << std::endl;
-            }
+                buffer.clear();
+                renderStateFile(state, province_ids, buffer);
+
+                auto state_path = root / (std::to_string(state.id) + "-" + state.name + ".txt");
 
-            // TODO: Resources
+                std::error_code ec;
+                if(std::ofstream out(state_path); out) {
+                    out.write(buffer.data(), buffer.size());
+                    out.close();
 
-            if(state.impassable) {
-                out << "\timpassable = yes" << std::endl;
+                    if(!out) {
+                        ec = std::make_error_code(std::errc::io_error);
+                    }
+                } else {
+                    ec = std::make_error_code(static_cast<std::errc>(errno));
+                }
+
+                if(ec) {
+                    std::lock_guard<std::mutex> lock(failures_mutex);
+                    failures.emplace_back(state_path, ec);
+                }
             }
+        }, STATE_EXPORT_CHUNK_SIZE, MAX_CONCURRENT_EXPORT_FILES);
 
-            // History here
-            out << "\thistory={" << std::endl;
-
-            // NOTE (from wiki):
-            //   Only one province can be defined within one victory_points.
-            //   In order to have multiple provinces with victory points in one
-            //   state, several instances of victory_points = { ... } need to be
-            //   put in.
-            // TODO: This should be a for-loop, generating a 'victory_points={}'
-            //   block for each victory point
-            // out << "\t\tvictory_points={" << std::endl;
-            // TODO Format is "PROVID AMOUNT"
-            // out << "\t\t}" << std::endl;
-
-            // TODO: Owner
-            //   Game will load without owners, but doing stuff to this state
-            //   (like transferring it) will cause a crash
-            // For now, we are using a country that does not exist at the start
-            //   of the game and has no focus tree for testing.
-            out << "\t\towner = CHA" << std::endl;
-
-            out << "\t\tbuildings={" << std::endl;
-            // TODO
-            //  NOTE: Each of these can be left blank if their count is 0
-            //  NOTE: When designing how these buildings are outputted, we
-            //    should keep in mind that custom buildings can be added as well
-            //
-            //  infrastructure = ...
-            //  arms_factory = ...
-            //  industrial_complex = ...
-            //  dockyard = ...
-            //  airbase = ... // TODO: air_base? wiki disagrees with what's in the files
-            //  anti_air_building = ...
-            //  synthetic_refinery = ...
-            //  fuel_silo = ...
-            //  radar_station = ...
-            //  rocket_site = ...
-            //  nuclear_reactor = ...
-            //  for each province: // Skip if province has no buildings
-            //    id = {
-            //      naval_base = ...
-            //      bunker = ...
-            //      coastal_bunker = ...
-            //      supply_node = ...
-            //      rail_way = ...
-            //    }
-            out << "\t\t}" << std::endl;
-
-            // TODO
-            //  This is optional, for if someone other than the owner should
-            //  start out controlling it
-            // out << "\t\tcontroller = " << std::endl;
-
-            // TODO
-            // Optional, for if claimed by another country
-            // out << "\t\tadd_core_of = " << std::endl;
-
-            // TODO: This serves as an effect block. Do we want to allow
-            //   defining other effects on a state?
-
-            out << "\t}" << std::endl;
-            // More general state information
-            out << "\tprovinces={" << std::endl;
-            out << "\t\t" << provinces_ss.str() << std::endl;
-            out << "\t}" << std::endl;
-            // TODO
-            //   This is optional, it is for defining the base supply of the
-            //    state
-            // out << "\tlocal_supplies=" << ... << std::endl;
-            out << "}";
-        } else {
-            WRITE_ERROR("Failed to open file ", state_path);
-            RETURN_ERROR(std::make_error_code(static_cast<std::errc>(errno)));
+    if(!failures.empty()) {
+        for(auto&& [path, ec] : failures) {
+            WRITE_ERROR("Failed to write file ", path, ". Reason: ", ec.message());
         }
+
+        WRITE_ERROR("Failed to export ", failures.size(), " of ",
+                    states.size(), " state files.");
+        RETURN_ERROR(STATUS_STATE_EXPORT_FAILED);
     }
 
     // TODO: We should also export blank state files for all of the vanilla
@@ -339,6 +327,127 @@ auto HMDT::Project::StateProject::export_(const std::filesystem::path& root) con
     return STATUS_SUCCESS;
 }
 
+/**
+ * @brief Writes the history file for a single state
+ *
+ * @param state The state to write
+ * @param province_ids The exported ID of every province in the state, in the
+ *                     same order as state.provinces
+ * @param out The buffer to append the file contents to
+ */
+void HMDT::Project::StateProject::renderStateFile(const State& state,
+                                                  const std::vector<uint32_t>& province_ids,
+                                                  std::string& out)
+{
+    out.reserve(out.size() + STATE_FILE_BASE_SIZE + province_ids.size() * 6);
+
+    out += "state={\n";
+    // General state information
+    out += "\tid=";
+    out += std::to_string(state.id);
+    out += "\n\tname=\"";
+    out += state.name; // TODO: HoI4 uses STATE_{ID} here, is that for localization?
+    out += "\"\n\tmanpower=";
+    out += std::to_string(state.manpower);
+    out += "\n\tstate_category = ";
+    out += state.category.str();
+    out += '\n';
+
+    // Leave this out of the export if it's left as the default 1.0
+    if(state.buildings_max_level_factor != 1.0) {
+        // TODO: wiki recommends avoiding this. Should we not support it at all?
+
+        // %g matches how an ostream would write out the value by default
+        char factor[32];
+        std::snprintf(factor, sizeof(factor), "%g",
+                      static_cast<double>(state.buildings_max_level_factor));
+
+        out += "\tbuildings_max_level_factor=";
+        out += factor;
+        out += '\n';
+    }
+
+    // TODO: Resources
+
+    if(state.impassable) {
+        out += "\timpassable = yes\n";
+    }
+
+    // History here
+    out += "\thistory={\n";
+
+    // NOTE (from wiki):
+    //   Only one province can be defined within one victory_points.
+    //   In order to have multiple provinces with victory points in one
+    //   state, several instances of victory_points = { ... } need to be
+    //   put in.
+    // TODO: This should be a for-loop, generating a 'victory_points={}'
+    //   block for each victory point
+    // out << "\t\tvictory_points={" << std::endl;
+    // TODO Format is "PROVID AMOUNT"
+    // out << "\t\t}" << std::endl;
+
+    // TODO: Owner
+    //   Game will load without owners, but doing stuff to this state
+    //   (like transferring it) will cause a crash
+    // For now, we are using a country that does not exist at the start
+    //   of the game and has no focus tree for testing.
+    out += "\t\towner = CHA\n";
+
+    out += "\t\tbuildings={\n";
+    // TODO
+    //  NOTE: Each of these can be left blank if their count is 0
+    //  NOTE: When designing how these buildings are outputted, we
+    //    should keep in mind that custom buildings can be added as well
+    //
+    //  infrastructure = ...
+    //  arms_factory = ...
+    //  industrial_complex = ...
+    //  dockyard = ...
+    //  airbase = ... // TODO: air_base? wiki disagrees with what's in the files
+    //  anti_air_building = ...
+    //  synthetic_refinery = ...
+    //  fuel_silo = ...
+    //  radar_station = ...
+    //  rocket_site = ...
+    //  nuclear_reactor = ...
+    //  for each province: // Skip if province has no buildings
+    //    id = {
+    //      naval_base = ...
+    //      bunker = ...
+    //      coastal_bunker = ...
+    //      supply_node = ...
+    //      rail_way = ...
+    //    }
+    out += "\t\t}\n";
+
+    // TODO
+    //  This is optional, for if someone other than the owner should
+    //  start out controlling it
+    // out << "\t\tcontroller = " << std::endl;
+
+    // TODO
+    // Optional, for if claimed by another country
+    // out << "\t\tadd_core_of = " << std::endl;
+
+    // TODO: This serves as an effect block. Do we want to allow
+    //   defining other effects on a state?
+
+    out += "\t}\n";
+    // More general state information
+    out += "\tprovinces={\n\t\t";
+    for(auto id : province_ids) {
+        out += std::to_string(id);
+        out += ' ';
+    }
+    out += "\n\t}\n";
+    // TODO
+    //   This is optional, it is for defining the base supply of the
+    //    state
+    // out << "\tlocal_supplies=" << ... << std::endl;
+    out += '}';
+}
+
 auto HMDT::Project::StateProject::getMapData() -> std::shared_ptr<MapData> {
     return getRootParent().getMapProject().getMapData();
 }
@@ -381,7 +490,18 @@ auto HMDT::Project::StateProject::getStates() const -> const StateMap& {
     return m_states;
 }
 
+/**
+ * @brief Rebuilds the state ID matrix from the state of every province
+ * @details Everything which moves provinces between states finishes by calling
+ *          this, so the province table is also rebuilt here to pick up the
+ *          new states.
+ */
 void HMDT::Project::StateProject::updateStateIDMatrix() {
+    auto& province_project = getRootParent().getMapProject().getProvinceProject();
+    province_project.rebuildProvinceTable();
+
+    auto table = province_project.getProvinceTable();
+
     auto state_id_matrix = getMapData()->getStateIDMatrix().lock();
 
     auto label_matrix = getMapData()->getProvinces().lock();
@@ -390,10 +510,9 @@ void HMDT::Project::StateProject::updateStateIDMatrix() {
 
     parallelTransform(label_matrix_start, label_matrix_start + getMapData()->getProvincesSize(),
                       state_id_matrix.get(),
-                      [this](ProvinceID prov_id) -> StateID {
-                          if(getRootParent().getMapProject().getProvinceProject().isValidProvinceID(prov_id))
-                          {
-                              return getRootParent().getMapProject().getProvinceProject().getProvinceForID(prov_id).state;
+                      [&table](ProvinceID prov_id) -> StateID {
+                          if(auto index = table->getIndex(prov_id); index) {
+                              return table->getState(*index);
                           } else {
                               WRITE_WARN("Invalid province ID ", prov_id,
                                          " detected when building state id matrix. Treating as though there's no state here.");
@@ -401,6 +520,9 @@ void HMDT::Project::StateProject::updateStateIDMatrix() {
                           }
                       });
 
+    // The matrix was written in place, so nothing else knows it has changed
+    getMapData()->markStateIDMatrixUpdated();
+
     if(prog_opts.debug) {
         auto path = getRootParent().getDebugRoot();
         auto fname = path / "stateidmtx.txt";
@@ -474,7 +596,7 @@ auto HMDT::Project::StateProject::addNewState(const std::vector<ProvinceID>& pro
         DEFAULT_BUILDINGS_MAX_LEVEL_FACTOR, /* buildings_max_level_factor */
         false, /* impassable */
         province_ids,
-        generateUniqueColor(ProvinceType::UNKNOWN)
+        m_color_allocator.allocate(ProvinceType::UNKNOWN)
     };
 
     updateStateIDMatrix();
@@ -497,6 +619,9 @@ auto HMDT::Project::StateProject::removeState(StateID id) noexcept -> MaybeVoid
         for(auto&& prov_id : state.provinces) {
             getRootParent().getMapProject().getProvinceProject().getProvinceForID(prov_id).state = -1;
         }
+
+        // Let the next new state re-use this state's color
+        m_color_allocator.release(state.color);
     });
 
     m_available_state_ids.push(id);
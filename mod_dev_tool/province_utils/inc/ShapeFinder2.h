@@ -11,11 +11,14 @@
 # include <unordered_map>
 # include <optional>
 # include <memory>
+# include <memory_resource>
 
+# include "ArenaResource.h"
 # include "IGraphicsWorker.h"
 # include "Types.h"
 # include "BitMap.h"
 # include "Monad.h"
+# include "UniqueColorGenerator.h"
 # include "Uuid.h"
 
 namespace HMDT {
@@ -26,7 +29,8 @@ namespace HMDT {
      */
     class ShapeFinder {
         public:
-            using LabelToColorMap = std::map<UUID, Color>;
+            using LabelToColorMap = std::pmr::map<UUID, Color>;
+            using BorderPixelList = std::pmr::vector<Pixel>;
 
             enum class Stage {
                 START,
@@ -51,15 +55,17 @@ namespace HMDT {
 
             Stage getStage() const;
 
-            std::vector<Pixel>& getBorderPixels();
+            BorderPixelList& getBorderPixels();
             LabelToColorMap& getLabelToColorMap();
             PolygonList& getShapes();
 
             const BitMap* getImage() const;
-            const std::vector<Pixel>& getBorderPixels() const;
+            const BorderPixelList& getBorderPixels() const;
             const LabelToColorMap& getLabelToColorMap() const;
             const PolygonList& getShapes() const;
 
+            const ArenaResource::Statistics& getArenaStatistics() const;
+
             static bool calculateAdjacency(const BitMap*, const ProvinceID*,
                                            std::set<ProvinceID>&, const Point2D&);
             static bool calculateAdjacency(const Dimensions&,
@@ -83,7 +89,8 @@ namespace HMDT {
                                                          const Point2D&,
                                                          Direction);
         protected:
-            using LabelShapeIdxMap = std::unordered_map<UUID, uint32_t>;
+            using LabelShapeIdxMap = std::pmr::unordered_map<UUID, uint32_t>;
+            using LabelParentMap = std::pmr::unordered_map<UUID, UUID>;
 
             uint32_t pass1();
             PolygonList& pass2(LabelShapeIdxMap&);
@@ -107,6 +114,10 @@ namespace HMDT {
 
             void calculateAdjacencies(PolygonList&) const;
 
+            void resetTransientData();
+
+            std::pmr::memory_resource* getArena() const noexcept;
+
         private:
             //! The graphics worker
             IGraphicsWorker& m_worker;
@@ -117,15 +128,29 @@ namespace HMDT {
             //! The shared map data
             std::shared_ptr<MapData> m_map_data;
 
+            /**
+             * @brief The arena which all per-run data is allocated out of.
+             * @details This must be declared before every container which
+             *          uses it, so that it gets destroyed after them. It is
+             *          released and re-used at the start of every run.
+             */
+            std::unique_ptr<ArenaResource> m_arena;
+
             //! A mapping of each label -> that label's root (key == value => key is already the root)
-            std::unordered_map<UUID, UUID> m_label_parents;
+            LabelParentMap m_label_parents;
 
             //! A vector of every border pixel
-            std::vector<Pixel> m_border_pixels;
+            BorderPixelList m_border_pixels;
 
             //! The color of each label
             LabelToColorMap m_label_to_color;
 
+            //! Gives out the debug color of each label
+            UniqueColorAllocator m_label_color_allocator;
+
+            //! Gives out the unique color of each shape
+            UniqueColorAllocator m_shape_color_allocator;
+
             //! Whether or not the find algorithm should stop
             bool m_do_estop;
 
@@ -7,7 +7,6 @@
 #include "Util.h"
 #include "Constants.h"
 #include "ProvinceMapBuilder.h" // getProvinceType
-#include "UniqueColorGenerator.h" // generateUniqueColor
 #include "Options.h"
 #include "Monad.h"
 #include "MapData.h"
@@ -22,9 +21,12 @@ HMDT::ShapeFinder::ShapeFinder(const BitMap* image, IGraphicsWorker& worker,
     m_worker(worker),
     m_image(image),
     m_map_data(map_data),
-    m_label_parents(),
-    m_border_pixels(),
-    m_label_to_color(),
+    m_arena(std::make_unique<ArenaResource>()),
+    m_label_parents(m_arena.get()),
+    m_border_pixels(m_arena.get()),
+    m_label_to_color(m_arena.get()),
+    m_label_color_allocator(),
+    m_shape_color_allocator(),
     m_do_estop(false),
     m_stage(Stage::START),
     m_shapes()
@@ -35,35 +37,78 @@ HMDT::ShapeFinder::ShapeFinder(IGraphicsWorker& worker):
     m_worker(worker),
     m_image(nullptr),
     m_map_data(nullptr),
-    m_label_parents(),
-    m_border_pixels(),
-    m_label_to_color(),
+    m_arena(std::make_unique<ArenaResource>()),
+    m_label_parents(m_arena.get()),
+    m_border_pixels(m_arena.get()),
+    m_label_to_color(m_arena.get()),
+    m_label_color_allocator(),
+    m_shape_color_allocator(),
     m_do_estop(false),
     m_stage(Stage::START),
     m_shapes()
 { }
 
+/**
+ * @brief Moves another ShapeFinder into this one.
+ * @details The arena is moved along with all of the data allocated out of it,
+ *          which means that 'other' must not be re-used afterwards.
+ *
+ * @param other The ShapeFinder to move from
+ */
 HMDT::ShapeFinder::ShapeFinder(ShapeFinder&& other):
     m_worker(other.m_worker),
     m_image(std::move(other.m_image)),
     m_map_data(std::move(other.m_map_data)),
+    m_arena(std::move(other.m_arena)),
     m_label_parents(std::move(other.m_label_parents)),
     m_border_pixels(std::move(other.m_border_pixels)),
     m_label_to_color(std::move(other.m_label_to_color)),
+    m_label_color_allocator(std::move(other.m_label_color_allocator)),
+    m_shape_color_allocator(std::move(other.m_shape_color_allocator)),
     m_do_estop(std::move(other.m_do_estop)),
     m_stage(std::move(other.m_stage)),
     m_shapes(std::move(other.m_shapes))
 { }
 
+/**
+ * @brief Moves another ShapeFinder into this one.
+ * @details This ShapeFinder keeps its own arena, so all of the data held by
+ *          'other' gets moved element-by-element into it.
+ *
+ * @param other The ShapeFinder to move from
+ *
+ * @return This ShapeFinder
+ */
 auto HMDT::ShapeFinder::operator=(ShapeFinder&& other) -> ShapeFinder& {
+    resetTransientData();
+
     m_image = std::move(other.m_image);
     m_map_data = std::move(other.m_map_data);
+
+    // Note that the containers do not propagate their memory resource on
+    //   move-assignment, so these will be re-allocated out of our own arena
     m_label_parents = std::move(other.m_label_parents);
     m_border_pixels = std::move(other.m_border_pixels);
     m_label_to_color = std::move(other.m_label_to_color);
+    m_label_color_allocator = std::move(other.m_label_color_allocator);
+    m_shape_color_allocator = std::move(other.m_shape_color_allocator);
     m_do_estop = std::move(other.m_do_estop);
     m_stage = std::move(other.m_stage);
-    m_shapes = std::move(other.m_shapes);
+
+    // PolygonList itself is not arena-allocated, so make sure that each shape's
+    //   pixels get moved into our arena by hand
+    m_shapes.reserve(other.m_shapes.size());
+    for(Polygon& shape : other.m_shapes) {
+        m_shapes.push_back(Polygon{
+            shape.id,
+            std::pmr::vector<Pixel>(std::move(shape.pixels), getArena()),
+            shape.color,
+            shape.unique_color,
+            shape.bounding_box,
+            std::move(shape.adjacent_labels)
+        });
+    }
+    other.m_shapes.clear();
 
     return *this;
 }
@@ -169,7 +214,7 @@ uint32_t HMDT::ShapeFinder::pass1() {
             }
 
             if(m_label_to_color.count(label) == 0)
-                m_label_to_color[label] = (label == 0 ? BORDER_COLOR : generateUniqueColor(ProvinceType::UNKNOWN));
+                m_label_to_color[label] = (label == 0 ? BORDER_COLOR : m_label_color_allocator.allocate(ProvinceType::UNKNOWN));
 
             m_worker.writeDebugColor(x, y, m_label_to_color[label]);
         }
@@ -343,6 +388,10 @@ bool HMDT::ShapeFinder::mergeBorders(PolygonList& shapes,
  * @return A list of every shape in the image.
  */
 const HMDT::PolygonList& HMDT::ShapeFinder::findAllShapes() {
+    // Throw away anything left over from a previous run, so that we start over
+    //   from the beginning of the arena
+    resetTransientData();
+
     m_stage = Stage::PASS1;
 
     // Do pass 1, and reserve enough space in the m_border_pixels vector for all
@@ -369,10 +418,7 @@ const HMDT::PolygonList& HMDT::ShapeFinder::findAllShapes() {
         }
     }
 
-    LabelShapeIdxMap label_to_shapeidx;
-
-    // Make sure that any unique colors consumed will go back to the beginning
-    resetUniqueColorGenerator();
+    LabelShapeIdxMap label_to_shapeidx(getArena());
 
     m_stage = Stage::PASS2;
     // Do pass 1, we now have all of the shapes in the image, though there are
@@ -401,9 +447,6 @@ const HMDT::PolygonList& HMDT::ShapeFinder::findAllShapes() {
         return m_shapes;
     }
 
-    // Again, we want to end this function by not consuming any unique colors
-    resetUniqueColorGenerator();
-
     m_stage = Stage::MERGE_BORDERS;
     // Merge all of the border pixels together into surrounding shapes
     //  If this fails, then we return an empty-list of shapes to denote failure
@@ -421,6 +464,8 @@ const HMDT::PolygonList& HMDT::ShapeFinder::findAllShapes() {
     m_do_estop = false;
     m_stage = Stage::DONE;
 
+    WRITE_DEBUG("Shape finder arena usage: ", getArenaStatistics());
+
     return m_shapes;
 }
 
@@ -695,11 +740,11 @@ void HMDT::ShapeFinder::buildShape(const UUID& label, const Pixel& pixel,
 
         // Create a new shape
         auto prov_type = getProvinceType(pixel.color);
-        auto unique_color = generateUniqueColor(prov_type);
+        auto unique_color = m_shape_color_allocator.allocate(prov_type);
 
         shapes.push_back(Polygon{
             label,
-            { },
+            std::pmr::vector<Pixel>(getArena()),
             pixel.color,
             unique_color,
             { { 0, 0 }, { 0, 0 } }, /* bounding_box */
@@ -800,7 +845,7 @@ HMDT::ShapeFinder::Stage HMDT::ShapeFinder::getStage() const {
 }
 
 auto HMDT::ShapeFinder::getBorderPixels() 
-    -> std::vector<Pixel>&
+    -> BorderPixelList&
 {
     return m_border_pixels;
 }
@@ -820,7 +865,7 @@ const HMDT::BitMap* HMDT::ShapeFinder::getImage() const {
 }
 
 auto HMDT::ShapeFinder::getBorderPixels() const
-    -> const std::vector<Pixel>&
+    -> const BorderPixelList&
 {
     return m_border_pixels;
 }
@@ -835,6 +880,42 @@ auto HMDT::ShapeFinder::getShapes() const -> const PolygonList& {
     return m_shapes;
 }
 
+/**
+ * @brief Gets usage statistics about the arena that all data for a single run
+ *        of the shape finder is allocated out of.
+ *
+ * @return The arena's statistics
+ */
+auto HMDT::ShapeFinder::getArenaStatistics() const
+    -> const ArenaResource::Statistics&
+{
+    return m_arena->getStatistics();
+}
+
+/**
+ * @brief Clears out all data from the last run and releases the arena it was
+ *        allocated out of, so that the memory can be re-used.
+ */
+void HMDT::ShapeFinder::resetTransientData() {
+    // Every container must give up its storage _before_ the arena gets
+    //   released. Note that clear() is not enough for the hash maps, as their
+    //   bucket arrays would otherwise be left pointing into the arena.
+    m_shapes.clear();
+    m_label_parents = LabelParentMap(getArena());
+    m_border_pixels = BorderPixelList(getArena());
+    m_label_to_color = LabelToColorMap(getArena());
+
+    m_arena->release();
+
+    // Each run hands out its colors from the beginning again
+    m_label_color_allocator.reset();
+    m_shape_color_allocator.reset();
+}
+
+std::pmr::memory_resource* HMDT::ShapeFinder::getArena() const noexcept {
+    return m_arena.get();
+}
+
 void HMDT::ShapeFinder::calculateAdjacencies(PolygonList& shapes) const {
     auto prov_matrix = m_map_data->getProvinces().lock();
 
@@ -0,0 +1,441 @@
+/**
+ * @file ColorGenerator.cpp
+ *
+ * @brief Generates the unique color arrays declared in ColorArray.h, along with
+ *        a perfect-hash index from each color back to where it is in them.
+ *
+ * @details This is run at build time, and writes out a single C++ source file
+ *          which is then compiled into the unique_colors library. The colors
+ *          are generated in exactly the same order as the original Python
+ *          generator did, so that existing projects keep the same colors.
+ */
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+#include "UniqueColorHash.h"
+
+namespace {
+    //! The seed which the colors are shuffled with
+    constexpr std::uint32_t RANDOM_SEED = 1622487670;
+
+    //! Maximum possible legal value for hue
+    constexpr int MAX_HUE_VALUE = 360;
+
+    constexpr int MIN_SAT_VALUE = 50;
+    constexpr int MAX_SAT_VALUE = 80;
+
+    constexpr int MIN_VAL_VALUE = 50;
+    constexpr int MAX_VAL_VALUE = 100;
+
+    //! How many colors should go into each bucket of the index, on average
+    constexpr std::size_t INDEX_BUCKET_SIZE = 4;
+
+    //! The most seeds to try for a single bucket before giving up
+    constexpr std::uint32_t INDEX_MAX_SEED = 1 << 24;
+
+    /**
+     * @brief A single table of colors
+     */
+    struct ColorTable {
+        //! The name of the array the table is written to
+        const char* name;
+
+        //! The range of hues the table covers, as [first, last)
+        std::pair<int, int> hue_range;
+    };
+
+    // Note that the order of these must match UniqueColors::Table
+    constexpr std::array<ColorTable, 4> COLOR_TABLES = {
+        // Land colors (70 <= hue < 155)
+        ColorTable{ "HMDT_ALL_LANDS", { 70, 155 } },
+        // Sea colors (175 <= hue < 255)
+        ColorTable{ "HMDT_ALL_SEAS", { 175, 255 } },
+        // Lake colors (256 <= hue < 335)
+        ColorTable{ "HMDT_ALL_LAKES", { 256, 335 } },
+        // All unknown colors (0 <= hue < 69)
+        ColorTable{ "HMDT_ALL_UNKNOWNS", { 0, 69 } }
+    };
+
+    /**
+     * @brief A Mersenne Twister which produces the same values as Python's
+     *        random.Random does for the same integer seed.
+     * @details std::mt19937 cannot be used here, as it gets seeded differently.
+     */
+    class PythonRandom {
+        public:
+            explicit PythonRandom(std::uint32_t seed) {
+                // Python seeds with init_by_array(), using the 32-bit words of
+                //   the seed as the key
+                initGenRand(19650218u);
+
+                std::uint32_t i = 1;
+                for(std::size_t k = N; k > 0; --k) {
+                    m_state[i] = (m_state[i] ^ ((m_state[i - 1] ^ (m_state[i - 1] >> 30)) * 1664525u)) + seed;
+                    ++i;
+                    if(i >= N) { m_state[0] = m_state[N - 1]; i = 1; }
+                }
+                for(std::size_t k = N - 1; k > 0; --k) {
+                    m_state[i] = (m_state[i] ^ ((m_state[i - 1] ^ (m_state[i - 1] >> 30)) * 1566083941u)) - i;
+                    ++i;
+                    if(i >= N) { m_state[0] = m_state[N - 1]; i = 1; }
+                }
+
+                m_state[0] = 0x80000000u;
+            }
+
+            /**
+             * @brief Gets a random integer in [0, n), the same way Python's
+             *        random.Random._randbelow() does.
+             */
+            std::uint32_t randBelow(std::uint32_t n) {
+                int k = 0;
+                for(auto v = n; v != 0; v >>= 1) {
+                    ++k;
+                }
+
+                std::uint32_t r = getRandBits(k);
+                while(r >= n) {
+                    r = getRandBits(k);
+                }
+
+                return r;
+            }
+
+        private:
+            constexpr static std::size_t N = 624;
+            constexpr static std::size_t M = 397;
+
+            void initGenRand(std::uint32_t s) {
+                m_state[0] = s;
+                for(m_index = 1; m_index < N; ++m_index) {
+                    m_state[m_index] = 1812433253u * (m_state[m_index - 1] ^ (m_state[m_index - 1] >> 30)) + static_cast<std::uint32_t>(m_index);
+                }
+            }
+
+            std::uint32_t getRandBits(int k) {
+                return genRand() >> (32 - k);
+            }
+
+            std::uint32_t genRand() {
+                constexpr std::uint32_t UPPER_MASK = 0x80000000u;
+                constexpr std::uint32_t LOWER_MASK = 0x7FFFFFFFu;
+                constexpr std::uint32_t MATRIX_A = 0x9908B0DFu;
+
+                if(m_index >= N) {
+                    std::size_t kk = 0;
+                    for(; kk < N - M; ++kk) {
+                        auto y = (m_state[kk] & UPPER_MASK) | (m_state[kk + 1] & LOWER_MASK);
+                        m_state[kk] = m_state[kk + M] ^ (y >> 1) ^ ((y & 1) ? MATRIX_A : 0);
+                    }
+                    for(; kk < N - 1; ++kk) {
+                        auto y = (m_state[kk] & UPPER_MASK) | (m_state[kk + 1] & LOWER_MASK);
+                        m_state[kk] = m_state[kk + M - N] ^ (y >> 1) ^ ((y & 1) ? MATRIX_A : 0);
+                    }
+                    auto y = (m_state[N - 1] & UPPER_MASK) | (m_state[0] & LOWER_MASK);
+                    m_state[N - 1] = m_state[M - 1] ^ (y >> 1) ^ ((y & 1) ? MATRIX_A : 0);
+
+                    m_index = 0;
+                }
+
+                auto y = m_state[m_index++];
+                y ^= (y >> 11);
+                y ^= (y << 7) & 0x9D2C5680u;
+                y ^= (y << 15) & 0xEFC60000u;
+                y ^= (y >> 18);
+
+                return y;
+            }
+
+            std::array<std::uint32_t, N> m_state;
+            std::size_t m_index;
+    };
+
+    /**
+     * @brief Converts an HSV color to RGB, the same way Python's
+     *        colorsys.hsv_to_rgb() does.
+     * @details The build must not contract any of this into fused
+     *          multiply-adds, as the results would no longer match.
+     */
+    std::uint32_t hsvToRGB(double h, double s, double v) {
+        double r = v;
+        double g = v;
+        double b = v;
+
+        if(s != 0.0) {
+            int i = static_cast<int>(h * 6.0);
+            double f = (h * 6.0) - i;
+            double p = v * (1.0 - s);
+            double q = v * (1.0 - s * f);
+            double t = v * (1.0 - s * (1.0 - f));
+
+            switch(i % 6) {
+                case 0: r = v; g = t; b = p; break;
+                case 1: r = q; g = v; b = p; break;
+                case 2: r = p; g = v; b = t; break;
+                case 3: r = p; g = q; b = v; break;
+                case 4: r = t; g = p; b = v; break;
+                case 5: r = v; g = p; b = q; break;
+            }
+        }
+
+        auto to_byte = [](double c) {
+            return static_cast<std::uint32_t>(static_cast<int>(255 * c));
+        };
+
+        return (to_byte(r) << 16) | (to_byte(g) << 8) | to_byte(b);
+    }
+
+    /**
+     * @brief Generates every color for a single table.
+     *
+     * @param hue_range The range of hues the table covers
+     *
+     * @return Every color, packed as 0xRRGGBB
+     */
+    std::vector<std::uint32_t> generateColors(const std::pair<int, int>& hue_range)
+    {
+        std::vector<std::uint32_t> colors;
+        std::unordered_set<std::uint32_t> seen;
+
+        for(int hue = hue_range.first; hue < hue_range.second; ++hue) {
+            for(int sat = MIN_SAT_VALUE; sat < MAX_SAT_VALUE; ++sat) {
+                for(int val = MIN_VAL_VALUE; val < MAX_VAL_VALUE; ++val) {
+                    auto color = hsvToRGB(hue / static_cast<double>(MAX_HUE_VALUE),
+                                          sat / 100.0,
+                                          val / 100.0);
+
+                    // Remove duplicates, keeping the first of each
+                    if(seen.insert(color).second) {
+                        colors.push_back(color);
+                    }
+                }
+            }
+        }
+
+        // Shuffle the same way random.shuffle() does
+        PythonRandom random(RANDOM_SEED);
+        for(auto i = colors.size() - 1; i > 0; --i) {
+            auto j = random.randBelow(static_cast<std::uint32_t>(i + 1));
+            std::swap(colors[i], colors[j]);
+        }
+
+        return colors;
+    }
+
+    /**
+     * @brief A perfect hash from every color to where it is in the tables
+     */
+    struct ColorIndex {
+        //! The seed used for each bucket
+        std::vector<std::uint32_t> seeds;
+
+        //! The color and table of each slot
+        std::vector<std::uint32_t> entries;
+
+        //! Which color of its table each slot holds
+        std::vector<std::uint32_t> positions;
+    };
+
+    /**
+     * @brief Builds the index, using hash-and-displace.
+     * @details Colors are first split up into small buckets. Then, starting
+     *          with the largest bucket, a seed is searched for which hashes
+     *          every color in the bucket to a slot that is not yet taken.
+     *
+     * @param tables Every table of colors
+     * @param index The index to build
+     *
+     * @return True if the index was built, false otherwise.
+     */
+    bool buildIndex(const std::vector<std::vector<std::uint32_t>>& tables,
+                    ColorIndex& index)
+    {
+        using namespace HMDT::UniqueColors;
+
+        struct Key {
+            std::uint32_t color;
+            std::uint32_t table;
+            std::uint32_t position;
+        };
+
+        // If a color shows up in more than one table, then the first table
+        //   it is in is the one which gets indexed
+        std::vector<Key> keys;
+        std::unordered_set<std::uint32_t> seen;
+        for(std::uint32_t t = 0; t < tables.size(); ++t) {
+            for(std::uint32_t p = 0; p < tables[t].size(); ++p) {
+                if(seen.insert(tables[t][p]).second) {
+                    keys.push_back(Key{ tables[t][p], t, p });
+                }
+            }
+        }
+
+        const std::size_t bucket_count = keys.size() / INDEX_BUCKET_SIZE + 1;
+        const std::size_t slot_count = keys.size() + keys.size() / 8 + 1;
+
+        std::vector<std::vector<const Key*>> buckets(bucket_count);
+        for(auto&& key : keys) {
+            buckets[hashColor(key.color, 0) % bucket_count].push_back(&key);
+        }
+
+        std::vector<std::size_t> order(bucket_count);
+        for(std::size_t b = 0; b < bucket_count; ++b) {
+            order[b] = b;
+        }
+        std::stable_sort(order.begin(), order.end(),
+                         [&buckets](std::size_t a, std::size_t b) {
+                             return buckets[a].size() > buckets[b].size();
+                         });
+
+        index.seeds.assign(bucket_count, 1);
+        index.entries.assign(slot_count, EMPTY_INDEX_ENTRY);
+        index.positions.assign(slot_count, 0);
+
+        std::vector<std::size_t> slots;
+        for(auto b : order) {
+            const auto& bucket = buckets[b];
+            if(bucket.empty()) break;
+
+            std::uint32_t seed = 1;
+            for(; seed < INDEX_MAX_SEED; ++seed) {
+                slots.clear();
+
+                bool fits = true;
+                for(auto* key : bucket) {
+                    auto slot = hashColor(key->color, seed) % slot_count;
+
+                    if(index.entries[slot] != EMPTY_INDEX_ENTRY ||
+                       std::find(slots.begin(), slots.end(), slot) != slots.end())
+                    {
+                        fits = false;
+                        break;
+                    }
+
+                    slots.push_back(slot);
+                }
+
+                if(fits) break;
+            }
+
+            if(seed == INDEX_MAX_SEED) {
+                std::cerr << "Failed to find a seed for bucket " << b << std::endl;
+                return false;
+            }
+
+            index.seeds[b] = seed;
+            for(std::size_t i = 0; i < bucket.size(); ++i) {
+                index.entries[slots[i]] = bucket[i]->color |
+                    (bucket[i]->table << INDEX_ENTRY_TABLE_SHIFT);
+                index.positions[slots[i]] = bucket[i]->position;
+            }
+        }
+
+        return true;
+    }
+
+    /**
+     * @brief Writes an array of values as a C++ initializer list.
+     */
+    template<typename T>
+    void writeValues(std::ostream& out, const std::vector<T>& values,
+                     std::size_t per_line)
+    {
+        char buffer[16];
+
+        for(std::size_t i = 0; i < values.size(); ++i) {
+            if(i % per_line == 0) {
+                out << "\n   ";
+            }
+
+            std::snprintf(buffer, sizeof(buffer), " 0x%X,",
+                          static_cast<unsigned int>(values[i]));
+            out << buffer;
+        }
+
+        out << '\n';
+    }
+}
+
+int main(int argc, char** argv) {
+    if(argc != 2) {
+        std::cerr << "Usage: " << argv[0] << " OUTPUT_FILE" << std::endl;
+        return 1;
+    }
+
+    std::vector<std::vector<std::uint32_t>> tables;
+    for(auto&& table : COLOR_TABLES) {
+        std::cout << "Generating " << table.name << "..." << std::endl;
+
+        tables.push_back(generateColors(table.hue_range));
+
+        std::cout << "Generated " << tables.back().size() << " colors."
+                  << std::endl;
+    }
+
+    std::cout << "Building index..." << std::endl;
+    ColorIndex index;
+    if(!buildIndex(tables, index)) {
+        return 1;
+    }
+
+    std::ofstream out(argv[1]);
+    if(!out) {
+        std::cerr << "Failed to open " << argv[1] << std::endl;
+        return 1;
+    }
+
+    out << "// Generated by ColorGenerator. Do not edit.\n\n"
+           "#include \"ColorArray.h\"\n\n"
+           "extern \"C\" {\n";
+
+    for(std::size_t t = 0; t < tables.size(); ++t) {
+        std::vector<std::uint8_t> bytes;
+        bytes.reserve(tables[t].size() * 3);
+        for(auto color : tables[t]) {
+            bytes.push_back((color >> 16) & 0xFF);
+            bytes.push_back((color >> 8) & 0xFF);
+            bytes.push_back(color & 0xFF);
+        }
+
+        const char* name = COLOR_TABLES[t].name;
+
+        out << "const unsigned char " << name << "[] = {";
+        writeValues(out, bytes, 18);
+        out << "};\n"
+            << "const unsigned int " << name << "_SIZE = sizeof(" << name
+            << ");\n\n";
+    }
+
+    out << "const unsigned int HMDT_UNIQUE_COLOR_INDEX_SEEDS[] = {";
+    writeValues(out, index.seeds, 12);
+    out << "};\n"
+           "const unsigned int HMDT_UNIQUE_COLOR_INDEX_SEEDS_SIZE = "
+           "sizeof(HMDT_UNIQUE_COLOR_INDEX_SEEDS) / sizeof(unsigned int);\n\n";
+
+    out << "const unsigned int HMDT_UNIQUE_COLOR_INDEX_ENTRIES[] = {";
+    writeValues(out, index.entries, 8);
+    out << "};\n\n";
+
+    out << "const unsigned int HMDT_UNIQUE_COLOR_INDEX_POSITIONS[] = {";
+    writeValues(out, index.positions, 12);
+    out << "};\n"
+           "const unsigned int HMDT_UNIQUE_COLOR_INDEX_SIZE = "
+           "sizeof(HMDT_UNIQUE_COLOR_INDEX_ENTRIES) / sizeof(unsigned int);\n"
+           "}\n";
+
+    if(!out) {
+        std::cerr << "Failed to write " << argv[1] << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
+
@@ -2,6 +2,8 @@
  * @file ColorArray.h
  *
  * @brief Declares all external color arrays used by the shape finder algorithm.
+ *
+ * @details The arrays are generated at build time by ColorGenerator.
  */
 
 #ifndef COLOR_ARRAY_H
@@ -27,6 +29,18 @@ extern "C" {
     extern const unsigned char HMDT_ALL_UNKNOWNS[];
     //! The size of HMDT_ALL_UNKNOWNS.
     extern const unsigned int  HMDT_ALL_UNKNOWNS_SIZE;
+
+    //! The hash seed of each bucket in the unique color index.
+    extern const unsigned int  HMDT_UNIQUE_COLOR_INDEX_SEEDS[];
+    //! The number of values in HMDT_UNIQUE_COLOR_INDEX_SEEDS.
+    extern const unsigned int  HMDT_UNIQUE_COLOR_INDEX_SEEDS_SIZE;
+
+    //! The color and table in each slot of the unique color index.
+    extern const unsigned int  HMDT_UNIQUE_COLOR_INDEX_ENTRIES[];
+    //! Which color of its table each slot of the unique color index holds.
+    extern const unsigned int  HMDT_UNIQUE_COLOR_INDEX_POSITIONS[];
+    //! The number of slots in the unique color index.
+    extern const unsigned int  HMDT_UNIQUE_COLOR_INDEX_SIZE;
 }
 
 #endif
@@ -0,0 +1,44 @@
+/**
+ * @file UniqueColorHash.h
+ *
+ * @brief Defines the hash function used by the unique color index. This is
+ *        shared between the color generator, which builds the index, and the
+ *        library, which looks colors up in it.
+ */
+
+#ifndef UNIQUE_COLOR_HASH_H
+# define UNIQUE_COLOR_HASH_H
+
+# include <cstdint>
+
+namespace HMDT::UniqueColors {
+    //! Marks a slot in the index which has no color in it
+    constexpr std::uint32_t EMPTY_INDEX_ENTRY = 0xFFFFFFFF;
+
+    //! Masks an index entry down to just the color
+    constexpr std::uint32_t INDEX_ENTRY_COLOR_MASK = 0x00FFFFFF;
+
+    //! How far the table a color belongs to is shifted within an index entry
+    constexpr std::uint32_t INDEX_ENTRY_TABLE_SHIFT = 24;
+
+    /**
+     * @brief Hashes a 24-bit color.
+     *
+     * @param rgb The color, packed as 0xRRGGBB
+     * @param seed Which hash function to use
+     *
+     * @return The hash of the color
+     */
+    constexpr std::uint32_t hashColor(std::uint32_t rgb, std::uint32_t seed) {
+        std::uint32_t x = rgb ^ (seed * 0x9E3779B9u);
+        x ^= x >> 16;
+        x *= 0x7FEB352Du;
+        x ^= x >> 15;
+        x *= 0x846CA68Bu;
+        x ^= x >> 16;
+        return x;
+    }
+}
+
+#endif
+
@@ -0,0 +1,42 @@
+/**
+ * @file UniqueColorIndex.h
+ *
+ * @brief Declares a reverse index from every unique color to where it is in the
+ *        color arrays.
+ */
+
+#ifndef UNIQUE_COLOR_INDEX_H
+# define UNIQUE_COLOR_INDEX_H
+
+# include <cstdint>
+# include <optional>
+
+namespace HMDT::UniqueColors {
+    /**
+     * @brief Each of the color arrays declared in ColorArray.h
+     */
+    enum class Table: std::uint8_t {
+        LANDS = 0,
+        SEAS,
+        LAKES,
+        UNKNOWNS
+    };
+
+    /**
+     * @brief Where a color can be found in the color arrays
+     */
+    struct Location {
+        //! The array the color is in
+        Table table;
+
+        //! Which color of the array it is (not which byte)
+        std::uint32_t index;
+    };
+
+    std::optional<Location> findColor(std::uint32_t) noexcept;
+    std::optional<Location> findColor(std::uint8_t, std::uint8_t,
+                                      std::uint8_t) noexcept;
+}
+
+#endif
+
@@ -0,0 +1,55 @@
+
+#include "UniqueColorIndex.h"
+
+#include "ColorArray.h"
+#include "UniqueColorHash.h"
+
+/**
+ * @brief Finds where a color is in the color arrays.
+ * @details The index is a perfect hash built when the arrays are generated, so
+ *          this only ever has to look at a single slot.
+ *
+ * @param rgb The color to find, packed as 0xRRGGBB
+ *
+ * @return Where the color is, or std::nullopt if it is not a unique color.
+ */
+auto HMDT::UniqueColors::findColor(std::uint32_t rgb) noexcept
+    -> std::optional<Location>
+{
+    rgb &= INDEX_ENTRY_COLOR_MASK;
+
+    auto bucket = hashColor(rgb, 0) % HMDT_UNIQUE_COLOR_INDEX_SEEDS_SIZE;
+    auto slot = hashColor(rgb, HMDT_UNIQUE_COLOR_INDEX_SEEDS[bucket]) %
+                HMDT_UNIQUE_COLOR_INDEX_SIZE;
+
+    // Colors which are not in the index still hash to some slot, so make sure
+    //   that the slot actually holds this color
+    auto entry = HMDT_UNIQUE_COLOR_INDEX_ENTRIES[slot];
+    if(entry == EMPTY_INDEX_ENTRY || (entry & INDEX_ENTRY_COLOR_MASK) != rgb) {
+        return std::nullopt;
+    }
+
+    return Location{
+        static_cast<Table>(entry >> INDEX_ENTRY_TABLE_SHIFT),
+        HMDT_UNIQUE_COLOR_INDEX_POSITIONS[slot]
+    };
+}
+
+/**
+ * @brief Finds where a color is in the color arrays.
+ *
+ * @param r The red component of the color
+ * @param g The green component of the color
+ * @param b The blue component of the color
+ *
+ * @return Where the color is, or std::nullopt if it is not a unique color.
+ */
+auto HMDT::UniqueColors::findColor(std::uint8_t r, std::uint8_t g,
+                                   std::uint8_t b) noexcept
+    -> std::optional<Location>
+{
+    return findColor((static_cast<std::uint32_t>(r) << 16) |
+                     (static_cast<std::uint32_t>(g) << 8) |
+                     static_cast<std::uint32_t>(b));
+}
+
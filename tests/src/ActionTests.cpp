@@ -1,12 +1,21 @@
 
 #include "ActionTests.h"
 
+#include <fstream>
+
 #include "gtest/gtest.h"
 
 #include "IAction.h"
 #include "ActionManager.h"
 
 #include "SetPropertyAction.h"
+#include "BulkSetPropertyAction.h"
+#include "EditJournal.h"
+#include "HierarchyEdits.h"
+
+#include "HoI4Project.h"
+
+#include "TestUtils.h"
 
 namespace HMDT::UnitTests {
     void ActionTests::SetUp() { }
@@ -14,6 +23,12 @@ namespace HMDT::UnitTests {
     void ActionTests::TearDown() {
         // Make sure we clear the history at the end of each test
         Action::ActionManager::getInstance().clearHistory();
+
+        // Also restore any settings a test may have changed
+        Action::ActionManager::getInstance().setHistoryBudget(Action::ActionManager::DEFAULT_HISTORY_BUDGET);
+        Action::ActionManager::getInstance().setCoalesceWindow(Action::ActionManager::Clock::duration::zero());
+        Action::ActionManager::getInstance().setJournal(nullptr);
+        Action::ActionManager::getInstance().setOnEditsCallback([](const auto&...) { });
     }
 
     class TestAction: public Action::IAction {
@@ -179,5 +194,365 @@ namespace HMDT::UnitTests {
         ASSERT_EQ(s1.b, 'a');
         ASSERT_EQ(s1.c, 3.1415f);
     }
-}
 
+    TEST_F(ActionTests, HistoryBudgetTest) {
+        auto& manager = Action::ActionManager::getInstance();
+
+        const auto action_size = TestAction(5).getSize();
+
+        // Only enough room for 3 actions
+        manager.setHistoryBudget(action_size * 3);
+
+        for(int i = 0; i < 5; ++i) {
+            ASSERT_TRUE(manager.doAction(new TestAction(i)));
+        }
+
+        ASSERT_EQ(manager.getHistorySize(), 3);
+        ASSERT_EQ(manager.getHistoryBytes(), action_size * 3);
+
+        // The newest action always survives, even if it alone is over budget
+        manager.setHistoryBudget(0);
+        ASSERT_EQ(manager.getHistorySize(), 1);
+        ASSERT_EQ(manager.getHistoryBytes(), action_size);
+
+        manager.clearHistory();
+        ASSERT_EQ(manager.getHistoryBytes(), 0);
+    }
+
+    TEST_F(ActionTests, CoalesceSetPropertyTest) {
+        struct TestStructure {
+            int a;
+            std::string b;
+        };
+
+        TestStructure s1{ 5, "" };
+
+        auto& manager = Action::ActionManager::getInstance();
+        manager.setCoalesceWindow(std::chrono::hours(1));
+
+        // Simulate typing into a text box
+        for(auto&& text : { "H", "He", "Hel", "Hell", "Hello" }) {
+            ASSERT_TRUE(manager.doAction(NewSetPropertyAction(&s1, b, std::string(text))));
+        }
+        ASSERT_EQ(manager.getHistorySize(), 1);
+        ASSERT_EQ(s1.b, "Hello");
+
+        // Different fields must not be merged together
+        ASSERT_TRUE(manager.doAction(NewSetPropertyAction(&s1, a, 6)));
+        ASSERT_TRUE(manager.doAction(NewSetPropertyAction(&s1, a, 7)));
+        ASSERT_EQ(manager.getHistorySize(), 2);
+
+        ASSERT_TRUE(manager.undoAction());
+        ASSERT_EQ(s1.a, 5);
+        ASSERT_EQ(s1.b, "Hello");
+
+        ASSERT_TRUE(manager.undoAction());
+        ASSERT_EQ(s1.b, "");
+
+        // Redo, and make sure that we don't merge into a redone action
+        ASSERT_TRUE(manager.redoAction());
+        ASSERT_TRUE(manager.doAction(NewSetPropertyAction(&s1, b, std::string("Hello!"))));
+        ASSERT_EQ(manager.getHistorySize(), 2);
+
+        ASSERT_TRUE(manager.undoAction());
+        ASSERT_EQ(s1.b, "Hello");
+    }
+
+    TEST_F(ActionTests, GroupActionTest) {
+        struct TestStructure {
+            int a;
+        };
+
+        std::vector<TestStructure> structures(500, TestStructure{ 0 });
+
+        auto& manager = Action::ActionManager::getInstance();
+
+        manager.beginGroup();
+        for(auto& structure : structures) {
+            ASSERT_TRUE(manager.doAction(NewSetPropertyAction(&structure, a, 1)));
+        }
+
+        // Nothing gets recorded until the group is ended, and we can't undo
+        //   part-way through a group
+        ASSERT_EQ(manager.getHistorySize(), 0);
+        ASSERT_FALSE(manager.undoAction());
+
+        ASSERT_TRUE(manager.endGroup());
+        ASSERT_FALSE(manager.isGrouping());
+        ASSERT_EQ(manager.getHistorySize(), 1);
+        ASSERT_GT(manager.getHistoryBytes(), 0);
+
+        for(auto&& structure : structures) {
+            ASSERT_EQ(structure.a, 1);
+        }
+
+        ASSERT_TRUE(manager.undoAction());
+        for(auto&& structure : structures) {
+            ASSERT_EQ(structure.a, 0);
+        }
+
+        ASSERT_TRUE(manager.redoAction());
+        for(auto&& structure : structures) {
+            ASSERT_EQ(structure.a, 1);
+        }
+
+        // Empty groups should not create any history
+        manager.beginGroup();
+        ASSERT_FALSE(manager.endGroup());
+        ASSERT_EQ(manager.getHistorySize(), 1);
+    }
+
+    TEST_F(ActionTests, BulkSetPropertyActionTest) {
+        struct TestStructure {
+            int id;
+            std::string terrain;
+        };
+
+        std::vector<TestStructure> structures;
+        for(int i = 0; i < 100; ++i) {
+            structures.push_back(TestStructure{ i, (i % 10 == 0) ? "hills" : "plains" });
+        }
+
+        RefVector<TestStructure> selected(structures.begin(), structures.end());
+
+        uint32_t num_notifications = 0;
+        std::vector<int> notified_ids;
+        std::string notified_field;
+        auto on_changed = [&](const std::vector<int>& ids, std::string_view field) {
+            ++num_notifications;
+            notified_ids = ids;
+            notified_field = field;
+        };
+
+        auto& manager = Action::ActionManager::getInstance();
+
+        ASSERT_TRUE(manager.doAction(
+                    new Action::BulkSetPropertyAction<TestStructure, std::string>(
+                        selected, &TestStructure::terrain, std::string("hills"),
+                        "terrain", on_changed)));
+
+        // Only the structures which actually changed get reported, and only
+        //   a single history entry is made for all of them
+        ASSERT_EQ(num_notifications, 1);
+        ASSERT_EQ(notified_ids.size(), 90);
+        ASSERT_EQ(notified_field, "terrain");
+        ASSERT_EQ(manager.getHistorySize(), 1);
+
+        for(auto&& structure : structures) {
+            ASSERT_EQ(structure.terrain, "hills");
+        }
+
+        ASSERT_TRUE(manager.undoAction());
+        ASSERT_EQ(num_notifications, 2);
+
+        for(auto&& structure : structures) {
+            ASSERT_EQ(structure.terrain, (structure.id % 10 == 0) ? "hills" : "plains");
+        }
+
+        // If anything was modified behind our back, then nothing gets touched
+        structures[1].terrain = "forest";
+        ASSERT_FALSE(manager.redoAction());
+        ASSERT_EQ(structures[2].terrain, "plains");
+
+        // Setting a value that everything already has does not make history
+        manager.clearHistory();
+        ASSERT_TRUE(manager.doAction(NewBulkSetPropertyAction(selected, id, 0)));
+        ASSERT_EQ(manager.getHistorySize(), 1);
+
+        ASSERT_TRUE(manager.doAction(NewBulkSetPropertyAction(selected, id, 0)));
+        ASSERT_EQ(manager.getHistorySize(), 1);
+
+        // The callback can also be passed along through the macro
+        num_notifications = 0;
+        ASSERT_TRUE(manager.doAction(
+                    NewBulkSetPropertyActionWithCallback(selected, terrain,
+                                                         std::string("forest"),
+                                                         on_changed)));
+        ASSERT_EQ(num_notifications, 1);
+        ASSERT_EQ(notified_ids.size(), 99);
+        ASSERT_EQ(notified_field, "terrain");
+    }
+
+    TEST_F(ActionTests, EditJournalTest) {
+        using Type = Action::JournalDelta::Type;
+
+        auto path = getTestProgramPath() / "tmp" / "journal_test" / "edits.journal";
+        std::filesystem::remove_all(path.parent_path());
+
+        Province province{};
+        State state{};
+        state.id = 3;
+        state.name = "Old";
+
+        auto& manager = Action::ActionManager::getInstance();
+
+        {
+            auto journal = Action::EditJournal::open(path);
+            ASSERT_SUCCEEDED(journal);
+            manager.setJournal(*journal);
+        }
+
+        // Every do, undo, and redo is recorded with the value it leaves behind
+        ASSERT_TRUE(manager.doAction(NewSetPropertyAction(&province, coastal, true)));
+        ASSERT_TRUE(manager.doAction(NewSetPropertyAction(&state, name, std::string("New"))));
+        ASSERT_TRUE(manager.undoAction());
+        ASSERT_TRUE(manager.redoAction());
+
+        // As are edits made outside of any action
+        manager.recordEdits({ Action::JournalDelta::removeState(state.id) });
+
+        ASSERT_EQ(manager.getJournal()->getSequence(), 5);
+
+        // Nothing is written until the journal is flushed
+        ASSERT_EQ(Action::EditJournal::read(path)->size(), 0);
+        ASSERT_SUCCEEDED(manager.getJournal()->flush());
+
+        auto deltas = Action::EditJournal::read(path);
+        ASSERT_SUCCEEDED(deltas);
+        ASSERT_EQ(deltas->size(), 5);
+
+        ASSERT_EQ((*deltas)[0].type, Type::SET_PROVINCE_PROPERTY);
+        ASSERT_EQ((*deltas)[1].type, Type::SET_STATE_PROPERTY);
+        ASSERT_EQ((*deltas)[4].type, Type::REMOVE_STATE);
+
+        // Replaying the deltas onto the original values gives back the
+        //   values from after the edits
+        Province replayed_province = province;
+        replayed_province.coastal = false;
+        ASSERT_TRUE(Action::applySetPropertyDelta((*deltas)[0], replayed_province));
+        ASSERT_TRUE(replayed_province.coastal);
+
+        State replayed_state = state;
+        ASSERT_TRUE(Action::applySetPropertyDelta((*deltas)[2], replayed_state));
+        ASSERT_EQ(replayed_state.name, "Old");
+        ASSERT_TRUE(Action::applySetPropertyDelta((*deltas)[3], replayed_state));
+        ASSERT_EQ(replayed_state.name, "New");
+
+        // A record which was only partially written is ignored, and cut off
+        //   when the journal is next opened
+        manager.setJournal(nullptr);
+        {
+            std::ofstream out(path, std::ios::binary | std::ios::app);
+            out << "\x20\x00\x00\x00partial";
+        }
+        ASSERT_EQ(Action::EditJournal::read(path)->size(), 5);
+
+        auto journal = Action::EditJournal::open(path);
+        ASSERT_SUCCEEDED(journal);
+        ASSERT_EQ((*journal)->getSequence(), 5);
+
+        // Setting the same field over and over only keeps the last value, so
+        //   the state's name is only set once and its manpower only once
+        for(int i = 0; i < 10; ++i) {
+            state.manpower = i;
+            (*journal)->append({ *Action::makeSetPropertyDelta(state,
+                                                               &State::manpower,
+                                                               state.manpower) });
+        }
+        ASSERT_SUCCEEDED((*journal)->compact());
+
+        deltas = Action::EditJournal::read(path);
+        ASSERT_SUCCEEDED(deltas);
+        ASSERT_EQ(deltas->size(), 4);
+
+        State compacted_state = state;
+        compacted_state.manpower = 0;
+        ASSERT_TRUE(Action::applySetPropertyDelta(deltas->back(), compacted_state));
+        ASSERT_EQ(compacted_state.manpower, 9);
+
+        // Once saved, every edit up to the save is dropped
+        ASSERT_SUCCEEDED((*journal)->discardThrough(5));
+        ASSERT_EQ(Action::EditJournal::read(path)->size(), 1);
+
+        ASSERT_SUCCEEDED((*journal)->discardThrough((*journal)->getSequence()));
+        ASSERT_EQ(Action::EditJournal::read(path)->size(), 0);
+
+        // A crash writes out whatever is still buffered, without compacting
+        for(std::size_t i = 0; i < 3; ++i) {
+            (*journal)->append({ *Action::makeSetPropertyDelta(state,
+                                                               &State::manpower,
+                                                               i) });
+        }
+        ASSERT_EQ(Action::EditJournal::read(path)->size(), 0);
+        ASSERT_TRUE((*journal)->flushForCrash());
+        ASSERT_EQ(Action::EditJournal::read(path)->size(), 3);
+
+        // Closing the project on purpose leaves nothing behind to recover
+        (*journal)->append({ Action::JournalDelta::removeState(state.id) });
+        ASSERT_SUCCEEDED((*journal)->clear());
+        ASSERT_EQ(Action::EditJournal::read(path)->size(), 0);
+
+        ASSERT_SUCCEEDED((*journal)->flush());
+        ASSERT_EQ(Action::EditJournal::read(path)->size(), 0);
+    }
+
+    TEST_F(ActionTests, HierarchyIndexEditsTest) {
+        auto& manager = Action::ActionManager::getInstance();
+
+        Project::HoI4Project project;
+        auto& provinces = project.getMapProject().getProvinceProject().getProvinces();
+
+        std::vector<ProvinceID> ids;
+        for(std::size_t i = 0; i < 4; ++i) {
+            Province province{};
+            province.terrain = "plains";
+
+            ids.push_back(province.id);
+            provinces.emplace(province.id, province);
+        }
+        project.getMapProject().getProvinceProject().rebuildProvinceTable();
+
+        ASSERT_EQ(project.getHierarchyIndex().findByValue("Terrain", "plains").size(), 4);
+
+        // Keep the index up to date the same way that the GUI does
+        uint32_t num_incomplete = 0;
+        manager.setOnEditsCallback([&project, &num_incomplete](const auto& deltas,
+                                                               bool is_complete)
+        {
+            if(!is_complete) {
+                ++num_incomplete;
+                project.invalidateHierarchyIndex();
+                return;
+            }
+
+            if(auto paths = Action::getChangedPropertyPaths(deltas, project); paths) {
+                project.updateHierarchyIndex(*paths);
+            } else {
+                project.invalidateHierarchyIndex();
+            }
+        });
+
+        auto* province = &provinces.at(ids[1]);
+        ASSERT_TRUE(manager.doAction(NewSetPropertyAction(province, terrain,
+                                                          TerrainID("hills"))));
+
+        const auto& index = project.getHierarchyIndex();
+        ASSERT_EQ(index.findByValue("Terrain", "plains").size(), 3);
+        ASSERT_EQ(index.findByValue("Terrain", "hills").size(), 1);
+
+        ASSERT_TRUE(manager.undoAction());
+        ASSERT_EQ(index.findByValue("Terrain", "plains").size(), 4);
+        ASSERT_EQ(index.findByValue("Terrain", "hills").size(), 0);
+
+        ASSERT_TRUE(manager.redoAction());
+        ASSERT_EQ(index.findByValue("Terrain", "hills").size(), 1);
+
+        // Paths point at the property nodes themselves
+        auto paths = Action::getChangedPropertyPaths(
+            { *Action::makeSetPropertyDelta(*province, &Province::coastal, true) },
+            project);
+        ASSERT_TRUE(paths.has_value());
+        ASSERT_EQ(paths->size(), 1);
+        ASSERT_SUCCEEDED(index.lookup(paths->front()));
+
+        // Edits which change the shape of the hierarchy cannot be applied to
+        //   the index
+        ASSERT_FALSE(Action::getChangedPropertyPaths(
+            { Action::JournalDelta::createContinent("Europe") }, project).has_value());
+
+        // Neither can actions which do not describe what they changed
+        ASSERT_TRUE(manager.doAction(new TestAction(0)));
+        ASSERT_EQ(num_incomplete, 1);
+        ASSERT_EQ(project.getHierarchyIndex().findByValue("Terrain", "hills").size(), 1);
+    }
+}
@@ -3,11 +3,14 @@
 
 #include <filesystem>
 #include <algorithm>
+#include <random>
+#include <cmath>
 
 #include "BitMap.h"
 #include "Constants.h"
 #include "StatusCodes.h"
 #include "Logger.h"
+#include "WorldNormalBuilder.h"
 
 #include "TestUtils.h"
 
@@ -890,3 +893,148 @@ TEST(BitMapTests, Test8BPPCustomColorTable) {
     HMDT::Log::Logger::getInstance().reset();
 }
 
+
+TEST(BitMapTests, GenerateWorldNormalMapTest) {
+    constexpr int32_t width = 173;
+    constexpr int32_t height = 91;
+
+    HMDT::BitMap2 heightmap;
+    heightmap.info_header.v1.width = width;
+    heightmap.info_header.v1.height = height;
+    heightmap.info_header.v1.bitsPerPixel = 8;
+    heightmap.info_header.v1.colorsUsed = 256;
+    ASSERT_SUCCEEDED(HMDT::createColorTable(heightmap, true));
+
+    std::mt19937 generator(1234);
+    std::uniform_int_distribution<int> distribution(0, 255);
+
+    heightmap.data.reset(new unsigned char[width * height]);
+    std::generate(heightmap.data.get(), heightmap.data.get() + width * height,
+                  [&]() { return distribution(generator); });
+
+    std::unique_ptr<unsigned char[]> normal_data(new unsigned char[width * height * 3]);
+    ASSERT_SUCCEEDED(HMDT::generateWorldNormalMap(heightmap, normal_data.get()));
+
+    // Reference implementation: a straightforward double-precision sobel
+    //   filter, with edges clamped to the nearest pixel
+    auto intensity = [&](int32_t x, int32_t y) {
+        x = std::clamp(x, 0, width - 1);
+        y = std::clamp(y, 0, height - 1);
+        auto c = heightmap.color_table[heightmap.data[x + y * width]];
+        return ((c.red + c.green + c.blue) / 3.0) / 255.0;
+    };
+
+    for(int32_t y = 0; y < height; ++y) {
+        for(int32_t x = 0; x < width; ++x) {
+            double dX = (intensity(x + 1, y - 1) + 2.0 * intensity(x + 1, y) + intensity(x + 1, y + 1)) -
+                        (intensity(x - 1, y - 1) + 2.0 * intensity(x - 1, y) + intensity(x - 1, y + 1));
+            double dY = (intensity(x - 1, y + 1) + 2.0 * intensity(x, y + 1) + intensity(x + 1, y + 1)) -
+                        (intensity(x - 1, y - 1) + 2.0 * intensity(x, y - 1) + intensity(x + 1, y - 1));
+            double dZ = 0.5;
+            double l = std::sqrt(dX * dX + dY * dY + dZ * dZ);
+
+            int expected[3] = {
+                static_cast<uint8_t>((dX / l + 1.0) * (255.0 / 2.0)),
+                static_cast<uint8_t>((dY / l + 1.0) * (255.0 / 2.0)),
+                static_cast<uint8_t>((dZ / l + 1.0) * (255.0 / 2.0))
+            };
+
+            auto index = (x + y * width) * 3;
+            for(int i = 0; i < 3; ++i) {
+                ASSERT_LE(std::abs(normal_data[index + i] - expected[i]), 1)
+                    << "at (" << x << ',' << y << ")[" << i << ']';
+            }
+        }
+    }
+
+    // Non 8-bit images must be rejected
+    heightmap.info_header.v1.bitsPerPixel = 24;
+    ASSERT_STATUS(HMDT::generateWorldNormalMap(heightmap, normal_data.get()),
+                  HMDT::STATUS_INVALID_BIT_DEPTH);
+}
+
+TEST(BitMapTests, WriteStreamedBMP) {
+    // We also want to see log outputs in the test output
+    HMDT::UnitTests::registerTestLogOutputFunction(true, true, true, true);
+
+    auto write_base_path = HMDT::UnitTests::getTestProgramPath() / "tmp";
+
+    if(!std::filesystem::exists(write_base_path)) {
+        TEST_COUT << "Directory " << write_base_path
+                  << " does not exist, creating." << std::endl;
+        ASSERT_TRUE(std::filesystem::create_directory(write_base_path));
+    }
+
+    // An odd height makes sure the middle row is written too
+    constexpr uint32_t WIDTH = 5;
+    constexpr uint32_t HEIGHT = 3;
+
+    // Every pixel of a filled image must be the fill color
+    auto fill_path = write_base_path / "streamed_fill.bmp";
+    auto res = HMDT::writeBMPFill(fill_path, WIDTH, HEIGHT, { 0x08, 0x1F, 0x82 });
+    ASSERT_SUCCEEDED(res);
+
+    HMDT::BitMap2 fill_bmp;
+    auto read_res = HMDT::readBMP(fill_path, fill_bmp);
+    ASSERT_SUCCEEDED(read_res);
+
+    ASSERT_EQ(fill_bmp.info_header.v1.width, WIDTH);
+    ASSERT_EQ(fill_bmp.info_header.v1.height, HEIGHT);
+    ASSERT_EQ(fill_bmp.info_header.v1.bitsPerPixel, 24);
+
+    for(uint32_t i = 0; i < WIDTH * HEIGHT * 3; i += 3) {
+        ASSERT_EQ(fill_bmp.data[i], 0x08) << "at pixel " << (i / 3);
+        ASSERT_EQ(fill_bmp.data[i + 1], 0x1F) << "at pixel " << (i / 3);
+        ASSERT_EQ(fill_bmp.data[i + 2], 0x82) << "at pixel " << (i / 3);
+    }
+
+    // Each row must end up where the generator was asked to put it
+    auto rows_path = write_base_path / "streamed_rows.bmp";
+    res = HMDT::writeBMPRows(rows_path, WIDTH, HEIGHT, 1,
+                             [](uint32_t y, unsigned char* row) -> HMDT::MaybeVoid {
+                                 for(uint32_t x = 0; x < WIDTH; ++x) {
+                                     row[x] = static_cast<unsigned char>(y * WIDTH + x);
+                                 }
+                                 return HMDT::STATUS_SUCCESS;
+                             },
+                             true);
+    ASSERT_SUCCEEDED(res);
+
+    HMDT::BitMap2 rows_bmp;
+    read_res = HMDT::readBMP(rows_path, rows_bmp);
+    ASSERT_SUCCEEDED(read_res);
+
+    ASSERT_EQ(rows_bmp.info_header.v1.width, WIDTH);
+    ASSERT_EQ(rows_bmp.info_header.v1.height, HEIGHT);
+    ASSERT_EQ(rows_bmp.info_header.v1.bitsPerPixel, 8);
+
+    for(uint32_t i = 0; i < WIDTH * HEIGHT; ++i) {
+        ASSERT_EQ(rows_bmp.data[i], i);
+    }
+
+    // Writing the image back out must give the same image again
+    auto rewrite_path = write_base_path / "streamed_rows_rewrite.bmp";
+    res = HMDT::writeBMP(rewrite_path, rows_bmp);
+    ASSERT_SUCCEEDED(res);
+
+    HMDT::BitMap2 rewrite_bmp;
+    read_res = HMDT::readBMP(rewrite_path, rewrite_bmp);
+    ASSERT_SUCCEEDED(read_res);
+
+    ASSERT_EQ(rewrite_bmp.info_header.v1.height, HEIGHT);
+    for(uint32_t i = 0; i < WIDTH * HEIGHT; ++i) {
+        ASSERT_EQ(rewrite_bmp.data[i], rows_bmp.data[i]);
+    }
+
+    // A generator which fails must stop the write
+    auto failed_path = write_base_path / "streamed_failed.bmp";
+    res = HMDT::writeBMPRows(failed_path, WIDTH, HEIGHT, 3,
+                             [](uint32_t, unsigned char*) -> HMDT::MaybeVoid {
+                                 RETURN_ERROR(HMDT::STATUS_UNEXPECTED);
+                             });
+    ASSERT_STATUS(res, HMDT::STATUS_UNEXPECTED);
+
+    // Fill colors must be a whole pixel
+    res = HMDT::writeBMPFill(fill_path, WIDTH, HEIGHT, { });
+    ASSERT_STATUS(res, HMDT::STATUS_INVALID_BITS_PER_PIXEL);
+}
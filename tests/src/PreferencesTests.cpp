@@ -279,5 +279,60 @@ PREF_END_DEF();
         auto result = Preferences::getInstance().getPreferenceValue<int64_t>("SimpleSection.SimpleGroup.val2");
         ASSERT_OPTIONAL(result, 5L);
     }
+
+    TEST_F(PreferencesTests, PreferenceHandleTest) {
+        auto& prefs = Preferences::getInstance(false);
+
+        prefs.setDefaultValues(simple_conf_defaults);
+        prefs.resetToDefaults();
+
+        auto handle = prefs.getHandle<int64_t>("SimpleSection.SimpleGroup.val2");
+        ASSERT_EQ(handle.getValuePath(), "SimpleSection.SimpleGroup.val2");
+        ASSERT_OPTIONAL(handle.get(), 5L);
+
+        // Reading does not change anything
+        auto version = prefs.getVersion();
+        ASSERT_OPTIONAL(handle.get(), 5L);
+        ASSERT_EQ(prefs.getVersion(), version);
+
+        // Changes are picked up on the next read
+        ASSERT_TRUE(prefs.setPreferenceValue("SimpleSection.SimpleGroup.val2", 35L));
+        ASSERT_NE(prefs.getVersion(), version);
+        ASSERT_OPTIONAL(handle.get(), 35L);
+
+        // Handles to values which do not exist, or have the wrong type, are
+        //   empty
+        ASSERT_NULLOPT(prefs.getHandle<int64_t>("SimpleSection.SimpleGroup.missing").get());
+        ASSERT_NULLOPT(prefs.getHandle<bool>("SimpleSection.SimpleGroup.val2").get());
+
+        // Subscribers get told the new value after every change
+        std::vector<int64_t> changes;
+        auto id = prefs.subscribe("SimpleSection.SimpleGroup.val2",
+                                  [&changes](const Preferences::ValueVariant& value) {
+                                      changes.push_back(std::get<int64_t>(value));
+                                  });
+        ASSERT_SUCCEEDED(id);
+
+        ASSERT_STATUS(prefs.subscribe("SimpleSection.SimpleGroup.missing",
+                                      [](const Preferences::ValueVariant&) { }),
+                      STATUS_VALUE_NOT_FOUND);
+
+        ASSERT_TRUE(prefs.setPreferenceValue("SimpleSection.SimpleGroup.val2", 7L));
+        prefs.resetToDefaults();
+        ASSERT_OPTIONAL(handle.get(), 5L);
+
+        ASSERT_EQ(changes, (std::vector<int64_t>{ 7, 5 }));
+
+        // Changes to other values do not notify
+        ASSERT_TRUE(prefs.setPreferenceValue("SimpleSection.SimpleGroup.val1", true));
+        ASSERT_EQ(changes.size(), 2);
+
+        ASSERT_TRUE(prefs.unsubscribe(*id));
+        ASSERT_FALSE(prefs.unsubscribe(*id));
+
+        ASSERT_TRUE(prefs.setPreferenceValue("SimpleSection.SimpleGroup.val2", 9L));
+        ASSERT_EQ(changes.size(), 2);
+        ASSERT_OPTIONAL(handle.get(), 9L);
+    }
 }
 
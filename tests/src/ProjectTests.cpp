@@ -3,9 +3,14 @@
 #include "gmock/gmock.h"
 
 #include <filesystem>
+#include <atomic>
+#include <chrono>
 #include <cstring>
+#include <deque>
 #include <fstream>
+#include <mutex>
 #include <stack>
+#include <thread>
 #include <vector>
 
 #include "HoI4Project.h"
@@ -16,6 +21,18 @@
 #include "Util.h"
 #include "ProjectNode.h"
 #include "LinkNode.h"
+#include "ProvinceNode.h"
+#include "IndexedGroupNode.h"
+#include "NodeKeyNames.h"
+#include "PropertyNode.h"
+#include "Query.h"
+#include "HierarchyIndex.h"
+#include "ProvincePreviewCache.h"
+#include "ProvinceSpanIndex.h"
+#include "StateProject.h"
+#include "ProvinceStateValidator.h"
+#include "ProjectSnapshot.h"
+#include "LoadScheduler.h"
 
 #include "TestUtils.h"
 #include "TestMocks.h"
@@ -367,6 +384,103 @@ TEST(ProjectTests, RiversProjectExportTemplateTest) {
     HMDT::Log::Logger::getInstance().reset();
 }
 
+TEST(ProjectTests, RiversProjectFillTemplateTest) {
+    using HMDT::Project::RiversProject;
+
+    HMDT::Province land{ }, sea{ }, lake{ };
+    land.type = HMDT::ProvinceType::LAND;
+    sea.type = HMDT::ProvinceType::SEA;
+    lake.type = HMDT::ProvinceType::LAKE;
+
+    HMDT::ProvinceList provinces;
+    for(auto* prov : { &land, &sea, &lake }) {
+        provinces[prov->id] = *prov;
+    }
+
+    HMDT::Project::ProvinceTable table(provinces);
+
+    // Index 0 is for pixels without a province, and everything else is
+    //   shifted up by one
+    auto palette_table = RiversProject::generatePaletteTable(table);
+    ASSERT_EQ(palette_table.size(), 4);
+    ASSERT_EQ(palette_table[0], 14);
+    ASSERT_EQ(palette_table[*table.getIndex(land.id) + 1], 12);
+    ASSERT_EQ(palette_table[*table.getIndex(sea.id) + 1], 13);
+    ASSERT_EQ(palette_table[*table.getIndex(lake.id) + 1], 13);
+
+    // Use enough pixels that the template gets split up across threads
+    constexpr std::uint64_t size = 1 << 20;
+
+    std::vector<uint32_t> index_matrix(size);
+    for(std::uint64_t i = 0; i < size; ++i) {
+        index_matrix[i] = i % palette_table.size();
+    }
+
+    std::vector<uint8_t> data(size);
+    auto num_invalid = RiversProject::fillTemplate(data.data(),
+                                                   index_matrix.data(),
+                                                   palette_table, size);
+
+    // Pixels without a province are still filled in, and are all counted
+    ASSERT_EQ(num_invalid, size / palette_table.size());
+    for(std::uint64_t i = 0; i < size; ++i) {
+        ASSERT_EQ(data[i], palette_table[index_matrix[i]]);
+    }
+}
+
+TEST(ProjectTests, ProvinceIndexMatrixWithoutSpansTest) {
+    HMDT::Project::Project hproject;
+
+    auto& prov_project = hproject.getMapProject().getProvinceProject();
+
+    constexpr uint32_t width = 4;
+    constexpr uint32_t height = 2;
+
+    // Note that we have to set up the MapData's width+height ourselves, since
+    //   nothing is being loaded
+    {
+        auto map_data_ptr = hproject.getMapProject().getMapData();
+
+        map_data_ptr->~MapData();
+        new (map_data_ptr.get()) HMDT::MapData(width, height);
+    }
+
+    HMDT::Province land{ }, sea{ };
+    land.type = HMDT::ProvinceType::LAND;
+    sea.type = HMDT::ProvinceType::SEA;
+
+    prov_project.getProvinces()[land.id] = land;
+    prov_project.getProvinces()[sea.id] = sea;
+    prov_project.rebuildProvinceTable();
+
+    HMDT::ProvinceID unknown;
+    {
+        auto provinces = hproject.getMapProject().getMapData()->getProvinces().lock();
+        const HMDT::ProvinceID layout[width * height] = {
+            land.id, land.id, sea.id, sea.id,
+            land.id, unknown, unknown, sea.id
+        };
+        std::copy(layout, layout + width * height, provinces.get());
+    }
+
+    // No shapes were ever found, so there are no spans to build the matrix
+    //   from, and it must come from the provinces themselves
+    auto table = prov_project.getProvinceTable();
+    auto index_matrix = prov_project.buildProvinceIndexMatrix(*table);
+    ASSERT_NE(index_matrix, nullptr);
+
+    auto land_value = *table->getIndex(land.id) + 1;
+    auto sea_value = *table->getIndex(sea.id) + 1;
+
+    const uint32_t expected[width * height] = {
+        land_value, land_value, sea_value, sea_value,
+        land_value, 0, 0, sea_value
+    };
+    for(uint32_t i = 0; i < width * height; ++i) {
+        ASSERT_EQ(index_matrix[i], expected[i]) << "At index " << i;
+    }
+}
+
 TEST(ProjectTests, ConvertV1ProvinceIDsToUUIDTest) {
     SET_PROGRAM_OPTION(debug, true);
 
@@ -954,3 +1068,953 @@ TEST(ProjectTests, SimpleHierarchyIterationTest) {
     ASSERT_EQ(c, num_nodes);
 }
 
+TEST(ProjectTests, LazyProvinceHierarchyTest) {
+    HMDT::Project::Project hproject;
+
+    auto& prov_project = dynamic_cast<HMDT::Project::ProvinceProject&>(hproject.getMapProject().getProvinceProject());
+
+    constexpr uint32_t NUM_PROVINCES = 1000;
+
+    std::vector<HMDT::ProvinceID> ids;
+    for(uint32_t i = 0; i < NUM_PROVINCES; ++i) {
+        HMDT::Province province{};
+        province.type = HMDT::ProvinceType::LAND;
+        province.terrain = "plains";
+
+        ids.push_back(province.id);
+        prov_project.getProvinces().emplace(province.id, province);
+    }
+    prov_project.rebuildProvinceTable();
+
+    uint32_t num_visited = 0;
+    auto maybe_group = prov_project.visitProvinces([&num_visited](auto&&...) -> HMDT::MaybeVoid {
+        ++num_visited;
+        return HMDT::STATUS_SUCCESS;
+    });
+    ASSERT_SUCCEEDED(maybe_group);
+
+    auto group = std::dynamic_pointer_cast<HMDT::Project::Hierarchy::IndexedGroupNode>(*maybe_group);
+    ASSERT_NE(group, nullptr);
+
+    // Nothing should be built until it is asked for
+    ASSERT_EQ(group->getChildCount(), NUM_PROVINCES);
+    ASSERT_EQ(group->getBuiltChildCount(), 0);
+    ASSERT_EQ(num_visited, 1);
+
+    // Looking up a single province should only build that one province, and
+    //   should not call back into a visitor which may no longer exist
+    auto maybe_node = group->getChild(std::to_string(ids[42]));
+    ASSERT_SUCCEEDED(maybe_node);
+    ASSERT_EQ((*maybe_node)->getType(), HMDT::Project::Hierarchy::Node::Type::PROVINCE);
+    ASSERT_EQ(group->getBuiltChildCount(), 1);
+    ASSERT_EQ(num_visited, 1);
+
+    // The same node should be handed back out on the next lookup
+    auto maybe_node2 = group->getChild(std::to_string(ids[42]));
+    ASSERT_SUCCEEDED(maybe_node2);
+    ASSERT_EQ(maybe_node->get(), maybe_node2->get());
+
+    ASSERT_STATUS(group->lookupChild("not a uuid"), HMDT::STATUS_VALUE_NOT_FOUND);
+    ASSERT_STATUS(group->lookupChild(std::to_string(HMDT::UUID())), HMDT::STATUS_VALUE_NOT_FOUND);
+
+    // Properties are bound directly to the province
+    auto province_node = std::dynamic_pointer_cast<HMDT::Project::Hierarchy::ProvinceNode>(*maybe_node);
+    ASSERT_NE(province_node, nullptr);
+
+    auto maybe_terrain = (*province_node)[HMDT::Project::Hierarchy::ProvinceKeys::TERRAIN];
+    ASSERT_SUCCEEDED(maybe_terrain);
+    auto terrain_node = std::dynamic_pointer_cast<HMDT::Project::Hierarchy::IPropertyNode>(*maybe_terrain);
+    ASSERT_NE(terrain_node, nullptr);
+    ASSERT_EQ(*terrain_node, HMDT::TerrainID("plains"));
+
+    ASSERT_SUCCEEDED(terrain_node->setValue(HMDT::TerrainID("hills")));
+    ASSERT_EQ(prov_project.getProvinceForID(ids[42]).terrain, "hills");
+
+    // Starting to iterate should only build the nodes that are stepped into
+    {
+        auto it = group->begin();
+        ASSERT_EQ((*it).get(), group.get());
+        ASSERT_EQ(group->getBuiltChildCount(), 1);
+
+        ++it;
+        ASSERT_EQ(it->getType(), HMDT::Project::Hierarchy::Node::Type::PROVINCE);
+        ASSERT_LE(group->getBuiltChildCount(), 2);
+    }
+
+    // Iterating should visit every node exactly once, in pre-order
+    uint32_t num_nodes = 0;
+    uint32_t num_province_nodes = 0;
+    for(auto it = group->begin(); it != group->end(); ++it) {
+        if(num_nodes == 0) {
+            ASSERT_EQ((*it).get(), group.get());
+        }
+
+        if(it->getType() == HMDT::Project::Hierarchy::Node::Type::PROVINCE) {
+            ++num_province_nodes;
+        }
+        ++num_nodes;
+    }
+
+    ASSERT_EQ(num_province_nodes, NUM_PROVINCES);
+    ASSERT_EQ(group->getBuiltChildCount(), NUM_PROVINCES);
+
+    // One group, and each province has 6 properties
+    ASSERT_EQ(num_nodes, 1 + NUM_PROVINCES * (1 + 6));
+    ASSERT_EQ(num_visited, 1);
+
+    // Nodes which outlive their provinces should fail rather than refer to
+    //   provinces which no longer exist
+    auto load_path = HMDT::UnitTests::getTestProgramPath() / "tmp" / "lazy_province_hierarchy";
+    std::filesystem::create_directories(load_path);
+    std::ofstream(load_path / HMDT::PROVINCEDATA_FILENAME).close();
+
+    // There is no province map, so only the provinces themselves get loaded
+    prov_project.load(load_path);
+    ASSERT_TRUE(prov_project.getProvinces().empty());
+    ASSERT_STATUS(terrain_node->getAnyValue(), HMDT::STATUS_VALUE_NOT_FOUND);
+    ASSERT_STATUS(terrain_node->setValue(HMDT::TerrainID("plains")),
+                  HMDT::STATUS_VALUE_NOT_FOUND);
+}
+
+TEST(ProjectTests, LazyHierarchyIndexTest) {
+    using namespace HMDT::Project::Hierarchy;
+
+    HMDT::Project::Project hproject;
+
+    auto& prov_project = dynamic_cast<HMDT::Project::ProvinceProject&>(hproject.getMapProject().getProvinceProject());
+
+    constexpr uint32_t NUM_PROVINCES = 100;
+
+    std::vector<HMDT::ProvinceID> ids;
+    for(uint32_t i = 0; i < NUM_PROVINCES; ++i) {
+        HMDT::Province province{};
+        province.type = HMDT::ProvinceType::LAND;
+        province.terrain = (i % 2 == 0) ? "plains" : "hills";
+
+        ids.push_back(province.id);
+        prov_project.getProvinces().emplace(province.id, province);
+    }
+    prov_project.rebuildProvinceTable();
+
+    auto maybe_group = prov_project.visitProvinces([](auto&&...) -> HMDT::MaybeVoid {
+        return HMDT::STATUS_SUCCESS;
+    });
+    ASSERT_SUCCEEDED(maybe_group);
+
+    auto group = std::dynamic_pointer_cast<IndexedGroupNode>(*maybe_group);
+    ASSERT_NE(group, nullptr);
+
+    auto root = std::make_shared<GroupNode>("Root");
+    ASSERT_SUCCEEDED(root->addChild(group));
+
+    // Building the index should not build any provinces
+    HierarchyIndex index;
+    ASSERT_SUCCEEDED(index.build(root));
+    ASSERT_EQ(index.size(), 1);
+    ASSERT_EQ(group->getBuiltChildCount(), 0);
+
+    // Looking up a path should only build the province along it
+    auto terrain_path = group->getName() + '/' + std::to_string(ids[7]) +
+                        '/' + ProvinceKeys::TERRAIN;
+    auto maybe_terrain = index.lookup(terrain_path);
+    ASSERT_SUCCEEDED(maybe_terrain);
+    ASSERT_EQ((*maybe_terrain)->getType(), Node::Type::PROPERTY);
+    ASSERT_EQ(group->getBuiltChildCount(), 1);
+
+    // And looking it up again should not index it twice
+    auto size = index.size();
+    ASSERT_SUCCEEDED(index.lookup(terrain_path));
+    ASSERT_SUCCEEDED(index.lookup(group->getName() + '/' + std::to_string(ids[7])));
+    ASSERT_EQ(index.size(), size);
+
+    ASSERT_STATUS(index.lookup(group->getName() + "/not a uuid"),
+                  HMDT::STATUS_VALUE_NOT_FOUND);
+    ASSERT_STATUS(index.updateProperty(group->getName() + '/' + std::to_string(HMDT::UUID()) + "/Terrain"),
+                  HMDT::STATUS_VALUE_NOT_FOUND);
+    ASSERT_EQ(group->getBuiltChildCount(), 1);
+
+    // A query without wildcards is the same as a lookup
+    auto maybe_results = index.query(group->getName() + '/' + std::to_string(ids[8]) +
+                                     '/' + ProvinceKeys::TERRAIN);
+    ASSERT_SUCCEEDED(maybe_results);
+    ASSERT_EQ(maybe_results->size(), 1);
+    ASSERT_EQ(group->getBuiltChildCount(), 2);
+
+    // A query with a wildcard over the provinces needs every one of them
+    maybe_results = index.query(group->getName() + "/*/" + ProvinceKeys::TERRAIN);
+    ASSERT_SUCCEEDED(maybe_results);
+    ASSERT_EQ(maybe_results->size(), NUM_PROVINCES);
+    ASSERT_EQ(group->getBuiltChildCount(), NUM_PROVINCES);
+
+    // Every node has now been indexed exactly once: the group, and each
+    //   province with its 6 properties
+    ASSERT_EQ(index.size(), 1 + NUM_PROVINCES * (1 + 6));
+    ASSERT_EQ(index.getNodesOfType(Node::Type::PROVINCE).size(), NUM_PROVINCES);
+}
+
+TEST(ProjectTests, HierarchyQueryTest) {
+    using namespace HMDT::Project::Hierarchy;
+
+    std::vector<std::string> terrains{ "plains", "forest", "plains", "hills" };
+    // Not a vector<bool>, as that does not hand out references
+    std::deque<bool> coastals{ true, false, false, true };
+
+    // Root -> Map -> Provinces -> N -> { Terrain, Coastal }
+    auto root = std::make_shared<GroupNode>("Root");
+    auto map = std::make_shared<GroupNode>("Map");
+    auto provinces = std::make_shared<GroupNode>("Provinces");
+    ASSERT_SUCCEEDED(root->addChild(map));
+    ASSERT_SUCCEEDED(map->addChild(provinces));
+
+    for(std::size_t i = 0; i < terrains.size(); ++i) {
+        auto province = std::make_shared<GroupNode>(std::to_string(i));
+
+        auto terrain = std::make_shared<PropertyNode<std::string>>(
+            "Terrain",
+            [&terrains, i]() -> HMDT::MaybeRef<std::string> {
+                return std::ref(terrains[i]);
+            },
+            [&terrains, i](const std::string& t) -> HMDT::MaybeVoid {
+                terrains[i] = t;
+                return HMDT::STATUS_SUCCESS;
+            });
+        auto coastal = std::make_shared<ConstPropertyNode<bool>>(
+            "Coastal",
+            [&coastals, i]() -> HMDT::MaybeRef<const bool> {
+                return std::cref(coastals[i]);
+            });
+
+        ASSERT_SUCCEEDED(province->addChild(terrain));
+        ASSERT_SUCCEEDED(province->addChild(coastal));
+        ASSERT_SUCCEEDED(provinces->addChild(province));
+    }
+
+    auto getNames = [](const std::vector<INodePtr>& nodes) {
+        std::vector<std::string> names;
+        for(auto&& node : nodes) {
+            names.push_back(node->getName());
+        }
+        return names;
+    };
+
+    // Parsing
+    ASSERT_STATUS(Query::parse(""), HMDT::STATUS_INVALID_QUERY);
+    ASSERT_STATUS(Query::parse("Map//Provinces"), HMDT::STATUS_INVALID_QUERY);
+    ASSERT_STATUS(Query::parse("Map/Provinces/"), HMDT::STATUS_INVALID_QUERY);
+    ASSERT_STATUS(Query::parse("Map/Provinces/*/Terrain =="), HMDT::STATUS_INVALID_QUERY);
+    ASSERT_STATUS(Query::parse("Map/Provinces/*/Terrain = plains"), HMDT::STATUS_INVALID_QUERY);
+    ASSERT_STATUS(Query::parse("Map/Provinces/*/Terrain == \"plains"), HMDT::STATUS_INVALID_QUERY);
+
+    auto maybe_query = Query::parse("/Map/Provinces/*/Terrain == \"plains\"");
+    ASSERT_SUCCEEDED(maybe_query);
+    ASSERT_EQ(maybe_query->getSegments(),
+              (std::vector<std::string>{ "Map", "Provinces", "*", "Terrain" }));
+    ASSERT_EQ(maybe_query->getComparison(), Query::Comparison::EQUAL);
+    ASSERT_EQ(maybe_query->getValue(), "plains");
+    ASSERT_TRUE(maybe_query->hasWildcards());
+
+    // Running directly against the tree
+    auto maybe_results = maybe_query->execute(root);
+    ASSERT_SUCCEEDED(maybe_results);
+    ASSERT_EQ(maybe_results->size(), 2);
+    // Children of a GroupNode are unordered
+    ASSERT_THAT(*maybe_results, ::testing::UnorderedElementsAre(
+        *Key({ "Map", "Provinces", "0", "Terrain" }).lookup(root),
+        *Key({ "Map", "Provinces", "2", "Terrain" }).lookup(root)
+    ));
+
+    // Running against the index should give the same answers
+    HierarchyIndex index;
+    ASSERT_SUCCEEDED(index.build(root));
+
+    // Map, Provinces, and then 3 nodes per province
+    ASSERT_EQ(index.size(), 2 + terrains.size() * 3);
+
+    auto maybe_node = index.lookup("Map/Provinces/1/Terrain");
+    ASSERT_SUCCEEDED(maybe_node);
+    ASSERT_EQ(*maybe_node, *Key({ "Map", "Provinces", "1", "Terrain" }).lookup(root));
+    ASSERT_STATUS(index.lookup("Map/Provinces/9/Terrain"), HMDT::STATUS_VALUE_NOT_FOUND);
+
+    ASSERT_EQ(index.getNodesOfType(Node::Type::PROPERTY).size(), terrains.size());
+    ASSERT_EQ(index.getNodesOfType(Node::Type::CONST_PROPERTY).size(), terrains.size());
+    ASSERT_EQ(index.getNodesOfType(Node::Type::GROUP).size(), 2 + terrains.size());
+
+    maybe_results = index.query(*maybe_query);
+    ASSERT_SUCCEEDED(maybe_results);
+    ASSERT_THAT(*maybe_results,
+                ::testing::UnorderedElementsAreArray(*maybe_query->execute(root)));
+
+    maybe_results = index.query("Map/Provinces/*/Terrain != plains");
+    ASSERT_SUCCEEDED(maybe_results);
+    ASSERT_EQ(maybe_results->size(), 2);
+
+    maybe_results = index.query("Map/Provinces/*/Coastal == true");
+    ASSERT_SUCCEEDED(maybe_results);
+    ASSERT_EQ(maybe_results->size(), 2);
+
+    maybe_results = index.query("Map/Provinces/*");
+    ASSERT_SUCCEEDED(maybe_results);
+    ASSERT_THAT(getNames(*maybe_results),
+                ::testing::UnorderedElementsAre("0", "1", "2", "3"));
+
+    maybe_results = index.query("Map/Provinces/3/Terrain == hills");
+    ASSERT_SUCCEEDED(maybe_results);
+    ASSERT_EQ(maybe_results->size(), 1);
+
+    ASSERT_STATUS(index.query("Map/Provinces/*/Terrain = hills"), HMDT::STATUS_INVALID_QUERY);
+
+    ASSERT_EQ(index.findByValue("Terrain", "forest").size(), 1);
+
+    // Change a property through its node, and make sure the index follows
+    auto terrain_node = std::dynamic_pointer_cast<IPropertyNode>(
+        *index.lookup("Map/Provinces/1/Terrain"));
+    ASSERT_NE(terrain_node, nullptr);
+    ASSERT_SUCCEEDED(terrain_node->setValue(std::string("plains")));
+
+    // Not updated yet
+    ASSERT_EQ(index.findByValue("Terrain", "forest").size(), 1);
+
+    ASSERT_SUCCEEDED(index.updateProperty("Map/Provinces/1/Terrain"));
+    ASSERT_EQ(index.findByValue("Terrain", "forest").size(), 0);
+    ASSERT_EQ(index.findByValue("Terrain", "plains").size(), 3);
+
+    maybe_results = index.query(*maybe_query);
+    ASSERT_SUCCEEDED(maybe_results);
+    ASSERT_EQ(getNames(*maybe_results),
+              (std::vector<std::string>{ "Terrain", "Terrain", "Terrain" }));
+    ASSERT_THAT(*maybe_results,
+                ::testing::UnorderedElementsAreArray(*maybe_query->execute(root)));
+
+    ASSERT_STATUS(index.updateProperty("Map/Provinces"), HMDT::STATUS_INVALID_TYPE);
+    ASSERT_STATUS(index.updateProperty("Map/Provinces/9/Terrain"), HMDT::STATUS_VALUE_NOT_FOUND);
+
+    // Changes made without going through the index are picked up by refreshing
+    terrains[3] = "plains";
+    coastals[0] = false;
+    index.refreshValues();
+    ASSERT_EQ(index.findByValue("Terrain", "plains").size(), 4);
+    ASSERT_EQ(index.query("Map/Provinces/*/Coastal == true")->size(), 1);
+}
+
+TEST(ProjectTests, ProvinceTableTest) {
+    using HMDT::Project::ProvinceTable;
+
+    auto project_path = HMDT::UnitTests::getTestProgramPath() / "bin" / "simple.hoi4proj";
+
+    HMDT::UnitTests::HoI4ProjectMock hproject(project_path);
+    auto& map_project = hproject.getMapProject();
+    auto& prov_project = map_project.getProvinceProject();
+
+    // land1 <-> sea <-> land2 <-> land3, land3 is merged into land2
+    HMDT::Province land1{ }, sea{ }, land2{ }, land3{ };
+    for(auto* prov : { &land1, &sea, &land2, &land3 }) {
+        prov->parent_id = HMDT::INVALID_PROVINCE;
+        prov->type = HMDT::ProvinceType::LAND;
+        prov->coastal = false;
+        prov->terrain = "plains";
+        prov->continent = "europe";
+    }
+    sea.type = HMDT::ProvinceType::SEA;
+    sea.terrain = "ocean";
+    sea.continent = "";
+    land3.coastal = true;
+    land3.parent_id = land2.id;
+    land2.children.insert(land3.id);
+
+    land1.adjacent_provinces = { sea.id };
+    sea.adjacent_provinces = { land1.id, land2.id };
+    land2.adjacent_provinces = { sea.id, land3.id };
+    land3.adjacent_provinces = { land2.id, HMDT::UUID() /* does not exist */ };
+
+    auto& provinces = prov_project.getProvinces();
+    for(auto* prov : { &land1, &sea, &land2, &land3 }) {
+        provinces[prov->id] = *prov;
+    }
+
+    // Nothing is picked up until the table is rebuilt
+    ASSERT_TRUE(prov_project.getProvinceTable()->empty());
+    prov_project.rebuildProvinceTable();
+
+    auto table_ptr = prov_project.getProvinceTable();
+    const auto& table = *table_ptr;
+    ASSERT_EQ(table.size(), 4);
+
+    // Indices are ordered by ID
+    ASSERT_TRUE(std::is_sorted(table.getIDs().begin(), table.getIDs().end()));
+
+    auto land1_index = *table.getIndex(land1.id);
+    auto sea_index = *table.getIndex(sea.id);
+    auto land2_index = *table.getIndex(land2.id);
+    auto land3_index = *table.getIndex(land3.id);
+    ASSERT_EQ(table.getIndex(HMDT::UUID()), std::nullopt);
+
+    ASSERT_EQ(table.getID(sea_index), sea.id);
+    ASSERT_EQ(table.getType(sea_index), HMDT::ProvinceType::SEA);
+    ASSERT_TRUE(table.isCoastal(land3_index));
+    ASSERT_FALSE(table.isCoastal(land1_index));
+
+    // Strings are shared between provinces
+    ASSERT_EQ(table.getTerrain(land1_index), table.getTerrain(land2_index));
+    ASSERT_NE(table.getTerrain(land1_index), table.getTerrain(sea_index));
+    ASSERT_EQ(table.getTerrain(sea_index), "ocean");
+    ASSERT_EQ(table.getContinent(land3_index), "europe");
+
+    // Relations
+    ASSERT_EQ(table.getParent(land3_index), land2_index);
+    ASSERT_EQ(table.getParent(land2_index), ProvinceTable::INVALID_INDEX);
+    ASSERT_THAT(table.getChildren(land2_index), ::testing::ElementsAre(land3_index));
+    ASSERT_TRUE(table.getChildren(land3_index).empty());
+    ASSERT_THAT(table.getAdjacentProvinces(sea_index),
+                ::testing::UnorderedElementsAre(land1_index, land2_index));
+
+    // The missing adjacent province is dropped
+    ASSERT_THAT(table.getAdjacentProvinces(land3_index),
+                ::testing::ElementsAre(land2_index));
+
+    // A dry run changes nothing
+    map_project.calculateCoastalProvinces(true);
+    ASSERT_FALSE(prov_project.getProvinceForID(land1.id).coastal);
+
+    map_project.calculateCoastalProvinces();
+
+    const auto& const_prov_project = prov_project;
+    ASSERT_TRUE(const_prov_project.getProvinceForID(land1.id).coastal);
+    ASSERT_TRUE(const_prov_project.getProvinceForID(land2.id).coastal);
+    ASSERT_FALSE(const_prov_project.getProvinceForID(land3.id).coastal);
+    ASSERT_FALSE(const_prov_project.getProvinceForID(sea.id).coastal);
+
+    // The table was rebuilt after the provinces were changed, while the old
+    //   one is left untouched for anyone still reading it
+    auto new_table = prov_project.getProvinceTable();
+    ASSERT_NE(new_table, table_ptr);
+    ASSERT_TRUE(new_table->isCoastal(land1_index));
+    ASSERT_FALSE(new_table->isCoastal(land3_index));
+    ASSERT_FALSE(table.isCoastal(land1_index));
+    ASSERT_TRUE(table.isCoastal(land3_index));
+
+    // Changes are only picked up once the table is rebuilt
+    prov_project.getProvinceForID(land1.id).coastal = false;
+    ASSERT_TRUE(prov_project.getProvinceTable()->isCoastal(land1_index));
+
+    prov_project.rebuildProvinceTable();
+    ASSERT_FALSE(prov_project.getProvinceTable()->isCoastal(land1_index));
+
+    map_project.calculateCoastalProvinces();
+    ASSERT_TRUE(const_prov_project.getProvinceForID(land1.id).coastal);
+
+    // Only the changed provinces and their neighbors are re-calculated
+    prov_project.getProvinceForID(sea.id).type = HMDT::ProvinceType::LAND;
+    prov_project.getProvinceForID(land3.id).coastal = true;
+    prov_project.rebuildProvinceTable();
+
+    map_project.calculateCoastalProvinces({ sea.id, HMDT::UUID() /* does not exist */ });
+    ASSERT_FALSE(const_prov_project.getProvinceForID(land1.id).coastal);
+    ASSERT_FALSE(const_prov_project.getProvinceForID(land2.id).coastal);
+    ASSERT_FALSE(const_prov_project.getProvinceForID(sea.id).coastal);
+    ASSERT_TRUE(const_prov_project.getProvinceForID(land3.id).coastal);
+}
+
+TEST(ProjectTests, ProvincePreviewCacheTest) {
+    using HMDT::Project::ProvincePreviewCache;
+
+    std::atomic<std::size_t> num_builds = 0;
+
+    ProvincePreviewCache cache(
+        [&num_builds](const HMDT::ProvinceID&, const HMDT::BoundingBox& bb) {
+            ++num_builds;
+            return ProvincePreviewCache::DataPtr(
+                new unsigned char[ProvincePreviewCache::getPreviewSize(bb)]());
+        },
+        1000);
+
+    // 10x10 RGBA previews are 400 bytes each, so only 2 fit
+    HMDT::BoundingBox bb{ { 0, 10 }, { 10, 0 } };
+    ASSERT_EQ(ProvincePreviewCache::getPreviewSize(bb), 400);
+
+    std::vector<HMDT::ProvinceID> ids(5);
+
+    ASSERT_EQ(cache.find(ids[0]), nullptr);
+
+    auto data0 = cache.get(ids[0], bb);
+    ASSERT_NE(data0, nullptr);
+    ASSERT_EQ(num_builds, 1);
+
+    // Cached previews are not rebuilt
+    ASSERT_EQ(cache.get(ids[0], bb), data0);
+    ASSERT_EQ(cache.find(ids[0]), data0);
+    ASSERT_EQ(num_builds, 1);
+
+    cache.get(ids[1], bb);
+    cache.get(ids[0], bb);
+    cache.get(ids[2], bb);
+    ASSERT_EQ(num_builds, 3);
+    ASSERT_EQ(cache.size(), 2);
+    ASSERT_EQ(cache.getTotalBytes(), 800);
+
+    // 1 was the least recently used, so it should be the one that was evicted
+    ASSERT_NE(cache.find(ids[0]), nullptr);
+    ASSERT_EQ(cache.find(ids[1]), nullptr);
+
+    // Prefetching builds in the background, skipping anything already cached
+    cache.setByteBudget(10000);
+    cache.prefetch({ { ids[0], bb }, { ids[3], bb }, { ids[4], bb } });
+    cache.waitForPrefetch();
+
+    ASSERT_EQ(num_builds, 5);
+    ASSERT_NE(cache.find(ids[3]), nullptr);
+    ASSERT_NE(cache.find(ids[4]), nullptr);
+
+    cache.get(ids[3], bb);
+    ASSERT_EQ(num_builds, 5);
+
+    cache.clear();
+    ASSERT_EQ(cache.size(), 0);
+    ASSERT_EQ(cache.getTotalBytes(), 0);
+    ASSERT_EQ(cache.find(ids[3]), nullptr);
+
+    // Cancelling waits for the preview being built, and drops the rest
+    std::atomic<std::size_t> num_slow_builds = 0;
+    ProvincePreviewCache slow_cache(
+        [&num_slow_builds](const HMDT::ProvinceID&, const HMDT::BoundingBox& bb) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(20));
+            ++num_slow_builds;
+            return ProvincePreviewCache::DataPtr(
+                new unsigned char[ProvincePreviewCache::getPreviewSize(bb)]());
+        },
+        10000);
+
+    slow_cache.prefetch({ { ids[0], bb }, { ids[1], bb }, { ids[2], bb } });
+    slow_cache.cancelPrefetch();
+
+    std::size_t num_built = num_slow_builds;
+    ASSERT_LE(num_built, 1);
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    ASSERT_EQ(num_slow_builds, num_built);
+}
+
+TEST(ProjectTests, ProvinceSpanIndexTest) {
+    using HMDT::Project::ProvinceSpanIndex;
+
+    HMDT::ProvinceID a;
+    HMDT::ProvinceID b;
+    HMDT::ProvinceID c;
+    HMDT::ProvinceID missing;
+
+    constexpr std::uint32_t width = 5;
+    constexpr std::uint32_t height = 3;
+
+    // a a b b b
+    // a c c b a
+    // c c c c c
+    HMDT::ProvinceID labels[width * height] = {
+        a, a, b, b, b,
+        a, c, c, b, a,
+        c, c, c, c, c,
+    };
+
+    ProvinceSpanIndex index(labels, width, height);
+
+    ASSERT_EQ(index.size(), 3);
+
+    auto to_tuples = [](const ProvinceSpanIndex::SpanList* spans) {
+        std::vector<std::tuple<std::uint32_t, std::uint32_t, std::uint32_t>> result;
+        for(auto&& span : *spans) {
+            result.emplace_back(span.y, span.x_begin, span.x_end);
+        }
+        return result;
+    };
+
+    using T = std::tuple<std::uint32_t, std::uint32_t, std::uint32_t>;
+
+    // Spans are in row-major order, and runs are never split
+    ASSERT_NE(index.getSpans(a), nullptr);
+    ASSERT_THAT(to_tuples(index.getSpans(a)),
+                ::testing::ElementsAre(T{0, 0, 2}, T{1, 0, 1}, T{1, 4, 5}));
+    ASSERT_THAT(to_tuples(index.getSpans(b)),
+                ::testing::ElementsAre(T{0, 2, 5}, T{1, 3, 4}));
+    ASSERT_THAT(to_tuples(index.getSpans(c)),
+                ::testing::ElementsAre(T{1, 1, 3}, T{2, 0, 5}));
+    ASSERT_EQ(index.getSpans(missing), nullptr);
+
+    ASSERT_EQ(index.getPixelCount(a), 4);
+    ASSERT_EQ(index.getPixelCount(b), 4);
+    ASSERT_EQ(index.getPixelCount(c), 7);
+    ASSERT_EQ(index.getPixelCount(missing), 0);
+
+    index.clear();
+    ASSERT_EQ(index.size(), 0);
+    ASSERT_EQ(index.getSpans(a), nullptr);
+}
+
+TEST(ProjectTests, ProvinceSpatialIndexTest) {
+    using HMDT::Project::ProvinceSpanIndex;
+    using HMDT::Project::ProvinceSpatialIndex;
+    using ::testing::UnorderedElementsAre;
+
+    HMDT::ProvinceID a;
+    HMDT::ProvinceID b;
+    HMDT::ProvinceID c;
+
+    // Large enough to cover several cells in each direction
+    constexpr std::uint32_t width = 200;
+    constexpr std::uint32_t height = 130;
+
+    // a fills the left half and b the right half, apart from a small square
+    //   of c in b's bottom corner, and a strip of unowned pixels along the
+    //   bottom
+    std::vector<HMDT::ProvinceID> labels(width * height);
+    for(std::uint32_t y = 0; y < height; ++y) {
+        for(std::uint32_t x = 0; x < width; ++x) {
+            auto& label = labels[HMDT::xyToIndex(width, x, y)];
+            if(y >= 120) {
+                label = HMDT::INVALID_PROVINCE;
+            } else if(x >= 150 && x < 160 && y >= 100 && y < 110) {
+                label = c;
+            } else {
+                label = x < 100 ? a : b;
+            }
+        }
+    }
+
+    auto span_index = std::make_shared<ProvinceSpanIndex>(labels.data(),
+                                                          width, height);
+
+    ProvinceSpatialIndex index;
+    index.build(span_index, width, height);
+
+    // Unowned pixels are never returned
+    ASSERT_EQ(index.size(), 3);
+
+    // Rects are half-open
+    ASSERT_THAT(index.queryRect(0, 0, 100, 10), UnorderedElementsAre(a));
+    ASSERT_THAT(index.queryRect(0, 0, 101, 10), UnorderedElementsAre(a, b));
+    ASSERT_THAT(index.queryRect(140, 95, 200, 105), UnorderedElementsAre(b, c));
+    ASSERT_THAT(index.queryRect(151, 101, 155, 105), UnorderedElementsAre(c));
+    ASSERT_THAT(index.queryRect(0, 120, 200, 130), ::testing::IsEmpty());
+    ASSERT_THAT(index.queryRect(50, 50, 50, 60), ::testing::IsEmpty());
+
+    // A triangle in b whose tip reaches down into c
+    ASSERT_THAT(index.queryPolygon({ {140, 10}, {190, 10}, {155, 115} }),
+                UnorderedElementsAre(b, c));
+
+    // A shorter triangle, which stops before reaching c
+    ASSERT_THAT(index.queryPolygon({ {140, 10}, {190, 10}, {165, 80} }),
+                UnorderedElementsAre(b));
+
+    // Degenerate polygons match nothing
+    ASSERT_THAT(index.queryPolygon({ {0, 0}, {50, 50} }), ::testing::IsEmpty());
+
+    // The province containing the point is always first
+    auto nearest = index.queryNearest(155, 105, 3);
+    ASSERT_EQ(nearest.size(), 3);
+    ASSERT_EQ(nearest[0].first, c);
+    ASSERT_DOUBLE_EQ(nearest[0].second, 0);
+    ASSERT_EQ(nearest[1].first, b);
+    ASSERT_DOUBLE_EQ(nearest[1].second, 5);
+    ASSERT_EQ(nearest[2].first, a);
+    ASSERT_DOUBLE_EQ(nearest[2].second, 56);
+
+    // Points in unowned pixels still find the closest province
+    nearest = index.queryNearest(10, 125, 1);
+    ASSERT_EQ(nearest.size(), 1);
+    ASSERT_EQ(nearest[0].first, a);
+    ASSERT_DOUBLE_EQ(nearest[0].second, 6);
+
+    index.clear();
+    ASSERT_EQ(index.size(), 0);
+    ASSERT_THAT(index.queryRect(0, 0, width, height), ::testing::IsEmpty());
+}
+
+TEST(ProjectTests, StateFileRenderTest) {
+    HMDT::State state;
+    state.id = 12;
+    state.name = "Test State";
+    state.manpower = 5000;
+    state.category = HMDT::StateCategory("city");
+    state.buildings_max_level_factor = 1.0f;
+    state.impassable = false;
+
+    std::string buffer;
+    HMDT::Project::StateProject::renderStateFile(state, { 3, 1, 2 }, buffer);
+
+    const std::string expected = "state={\n"
+                                 "\tid=12\n"
+                                 "\tname=\"Test State\"\n"
+                                 "\tmanpower=5000\n"
+                                 "\tstate_category = city\n"
+                                 "\thistory={\n"
+                                 "\t\towner = CHA\n"
+                                 "\t\tbuildings={\n"
+                                 "\t\t}\n"
+                                 "\t}\n"
+                                 "\tprovinces={\n"
+                                 "\t\t3 1 2 \n"
+                                 "\t}\n"
+                                 "}";
+    ASSERT_EQ(buffer, expected);
+
+    // Non-default values should be written out the same way an ostream would
+    state.buildings_max_level_factor = 0.25f;
+    state.impassable = true;
+
+    buffer.clear();
+    HMDT::Project::StateProject::renderStateFile(state, { }, buffer);
+
+    ASSERT_NE(buffer.find("\tbuildings_max_level_factor=0.25\n"), std::string::npos);
+    ASSERT_NE(buffer.find("\timpassable = yes\n"), std::string::npos);
+    ASSERT_NE(buffer.find("\tprovinces={\n\t\t\n\t}\n"), std::string::npos);
+}
+
+TEST(ProjectTests, ProvinceStateValidatorTest) {
+    using HMDT::Project::ProvinceStateValidator;
+    using Type = ProvinceStateValidator::Issue::Type;
+
+    HMDT::Province a{ }, b{ }, c{ }, d{ }, e{ };
+    for(auto* prov : { &a, &b, &c, &d, &e }) {
+        prov->parent_id = HMDT::INVALID_PROVINCE;
+        prov->type = HMDT::ProvinceType::LAND;
+        prov->terrain = "plains";
+        prov->continent = "europe";
+    }
+    a.state = 1; // Listed twice by its state
+    b.state = 1; // Not listed by its state
+    c.state = 2; // Also listed by state 1
+    d.state = 7; // Does not exist, but listed by state 2
+    e.state = ProvinceStateValidator::NO_STATE;
+
+    HMDT::ProvinceList provinces;
+    for(auto* prov : { &a, &b, &c, &d, &e }) {
+        provinces[prov->id] = *prov;
+    }
+
+    HMDT::UUID missing;
+
+    ProvinceStateValidator::StateMap states;
+    states[1] = HMDT::State{ 1, "STATE1", 0, "", 1.0f, false, { a.id, c.id, a.id }, HMDT::Color{ } };
+    states[2] = HMDT::State{ 2, "STATE2", 0, "", 1.0f, false, { c.id, missing, d.id }, HMDT::Color{ } };
+
+    HMDT::Project::ProvinceTable table(provinces);
+
+    ProvinceStateValidator validator;
+    validator.validate(table, states);
+
+    ASSERT_EQ(validator.getIssues().size(), 6);
+    ASSERT_EQ(validator.count(Type::DUPLICATE), 1);
+    ASSERT_EQ(validator.count(Type::NOT_IN_STATE), 1);
+    ASSERT_EQ(validator.count(Type::ORPHANED), 2);
+    ASSERT_EQ(validator.count(Type::INVALID_STATE_ID), 1);
+    ASSERT_EQ(validator.count(Type::MISSING_PROVINCE), 1);
+    ASSERT_TRUE(validator.hasErrors());
+
+    ASSERT_EQ(validator.getStatesToFix(), (std::vector<HMDT::StateID>{ 1, 2 }));
+
+    // Fix everything in bulk
+    for(auto state_id : validator.getStatesToFix()) {
+        validator.fixState(table, states.at(state_id));
+    }
+    validator.fixProvinces(provinces);
+
+    ASSERT_EQ(states.at(1).provinces, (std::vector<HMDT::ProvinceID>{ a.id, b.id }));
+    ASSERT_EQ(states.at(2).provinces, (std::vector<HMDT::ProvinceID>{ c.id }));
+    ASSERT_EQ(provinces.at(d.id).state, ProvinceStateValidator::NO_STATE);
+    ASSERT_EQ(provinces.at(a.id).state, 1);
+
+    // Nothing is left to fix
+    validator.validate(HMDT::Project::ProvinceTable(provinces), states);
+    ASSERT_TRUE(validator.getIssues().empty());
+    ASSERT_FALSE(validator.hasErrors());
+    ASSERT_TRUE(validator.getStatesToFix().empty());
+}
+
+TEST(ProjectTests, ProjectSnapshotTest) {
+    auto root = HMDT::UnitTests::getTestProgramPath() / "tmp" / "snapshot_save";
+    std::filesystem::remove_all(root);
+
+    auto writer = [](const std::string& contents) {
+        return [contents](const std::filesystem::path& path) -> HMDT::MaybeVoid {
+            std::ofstream out(path);
+            out << contents;
+            return HMDT::STATUS_SUCCESS;
+        };
+    };
+    auto read = [](const std::filesystem::path& path) {
+        std::ifstream in(path);
+        return std::string(std::istreambuf_iterator<char>(in),
+                           std::istreambuf_iterator<char>());
+    };
+
+    {
+        HMDT::Project::ProjectSnapshot snapshot;
+        snapshot.addDirectory(root / "sub");
+        snapshot.addFile(root / "a.txt", writer("first a"));
+        snapshot.addFile(root / "sub" / "b.txt", writer("first b"));
+        ASSERT_EQ(snapshot.size(), 2);
+
+        auto result = snapshot.write();
+        ASSERT_SUCCEEDED(result);
+        ASSERT_EQ(*result, (std::vector<std::filesystem::path>{
+            root / "a.txt", root / "sub" / "b.txt"
+        }));
+    }
+
+    ASSERT_EQ(read(root / "a.txt"), "first a");
+    ASSERT_EQ(read(root / "sub" / "b.txt"), "first b");
+    ASSERT_FALSE(std::filesystem::exists(root / ("a.txt" + HMDT::Project::ProjectSnapshot::BACKUP_EXTENSION)));
+
+    // A single failed file must leave every file as it was before
+    {
+        HMDT::Project::ProjectSnapshot snapshot;
+        snapshot.addFile(root / "a.txt", writer("second a"));
+        snapshot.addFile(root / "sub" / "b.txt",
+            [](const std::filesystem::path&) -> HMDT::MaybeVoid {
+                RETURN_ERROR(HMDT::STATUS_UNEXPECTED);
+            });
+
+        auto result = snapshot.write();
+        ASSERT_TRUE(IS_FAILURE(result));
+    }
+
+    ASSERT_EQ(read(root / "a.txt"), "first a");
+    ASSERT_EQ(read(root / "sub" / "b.txt"), "first b");
+    ASSERT_FALSE(std::filesystem::exists(root / ("a.txt" + HMDT::Project::ProjectSnapshot::TEMP_EXTENSION)));
+
+    // If a file can't be moved into place, then the ones which already were
+    //   must be put back. A file can't replace a directory with something in
+    //   it, so that is what gets in the way here.
+    std::filesystem::create_directories(root / "blocked" / "inner");
+    {
+        HMDT::Project::ProjectSnapshot snapshot;
+        snapshot.addFile(root / "a.txt", writer("third a"));
+        snapshot.addFile(root / "new.txt", writer("new"));
+        snapshot.addFile(root / "blocked", writer("blocked"));
+
+        auto result = snapshot.write();
+        ASSERT_TRUE(IS_FAILURE(result));
+    }
+
+    ASSERT_EQ(read(root / "a.txt"), "first a");
+    ASSERT_FALSE(std::filesystem::exists(root / "new.txt"));
+    ASSERT_TRUE(std::filesystem::is_directory(root / "blocked"));
+    for(auto&& name : { "a.txt", "new.txt", "blocked" }) {
+        ASSERT_FALSE(std::filesystem::exists(root / (name + HMDT::Project::ProjectSnapshot::TEMP_EXTENSION)));
+        ASSERT_FALSE(std::filesystem::exists(root / (name + HMDT::Project::ProjectSnapshot::BACKUP_EXTENSION)));
+    }
+
+    std::filesystem::remove_all(root);
+}
+
+TEST(ProjectTests, LoadSchedulerTest) {
+    using HMDT::Project::LoadScheduler;
+
+    std::mutex order_mutex;
+    std::vector<std::string> order;
+    auto record = [&order_mutex, &order](const std::string& name) {
+        std::lock_guard<std::mutex> lock(order_mutex);
+        order.push_back(name);
+    };
+    auto index_of = [&order](const std::string& name) {
+        return std::find(order.begin(), order.end(), name) - order.begin();
+    };
+
+    // "input" and "continents" only finish once both have started, so they
+    //   must be run at the same time
+    std::atomic<int> started = 0;
+    auto wait_for_both = [&started]() {
+        ++started;
+
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+        while(started < 2 && std::chrono::steady_clock::now() < deadline) {
+            std::this_thread::yield();
+        }
+        return started >= 2;
+    };
+
+    std::thread::id caller_stage_thread;
+
+    LoadScheduler scheduler;
+    scheduler.addStage("states", [&]() -> HMDT::MaybeVoid {
+        record("states");
+        return HMDT::STATUS_SUCCESS;
+    }, { "provinces" });
+    scheduler.addStage("input", [&]() -> HMDT::MaybeVoid {
+        RETURN_ERROR_IF(!wait_for_both(), HMDT::STATUS_UNEXPECTED);
+        record("input");
+        return HMDT::STATUS_SUCCESS;
+    });
+    scheduler.addStage("continents", [&]() -> HMDT::MaybeVoid {
+        RETURN_ERROR_IF(!wait_for_both(), HMDT::STATUS_UNEXPECTED);
+        record("continents");
+        return HMDT::STATUS_SUCCESS;
+    });
+    scheduler.addStage("provinces", [&]() -> HMDT::MaybeVoid {
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        record("provinces");
+        return HMDT::STATUS_SUCCESS;
+    }, { "input" });
+    scheduler.addStage("heightmap", [&]() -> HMDT::MaybeVoid {
+        caller_stage_thread = std::this_thread::get_id();
+        record("heightmap");
+        return HMDT::STATUS_SUCCESS;
+    }, { "input" }, LoadScheduler::Affinity::CALLER);
+
+    ASSERT_TRUE(scheduler.hasStage("provinces"));
+    ASSERT_FALSE(scheduler.hasStage("rivers"));
+
+    auto result = scheduler.run();
+    ASSERT_SUCCEEDED(result);
+
+    ASSERT_EQ(order.size(), 5);
+    ASSERT_LT(index_of("input"), index_of("provinces"));
+    ASSERT_LT(index_of("provinces"), index_of("states"));
+    ASSERT_LT(index_of("input"), index_of("heightmap"));
+    ASSERT_EQ(caller_stage_thread, std::this_thread::get_id());
+
+    const auto& timings = scheduler.getTimings();
+    ASSERT_EQ(timings.size(), 5);
+    ASSERT_EQ(timings[0].name, "states");
+    for(auto&& timing : timings) {
+        ASSERT_TRUE(timing.was_run);
+    }
+
+    // The longest chain is input -> provinces -> states
+    ASSERT_GE(scheduler.getCriticalPathTime(), timings[3].duration);
+    ASSERT_GE(scheduler.getTotalTime(), scheduler.getCriticalPathTime());
+
+    // A failed stage stops everything that depends on it from running
+    {
+        LoadScheduler failing_scheduler;
+        failing_scheduler.addStage("input", []() -> HMDT::MaybeVoid {
+            RETURN_ERROR(HMDT::STATUS_DIMENSION_MISMATCH);
+        });
+        failing_scheduler.addStage("provinces", []() -> HMDT::MaybeVoid {
+            return HMDT::STATUS_SUCCESS;
+        }, { "input" });
+
+        auto failed_result = failing_scheduler.run();
+        ASSERT_STATUS(failed_result, HMDT::STATUS_DIMENSION_MISMATCH);
+        ASSERT_FALSE(failing_scheduler.getTimings()[1].was_run);
+    }
+
+    // Unknown and cyclic dependencies can never be run
+    {
+        LoadScheduler unknown_scheduler;
+        unknown_scheduler.addStage("provinces", []() -> HMDT::MaybeVoid {
+            return HMDT::STATUS_SUCCESS;
+        }, { "input" });
+
+        auto unknown_result = unknown_scheduler.run();
+        ASSERT_STATUS(unknown_result, HMDT::STATUS_KEY_NOT_FOUND);
+
+        LoadScheduler cyclic_scheduler;
+        cyclic_scheduler.addStage("a", []() -> HMDT::MaybeVoid {
+            return HMDT::STATUS_SUCCESS;
+        }, { "b" });
+        cyclic_scheduler.addStage("b", []() -> HMDT::MaybeVoid {
+            return HMDT::STATUS_SUCCESS;
+        }, { "a" });
+
+        auto cyclic_result = cyclic_scheduler.run();
+        ASSERT_STATUS(cyclic_result, HMDT::STATUS_LOAD_STAGE_CYCLE);
+    }
+}
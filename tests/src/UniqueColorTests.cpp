@@ -10,6 +10,7 @@
 #include "ColorArray.h" // We use the raw arrays rather than the fancy generator
                         // functions for efficiency in some tests
 #include "UniqueColorGenerator.h"
+#include "UniqueColorIndex.h"
 #include "TestUtils.h"
 
 #pragma pack(push, 1)
@@ -115,25 +116,163 @@ TEST(UniqueColorTests, TestColorUniqueness) {
     }
 }
 
-// We want to be able to use this function despite its private nature
-//  NOTE: Do not ever actually use this in practice, this is simply to make the
-//   unit test easier to write and run
-using UniqueColorPtr = const unsigned char*;
-extern UniqueColorPtr& getUniqueColorPtr(HMDT::ProvinceType);
-
 TEST(UniqueColorTests, TestGetUnknownsWhenOutOfColors) {
-    // Make sure that we start these at the beginning
-    HMDT::resetUniqueColorGenerator(HMDT::ProvinceType::UNKNOWN);
+    HMDT::UniqueColorAllocator allocator;
 
-    // Force the LAND to the end
-    ::getUniqueColorPtr(HMDT::ProvinceType::LAND) = HMDT_ALL_LANDS + HMDT_ALL_LANDS_SIZE;
+    // Use up every LAND color
+    std::size_t land_count = HMDT_ALL_LANDS_SIZE / 3;
+    auto lands = allocator.allocate(HMDT::ProvinceType::LAND, land_count);
+    ASSERT_EQ(lands.size(), land_count);
+    ASSERT_EQ(lands.back(), (HMDT::Color{ HMDT_ALL_LANDS[HMDT_ALL_LANDS_SIZE - 3],
+                                          HMDT_ALL_LANDS[HMDT_ALL_LANDS_SIZE - 2],
+                                          HMDT_ALL_LANDS[HMDT_ALL_LANDS_SIZE - 1] }));
 
-    auto c = HMDT::generateUniqueColor(HMDT::ProvinceType::LAND);
+    // Once they are gone, UNKNOWN colors get given out instead, from the same
+    //   list as if they had been asked for directly
+    auto c = allocator.allocate(HMDT::ProvinceType::LAND);
+    ASSERT_EQ(c, (HMDT::Color{ HMDT_ALL_UNKNOWNS[0],
+                               HMDT_ALL_UNKNOWNS[1],
+                               HMDT_ALL_UNKNOWNS[2] }));
+    ASSERT_EQ(allocator.allocate(HMDT::ProvinceType::UNKNOWN),
+              (HMDT::Color{ HMDT_ALL_UNKNOWNS[3],
+                            HMDT_ALL_UNKNOWNS[4],
+                            HMDT_ALL_UNKNOWNS[5] }));
 
-    // Reset this again since generateUniqueColor _should_ have grabbed a value
-    //  from here
-    HMDT::resetUniqueColorGenerator(HMDT::ProvinceType::UNKNOWN);
-    
-    ASSERT_EQ(c, HMDT::generateUniqueColor(HMDT::ProvinceType::UNKNOWN));
+    // Releasing a LAND color makes it available again
+    ASSERT_TRUE(allocator.release(lands.front()));
+    ASSERT_EQ(allocator.allocate(HMDT::ProvinceType::LAND), lands.front());
 }
 
+TEST(UniqueColorTests, TestColorAllocator) {
+    auto color_at = [](const unsigned char* array, std::size_t index) {
+        return HMDT::Color{ array[index * 3],
+                            array[index * 3 + 1],
+                            array[index * 3 + 2] };
+    };
+
+    HMDT::UniqueColorAllocator allocator;
+
+    // Colors are given out from the start of each type's list
+    auto land = allocator.allocate(HMDT::ProvinceType::LAND);
+    ASSERT_EQ(land, color_at(HMDT_ALL_LANDS, 0));
+    ASSERT_TRUE(allocator.isInUse(land));
+
+    // Each type has its own cursor
+    auto sea = allocator.allocate(HMDT::ProvinceType::SEA);
+    ASSERT_EQ(sea, color_at(HMDT_ALL_SEAS, 0));
+
+    // Allocating in bulk must give the same colors as one at a time
+    auto lands = allocator.allocate(HMDT::ProvinceType::LAND, 4);
+    ASSERT_EQ(lands.size(), 4);
+    for(std::size_t i = 0; i < lands.size(); ++i) {
+        ASSERT_EQ(lands[i], color_at(HMDT_ALL_LANDS, i + 1));
+    }
+    ASSERT_EQ(allocator.getInUseCount(), 6);
+
+    // Released colors get re-used before any new ones
+    ASSERT_TRUE(allocator.release(lands[1]));
+    ASSERT_FALSE(allocator.release(lands[1]));
+    ASSERT_FALSE(allocator.isInUse(lands[1]));
+    ASSERT_EQ(allocator.allocate(HMDT::ProvinceType::LAND), lands[1]);
+    ASSERT_EQ(allocator.allocate(HMDT::ProvinceType::LAND),
+              color_at(HMDT_ALL_LANDS, 5));
+
+    // Colors marked as in use get skipped over
+    ASSERT_TRUE(allocator.markInUse(color_at(HMDT_ALL_LANDS, 6),
+                                    HMDT::ProvinceType::LAND));
+    ASSERT_FALSE(allocator.markInUse(color_at(HMDT_ALL_LANDS, 6)));
+    ASSERT_EQ(allocator.allocate(HMDT::ProvinceType::LAND),
+              color_at(HMDT_ALL_LANDS, 7));
+
+    // Resetting a single type leaves the others alone
+    allocator.reset(HMDT::ProvinceType::LAND);
+    ASSERT_FALSE(allocator.isInUse(land));
+    ASSERT_TRUE(allocator.isInUse(sea));
+    ASSERT_EQ(allocator.allocate(HMDT::ProvinceType::LAND), land);
+
+    // Separate allocators never affect each other
+    HMDT::UniqueColorAllocator other_allocator;
+    ASSERT_EQ(other_allocator.allocate(HMDT::ProvinceType::SEA), sea);
+
+    allocator.reset();
+    ASSERT_EQ(allocator.getInUseCount(), 0);
+
+    // Allocating from many threads at once must never give out the same color
+    //   twice
+    constexpr std::size_t THREAD_COUNT = 8;
+    constexpr std::size_t COLORS_PER_THREAD = 256;
+
+    std::vector<std::vector<HMDT::Color>> thread_colors(THREAD_COUNT);
+    std::vector<std::thread> threads;
+    for(std::size_t t = 0; t < THREAD_COUNT; ++t) {
+        threads.emplace_back([&allocator, &thread_colors, t]() {
+            for(std::size_t i = 0; i < COLORS_PER_THREAD; ++i) {
+                if(i % 2 == 0) {
+                    thread_colors[t].push_back(allocator.allocate(HMDT::ProvinceType::UNKNOWN));
+                } else {
+                    auto colors = allocator.allocate(HMDT::ProvinceType::UNKNOWN, 1);
+                    thread_colors[t].push_back(colors.front());
+                }
+            }
+        });
+    }
+    for(auto&& thread : threads) {
+        thread.join();
+    }
+
+    std::set<std::tuple<uint8_t, uint8_t, uint8_t>> unique_colors;
+    for(auto&& colors : thread_colors) {
+        for(auto&& color : colors) {
+            unique_colors.emplace(color.r, color.g, color.b);
+        }
+    }
+    ASSERT_EQ(unique_colors.size(), THREAD_COUNT * COLORS_PER_THREAD);
+    ASSERT_EQ(allocator.getInUseCount(), THREAD_COUNT * COLORS_PER_THREAD);
+}
+
+TEST(UniqueColorTests, TestColorIndex) {
+    std::array<std::pair<const unsigned char*, unsigned int>, 4> color_lists = {
+        std::make_pair(HMDT_ALL_LANDS, HMDT_ALL_LANDS_SIZE),
+        std::make_pair(HMDT_ALL_SEAS, HMDT_ALL_SEAS_SIZE),
+        std::make_pair(HMDT_ALL_LAKES, HMDT_ALL_LAKES_SIZE),
+        std::make_pair(HMDT_ALL_UNKNOWNS, HMDT_ALL_UNKNOWNS_SIZE)
+    };
+
+    // Every color must be found exactly where it is in its array
+    for(uint32_t t = 0; t < color_lists.size(); ++t) {
+        auto&& [array, size] = color_lists[t];
+
+        for(uint32_t i = 0; i < size / 3; ++i) {
+            auto location = HMDT::UniqueColors::findColor(array[i * 3],
+                                                          array[i * 3 + 1],
+                                                          array[i * 3 + 2]);
+            ASSERT_TRUE(location.has_value()) << "table " << t << ", index " << i;
+            ASSERT_EQ(static_cast<uint32_t>(location->table), t);
+            ASSERT_EQ(location->index, i);
+        }
+    }
+
+    // Anything which is found must actually be the color that was looked for
+    for(uint32_t rgb = 0; rgb <= 0xFFFFFF; rgb += 97) {
+        if(auto location = HMDT::UniqueColors::findColor(rgb); location) {
+            auto* color = color_lists[static_cast<uint32_t>(location->table)].first +
+                          location->index * 3;
+
+            ASSERT_EQ((color[0] << 16) | (color[1] << 8) | color[2], rgb);
+        }
+    }
+
+    ASSERT_FALSE(HMDT::UniqueColors::findColor(0, 0, 0).has_value());
+
+    HMDT::Color sea{ HMDT_ALL_SEAS[0], HMDT_ALL_SEAS[1], HMDT_ALL_SEAS[2] };
+    ASSERT_EQ(*HMDT::findUniqueColorType(sea), HMDT::ProvinceType::SEA);
+    ASSERT_FALSE(HMDT::findUniqueColorType(HMDT::Color{ 0, 0, 0 }));
+
+    // A loaded color goes back to the list it was generated for once released
+    HMDT::UniqueColorAllocator allocator;
+    ASSERT_TRUE(allocator.markInUse(sea));
+    ASSERT_EQ(allocator.allocate(HMDT::ProvinceType::SEA),
+              (HMDT::Color{ HMDT_ALL_SEAS[3], HMDT_ALL_SEAS[4], HMDT_ALL_SEAS[5] }));
+    ASSERT_TRUE(allocator.release(sea));
+    ASSERT_EQ(allocator.allocate(HMDT::ProvinceType::SEA), sea);
+}
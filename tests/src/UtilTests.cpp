@@ -2,6 +2,8 @@
 #include "gtest/gtest.h"
 
 #include <random>
+#include <sstream>
+#include <thread>
 
 #include <libintl.h>
 
@@ -9,6 +11,12 @@
 #include "Monad.h"
 #include "Maybe.h"
 #include "StatusCodes.h"
+#include "ArenaResource.h"
+#include "Symbol.h"
+#include "LRUCache.h"
+#include "DenseBitSet.h"
+#include "SelectionMask.h"
+#include "MapData.h"
 
 #include "TestOverrides.h"
 #include "TestUtils.h"
@@ -266,11 +274,15 @@ TEST(UtilTests, TrimTests) {
     std::pair<std::string, std::string> ltrim_tests[] = {
         { "    ltrim   ", "ltrim   " },
         { "ltrim   ", "ltrim   " },
-        { "ltrim", "ltrim" }
+        { "ltrim", "ltrim" },
+        { "   ", "" },
+        { "", "" }
     };
     std::pair<std::string, std::string> rtrim_tests[] = {
         { "rtrim   ", "rtrim" },
-        { "          rtrim   ", "          rtrim" }
+        { "          rtrim   ", "          rtrim" },
+        { "   ", "" },
+        { "", "" }
     };
     std::pair<std::string, std::string> trim_tests[] = {
         { "   trim    ", "trim" },
@@ -303,6 +315,31 @@ TEST(UtilTests, ClampTests) {
     ASSERT_EQ(HMDT::clamp(533, 5, 20), 20);
 }
 
+TEST(UtilTests, GetCommonValueTests) {
+    HMDT::Province a;
+    HMDT::Province b;
+    HMDT::Province c;
+    a.terrain = b.terrain = c.terrain = "plains";
+    a.coastal = true;
+    b.coastal = c.coastal = false;
+
+    HMDT::RefVector<HMDT::Province> provinces{ a, b, c };
+    ASSERT_EQ(HMDT::getCommonValue(provinces, &HMDT::Province::terrain),
+              std::optional<std::string>("plains"));
+    ASSERT_EQ(HMDT::getCommonValue(provinces, &HMDT::Province::coastal),
+              std::nullopt);
+
+    // Const structures can be looked at too
+    HMDT::RefVector<const HMDT::Province> const_provinces{ b, c };
+    ASSERT_EQ(HMDT::getCommonValue(const_provinces, &HMDT::Province::coastal),
+              std::optional<bool>(false));
+
+    // There is nothing in common between no structures
+    ASSERT_EQ(HMDT::getCommonValue(HMDT::RefVector<HMDT::Province>{},
+                                   &HMDT::Province::terrain),
+              std::nullopt);
+}
+
 TEST(UtilTests, MonadBasicTest) {
     using HMDT::MonadOptional;
 
@@ -559,3 +596,449 @@ TEST(UtilTests, LargeParallelTransformTest) {
         ASSERT_EQ(output_data[i], expected_output_data[i]);
     }
 }
+
+TEST(UtilTests, ArenaResourceStatisticsTest) {
+    HMDT::ArenaResource arena(1024);
+
+    {
+        std::pmr::vector<uint32_t> values(&arena);
+        values.reserve(100);
+
+        for(uint32_t i = 0; i < 100; ++i) {
+            values.push_back(i);
+        }
+
+        auto&& stats = arena.getStatistics();
+        ASSERT_EQ(stats.num_allocations, 1);
+        ASSERT_EQ(stats.bytes_allocated, 100 * sizeof(uint32_t));
+        ASSERT_EQ(stats.bytes_in_use, 100 * sizeof(uint32_t));
+        ASSERT_GE(stats.bytes_reserved, stats.bytes_allocated);
+    }
+
+    // The vector gave back its memory, but the arena is still holding onto it
+    auto&& stats = arena.getStatistics();
+    ASSERT_EQ(stats.bytes_in_use, 0);
+    ASSERT_EQ(stats.num_deallocations, 1);
+    ASSERT_EQ(stats.peak_bytes_in_use, 100 * sizeof(uint32_t));
+    ASSERT_GT(stats.bytes_reserved, 0);
+
+    // Releasing should give everything back upstream, and let us re-use it
+    arena.release();
+    ASSERT_EQ(stats.bytes_allocated, 0);
+    ASSERT_EQ(stats.bytes_reserved, 0);
+    ASSERT_EQ(stats.num_releases, 1);
+
+    std::pmr::vector<uint32_t> values(10, 0, &arena);
+    ASSERT_EQ(stats.num_allocations, 1);
+    ASSERT_EQ(stats.bytes_in_use, 10 * sizeof(uint32_t));
+}
+
+TEST(UtilTests, UUIDStringTests) {
+    SET_PROGRAM_OPTION(quiet, true);
+
+    const std::string UUID_STR = "0123abcd-4567-89ef-fedc-ba9876543210";
+
+    auto maybe_uuid = HMDT::UUID::parse(UUID_STR);
+    ASSERT_SUCCEEDED(maybe_uuid);
+
+    // Bytes are always in the same order as in the string
+    HMDT::UUID::Bytes expected_bytes {
+        0x01, 0x23, 0xab, 0xcd, 0x45, 0x67, 0x89, 0xef,
+        0xfe, 0xdc, 0xba, 0x98, 0x76, 0x54, 0x32, 0x10
+    };
+    ASSERT_EQ(maybe_uuid->toBytes(), expected_bytes);
+    ASSERT_EQ(*maybe_uuid, HMDT::UUID(expected_bytes));
+
+    ASSERT_EQ(std::to_string(*maybe_uuid), UUID_STR);
+
+    // Uppercase parses to the same thing, but is always written as lowercase
+    auto maybe_upper_uuid = HMDT::UUID::parse("0123ABCD-4567-89EF-FEDC-BA9876543210");
+    ASSERT_SUCCEEDED(maybe_upper_uuid);
+    ASSERT_EQ(*maybe_upper_uuid, *maybe_uuid);
+
+    std::stringstream ss;
+    ss << *maybe_uuid << ';';
+    ASSERT_EQ(ss.str(), UUID_STR + ";");
+
+    // Round-trip a bunch of generated UUIDs
+    for(auto i = 0; i < 100; ++i) {
+        HMDT::UUID uuid;
+
+        char buffer[HMDT::UUID::STRING_REPR_LENGTH];
+        ASSERT_EQ(uuid.format(buffer), buffer + sizeof(buffer));
+
+        auto parsed = HMDT::UUID::parse(std::string_view(buffer, sizeof(buffer)));
+        ASSERT_SUCCEEDED(parsed);
+        ASSERT_EQ(*parsed, uuid);
+    }
+
+    ASSERT_STATUS(HMDT::UUID::parse(""), HMDT::STATUS_INVALID_UUID_STRING);
+    ASSERT_STATUS(HMDT::UUID::parse(UUID_STR.substr(1)), HMDT::STATUS_INVALID_UUID_STRING);
+    ASSERT_STATUS(HMDT::UUID::parse(UUID_STR + "0"), HMDT::STATUS_INVALID_UUID_STRING);
+    ASSERT_STATUS(HMDT::UUID::parse("0123abcd_4567-89ef-fedc-ba9876543210"), HMDT::STATUS_INVALID_UUID_STRING);
+    ASSERT_STATUS(HMDT::UUID::parse("0123abcd-4567-89ef-fedc-ba987654321g"), HMDT::STATUS_INVALID_UUID_STRING);
+
+    // Streams
+    {
+        std::stringstream in("  " + UUID_STR + "\n0123abcd-4567-89ef-fedc-ba9876543210x next");
+
+        HMDT::UUID uuid(HMDT::UUID::CreationParams::EMPTY);
+        in >> uuid;
+        ASSERT_EQ(uuid, *maybe_uuid);
+
+        // Too long, so the whole token is skipped and uuid is left alone
+        HMDT::UUID uuid2(HMDT::UUID::CreationParams::EMPTY);
+        in >> uuid2;
+        ASSERT_TRUE(uuid2.isEmpty());
+
+        std::string next;
+        in >> next;
+        ASSERT_EQ(next, "next");
+    }
+}
+
+TEST(UtilTests, UUIDBinaryTests) {
+    auto uuid1 = *HMDT::UUID::parse("0123abcd-4567-89ef-fedc-ba9876543210");
+    HMDT::UUID uuid2;
+
+    std::stringstream sstream;
+    HMDT::writeData(sstream, uuid1, uuid2);
+
+    auto data = sstream.str();
+    ASSERT_EQ(data.size(), 2 * HMDT::UUID::BINARY_REPR_LENGTH);
+    ASSERT_EQ(static_cast<uint8_t>(data[0]), 0x01);
+    ASSERT_EQ(static_cast<uint8_t>(data[15]), 0x10);
+
+    HMDT::UUID read1(HMDT::UUID::CreationParams::EMPTY);
+    HMDT::UUID read2(HMDT::UUID::CreationParams::EMPTY);
+    ASSERT_SUCCEEDED(HMDT::safeRead2(sstream, &read1, &read2));
+    ASSERT_EQ(read1, uuid1);
+    ASSERT_EQ(read2, uuid2);
+
+    // Nothing left to read
+    HMDT::UUID read3(HMDT::UUID::CreationParams::EMPTY);
+    ASSERT_FALSE(HMDT::safeRead(&read3, sstream));
+    ASSERT_TRUE(read3.isEmpty());
+}
+
+TEST(UtilTests, SymbolTests) {
+    struct TestTag;
+    using TestSymbol = HMDT::Symbol<TestTag>;
+
+    // Default symbols are the empty string, which is always ID 0
+    TestSymbol empty;
+    ASSERT_TRUE(empty.empty());
+    ASSERT_EQ(empty.getID(), 0);
+    ASSERT_EQ(empty, "");
+    ASSERT_EQ(TestSymbol(""), empty);
+
+    // New names get the next ID, and the same name always gets the same ID
+    ASSERT_EQ(TestSymbol::find("plains"), std::nullopt);
+
+    TestSymbol plains("plains");
+    TestSymbol forest(std::string("forest"));
+    TestSymbol plains2(std::string_view("plains"));
+
+    ASSERT_EQ(plains.getID(), 1);
+    ASSERT_EQ(forest.getID(), 2);
+    ASSERT_EQ(plains, plains2);
+    ASSERT_NE(plains, forest);
+    ASSERT_EQ(TestSymbol::getTable().size(), 3);
+    ASSERT_EQ(TestSymbol::find("plains"), plains);
+
+    // Symbols can be compared against, and used as, plain strings
+    ASSERT_EQ(plains, "plains");
+    ASSERT_EQ(plains, std::string("plains"));
+    ASSERT_EQ(std::string("forest"), forest);
+    ASSERT_NE(plains, "forest");
+    ASSERT_STREQ(plains.c_str(), "plains");
+    ASSERT_EQ(static_cast<const std::string&>(forest), "forest");
+    ASSERT_LT(forest, plains);
+
+    std::stringstream ss;
+    ss << plains << ';' << forest;
+    ASSERT_EQ(ss.str(), "plains;forest");
+
+    // Parsed the same way as strings
+    ASSERT_EQ(HMDT::fromString<TestSymbol>("forest"), forest);
+
+    // Every tag has its own table
+    ASSERT_EQ(HMDT::Symbol<struct OtherTag>("forest").getID(), 1);
+
+    // Interning from many threads at once should still give each name exactly
+    //   one ID
+    constexpr std::size_t NUM_THREADS = 8;
+    constexpr std::size_t NUM_NAMES = 500;
+
+    std::vector<std::vector<TestSymbol>> results(NUM_THREADS);
+    std::vector<std::thread> threads;
+    for(std::size_t t = 0; t < NUM_THREADS; ++t) {
+        threads.emplace_back([&results, t]() {
+            for(std::size_t i = 0; i < NUM_NAMES; ++i) {
+                results[t].emplace_back("name" + std::to_string(i));
+            }
+        });
+    }
+    for(auto&& thread : threads) {
+        thread.join();
+    }
+
+    ASSERT_EQ(TestSymbol::getTable().size(), 3 + NUM_NAMES);
+    for(std::size_t i = 0; i < NUM_NAMES; ++i) {
+        for(std::size_t t = 1; t < NUM_THREADS; ++t) {
+            ASSERT_EQ(results[0][i], results[t][i]);
+        }
+        ASSERT_EQ(results[0][i], "name" + std::to_string(i));
+    }
+}
+
+TEST(UtilTests, LRUCacheTests) {
+    HMDT::LRUCache<int, std::string> cache(10);
+
+    ASSERT_TRUE(cache.empty());
+    ASSERT_EQ(cache.get(1), nullptr);
+
+    cache.put(1, "one", 4);
+    cache.put(2, "two", 4);
+    ASSERT_EQ(cache.size(), 2);
+    ASSERT_EQ(cache.getTotalBytes(), 8);
+
+    // Touch 1 so that 2 becomes the least recently used
+    ASSERT_NE(cache.get(1), nullptr);
+    ASSERT_EQ(*cache.get(1), "one");
+
+    // Going over budget evicts the least recently used entries
+    cache.put(3, "three", 4);
+    ASSERT_EQ(cache.size(), 2);
+    ASSERT_EQ(cache.getTotalBytes(), 8);
+    ASSERT_TRUE(cache.contains(1));
+    ASSERT_FALSE(cache.contains(2));
+    ASSERT_TRUE(cache.contains(3));
+
+    // Replacing an entry updates its size
+    cache.put(1, "uno", 2);
+    ASSERT_EQ(cache.getTotalBytes(), 6);
+    ASSERT_EQ(*cache.get(1), "uno");
+
+    // An entry bigger than the whole budget is kept on its own
+    cache.put(4, "four", 100);
+    ASSERT_EQ(cache.size(), 1);
+    ASSERT_TRUE(cache.contains(4));
+    ASSERT_EQ(cache.getTotalBytes(), 100);
+
+    cache.put(5, "five", 1);
+    ASSERT_EQ(cache.size(), 1);
+    ASSERT_TRUE(cache.contains(5));
+
+    // Shrinking the budget evicts straight away
+    cache.setByteBudget(100);
+    cache.put(6, "six", 1);
+    cache.put(7, "seven", 1);
+    ASSERT_EQ(cache.size(), 3);
+    cache.setByteBudget(2);
+    ASSERT_EQ(cache.size(), 2);
+    ASSERT_FALSE(cache.contains(5));
+
+    ASSERT_TRUE(cache.erase(6));
+    ASSERT_FALSE(cache.erase(6));
+    ASSERT_EQ(cache.getTotalBytes(), 1);
+
+    cache.clear();
+    ASSERT_TRUE(cache.empty());
+    ASSERT_EQ(cache.getTotalBytes(), 0);
+}
+
+TEST(UtilTests, DenseBitSetTests) {
+    using HMDT::DenseBitSet;
+
+    DenseBitSet set;
+
+    ASSERT_TRUE(set.empty());
+    ASSERT_FALSE(set.test(0));
+    ASSERT_FALSE(set.test(1000));
+
+    // Setting grows the set as needed, and only reports new indices
+    ASSERT_TRUE(set.set(5));
+    ASSERT_TRUE(set.set(200));
+    ASSERT_TRUE(set.set(63));
+    ASSERT_TRUE(set.set(64));
+    ASSERT_FALSE(set.set(5));
+    ASSERT_EQ(set.count(), 4);
+    ASSERT_GE(set.capacity(), 201);
+
+    ASSERT_TRUE(set.test(5));
+    ASSERT_TRUE(set.test(63));
+    ASSERT_TRUE(set.test(64));
+    ASSERT_TRUE(set.test(200));
+    ASSERT_FALSE(set.test(6));
+    ASSERT_FALSE(set.test(199));
+
+    // Indices always come out in ascending order
+    ASSERT_EQ(set.getIndices(), std::vector<DenseBitSet::Index>({ 5, 63, 64, 200 }));
+
+    // The cached list is reused until something changes
+    const auto* indices = &set.getIndices();
+    ASSERT_EQ(&set.getIndices(), indices);
+
+    ASSERT_TRUE(set.reset(63));
+    ASSERT_FALSE(set.reset(63));
+    ASSERT_FALSE(set.reset(5000));
+    ASSERT_EQ(set.count(), 3);
+    ASSERT_EQ(set.getIndices(), std::vector<DenseBitSet::Index>({ 5, 64, 200 }));
+
+    std::vector<DenseBitSet::Index> visited;
+    set.forEach([&visited](auto index) { visited.push_back(index); });
+    ASSERT_EQ(visited, std::vector<DenseBitSet::Index>({ 5, 64, 200 }));
+
+    // Clearing keeps the space around
+    auto capacity = set.capacity();
+    set.clear();
+    ASSERT_TRUE(set.empty());
+    ASSERT_EQ(set.capacity(), capacity);
+    ASSERT_FALSE(set.test(200));
+    ASSERT_TRUE(set.getIndices().empty());
+
+    DenseBitSet reserved(1000);
+    ASSERT_GE(reserved.capacity(), 1000);
+    ASSERT_TRUE(reserved.empty());
+}
+
+TEST(UtilTests, SelectionMaskTests) {
+    using HMDT::SelectionMask;
+    using Rows = std::optional<std::pair<std::uint32_t, std::uint32_t>>;
+
+    constexpr auto W = SelectionMask::ROW_WIDTH;
+
+    SelectionMask mask(W * 4);
+
+    ASSERT_EQ(mask.getWidth(), W);
+    ASSERT_EQ(mask.getHeight(), 4);
+    ASSERT_EQ(mask.count(), 0);
+
+    // A brand new mask must be uploaded in full
+    ASSERT_TRUE(mask.isResized());
+    ASSERT_EQ(mask.getDirtyRows(), Rows(std::make_pair(0U, 4U)));
+    mask.markClean();
+    ASSERT_EQ(mask.getDirtyRows(), std::nullopt);
+
+    // Label 0 means "no label", and can never be selected
+    ASSERT_FALSE(mask.set(0));
+    ASSERT_FALSE(mask.test(0));
+    ASSERT_EQ(mask.getDirtyRows(), std::nullopt);
+
+    // Only the rows which were touched need to be uploaded
+    ASSERT_TRUE(mask.set(W + 5));
+    ASSERT_FALSE(mask.set(W + 5));
+    ASSERT_TRUE(mask.test(W + 5));
+    ASSERT_EQ(mask.getRow(1)[5], SelectionMask::SELECTED);
+    ASSERT_EQ(mask.getData()[W + 5], SelectionMask::SELECTED);
+    ASSERT_EQ(mask.getDirtyRows(), Rows(std::make_pair(1U, 2U)));
+
+    ASSERT_TRUE(mask.set(3 * W));
+    ASSERT_EQ(mask.getDirtyRows(), Rows(std::make_pair(1U, 4U)));
+    ASSERT_FALSE(mask.isResized());
+    mask.markClean();
+
+    // Assigning only touches labels whose selection changes
+    mask.assign({ 3 * W, 7, 7 });
+    ASSERT_EQ(mask.count(), 2);
+    ASSERT_TRUE(mask.test(7));
+    ASSERT_TRUE(mask.test(3 * W));
+    ASSERT_FALSE(mask.test(W + 5));
+    ASSERT_EQ(mask.getDirtyRows(), Rows(std::make_pair(0U, 2U)));
+    mask.markClean();
+
+    mask.assign({ 3 * W, 7 });
+    ASSERT_EQ(mask.getDirtyRows(), std::nullopt);
+
+    // Deselecting
+    ASSERT_TRUE(mask.set(7, false));
+    ASSERT_FALSE(mask.set(7, false));
+    ASSERT_FALSE(mask.test(7));
+    ASSERT_EQ(mask.getRow(0)[7], SelectionMask::NOT_SELECTED);
+    ASSERT_EQ(mask.count(), 1);
+    mask.markClean();
+
+    // Selecting past the end grows the mask, which must then be re-uploaded
+    ASSERT_TRUE(mask.set(W * 6));
+    ASSERT_TRUE(mask.isResized());
+    ASSERT_EQ(mask.getHeight(), 7);
+    ASSERT_EQ(mask.getDirtyRows(), Rows(std::make_pair(0U, 7U)));
+    ASSERT_TRUE(mask.test(3 * W));
+    mask.markClean();
+
+    // Shrinking drops anything which no longer fits
+    mask.resize(W * 2);
+    ASSERT_EQ(mask.getHeight(), 2);
+    ASSERT_EQ(mask.count(), 0);
+    ASSERT_FALSE(mask.test(3 * W));
+    mask.markClean();
+
+    mask.assign({ 1, 2, 3 });
+    mask.markClean();
+    mask.clear();
+    ASSERT_EQ(mask.count(), 0);
+    ASSERT_FALSE(mask.test(2));
+    ASSERT_EQ(mask.getDirtyRows(), Rows(std::make_pair(0U, 1U)));
+}
+
+TEST(UtilTests, MapDataLazyLayerTests) {
+    using Layer = HMDT::MapData::Layer;
+
+    HMDT::MapData map_data(16, 8);
+
+    // Nothing is allocated up front
+    ASSERT_EQ(map_data.getResidentSize(), 0);
+    ASSERT_FALSE(map_data.isResident(Layer::HEIGHTMAP));
+    ASSERT_FALSE(map_data.isResident(Layer::CITIES));
+
+    // Layers are allocated and zero-filled on first access, whether or not
+    //   the access is const
+    {
+        auto heightmap = map_data.getHeightMap().lock();
+        ASSERT_NE(heightmap, nullptr);
+        ASSERT_TRUE(map_data.isResident(Layer::HEIGHTMAP));
+        ASSERT_EQ(map_data.getResidentSize(), map_data.getHeightMapSize());
+
+        for(uint32_t i = 0; i < map_data.getHeightMapSize(); ++i) {
+            ASSERT_EQ(heightmap[i], 0);
+        }
+        heightmap[0] = 42;
+
+        // Later accesses get the same layer back
+        ASSERT_EQ(map_data.getHeightMap().lock()[0], 42);
+    }
+
+    {
+        const auto& const_map_data = map_data;
+        auto label_matrix = const_map_data.getLabelMatrix().lock();
+        ASSERT_NE(label_matrix, nullptr);
+        ASSERT_TRUE(map_data.isResident(Layer::LABEL_MATRIX));
+        ASSERT_EQ(map_data.getResidentSize(),
+                  map_data.getHeightMapSize() +
+                  map_data.getMatrixSize() * sizeof(uint32_t));
+    }
+
+    // Releasing a layer only affects that layer, and anything still holding
+    //   onto it keeps it alive
+    {
+        auto held_heightmap = map_data.getHeightMap().lock();
+
+        auto tag = map_data.getStateIDMatrixUpdatedTag();
+        map_data.release(Layer::HEIGHTMAP);
+        map_data.release(Layer::STATE_ID_MATRIX);
+        ASSERT_NE(map_data.getStateIDMatrixUpdatedTag(), tag);
+
+        ASSERT_FALSE(map_data.isResident(Layer::HEIGHTMAP));
+        ASSERT_TRUE(map_data.isResident(Layer::LABEL_MATRIX));
+        ASSERT_EQ(held_heightmap[0], 42);
+
+        // And the layer comes back empty
+        ASSERT_EQ(map_data.getHeightMap().lock()[0], 0);
+    }
+
+    // An empty map never allocates anything
+    HMDT::MapData empty_map_data;
+    ASSERT_EQ(empty_map_data.getCities().lock(), nullptr);
+    ASSERT_FALSE(empty_map_data.isResident(Layer::CITIES));
+}